@@ -10,6 +10,7 @@
 #include "Core/Macros.h"
 #include "Core/Common.h"
 #include "Core/Memory.h"
+#include "Core/Atomic.h"
 
 #include <new>
 
@@ -33,20 +34,26 @@ namespace zp
         constexpr MemoryLabel Temp = 7;
         constexpr MemoryLabel ThreadSafe = 8;
 
-        constexpr MemoryLabel Profiling = 9;
-        constexpr MemoryLabel Debug = 10;
+        // reset every frame, Frame memory stays valid as PreviousFrame through the next frame
+        constexpr MemoryLabel Frame = 9;
+        constexpr MemoryLabel PreviousFrame = 10;
 
-        constexpr MemoryLabel MemoryLabels_Count = 11;
+        constexpr MemoryLabel Profiling = 11;
+        constexpr MemoryLabel Debug = 12;
+
+        constexpr MemoryLabel MemoryLabels_Count = 13;
     };
 
     ZP_STATIC_ASSERT( static_cast<MemoryLabel>( MemoryLabels::MemoryLabels_Count ) < kMaxMemoryLabels );
 }
 
-#define ZP_NEW( l, t )                      new (zp::GetAllocator(static_cast<zp::MemoryLabel>(l))->allocate(sizeof(t), zp::kDefaultMemoryAlignment)) t(static_cast<zp::MemoryLabel>(l))
-#define ZP_NEW_ARGS( l, t, ... )            new (zp::GetAllocator(static_cast<zp::MemoryLabel>(l))->allocate(sizeof(t), zp::kDefaultMemoryAlignment)) t(static_cast<zp::MemoryLabel>(l),__VA_ARGS__)
+// over aligned types (cache line padded members) get their own alignment
+#define ZP_NEW_ALIGNMENT( t )               ( alignof(t) > zp::kDefaultMemoryAlignment ? alignof(t) : zp::kDefaultMemoryAlignment )
+#define ZP_NEW( l, t )                      new (zp::GetAllocator(static_cast<zp::MemoryLabel>(l))->allocate(sizeof(t), ZP_NEW_ALIGNMENT(t), static_cast<zp::MemoryLabel>(l))) t(static_cast<zp::MemoryLabel>(l))
+#define ZP_NEW_ARGS( l, t, ... )            new (zp::GetAllocator(static_cast<zp::MemoryLabel>(l))->allocate(sizeof(t), ZP_NEW_ALIGNMENT(t), static_cast<zp::MemoryLabel>(l))) t(static_cast<zp::MemoryLabel>(l),__VA_ARGS__)
 
-#define ZP_DELETE( t, p )                   do { const zp::MemoryLabel ZP_CONCAT(__memoryLabel_, __LINE__) = static_cast<t*>(p)->memoryLabel; static_cast<t*>(p)->~t(); zp::GetAllocator(ZP_CONCAT(__memoryLabel_, __LINE__))->free(p); (p) = nullptr; } while( false )
-#define ZP_DELETE_LABEL( l, t, p )          do { (p)->~t(); zp::GetAllocator(static_cast<zp::MemoryLabel>(l))->free(p); (p) = nullptr; } while( false )
+#define ZP_DELETE( t, p )                   do { const zp::MemoryLabel ZP_CONCAT(__memoryLabel_, __LINE__) = static_cast<t*>(p)->memoryLabel; static_cast<t*>(p)->~t(); zp::GetAllocator(ZP_CONCAT(__memoryLabel_, __LINE__))->free(p, ZP_CONCAT(__memoryLabel_, __LINE__)); (p) = nullptr; } while( false )
+#define ZP_DELETE_LABEL( l, t, p )          do { (p)->~t(); zp::GetAllocator(static_cast<zp::MemoryLabel>(l))->free(p, static_cast<zp::MemoryLabel>(l)); (p) = nullptr; } while( false )
 
 #if ZP_USE_SAFE_DELETE
 #define ZP_SAFE_DELETE( t, p )              do { if( p ) { ZP_DELETE( t, p ); } } while( false )
@@ -56,19 +63,19 @@ namespace zp
 #define ZP_SAFE_DELETE_LABEL( l, t, p )     ZP_DELETE_LABEL(l, t, p)
 #endif // ZP_USE_SAFE_DELETE
 
-#define ZP_MALLOC( l, s )                           zp::GetAllocator(static_cast<zp::MemoryLabel>(l))->allocate((s), zp::kDefaultMemoryAlignment)
-#define ZP_ALIGNED_MALLOC( l, s, a )                zp::GetAllocator(static_cast<zp::MemoryLabel>(l))->allocate((s), (a))
+#define ZP_MALLOC( l, s )                           zp::GetAllocator(static_cast<zp::MemoryLabel>(l))->allocate((s), zp::kDefaultMemoryAlignment, static_cast<zp::MemoryLabel>(l))
+#define ZP_ALIGNED_MALLOC( l, s, a )                zp::GetAllocator(static_cast<zp::MemoryLabel>(l))->allocate((s), (a), static_cast<zp::MemoryLabel>(l))
 
-#define ZP_MALLOC_T( l, t )                         static_cast<t*>(zp::GetAllocator(static_cast<zp::MemoryLabel>(l))->allocate(sizeof(t), zp::kDefaultMemoryAlignment))
-#define ZP_ALIGNED_MALLOC_T( l, t, a )              static_cast<t*>(zp::GetAllocator(static_cast<zp::MemoryLabel>(l))->allocate(sizeof(t), (a)))
+#define ZP_MALLOC_T( l, t )                         static_cast<t*>(zp::GetAllocator(static_cast<zp::MemoryLabel>(l))->allocate(sizeof(t), zp::kDefaultMemoryAlignment, static_cast<zp::MemoryLabel>(l)))
+#define ZP_ALIGNED_MALLOC_T( l, t, a )              static_cast<t*>(zp::GetAllocator(static_cast<zp::MemoryLabel>(l))->allocate(sizeof(t), (a), static_cast<zp::MemoryLabel>(l)))
 
-#define ZP_MALLOC_T_ARRAY( l, t, c )                static_cast<t*>(zp::GetAllocator(static_cast<zp::MemoryLabel>(l))->allocate(sizeof(t) * (c), zp::kDefaultMemoryAlignment))
-#define ZP_ALIGNED_MALLOC_T_ARRAY( l, t, c, a )     static_cast<t*>(zp::GetAllocator(static_cast<zp::MemoryLabel>(l))->allocate(sizeof(t) * (c), (a)))
+#define ZP_MALLOC_T_ARRAY( l, t, c )                static_cast<t*>(zp::GetAllocator(static_cast<zp::MemoryLabel>(l))->allocate(sizeof(t) * (c), zp::kDefaultMemoryAlignment, static_cast<zp::MemoryLabel>(l)))
+#define ZP_ALIGNED_MALLOC_T_ARRAY( l, t, c, a )     static_cast<t*>(zp::GetAllocator(static_cast<zp::MemoryLabel>(l))->allocate(sizeof(t) * (c), (a), static_cast<zp::MemoryLabel>(l)))
 
-#define ZP_REALLOC( l, p, s )                       zp::GetAllocator(static_cast<zp::MemoryLabel>(l))->reallocate( (p), (s), zp::kDefaultMemoryAlignment)
-#define ZP_ALIGNED_REALLOC( l, p, s, a )            zp::GetAllocator(static_cast<zp::MemoryLabel>(l))->reallocate((p), (s), (a))
+#define ZP_REALLOC( l, p, s )                       zp::GetAllocator(static_cast<zp::MemoryLabel>(l))->reallocate((p), (s), zp::kDefaultMemoryAlignment, static_cast<zp::MemoryLabel>(l))
+#define ZP_ALIGNED_REALLOC( l, p, s, a )            zp::GetAllocator(static_cast<zp::MemoryLabel>(l))->reallocate((p), (s), (a), static_cast<zp::MemoryLabel>(l))
 
-#define ZP_FREE( l, p )                             zp::GetAllocator(static_cast<zp::MemoryLabel>(l))->free((p))
+#define ZP_FREE( l, p )                             zp::GetAllocator(static_cast<zp::MemoryLabel>(l))->free((p), static_cast<zp::MemoryLabel>(l))
 
 #if ZP_USE_SAFE_FREE
 #define ZP_SAFE_FREE( l, p )            do { if( p ) { ZP_FREE( l, p ); } } while( false )
@@ -79,14 +86,27 @@ namespace zp
 
 namespace zp
 {
+    struct MemoryHeapStats
+    {
+        zp_size_t totalBytes;
+        zp_size_t usedBytes;
+        zp_size_t freeBytes;
+        zp_size_t largestFreeBlock;
+        zp_size_t freeBlockCount;
+    };
+
     class ZP_DECLSPEC_NOVTABLE IMemoryAllocator
     {
     public:
-        virtual void* allocate( zp_size_t size, zp_size_t alignment ) = 0;
+        // memoryLabel is the label the allocation was made through, several labels can share one allocator
+        virtual void* allocate( zp_size_t size, zp_size_t alignment, MemoryLabel memoryLabel ) = 0;
 
-        virtual void* reallocate( void* ptr, zp_size_t size, zp_size_t alignment ) = 0;
+        virtual void* reallocate( void* ptr, zp_size_t size, zp_size_t alignment, MemoryLabel memoryLabel ) = 0;
 
-        virtual void free( void* ptr ) = 0;
+        virtual void free( void* ptr, MemoryLabel memoryLabel ) = 0;
+
+        // walks the heap under the allocator lock when the policy supports it, expensive
+        virtual void queryHeapStats( MemoryHeapStats& heapStats ) = 0;
     };
 
     template<typename Storage, typename Policy, typename Locking, typename Profiler>
@@ -114,22 +134,59 @@ namespace zp
 
         ~MemoryAllocator() = default;
 
-        void* allocate( zp_size_t size, zp_size_t alignment ) final;
+        void* allocate( zp_size_t size, zp_size_t alignment, MemoryLabel memoryLabel ) final;
+
+        void* reallocate( void* ptr, zp_size_t size, zp_size_t alignment, MemoryLabel memoryLabel ) final;
+
+        void free( void* ptr, MemoryLabel memoryLabel ) final;
+
+        void queryHeapStats( MemoryHeapStats& heapStats ) final;
 
-        void* reallocate( void* ptr, zp_size_t size, zp_size_t alignment ) final;
+        // direct use of an allocator, tracked under the allocator's own label
+        void* allocate( zp_size_t size, zp_size_t alignment )
+        {
+            return allocate( size, alignment, m_memoryLabel );
+        }
+
+        void* reallocate( void* ptr, zp_size_t size, zp_size_t alignment )
+        {
+            return reallocate( ptr, size, alignment, m_memoryLabel );
+        }
 
-        void free( void* ptr ) final;
+        void free( void* ptr )
+        {
+            free( ptr, m_memoryLabel );
+        }
 
         policy_reference policy()
         {
             return m_policy;
         }
 
+        storage_const_reference storage() const
+        {
+            return m_storage;
+        }
+
     private:
+        // size the profiler tracks for ptr, the policy's block size when it knows it
+        zp_size_t tracked_size( void* ptr, zp_size_t requestedSize ) const;
+
+        // called under the lock
+        void grow( zp_size_t size );
+
+        // called under the lock, requests memory for size even when the policy's counters say it has room. returns false
+        // when the storage is fixed or out of memory
+        zp_bool_t add_memory( zp_size_t size );
+
+        // called under the lock, gives free pools back to storage past its high water mark
+        void release_free_memory();
+
         storage_value m_storage;
         policy_value m_policy;
         lock_value m_lock;
         profiler_value m_profiler;
+        zp_size_t m_releaseCheckAllocated;
         MemoryLabel m_memoryLabel;
     };
 
@@ -137,6 +194,118 @@ namespace zp
 
     IMemoryAllocator* GetAllocator( MemoryLabel memoryLabel );
 
+    //
+    // Memory stats, counted by TrackedMemoryProfiler allocators
+    //
+
+    enum
+    {
+        kMemoryHistogramBucketCount = 16,
+    };
+
+    struct MemoryLabelStats
+    {
+        zp_size_t liveBytes;
+        zp_size_t liveCount;
+        zp_size_t peakBytes;
+
+        // since the previous snapshot
+        zp_size_t allocations;
+        zp_size_t frees;
+
+        // live allocations by size, bucket i holds sizes up to 16 << i and the last bucket everything larger
+        zp_size_t histogram[ kMemoryHistogramBucketCount ];
+
+        // allocator backing the label, shared with any other label registered to it. Only filled by heap snapshots
+        MemoryHeapStats heapStats;
+    };
+
+    // size bucket of the allocation histogram
+    zp_size_t GetMemoryHistogramBucket( zp_size_t size );
+
+    // takes a new snapshot of every label's counters, done automatically on Profiler::AdvanceFrame. Heap stats walk every
+    // allocator's heap under its lock, only request them when other threads aren't using allocators without a real lock
+    void SnapshotMemoryStats( zp_bool_t includeHeapStats = false );
+
+    // stats from the last snapshot indexed by label. Returns the number written
+    zp_size_t GetMemoryLabelStats( MemoryLabelStats* labelStats, zp_size_t labelStatsCount );
+
+    void RegisterMemoryStatsSnapshot();
+
+    void UnregisterMemoryStatsSnapshot();
+
+    //
+    // Sampling heap profiler, records the stack of roughly one allocation every sampling rate bytes per thread
+    //
+
+    class DataStreamWriter;
+
+    enum
+    {
+        kDefaultMemorySamplingRate = 512 KB,
+        kMaxMemorySamples = 2048,
+    };
+
+    enum class MemorySampleFormat
+    {
+        // legacy pprof heap profile, heap_v2
+        Pprof,
+
+        // folded stacks for flame graphs, weighted by estimated live bytes
+        Folded,
+    };
+
+    struct MemorySamplerStats
+    {
+        zp_size_t liveSamples;
+        zp_size_t droppedSamples;
+        zp_size_t samplingRate;
+    };
+
+    // average bytes between samples, 0 disables sampling. Other threads pick up the new rate after their current interval
+    void SetMemorySamplingRate( zp_size_t samplingRate );
+
+    MemorySamplerStats GetMemorySamplerStats();
+
+    // writes every live sample
+    void WriteMemorySamples( DataStreamWriter& writer, MemorySampleFormat format );
+
+    //
+    // Memory budgets, enforced on the live bytes counted by TrackedMemoryProfiler allocators
+    //
+
+    struct MemoryBudget
+    {
+        // pressure callbacks run at the next frame boundary while live bytes are above it, 0 for none
+        zp_size_t softLimit;
+
+        // allocations that would pass it call the exceeded handler and return nullptr, 0 for none
+        zp_size_t hardLimit;
+    };
+
+    using MemoryPressureCallback = void ( * )( MemoryLabel memoryLabel, zp_size_t liveBytes, zp_size_t softLimit, void* userData );
+
+    using MemoryBudgetExceededHandler = void ( * )( MemoryLabel memoryLabel, zp_size_t liveBytes, zp_size_t hardLimit );
+
+    void SetMemoryBudget( MemoryLabel memoryLabel, const MemoryBudget& budget );
+
+    MemoryBudget GetMemoryBudget( MemoryLabel memoryLabel );
+
+    // callbacks should free what they can (evict caches, shrink rings), they run for every label over its soft budget
+    void RegisterMemoryPressureCallback( MemoryPressureCallback callback, void* userData );
+
+    void UnregisterMemoryPressureCallback( MemoryPressureCallback callback, void* userData );
+
+    // runs pressure callbacks for labels that went over their soft budget since the last call, once per frame
+    void ProcessMemoryPressure();
+
+    // called from an allocation that would go over a hard budget, the allocation fails once it returns. The default
+    // prints the top consumers, install one to terminate instead. nullptr restores the default
+    void SetMemoryBudgetExceededHandler( MemoryBudgetExceededHandler handler );
+
+    // labels by live bytes and, when sampling, the largest sampled call stacks of memoryLabel
+    void PrintTopMemoryConsumers( MemoryLabel memoryLabel );
+
     //
     //
     //
@@ -163,13 +332,13 @@ namespace zp
 
         [[nodiscard]] void* allocate( zp_size_t size ) const
         {
-            void* ptr = GetAllocator( memoryLabel )->allocate( size, alignment );
+            void* ptr = GetAllocator( memoryLabel )->allocate( size, alignment, memoryLabel );
             return ptr;
         }
 
         void free( void* ptr ) const
         {
-            GetAllocator( memoryLabel )->free( ptr );
+            GetAllocator( memoryLabel )->free( ptr, memoryLabel );
         }
 
     private:
@@ -190,6 +359,8 @@ namespace zp
         , m_policy( zp_move( policy ) )
         , m_lock( zp_move( locking ) )
         , m_profiler( zp_move( profiler ) )
+        , m_releaseCheckAllocated( 0 )
+        , m_memoryLabel( MemoryLabels::Default )
     {
         if( m_storage.is_fixed() )
         {
@@ -200,27 +371,105 @@ namespace zp
     }
 
     template<typename Storage, typename Policy, typename Locking, typename Profiler>
-    void* MemoryAllocator<Storage, Policy, Locking, Profiler>::allocate( const zp_size_t size, const zp_size_t alignment )
+    void* MemoryAllocator<Storage, Policy, Locking, Profiler>::allocate( const zp_size_t size, const zp_size_t alignment, const MemoryLabel memoryLabel )
     {
+        // allocations racing past the budget check can overshoot it by one allocation each
+        if constexpr( requires { m_profiler.within_budget( size, 0, memoryLabel ); } )
+        {
+            if( !m_profiler.within_budget( size, 0, memoryLabel ) ) [[unlikely]]
+            {
+                m_profiler.report_over_budget( size, 0, memoryLabel );
+                return nullptr;
+            }
+        }
+
+        // policies with a lock free fast path (thread caches, atomic bump) only fall back to the lock when it misses
+        if constexpr( requires { m_policy.try_allocate( size, alignment ); } )
+        {
+            void* ptr = m_policy.try_allocate( size, alignment );
+            if( ptr )
+            {
+                m_profiler.track_allocate( ptr, tracked_size( ptr, size ), alignment, memoryLabel );
+                return ptr;
+            }
+        }
+
         m_lock.acquire();
-        if( !m_storage.is_fixed() )
+
+        void* ptr;
+
+        // lock free pools can lose the free slots counted by grow() to allocations outside the lock, so add slabs until
+        // the pop under the lock succeeds
+        if constexpr( requires { m_policy.empty(); } )
         {
-            const zp_size_t allocSize = size + m_policy.overhead();
-            const zp_size_t allocatedSize = m_policy.allocated();
-            const zp_size_t totalSize = m_policy.total();
+            for( ;; )
+            {
+                if( m_policy.empty() && !add_memory( size ) )
+                {
+                    ptr = nullptr;
+                    break;
+                }
+
+                ptr = m_policy.allocate( size, alignment );
+                if( ptr != nullptr || m_storage.is_fixed() )
+                {
+                    break;
+                }
+            }
+        }
+        else
+        {
+            grow( size );
 
-            if( ( allocatedSize + allocSize ) >= totalSize )
+            ptr = m_policy.allocate( size, alignment );
+        }
+
+        ZP_ASSERT_MSG( ptr, "Out of memory" );
+
+        if( ptr != nullptr )
+        {
+            m_profiler.track_allocate( ptr, tracked_size( ptr, size ), alignment, memoryLabel );
+        }
+
+        m_lock.release();
+
+        return ptr;
+    }
+
+    template<typename Storage, typename Policy, typename Locking, typename Profiler>
+    void* MemoryAllocator<Storage, Policy, Locking, Profiler>::reallocate( void* oldPtr, const zp_size_t size, const zp_size_t alignment, const MemoryLabel memoryLabel )
+    {
+        // reallocating nothing from a lock free pool has to take allocate's slab retry
+        if constexpr( requires { m_policy.empty(); } )
+        {
+            if( oldPtr == nullptr )
             {
-                zp_size_t requestedSize;
-                void* mem = m_storage.request_memory( allocSize, requestedSize );
-                m_policy.add_memory( mem, requestedSize );
+                return allocate( size, alignment, memoryLabel );
             }
         }
 
-        void* ptr = m_policy.allocate( size, alignment );
+        m_lock.acquire();
+
+        const zp_size_t oldSize = oldPtr ? tracked_size( oldPtr, 0 ) : 0;
+
+        if constexpr( requires { m_profiler.within_budget( size, oldSize, memoryLabel ); } )
+        {
+            if( !m_profiler.within_budget( size, oldSize, memoryLabel ) ) [[unlikely]]
+            {
+                m_lock.release();
+
+                // oldPtr stays allocated, as with any failed reallocate
+                m_profiler.report_over_budget( size, oldSize, memoryLabel );
+                return nullptr;
+            }
+        }
+
+        grow( size );
+
+        void* ptr = m_policy.reallocate( oldPtr, size, alignment );
         ZP_ASSERT( ptr );
 
-        m_profiler.track_allocate( ptr, size, alignment, m_memoryLabel );
+        m_profiler.track_reallocate( oldPtr, oldSize, ptr, tracked_size( ptr, size ), alignment, memoryLabel );
 
         m_lock.release();
 
@@ -228,9 +477,58 @@ namespace zp
     }
 
     template<typename Storage, typename Policy, typename Locking, typename Profiler>
-    void* MemoryAllocator<Storage, Policy, Locking, Profiler>::reallocate( void* oldPtr, const zp_size_t size, const zp_size_t alignment )
+    void MemoryAllocator<Storage, Policy, Locking, Profiler>::free( void* ptr, const MemoryLabel memoryLabel )
+    {
+        if constexpr( requires { m_policy.try_free( ptr ); } )
+        {
+            // policies with a lock free path keep block sizes readable without the lock, read it while ptr is still allocated
+            const zp_size_t size = ptr ? tracked_size( ptr, 0 ) : 0;
+
+            if( m_policy.try_free( ptr ) )
+            {
+                m_profiler.track_free( ptr, size, memoryLabel );
+                return;
+            }
+        }
+
+        m_lock.acquire();
+
+        const zp_size_t size = ptr ? tracked_size( ptr, 0 ) : 0;
+
+        m_policy.free( ptr );
+
+        m_profiler.track_free( ptr, size, memoryLabel );
+
+        release_free_memory();
+
+        m_lock.release();
+    }
+
+    template<typename Storage, typename Policy, typename Locking, typename Profiler>
+    void MemoryAllocator<Storage, Policy, Locking, Profiler>::queryHeapStats( MemoryHeapStats& heapStats )
     {
         m_lock.acquire();
+
+        const zp_size_t totalBytes = m_policy.total();
+        const zp_size_t usedBytes = m_policy.allocated();
+
+        heapStats = {
+            .totalBytes = totalBytes,
+            .usedBytes = usedBytes,
+            .freeBytes = totalBytes > usedBytes ? totalBytes - usedBytes : 0,
+        };
+
+        if constexpr( requires { m_policy.heap_stats( heapStats ); } )
+        {
+            m_policy.heap_stats( heapStats );
+        }
+
+        m_lock.release();
+    }
+
+    template<typename Storage, typename Policy, typename Locking, typename Profiler>
+    void MemoryAllocator<Storage, Policy, Locking, Profiler>::grow( const zp_size_t size )
+    {
         if( !m_storage.is_fixed() )
         {
             const zp_size_t allocSize = size + m_policy.overhead();
@@ -239,32 +537,77 @@ namespace zp
 
             if( ( allocatedSize + allocSize ) >= totalSize )
             {
-                zp_size_t requestedSize;
-                void* mem = m_storage.request_memory( allocSize, requestedSize );
-                m_policy.add_memory( mem, requestedSize );
+                add_memory( size );
             }
         }
+    }
 
-        void* ptr = m_policy.reallocate( oldPtr, size, alignment );
-        ZP_ASSERT( ptr );
+    template<typename Storage, typename Policy, typename Locking, typename Profiler>
+    zp_bool_t MemoryAllocator<Storage, Policy, Locking, Profiler>::add_memory( const zp_size_t size )
+    {
+        if( m_storage.is_fixed() )
+        {
+            return false;
+        }
 
-        m_profiler.track_reallocate( oldPtr, ptr, size, alignment, m_memoryLabel );
+        zp_size_t requestedSize;
+        void* mem = m_storage.request_memory( size + m_policy.overhead(), requestedSize );
 
-        m_lock.release();
+        // reservation used up or the commit failed, nothing to hand the policy
+        if( mem == nullptr )
+        {
+            return false;
+        }
 
-        return ptr;
+        m_policy.add_memory( mem, requestedSize );
+
+        m_releaseCheckAllocated = m_policy.total();
+
+        return true;
     }
 
     template<typename Storage, typename Policy, typename Locking, typename Profiler>
-    void MemoryAllocator<Storage, Policy, Locking, Profiler>::free( void* ptr )
+    void MemoryAllocator<Storage, Policy, Locking, Profiler>::release_free_memory()
     {
-        m_lock.acquire();
+        if constexpr( requires( void* mem, zp_size_t size ) { m_storage.release_memory( mem, size ); m_policy.release_free_pool( size ); } )
+        {
+            // looking for free pools walks the heap, only look again once at least a page worth has been freed
+            if( !m_storage.should_release_memory() || m_policy.allocated() + m_storage.page_size() > m_releaseCheckAllocated )
+            {
+                return;
+            }
 
-        m_policy.free( ptr );
+            while( m_storage.should_release_memory() )
+            {
+                zp_size_t poolSize;
+                void* pool = m_policy.release_free_pool( poolSize );
+                if( pool == nullptr )
+                {
+                    break;
+                }
+
+                m_storage.release_memory( pool, poolSize );
+            }
 
-        m_profiler.track_free( ptr, m_memoryLabel );
+            m_releaseCheckAllocated = m_policy.allocated();
+        }
+    }
 
-        m_lock.release();
+    template<typename Storage, typename Policy, typename Locking, typename Profiler>
+    zp_size_t MemoryAllocator<Storage, Policy, Locking, Profiler>::tracked_size( void* ptr, const zp_size_t requestedSize ) const
+    {
+        if constexpr( !Profiler::kTracksAllocations )
+        {
+            return requestedSize;
+        }
+        else if constexpr( requires { m_policy.block_size( ptr ); } )
+        {
+            return m_policy.block_size( ptr );
+        }
+        else
+        {
+            return requestedSize;
+        }
     }
 }
 
@@ -333,15 +676,17 @@ namespace zp
 
     struct NullMemoryProfiler
     {
+        static constexpr zp_bool_t kTracksAllocations = false;
+
         ZP_FORCEINLINE void track_allocate( void* ptr, zp_size_t size, zp_size_t alignment, MemoryLabel memoryLabel )
         {
         }
 
-        ZP_FORCEINLINE void track_reallocate( void* oldPtr, void* ptr, zp_size_t size, zp_size_t alignment, MemoryLabel memoryLabel )
+        ZP_FORCEINLINE void track_reallocate( void* oldPtr, zp_size_t oldSize, void* ptr, zp_size_t size, zp_size_t alignment, MemoryLabel memoryLabel )
         {
         }
 
-        ZP_FORCEINLINE void track_free( void* ptr, MemoryLabel memoryLabel )
+        ZP_FORCEINLINE void track_free( void* ptr, zp_size_t size, MemoryLabel memoryLabel )
         {
         }
     };
@@ -350,19 +695,22 @@ namespace zp
 
 namespace zp
 {
+    // per label live bytes, counts, peaks and size histogram, see SnapshotMemoryStats
     struct TrackedMemoryProfiler
     {
-        ZP_FORCEINLINE void track_allocate( void* ptr, zp_size_t size, zp_size_t alignment, MemoryLabel memoryLabel )
-        {
-        }
+        static constexpr zp_bool_t kTracksAllocations = ZP_USE_MEMORY_PROFILER;
 
-        ZP_FORCEINLINE void track_reallocate( void* oldPtr, void* ptr, zp_size_t size, zp_size_t alignment, MemoryLabel memoryLabel )
-        {
-        }
+        void track_allocate( void* ptr, zp_size_t size, zp_size_t alignment, MemoryLabel memoryLabel );
 
-        ZP_FORCEINLINE void track_free( void* ptr, MemoryLabel memoryLabel )
-        {
-        }
+        void track_reallocate( void* oldPtr, zp_size_t oldSize, void* ptr, zp_size_t size, zp_size_t alignment, MemoryLabel memoryLabel );
+
+        void track_free( void* ptr, zp_size_t size, MemoryLabel memoryLabel );
+
+        // false when allocating size bytes, with releasedSize given back, would pass memoryLabel's hard budget
+        [[nodiscard]] zp_bool_t within_budget( zp_size_t size, zp_size_t releasedSize, MemoryLabel memoryLabel ) const;
+
+        // calls the budget exceeded handler for an allocation within_budget failed, without any allocator lock held
+        void report_over_budget( zp_size_t size, zp_size_t releasedSize, MemoryLabel memoryLabel ) const;
     };
 };
 
@@ -371,13 +719,23 @@ namespace zp
 {
     class CriticalSectionMemoryLock
     {
+        ZP_NONCOPYABLE( CriticalSectionMemoryLock );
+
     public:
+        CriticalSectionMemoryLock();
+
+        // a lock is only moved before it is ever used, the new lock gets its own critical section
+        CriticalSectionMemoryLock( CriticalSectionMemoryLock&& other ) noexcept;
+
+        ~CriticalSectionMemoryLock();
+
         void acquire();
 
         void release();
 
     private:
-        //CriticalSection m_criticalSection;
+        // storage for a Platform CriticalSection, Platform.h can't be included here
+        alignas( 8 ) zp_uint8_t m_criticalSection[ 40 ];
     };
 }
 #pragma endregion
@@ -385,18 +743,46 @@ namespace zp
 #pragma region System Page Memory Allocator
 namespace zp
 {
+    enum
+    {
+        kMaxReleasedMemoryRanges = 16,
+    };
+
     class SystemPageMemoryStorage
     {
     public:
-        SystemPageMemoryStorage( void* systemMemory, zp_size_t pageSize, zp_size_t totalSize );
+        // committed memory past decommitHighWaterMark is given back to the system as the policy frees whole pools, 0 keeps
+        // everything. Large pages fall back to regular pages when the system or process doesn't allow them
+        SystemPageMemoryStorage( void* systemMemory, zp_size_t pageSize, zp_size_t totalSize, zp_size_t decommitHighWaterMark = 0, zp_bool_t useLargePages = false );
 
         void* request_memory( zp_size_t size, zp_size_t& requestedSize );
 
+        void release_memory( void* mem, zp_size_t size );
+
+        [[nodiscard]] zp_bool_t should_release_memory() const;
+
+        [[nodiscard]] zp_size_t page_size() const;
+
+        [[nodiscard]] zp_size_t committed() const;
+
         [[nodiscard]] zp_bool_t is_fixed() const;
 
     private:
+        struct ReleasedRange
+        {
+            void* ptr;
+            zp_size_t size;
+        };
+
+        void* request_released_memory( zp_size_t size );
+
+        FixedArray<ReleasedRange, kMaxReleasedMemoryRanges> m_releasedRanges;
+        zp_size_t m_releasedRangeCount;
         zp_size_t m_pageSize;
+        zp_size_t m_largePageSize;
         zp_size_t m_totalSize;
+        zp_size_t m_committedSize;
+        zp_size_t m_decommitHighWaterMark;
         void* m_systemMemory;
         void* m_memory;
     };
@@ -462,6 +848,223 @@ namespace zp
     };
 }
 
+namespace zp
+{
+    //
+    // Bump allocator safe to use from any thread without a lock, frees are no-ops. Each allocation is preceded by its
+    // size for reallocate. Memory added after the first add_memory has to follow on directly from it, which
+    // SystemPageMemoryStorage's page commits do.
+    //
+
+    class AtomicLinearAllocatorPolicy
+    {
+    public:
+        void add_memory( void* mem, zp_size_t size );
+
+        [[nodiscard]] zp_size_t allocated() const;
+
+        [[nodiscard]] zp_size_t total() const;
+
+        [[nodiscard]] zp_size_t overhead() const;
+
+        // lock free, nullptr when the committed memory is used up
+        void* try_allocate( zp_size_t size, zp_size_t alignment );
+
+        zp_bool_t try_free( void* ptr );
+
+        void* allocate( zp_size_t size, zp_size_t alignment );
+
+        void* reallocate( void* ptr, zp_size_t size, zp_size_t alignment );
+
+        void free( void* ptr );
+
+        [[nodiscard]] zp_size_t block_size( void* ptr ) const;
+
+        // only safe once nothing can be using or allocating memory from the allocator
+        void reset();
+
+    private:
+        zp_uint8_t* m_ptr {};
+        zp_int64_t m_allocated {};
+        zp_int64_t m_size {};
+    };
+}
+
+#pragma region Pool Memory Allocator
+namespace zp
+{
+    //
+    // Fixed size objects carved from slabs of storage memory. Allocate and free are a single CAS on a free list head
+    // tagged with a counter in the unused upper pointer bits, the allocator lock is only taken to add a new slab.
+    //
+
+    template<zp_size_t ObjectSize, zp_size_t Alignment = kDefaultMemoryAlignment>
+    class PoolAllocatorPolicy
+    {
+    public:
+        ZP_STATIC_ASSERT( ObjectSize > 0 );
+        ZP_STATIC_ASSERT( ( Alignment & ( Alignment - 1 ) ) == 0 );
+
+        static constexpr zp_size_t kSlotSize = zp_align_size( zp_max( ObjectSize, static_cast<zp_size_t>( sizeof( void* ) ) ), zp_max( Alignment, static_cast<zp_size_t>( alignof( void* ) ) ) );
+
+        void add_memory( void* mem, zp_size_t size )
+        {
+            const zp_ptr_t begin = zp_align_size( reinterpret_cast<zp_ptr_t>( mem ), zp_max( Alignment, static_cast<zp_size_t>( alignof( void* ) ) ) );
+            const zp_ptr_t end = reinterpret_cast<zp_ptr_t>( mem ) + size;
+
+            const zp_size_t slotCount = begin < end ? ( end - begin ) / kSlotSize : 0;
+            if( slotCount == 0 )
+            {
+                return;
+            }
+
+            // link the slab in address order so objects come out contiguous
+            zp_uint8_t* const first = reinterpret_cast<zp_uint8_t*>( begin );
+            for( zp_size_t i = 0; i < slotCount - 1; ++i )
+            {
+                *reinterpret_cast<void**>( first + ( i * kSlotSize ) ) = first + ( ( i + 1 ) * kSlotSize );
+            }
+
+            push( first, first + ( ( slotCount - 1 ) * kSlotSize ) );
+
+            Atomic::Add( &m_totalSlots, static_cast<zp_int64_t>( slotCount ) );
+        }
+
+        [[nodiscard]] zp_size_t allocated() const
+        {
+            return static_cast<zp_size_t>( Atomic::LoadAcquire( &m_allocatedSlots ) ) * kSlotSize;
+        }
+
+        [[nodiscard]] zp_size_t total() const
+        {
+            return static_cast<zp_size_t>( Atomic::LoadAcquire( &m_totalSlots ) ) * kSlotSize;
+        }
+
+        [[nodiscard]] zp_size_t overhead() const
+        {
+            return Alignment;
+        }
+
+        // only a snapshot, other threads may push or pop at any time
+        [[nodiscard]] zp_bool_t empty() const
+        {
+            return GetPointer( Atomic::LoadAcquire( &m_head ) ) == nullptr;
+        }
+
+        // lock free, nullptr when the pool needs another slab
+        void* try_allocate( zp_size_t size, zp_size_t alignment )
+        {
+            ZP_ASSERT_MSG( size <= ObjectSize && alignment <= kSlotSize && ( kSlotSize % alignment ) == 0, "Allocation does not fit the pool" );
+
+            // counted before the pop (and after the push in free) so allocated() never under reports for stats and release
+            Atomic::Increment( &m_allocatedSlots );
+
+            zp_int64_t head = Atomic::LoadAcquire( &m_head );
+            for( ;; )
+            {
+                void* ptr = GetPointer( head );
+                if( ptr == nullptr )
+                {
+                    Atomic::Decrement( &m_allocatedSlots );
+                    return nullptr;
+                }
+
+                // ptr may be popped and reused by another thread first, slabs are never released so the read is safe
+                // and the tag makes the exchange fail
+                void* next = *static_cast<void* volatile*>( ptr );
+
+                const zp_int64_t prevHead = Atomic::CompareExchange( &m_head, MakeTaggedPointer( next, head ), head );
+                if( prevHead == head )
+                {
+                    return ptr;
+                }
+
+                head = prevHead;
+            }
+        }
+
+        zp_bool_t try_free( void* ptr )
+        {
+            if( ptr )
+            {
+                push( ptr, ptr );
+
+                Atomic::Decrement( &m_allocatedSlots );
+            }
+
+            return true;
+        }
+
+        void* allocate( zp_size_t size, zp_size_t alignment )
+        {
+            return try_allocate( size, alignment );
+        }
+
+        void* reallocate( void* ptr, zp_size_t size, zp_size_t alignment )
+        {
+            if( ptr == nullptr )
+            {
+                return allocate( size, alignment );
+            }
+
+            ZP_ASSERT_MSG( size <= ObjectSize, "Allocation does not fit the pool" );
+            return ptr;
+        }
+
+        void free( void* ptr )
+        {
+            try_free( ptr );
+        }
+
+    private:
+        enum : zp_uint64_t
+        {
+            kPointerBits = 48,
+            kPointerMask = ( 1ull << kPointerBits ) - 1,
+        };
+
+        static void* GetPointer( zp_int64_t taggedPointer )
+        {
+            return reinterpret_cast<void*>( static_cast<zp_uint64_t>( taggedPointer ) & kPointerMask );
+        }
+
+        // new head for ptr with the tag of the previous head bumped
+        static zp_int64_t MakeTaggedPointer( void* ptr, zp_int64_t prevTaggedPointer )
+        {
+            const zp_uint64_t tag = ( static_cast<zp_uint64_t>( prevTaggedPointer ) >> kPointerBits ) + 1;
+            return static_cast<zp_int64_t>( ( tag << kPointerBits ) | ( reinterpret_cast<zp_uint64_t>( ptr ) & kPointerMask ) );
+        }
+
+        // pushes the already linked list first..last
+        void push( void* first, void* last )
+        {
+            ZP_ASSERT( ( reinterpret_cast<zp_uint64_t>( first ) & ~kPointerMask ) == 0 );
+
+            zp_int64_t head = Atomic::LoadAcquire( &m_head );
+            for( ;; )
+            {
+                *static_cast<void**>( last ) = GetPointer( head );
+
+                const zp_int64_t prevHead = Atomic::CompareExchange( &m_head, MakeTaggedPointer( first, head ), head );
+                if( prevHead == head )
+                {
+                    break;
+                }
+
+                head = prevHead;
+            }
+        }
+
+        zp_int64_t m_head {};
+        zp_int64_t m_allocatedSlots {};
+        zp_int64_t m_totalSlots {};
+    };
+
+    template<zp_size_t ObjectSize, zp_size_t Alignment = kDefaultMemoryAlignment>
+    using PoolMemoryAllocator = MemoryAllocator<SystemPageMemoryStorage, PoolAllocatorPolicy<ObjectSize, Alignment>, CriticalSectionMemoryLock, NullMemoryProfiler>;
+}
+#pragma endregion
+
 #pragma region TLSF Memory Allocator
 namespace zp
 {
@@ -482,14 +1085,394 @@ namespace zp
 
         void free( void* ptr );
 
+        [[nodiscard]] zp_size_t block_size( void* ptr ) const;
+
+        // walks every pool for the free block layout
+        void heap_stats( MemoryHeapStats& heapStats ) const;
+
+        // removes a pool with nothing allocated in it, returns the memory given to add_memory or nullptr when there are none.
+        // The first pool holds the allocator itself and is never released
+        void* release_free_pool( zp_size_t& size );
+
     private:
         zp_handle_t m_tlsf;
+        void* m_pools;
         zp_size_t m_allocated;
         zp_size_t m_size;
     };
 }
 #pragma endregion
 
+#pragma region Thread Cache Allocator
+namespace zp
+{
+    enum
+    {
+        kThreadCacheSizeClassCount = 10,
+        kThreadCacheMaxSize = 512,
+        kThreadCacheRefillSize = 4 KB,
+        kThreadCacheMinBatchCount = 4,
+        kThreadCacheMaxBatchCount = 32,
+        kMaxThreadCacheAllocators = kMaxMemoryLabels,
+        kInvalidThreadCacheIndex = kMaxThreadCacheAllocators,
+        kThreadCacheBlockPrefixSize = kDefaultMemoryAlignment,
+    };
+
+    // in front of every block a thread cache hands out, only written by the thread allocating or reallocating the block
+    struct ThreadCacheBlockPrefix
+    {
+        zp_size_t size;
+        zp_uint32_t offset;
+        zp_uint32_t sizeClass;
+    };
+
+    ZP_STATIC_ASSERT( sizeof( ThreadCacheBlockPrefix ) <= kThreadCacheBlockPrefixSize );
+
+    struct ThreadCacheFreeList
+    {
+        void* head;
+        zp_uint32_t count;
+    };
+
+    struct ThreadCacheFreeLists
+    {
+        ThreadCacheFreeList freeLists[ kThreadCacheSizeClassCount ];
+        zp_uint32_t generation;
+    };
+
+    namespace ThreadCache
+    {
+        constexpr zp_size_t kSizeClassSizes[ kThreadCacheSizeClassCount ] { 16, 32, 48, 64, 96, 128, 192, 256, 384, 512 };
+
+        // smallest size class that fits size, kThreadCacheSizeClassCount when size isn't cached
+        ZP_FORCEINLINE zp_size_t GetSizeClass( zp_size_t size )
+        {
+            zp_size_t sizeClass = 0;
+            while( sizeClass < kThreadCacheSizeClassCount && kSizeClassSizes[ sizeClass ] < size )
+            {
+                ++sizeClass;
+            }
+            return sizeClass;
+        }
+
+        // blocks moved per refill or flush, a thread keeps at most twice this many per size class
+        ZP_FORCEINLINE zp_uint32_t GetBatchCount( zp_size_t sizeClass )
+        {
+            const zp_size_t batchCount = kThreadCacheRefillSize / kSizeClassSizes[ sizeClass ];
+            return static_cast<zp_uint32_t>( zp_min( zp_max( batchCount, static_cast<zp_size_t>( kThreadCacheMinBatchCount ) ), static_cast<zp_size_t>( kThreadCacheMaxBatchCount ) ) );
+        }
+
+        // claims a cache index for an allocator, blocks left by exiting threads are pushed onto orphanedBlocks
+        zp_uint32_t Register( void** orphanedBlocks, zp_uint32_t& outGeneration );
+
+        void Unregister( zp_uint32_t cacheIndex );
+
+        // calling thread's free lists for cacheIndex, emptied if they belonged to an older allocator at the same index
+        ThreadCacheFreeLists* GetFreeLists( zp_uint32_t cacheIndex, zp_uint32_t generation );
+    }
+
+    //
+    // Wraps another policy with per thread free lists for small blocks. Allocations and frees that hit the calling
+    // thread's lists never take the allocator lock, misses refill and full lists flush a batch of blocks at a time through
+    // the allocator's regular (locked) path. Cached blocks stay allocated in the wrapped policy, so allocated() includes them.
+    // Every block carries a ThreadCacheBlockPrefix with its size class, so lock free frees never read the wrapped policy's
+    // block headers.
+    //
+
+    template<typename Policy>
+    class ThreadCacheAllocatorPolicy
+    {
+        ZP_NONCOPYABLE( ThreadCacheAllocatorPolicy );
+
+    public:
+        ThreadCacheAllocatorPolicy( Policy policy = {} )
+            : m_policy( zp_move( policy ) )
+            , m_orphanedBlocks( nullptr )
+            , m_cacheIndex( kInvalidThreadCacheIndex )
+            , m_cacheGeneration( 0 )
+        {
+        }
+
+        ThreadCacheAllocatorPolicy( ThreadCacheAllocatorPolicy&& other ) noexcept
+            : m_policy( zp_move( other.m_policy ) )
+            , m_orphanedBlocks( nullptr )
+            , m_cacheIndex( kInvalidThreadCacheIndex )
+            , m_cacheGeneration( 0 )
+        {
+            // thread caches point back at the policy, it can't move once registered
+            ZP_ASSERT( other.m_cacheIndex == kInvalidThreadCacheIndex );
+        }
+
+        ~ThreadCacheAllocatorPolicy()
+        {
+            if( m_cacheIndex != kInvalidThreadCacheIndex )
+            {
+                ThreadCache::Unregister( m_cacheIndex );
+            }
+        }
+
+        void add_memory( void* mem, zp_size_t size )
+        {
+            // registered on first use, by then the policy is in its final place in the allocator
+            if( m_cacheIndex == kInvalidThreadCacheIndex )
+            {
+                m_cacheIndex = ThreadCache::Register( &m_orphanedBlocks, m_cacheGeneration );
+            }
+
+            m_policy.add_memory( mem, size );
+        }
+
+        [[nodiscard]] zp_size_t allocated() const
+        {
+            return m_policy.allocated();
+        }
+
+        [[nodiscard]] zp_size_t total() const
+        {
+            return m_policy.total();
+        }
+
+        [[nodiscard]] zp_size_t overhead() const
+        {
+            return m_policy.overhead() + kThreadCacheBlockPrefixSize;
+        }
+
+        [[nodiscard]] zp_size_t block_size( void* ptr ) const
+        {
+            return get_prefix( ptr )->size;
+        }
+
+        // blocks sitting in thread caches count as used
+        void heap_stats( MemoryHeapStats& heapStats ) const
+        {
+            m_policy.heap_stats( heapStats );
+        }
+
+        // blocks sitting in thread caches keep their pool alive
+        void* release_free_pool( zp_size_t& size )
+        {
+            return m_policy.release_free_pool( size );
+        }
+
+        // lock free, nullptr when the calling thread has no cached block of the size
+        void* try_allocate( zp_size_t size, zp_size_t alignment )
+        {
+            const zp_size_t sizeClass = ThreadCache::GetSizeClass( size );
+            if( m_cacheIndex == kInvalidThreadCacheIndex || alignment > kDefaultMemoryAlignment || sizeClass == kThreadCacheSizeClassCount )
+            {
+                return nullptr;
+            }
+
+            ThreadCacheFreeList& freeList = ThreadCache::GetFreeLists( m_cacheIndex, m_cacheGeneration )->freeLists[ sizeClass ];
+
+            void* ptr = freeList.head;
+            if( ptr )
+            {
+                freeList.head = *static_cast<void**>( ptr );
+                --freeList.count;
+            }
+
+            return ptr;
+        }
+
+        // lock free, false when the block isn't cacheable or the calling thread's list is full
+        zp_bool_t try_free( void* ptr )
+        {
+            if( ptr == nullptr )
+            {
+                return false;
+            }
+
+            // the prefix is only written by the allocating thread, unlike the wrapped policy's block header which frees
+            // of neighbouring blocks rewrite under the lock
+            const zp_size_t sizeClass = get_prefix( ptr )->sizeClass;
+            if( sizeClass == kThreadCacheSizeClassCount )
+            {
+                return false;
+            }
+
+            ThreadCacheFreeList& freeList = ThreadCache::GetFreeLists( m_cacheIndex, m_cacheGeneration )->freeLists[ sizeClass ];
+            if( freeList.count >= ThreadCache::GetBatchCount( sizeClass ) * 2 )
+            {
+                return false;
+            }
+
+            *static_cast<void**>( ptr ) = freeList.head;
+            freeList.head = ptr;
+            ++freeList.count;
+
+            return true;
+        }
+
+        void* allocate( zp_size_t size, zp_size_t alignment )
+        {
+            free_orphaned_blocks();
+
+            const zp_size_t sizeClass = ThreadCache::GetSizeClass( size );
+            if( m_cacheIndex == kInvalidThreadCacheIndex || alignment > kDefaultMemoryAlignment || sizeClass == kThreadCacheSizeClassCount )
+            {
+                return allocate_block( size, alignment, kThreadCacheSizeClassCount );
+            }
+
+            // refill the calling thread's list with a batch, stopping early if the wrapped policy runs out
+            const zp_size_t classSize = ThreadCache::kSizeClassSizes[ sizeClass ];
+
+            void* ptr = allocate_block( classSize, kDefaultMemoryAlignment, sizeClass );
+            if( ptr )
+            {
+                ThreadCacheFreeList& freeList = ThreadCache::GetFreeLists( m_cacheIndex, m_cacheGeneration )->freeLists[ sizeClass ];
+
+                const zp_uint32_t batchCount = ThreadCache::GetBatchCount( sizeClass );
+                for( zp_uint32_t i = 1; i < batchCount; ++i )
+                {
+                    void* block = allocate_block( classSize, kDefaultMemoryAlignment, sizeClass );
+                    if( block == nullptr )
+                    {
+                        break;
+                    }
+
+                    *static_cast<void**>( block ) = freeList.head;
+                    freeList.head = block;
+                    ++freeList.count;
+                }
+            }
+
+            return ptr;
+        }
+
+        void* reallocate( void* ptr, zp_size_t size, zp_size_t alignment )
+        {
+            free_orphaned_blocks();
+
+            if( ptr == nullptr )
+            {
+                return allocate( size, alignment );
+            }
+
+            // uncached blocks with the same prefix offset resize in the wrapped policy, which moves the prefix along
+            ThreadCacheBlockPrefix* prefix = get_prefix( ptr );
+            const zp_size_t offset = get_prefix_offset( alignment );
+            if( prefix->sizeClass == kThreadCacheSizeClassCount && prefix->offset == offset )
+            {
+                void* block = m_policy.reallocate( ZP_OFFSET_PTR( ptr, -static_cast<zp_ptrdiff_t>( offset ) ), size + offset, alignment );
+                if( block == nullptr )
+                {
+                    return nullptr;
+                }
+
+                void* newPtr = ZP_OFFSET_PTR( block, offset );
+                get_prefix( newPtr )->size = m_policy.block_size( block ) - offset;
+                return newPtr;
+            }
+
+            void* newPtr = allocate( size, alignment );
+            if( newPtr )
+            {
+                zp_memcpy( newPtr, size, ptr, zp_min( prefix->size, size ) );
+                free( ptr );
+            }
+
+            return newPtr;
+        }
+
+        void free( void* ptr )
+        {
+            free_orphaned_blocks();
+
+            if( ptr == nullptr )
+            {
+                return;
+            }
+
+            const zp_size_t sizeClass = get_prefix( ptr )->sizeClass;
+            if( sizeClass == kThreadCacheSizeClassCount )
+            {
+                free_block( ptr );
+                return;
+            }
+
+            // list is full, hand a batch back to the wrapped policy and keep the newly freed block
+            ThreadCacheFreeList& freeList = ThreadCache::GetFreeLists( m_cacheIndex, m_cacheGeneration )->freeLists[ sizeClass ];
+
+            const zp_uint32_t batchCount = ThreadCache::GetBatchCount( sizeClass );
+            for( zp_uint32_t i = 0; i < batchCount && freeList.head; ++i )
+            {
+                void* block = freeList.head;
+                freeList.head = *static_cast<void**>( block );
+                --freeList.count;
+
+                free_block( block );
+            }
+
+            *static_cast<void**>( ptr ) = freeList.head;
+            freeList.head = ptr;
+            ++freeList.count;
+        }
+
+    private:
+        static ThreadCacheBlockPrefix* get_prefix( void* ptr )
+        {
+            return static_cast<ThreadCacheBlockPrefix*>( ZP_OFFSET_PTR( ptr, -static_cast<zp_ptrdiff_t>( kThreadCacheBlockPrefixSize ) ) );
+        }
+
+        // distance from the wrapped policy's block to the returned pointer, keeps alignments past the prefix size
+        static zp_size_t get_prefix_offset( zp_size_t alignment )
+        {
+            return zp_max( alignment, static_cast<zp_size_t>( kThreadCacheBlockPrefixSize ) );
+        }
+
+        // only called with the allocator lock held
+        void* allocate_block( zp_size_t size, zp_size_t alignment, zp_size_t sizeClass )
+        {
+            const zp_size_t offset = get_prefix_offset( alignment );
+
+            void* block = m_policy.allocate( size + offset, alignment );
+            if( block == nullptr )
+            {
+                return nullptr;
+            }
+
+            void* ptr = ZP_OFFSET_PTR( block, offset );
+            *get_prefix( ptr ) = {
+                .size = m_policy.block_size( block ) - offset,
+                .offset = static_cast<zp_uint32_t>( offset ),
+                .sizeClass = static_cast<zp_uint32_t>( sizeClass ),
+            };
+
+            return ptr;
+        }
+
+        // only called with the allocator lock held
+        void free_block( void* ptr )
+        {
+            m_policy.free( ZP_OFFSET_PTR( ptr, -static_cast<zp_ptrdiff_t>( get_prefix( ptr )->offset ) ) );
+        }
+
+        // blocks cached by threads that have since exited, only called with the allocator lock held
+        void free_orphaned_blocks()
+        {
+            if( Atomic::LoadAcquirePtr( &m_orphanedBlocks ) == nullptr )
+            {
+                return;
+            }
+
+            void* block = Atomic::ExchangePtr( &m_orphanedBlocks, static_cast<void*>( nullptr ) );
+            while( block )
+            {
+                void* next = *static_cast<void**>( block );
+                free_block( block );
+                block = next;
+            }
+        }
+
+        Policy m_policy;
+        void* m_orphanedBlocks;
+        zp_uint32_t m_cacheIndex;
+        zp_uint32_t m_cacheGeneration;
+    };
+}
+#pragma endregion
+
 namespace zp
 {
     template<zp_size_t Size>
@@ -575,6 +1558,19 @@ namespace zp
 
     using ManualArenaAllocator = MemoryAllocator<FixedAllocatedMemoryStorage, LinearAllocatorPolicy, NullMemoryLock, NullMemoryProfiler>;
     using ArenaAllocator = MemoryAllocator<FixedArenaMemoryStorage, LinearAllocatorPolicy, NullMemoryLock, NullMemoryProfiler>;
+
+    // the lock is only taken to commit more pages
+    using FrameMemoryAllocator = MemoryAllocator<SystemPageMemoryStorage, AtomicLinearAllocatorPolicy, CriticalSectionMemoryLock, NullMemoryProfiler>;
+
+    // registers the two allocators behind MemoryLabels::Frame and MemoryLabels::PreviousFrame
+    void RegisterFrameAllocators( FrameMemoryAllocator* frameAllocator, FrameMemoryAllocator* previousFrameAllocator );
+
+    // resets the PreviousFrame allocator and swaps it in as Frame. Everything allocated from PreviousFrame has to be retired
+    void AdvanceFrameAllocators();
+
+    // marks the calling thread as running work that can outlive the frame (background jobs), debug builds assert if it
+    // allocates frame memory. Returns the previous value
+    zp_bool_t SetFrameMemoryRestricted( zp_bool_t restricted );
 }
 #if 1
 namespace zp
@@ -32,6 +32,9 @@
 #pragma intrinsic(_InterlockedExchange64)
 #pragma intrinsic(_InterlockedExchangeAdd64)
 #pragma intrinsic(_InterlockedCompareExchanger64)
+
+#pragma intrinsic(_InterlockedExchangePointer)
+#pragma intrinsic(_InterlockedCompareExchangePointer)
 #else
 #error "Platform Not Implemented for Atomic.h"
 #endif
@@ -325,6 +328,165 @@ namespace zp
         {
 #if ZP_PLATFORM_WINDOWS
             return static_cast<zp_uint64_t>( _InterlockedExchange64( reinterpret_cast<__int64 volatile *>( target ), static_cast<__int64>( value ) ) );
+#endif
+        }
+
+        //
+        // Pointer
+        //
+
+        template<typename T>
+        ZP_FORCEINLINE T* ExchangePtr( T** target, T* value )
+        {
+#if ZP_PLATFORM_WINDOWS
+            return static_cast<T*>( _InterlockedExchangePointer( reinterpret_cast<void* volatile*>( target ), value ) );
+#endif
+        }
+
+        template<typename T>
+        ZP_FORCEINLINE T* CompareExchangePtr( T** destination, T* exChange, T* comperand )
+        {
+#if ZP_PLATFORM_WINDOWS
+            return static_cast<T*>( _InterlockedCompareExchangePointer( reinterpret_cast<void* volatile*>( destination ), exChange, comperand ) );
+#endif
+        }
+
+        //
+        // Load / Store
+        //
+
+        ZP_FORCEINLINE zp_uint32_t LoadAcquire( const zp_uint32_t* source )
+        {
+#if ZP_PLATFORM_WINDOWS
+#if ZP_MSC
+            const zp_uint32_t value = *static_cast<const volatile zp_uint32_t*>( source );
+            _ReadWriteBarrier();
+            return value;
+#else
+            return __atomic_load_n( source, __ATOMIC_ACQUIRE );
+#endif
+#endif
+        }
+
+        ZP_FORCEINLINE void StoreRelease( zp_uint32_t* destination, zp_uint32_t value )
+        {
+#if ZP_PLATFORM_WINDOWS
+#if ZP_MSC
+            _ReadWriteBarrier();
+            *static_cast<volatile zp_uint32_t*>( destination ) = value;
+#else
+            __atomic_store_n( destination, value, __ATOMIC_RELEASE );
+#endif
+#endif
+        }
+
+        ZP_FORCEINLINE zp_int64_t LoadRelaxed( const zp_int64_t* source )
+        {
+#if ZP_PLATFORM_WINDOWS
+#if ZP_MSC
+            return *static_cast<const volatile zp_int64_t*>( source );
+#else
+            return __atomic_load_n( source, __ATOMIC_RELAXED );
+#endif
+#endif
+        }
+
+        ZP_FORCEINLINE zp_int64_t LoadAcquire( const zp_int64_t* source )
+        {
+#if ZP_PLATFORM_WINDOWS
+#if ZP_MSC
+            const zp_int64_t value = *static_cast<const volatile zp_int64_t*>( source );
+            _ReadWriteBarrier();
+            return value;
+#else
+            return __atomic_load_n( source, __ATOMIC_ACQUIRE );
+#endif
+#endif
+        }
+
+        ZP_FORCEINLINE void StoreRelaxed( zp_int64_t* destination, zp_int64_t value )
+        {
+#if ZP_PLATFORM_WINDOWS
+#if ZP_MSC
+            *static_cast<volatile zp_int64_t*>( destination ) = value;
+#else
+            __atomic_store_n( destination, value, __ATOMIC_RELAXED );
+#endif
+#endif
+        }
+
+        ZP_FORCEINLINE void StoreRelease( zp_int64_t* destination, zp_int64_t value )
+        {
+#if ZP_PLATFORM_WINDOWS
+#if ZP_MSC
+            _ReadWriteBarrier();
+            *static_cast<volatile zp_int64_t*>( destination ) = value;
+#else
+            __atomic_store_n( destination, value, __ATOMIC_RELEASE );
+#endif
+#endif
+        }
+
+        ZP_FORCEINLINE zp_size_t LoadRelaxedSizeT( const zp_size_t* source )
+        {
+#if ZP_PLATFORM_WINDOWS
+#if ZP_MSC
+            return *static_cast<const volatile zp_size_t*>( source );
+#else
+            return __atomic_load_n( source, __ATOMIC_RELAXED );
+#endif
+#endif
+        }
+
+        ZP_FORCEINLINE zp_size_t LoadAcquireSizeT( const zp_size_t* source )
+        {
+#if ZP_PLATFORM_WINDOWS
+#if ZP_MSC
+            const zp_size_t value = *static_cast<const volatile zp_size_t*>( source );
+            _ReadWriteBarrier();
+            return value;
+#else
+            return __atomic_load_n( source, __ATOMIC_ACQUIRE );
+#endif
+#endif
+        }
+
+        ZP_FORCEINLINE void StoreReleaseSizeT( zp_size_t* destination, zp_size_t value )
+        {
+#if ZP_PLATFORM_WINDOWS
+#if ZP_MSC
+            _ReadWriteBarrier();
+            *static_cast<volatile zp_size_t*>( destination ) = value;
+#else
+            __atomic_store_n( destination, value, __ATOMIC_RELEASE );
+#endif
+#endif
+        }
+
+        template<typename T>
+        ZP_FORCEINLINE T* LoadAcquirePtr( T* const* source )
+        {
+#if ZP_PLATFORM_WINDOWS
+#if ZP_MSC
+            T* const value = *static_cast<T* const volatile*>( source );
+            _ReadWriteBarrier();
+            return value;
+#else
+            return __atomic_load_n( source, __ATOMIC_ACQUIRE );
+#endif
+#endif
+        }
+
+        template<typename T>
+        ZP_FORCEINLINE void StoreReleasePtr( T** destination, T* value )
+        {
+#if ZP_PLATFORM_WINDOWS
+#if ZP_MSC
+            _ReadWriteBarrier();
+            *static_cast<T* volatile*>( destination ) = value;
+#else
+            __atomic_store_n( destination, value, __ATOMIC_RELEASE );
+#endif
 #endif
         }
     };
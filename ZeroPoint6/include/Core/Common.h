@@ -593,13 +593,15 @@ void zp_lzf_expand( const void* srcBuffer, zp_size_t srcPosition, zp_size_t srcS
 template<typename T, typename Cmp>
 constexpr void zp_qsort3( T* begin, T* end, Cmp cmp )
 {
-    // partition
+    // partition, the pivot value is copied and the range bounds kept since begin, end and the pivot slot all move
+    T* lo = begin;
+    T* hi = end;
     T* mid = begin;
-    T* pivot = end;
+    const T pivot = *end;
 
     while( mid <= end )
     {
-        const zp_int32_t c = cmp( *mid, *pivot );
+        const zp_int32_t c = cmp( *mid, pivot );
         if( c < 0 )
         {
             zp_move_swap( *begin, *mid );
@@ -620,17 +622,205 @@ constexpr void zp_qsort3( T* begin, T* end, Cmp cmp )
     T* i = begin - 1;
     T* j = mid;
 
-    if( begin < i )
+    if( lo < i )
     {
-        zp_qsort3( begin, i, cmp );
+        zp_qsort3( lo, i, cmp );
     }
 
-    if( j < end )
+    if( j < hi )
     {
-        zp_qsort3( j, end, cmp );
+        zp_qsort3( j, hi, cmp );
     }
 };
 
+template<typename T, typename Cmp>
+constexpr void zp_insertion_sort( T* begin, T* end, Cmp cmp )
+{
+    for( T* i = begin + 1; i < end; ++i )
+    {
+        if( cmp( *i, *( i - 1 ) ) < 0 )
+        {
+            T value = zp_move( *i );
+
+            T* j = i;
+            do
+            {
+                *j = zp_move( *( j - 1 ) );
+                --j;
+            } while( j > begin && cmp( value, *( j - 1 ) ) < 0 );
+
+            *j = zp_move( value );
+        }
+    }
+}
+
+template<typename T, typename Cmp>
+constexpr void zp_heap_sift_down( T* begin, zp_size_t root, zp_size_t count, Cmp cmp )
+{
+    for( zp_size_t child = ( root * 2 ) + 1; child < count; child = ( root * 2 ) + 1 )
+    {
+        if( child + 1 < count && cmp( begin[ child ], begin[ child + 1 ] ) < 0 )
+        {
+            ++child;
+        }
+
+        if( cmp( begin[ root ], begin[ child ] ) >= 0 )
+        {
+            break;
+        }
+
+        zp_move_swap( begin[ root ], begin[ child ] );
+        root = child;
+    }
+}
+
+template<typename T, typename Cmp>
+constexpr void zp_heap_sort( T* begin, T* end, Cmp cmp )
+{
+    const zp_size_t count = end - begin;
+
+    for( zp_size_t i = count / 2; i > 0; --i )
+    {
+        zp_heap_sift_down( begin, i - 1, count, cmp );
+    }
+
+    for( zp_size_t i = count; i > 1; --i )
+    {
+        zp_move_swap( begin[ 0 ], begin[ i - 1 ] );
+        zp_heap_sift_down( begin, 0, i - 1, cmp );
+    }
+}
+
+// floor is the pivot left of [begin, end) from an earlier partition, every element in the range compares >= to it, nullptr for the leftmost range
+template<typename T, typename Cmp>
+constexpr void zp_introsort( T* begin, T* end, const T* floor, zp_size_t depthLimit, Cmp cmp )
+{
+    constexpr zp_size_t kInsertionSortThreshold = 16;
+
+    // recurse into the smaller side and loop on the larger one, stack depth stays O(log n)
+    while( static_cast<zp_size_t>( end - begin ) > kInsertionSortThreshold )
+    {
+        if( depthLimit == 0 )
+        {
+            zp_heap_sort( begin, end, cmp );
+            return;
+        }
+        --depthLimit;
+
+        // median of 3 ends up in begin, the last element is >= pivot so the scans below don't need bounds checks
+        T* mid = begin + ( ( end - begin ) / 2 );
+        T* last = end - 1;
+
+        if( cmp( *mid, *begin ) < 0 )
+        {
+            zp_move_swap( *mid, *begin );
+        }
+        if( cmp( *last, *mid ) < 0 )
+        {
+            zp_move_swap( *last, *mid );
+            if( cmp( *mid, *begin ) < 0 )
+            {
+                zp_move_swap( *mid, *begin );
+            }
+        }
+        zp_move_swap( *begin, *mid );
+
+        // duplicate keys in the samples or a pivot equal to the floor, fat-pivot partition so the run of equal keys is dropped
+        // in one pass instead of being split down to the insertion sort threshold
+        if( ( floor != nullptr && cmp( *floor, *begin ) >= 0 ) || cmp( *mid, *begin ) >= 0 || cmp( *begin, *last ) >= 0 )
+        {
+            T* lt = begin + 1;
+            T* gt = end;
+            for( T* i = begin + 1; i < gt; )
+            {
+                const zp_int32_t c = cmp( *i, *begin );
+                if( c < 0 )
+                {
+                    zp_move_swap( *lt, *i );
+                    ++lt;
+                    ++i;
+                }
+                else if( c > 0 )
+                {
+                    --gt;
+                    zp_move_swap( *i, *gt );
+                }
+                else
+                {
+                    ++i;
+                }
+            }
+
+            --lt;
+            zp_move_swap( *begin, *lt );
+
+            // [begin, lt) < pivot, [lt, gt) == pivot, [gt, end) > pivot
+            if( ( lt - begin ) < ( end - gt ) )
+            {
+                zp_introsort( begin, lt, floor, depthLimit, cmp );
+                floor = lt;
+                begin = gt;
+            }
+            else
+            {
+                zp_introsort( gt, end, static_cast<const T*>( lt ), depthLimit, cmp );
+                end = lt;
+            }
+            continue;
+        }
+
+        // both scans stop on equal keys, so runs of duplicates split evenly
+        T* i = begin;
+        T* j = end;
+        for( ;; )
+        {
+            do
+            {
+                ++i;
+            } while( cmp( *i, *begin ) < 0 );
+
+            do
+            {
+                --j;
+            } while( cmp( *begin, *j ) < 0 );
+
+            if( i >= j )
+            {
+                break;
+            }
+
+            zp_move_swap( *i, *j );
+        }
+
+        zp_move_swap( *begin, *j );
+
+        if( ( j - begin ) < ( end - ( j + 1 ) ) )
+        {
+            zp_introsort( begin, j, floor, depthLimit, cmp );
+            floor = j;
+            begin = j + 1;
+        }
+        else
+        {
+            zp_introsort( j + 1, end, static_cast<const T*>( j ), depthLimit, cmp );
+            end = j;
+        }
+    }
+
+    zp_insertion_sort( begin, end, cmp );
+}
+
+// introsort over [begin, end), cmp returns <0, 0 or >0 like zp_cmp
+template<typename T, typename Cmp>
+constexpr void zp_sort( T* begin, T* end, Cmp cmp )
+{
+    const zp_size_t count = end - begin;
+    if( count > 1 )
+    {
+        zp_introsort( begin, end, static_cast<const T*>( nullptr ), static_cast<zp_size_t>( zp_bitscan_reverse( count ) ) * 2, cmp );
+    }
+}
+
 //
 //
 //
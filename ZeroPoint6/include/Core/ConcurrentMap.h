@@ -0,0 +1,661 @@
+//
+// Created by phosg on 10/16/2026.
+//
+
+#ifndef ZP_CONCURRENT_MAP_H
+#define ZP_CONCURRENT_MAP_H
+
+#include "Core/Defines.h"
+#include "Core/Types.h"
+#include "Core/Common.h"
+#include "Core/Hash.h"
+#include "Core/Atomic.h"
+#include "Core/Memory.h"
+#include "Core/Allocator.h"
+#include "Core/FlatMap.h"
+
+#include <new>
+
+namespace zp
+{
+    //
+    // Insert only map that is safe to read and add to from any thread. Keys are split over stripes by hash, each stripe
+    // has its own lock that only writers take. Entries are never moved once published, so readers walk a stripe's table
+    // without locking and the value pointers handed out stay valid until clear() or destroy().
+    //
+
+    namespace ConcurrentMapStripe
+    {
+        enum : zp_size_t
+        {
+            kStripeCount = 16,
+            kNodesPerBlock = 32,
+            kMinTableCapacity = 8,
+            kCacheLineSize = 64,
+        };
+
+        void AcquireLock( zp_int32_t* lock );
+
+        void ReleaseLock( zp_int32_t* lock );
+    }
+
+    template<typename Key, typename Value, typename H = zp_hash64_t, typename KeyComparer = DefaultEquality<Key>, typename KeyHash = DefaultHash<Key, H>, typename Allocator = MemoryLabelAllocator>
+    class ConcurrentMap
+    {
+    public:
+        typedef Key key_value;
+        typedef const Key& key_const_reference;
+
+        typedef Value value_value;
+        typedef Value& value_reference;
+        typedef const Value& value_const_reference;
+        typedef Value&& value_move;
+
+        typedef Value* value_pointer;
+        typedef const Value* value_const_pointer;
+
+        typedef Allocator allocator_value;
+        typedef const Allocator& allocator_const_reference;
+
+        typedef KeyComparer comparer_value;
+        typedef KeyHash hash_func_value;
+
+        typedef H hash_value;
+        typedef const H const_hash_value;
+
+        class ConcurrentMapIterator;
+
+        typedef ConcurrentMapIterator iterator;
+
+        typedef ConcurrentMap<Key, Value, H, KeyComparer, KeyHash, Allocator>* self_pointer;
+
+        explicit ConcurrentMap( MemoryLabel memoryLabel );
+
+        ConcurrentMap( MemoryLabel memoryLabel, zp_size_t capacity );
+
+        ConcurrentMap( MemoryLabel memoryLabel, zp_size_t capacity, allocator_const_reference allocator );
+
+        ConcurrentMap( const ConcurrentMap& ) = delete;
+
+        ~ConcurrentMap();
+
+        // exact once every writer is done, a snapshot otherwise
+        [[nodiscard]] zp_size_t size() const;
+
+        [[nodiscard]] zp_bool_t empty() const;
+
+        // lookups never block and finish in a bounded number of steps
+        value_pointer find( key_const_reference key ) const;
+
+        // hash has to be what KeyHash returns for key
+        value_pointer find( const_hash_value hash, key_const_reference key ) const;
+
+        zp_bool_t tryGet( key_const_reference key, value_reference value ) const;
+
+        zp_bool_t tryGet( key_const_reference key, value_pointer value ) const;
+
+        zp_bool_t containsKey( key_const_reference key ) const;
+
+        // false, and value is left alone, when key was already added
+        zp_bool_t tryAdd( key_const_reference key, value_const_reference value );
+
+        zp_bool_t tryAdd( key_const_reference key, value_move value );
+
+        // factory() runs at most once per key, under the key's stripe lock. It may touch other maps but must not add to this one
+        template<typename Factory>
+        value_reference getOrAdd( key_const_reference key, Factory&& factory );
+
+        template<typename Factory>
+        value_reference getOrAdd( const_hash_value hash, key_const_reference key, Factory&& factory );
+
+        // not thread safe, no other thread may be using the map or any value pointer from it
+        void clear();
+
+        void destroy();
+
+        // visits every entry added before its stripe was reached
+        iterator begin();
+
+        iterator end();
+
+    private:
+        struct ConcurrentMapNode
+        {
+            zp_uint64_t bits;
+            key_value key;
+            value_value value;
+        };
+
+        struct ConcurrentMapNodeBlock
+        {
+            ConcurrentMapNodeBlock* next;
+            zp_size_t count;
+            ConcurrentMapNode nodes[ ConcurrentMapStripe::kNodesPerBlock ];
+        };
+
+        struct ConcurrentMapTable
+        {
+            // tables a reader may still be probing, freed with the map
+            ConcurrentMapTable* retired;
+            zp_size_t capacity;
+            ConcurrentMapNode* slots[ 1 ];
+        };
+
+        // one cache line per stripe, padding alone doesn't keep a stripe from straddling two lines
+        struct alignas( ConcurrentMapStripe::kCacheLineSize ) ConcurrentMapStripeData
+        {
+            ConcurrentMapTable* table;
+            ConcurrentMapNodeBlock* blocks;
+            zp_int64_t count;
+            zp_int32_t lock;
+        };
+
+        static allocator_value CreateAllocator( MemoryLabel memoryLabel );
+
+        static ConcurrentMapNode* FindNode( const ConcurrentMapTable* table, zp_uint64_t bits, key_const_reference key, const comparer_value& cmp );
+
+        ConcurrentMapStripeData& stripeFor( zp_uint64_t bits ) const;
+
+        ConcurrentMapTable* allocateTable( zp_size_t capacity );
+
+        // stripe lock has to be held
+        template<typename V>
+        ConcurrentMapNode* addLocked( ConcurrentMapStripeData& stripe, zp_uint64_t bits, key_const_reference key, V&& value );
+
+        void freeStripe( ConcurrentMapStripeData& stripe, zp_bool_t keepTable );
+
+        mutable ConcurrentMapStripeData m_stripes[ ConcurrentMapStripe::kStripeCount ];
+
+        zp_size_t m_initialTableCapacity;
+
+        comparer_value m_cmp;
+        hash_func_value m_hash;
+
+        allocator_value m_allocator;
+
+    public:
+        class ConcurrentMapIterator
+        {
+        private:
+            ConcurrentMapIterator( self_pointer map, zp_size_t stripe );
+
+            void advance();
+
+        public:
+            ~ConcurrentMapIterator() = default;
+
+            void operator++();
+
+            void operator++( int );
+
+            key_const_reference key() const;
+
+            value_reference value() const;
+
+            zp_bool_t operator==( const ConcurrentMapIterator& other ) const;
+
+            zp_bool_t operator!=( const ConcurrentMapIterator& other ) const;
+
+        private:
+            self_pointer m_map;
+            ConcurrentMapTable* m_table;
+            zp_size_t m_stripe;
+            zp_size_t m_slot;
+
+            friend class ConcurrentMap;
+        };
+
+    public:
+        const MemoryLabel memoryLabel;
+    };
+}
+
+//
+//
+//
+
+namespace zp
+{
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    ConcurrentMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::ConcurrentMap( MemoryLabel memoryLabel )
+        : m_stripes {}
+        , m_initialTableCapacity( ConcurrentMapStripe::kMinTableCapacity )
+        , m_cmp( comparer_value() )
+        , m_hash( hash_func_value() )
+        , m_allocator( CreateAllocator( memoryLabel ) )
+        , memoryLabel( memoryLabel )
+    {
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    ConcurrentMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::ConcurrentMap( MemoryLabel memoryLabel, zp_size_t capacity )
+        : ConcurrentMap( memoryLabel, capacity, CreateAllocator( memoryLabel ) )
+    {
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    ConcurrentMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::ConcurrentMap( MemoryLabel memoryLabel, zp_size_t capacity, allocator_const_reference allocator )
+        : m_stripes {}
+        , m_initialTableCapacity( zp_max( zp_upper_pow2_size( ( capacity * 2 ) / ConcurrentMapStripe::kStripeCount ), static_cast<zp_size_t>( ConcurrentMapStripe::kMinTableCapacity ) ) )
+        , m_cmp( comparer_value() )
+        , m_hash( hash_func_value() )
+        , m_allocator( allocator )
+        , memoryLabel( memoryLabel )
+    {
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    ConcurrentMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::~ConcurrentMap()
+    {
+        destroy();
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    zp_size_t ConcurrentMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::size() const
+    {
+        zp_int64_t count = 0;
+        for( const ConcurrentMapStripeData& stripe : m_stripes )
+        {
+            count += Atomic::LoadRelaxed( &stripe.count );
+        }
+
+        return static_cast<zp_size_t>( count );
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    zp_bool_t ConcurrentMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::empty() const
+    {
+        return size() == 0;
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    typename ConcurrentMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::value_pointer ConcurrentMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::find( key_const_reference key ) const
+    {
+        return find( m_hash( key ), key );
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    typename ConcurrentMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::value_pointer ConcurrentMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::find( const_hash_value hash, key_const_reference key ) const
+    {
+        const zp_uint64_t bits = FlatMapControl::HashBits( hash );
+
+        const ConcurrentMapTable* table = Atomic::LoadAcquirePtr( &stripeFor( bits ).table );
+        ConcurrentMapNode* node = FindNode( table, bits, key, m_cmp );
+
+        return node ? &node->value : nullptr;
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    zp_bool_t ConcurrentMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::tryGet( key_const_reference key, value_reference value ) const
+    {
+        const value_pointer found = find( key );
+        if( found )
+        {
+            value = *found;
+        }
+
+        return found != nullptr;
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    zp_bool_t ConcurrentMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::tryGet( key_const_reference key, value_pointer value ) const
+    {
+        const value_pointer found = find( key );
+        if( found )
+        {
+            *value = *found;
+        }
+
+        return found != nullptr;
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    zp_bool_t ConcurrentMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::containsKey( key_const_reference key ) const
+    {
+        return find( key ) != nullptr;
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    zp_bool_t ConcurrentMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::tryAdd( key_const_reference key, value_const_reference value )
+    {
+        const zp_uint64_t bits = FlatMapControl::HashBits( m_hash( key ) );
+        ConcurrentMapStripeData& stripe = stripeFor( bits );
+
+        ConcurrentMapStripe::AcquireLock( &stripe.lock );
+
+        const zp_bool_t added = FindNode( stripe.table, bits, key, m_cmp ) == nullptr;
+        if( added )
+        {
+            addLocked( stripe, bits, key, value );
+        }
+
+        ConcurrentMapStripe::ReleaseLock( &stripe.lock );
+
+        return added;
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    zp_bool_t ConcurrentMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::tryAdd( key_const_reference key, value_move value )
+    {
+        const zp_uint64_t bits = FlatMapControl::HashBits( m_hash( key ) );
+        ConcurrentMapStripeData& stripe = stripeFor( bits );
+
+        ConcurrentMapStripe::AcquireLock( &stripe.lock );
+
+        const zp_bool_t added = FindNode( stripe.table, bits, key, m_cmp ) == nullptr;
+        if( added )
+        {
+            addLocked( stripe, bits, key, zp_move( value ) );
+        }
+
+        ConcurrentMapStripe::ReleaseLock( &stripe.lock );
+
+        return added;
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    template<typename Factory>
+    typename ConcurrentMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::value_reference ConcurrentMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::getOrAdd( key_const_reference key, Factory&& factory )
+    {
+        return getOrAdd( m_hash( key ), key, zp_forward<Factory>( factory ) );
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    template<typename Factory>
+    typename ConcurrentMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::value_reference ConcurrentMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::getOrAdd( const_hash_value hash, key_const_reference key, Factory&& factory )
+    {
+        const zp_uint64_t bits = FlatMapControl::HashBits( hash );
+        ConcurrentMapStripeData& stripe = stripeFor( bits );
+
+        // common case is already added, don't touch the lock
+        ConcurrentMapNode* node = FindNode( Atomic::LoadAcquirePtr( &stripe.table ), bits, key, m_cmp );
+        if( node == nullptr )
+        {
+            ConcurrentMapStripe::AcquireLock( &stripe.lock );
+
+            // another thread may have added it between the lookup and taking the lock
+            node = FindNode( stripe.table, bits, key, m_cmp );
+            if( node == nullptr )
+            {
+                node = addLocked( stripe, bits, key, factory() );
+            }
+
+            ConcurrentMapStripe::ReleaseLock( &stripe.lock );
+        }
+
+        return node->value;
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    void ConcurrentMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::clear()
+    {
+        for( ConcurrentMapStripeData& stripe : m_stripes )
+        {
+            freeStripe( stripe, true );
+        }
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    void ConcurrentMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::destroy()
+    {
+        for( ConcurrentMapStripeData& stripe : m_stripes )
+        {
+            freeStripe( stripe, false );
+        }
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    typename ConcurrentMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::iterator ConcurrentMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::begin()
+    {
+        return iterator( this, 0 );
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    typename ConcurrentMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::iterator ConcurrentMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::end()
+    {
+        return iterator( this, ConcurrentMapStripe::kStripeCount );
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    typename ConcurrentMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::allocator_value ConcurrentMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::CreateAllocator( MemoryLabel memoryLabel )
+    {
+        if constexpr( requires { allocator_value( memoryLabel ); } )
+        {
+            return allocator_value( memoryLabel );
+        }
+        else
+        {
+            return allocator_value();
+        }
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    typename ConcurrentMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::ConcurrentMapNode* ConcurrentMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::FindNode( const ConcurrentMapTable* table, zp_uint64_t bits, key_const_reference key, const comparer_value& cmp )
+    {
+        ConcurrentMapNode* found = nullptr;
+
+        if( table )
+        {
+            // tables are never more than half full, so there is always an empty slot to stop on
+            const zp_size_t mask = table->capacity - 1;
+            for( zp_size_t i = 0, index = ( bits >> 4 ) & mask; i < table->capacity; ++i, index = ( index + 1 ) & mask )
+            {
+                ConcurrentMapNode* node = Atomic::LoadAcquirePtr( &table->slots[ index ] );
+                if( node == nullptr )
+                {
+                    break;
+                }
+
+                if( node->bits == bits && cmp( node->key, key ) )
+                {
+                    found = node;
+                    break;
+                }
+            }
+        }
+
+        return found;
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    typename ConcurrentMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::ConcurrentMapStripeData& ConcurrentMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::stripeFor( zp_uint64_t bits ) const
+    {
+        // low bits pick the stripe, the bits above them pick the slot
+        return m_stripes[ bits & ( ConcurrentMapStripe::kStripeCount - 1 ) ];
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    typename ConcurrentMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::ConcurrentMapTable* ConcurrentMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::allocateTable( zp_size_t capacity )
+    {
+        const zp_size_t size = sizeof( ConcurrentMapTable ) + ( sizeof( ConcurrentMapNode* ) * ( capacity - 1 ) );
+
+        ConcurrentMapTable* table = static_cast<ConcurrentMapTable*>( m_allocator.allocate( size ) );
+        zp_zero_memory( table, size );
+        table->capacity = capacity;
+
+        return table;
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    template<typename V>
+    typename ConcurrentMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::ConcurrentMapNode* ConcurrentMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::addLocked( ConcurrentMapStripeData& stripe, zp_uint64_t bits, key_const_reference key, V&& value )
+    {
+        ConcurrentMapNodeBlock* block = stripe.blocks;
+        if( block == nullptr || block->count == ConcurrentMapStripe::kNodesPerBlock )
+        {
+            block = static_cast<ConcurrentMapNodeBlock*>( m_allocator.allocate( sizeof( ConcurrentMapNodeBlock ) ) );
+            block->next = stripe.blocks;
+            block->count = 0;
+
+            stripe.blocks = block;
+        }
+
+        // fully constructed before it's published, readers only ever see finished nodes
+        ConcurrentMapNode* node = new( block->nodes + block->count ) ConcurrentMapNode { bits, key, value_value( zp_forward<V>( value ) ) };
+        ++block->count;
+
+        const zp_int64_t count = stripe.count + 1;
+
+        ConcurrentMapTable* table = stripe.table;
+        if( table == nullptr || static_cast<zp_size_t>( count * 2 ) > table->capacity )
+        {
+            ConcurrentMapTable* grownTable = allocateTable( table ? table->capacity * 2 : m_initialTableCapacity );
+            grownTable->retired = table;
+
+            if( table )
+            {
+                const zp_size_t mask = grownTable->capacity - 1;
+                for( zp_size_t i = 0; i < table->capacity; ++i )
+                {
+                    ConcurrentMapNode* oldNode = table->slots[ i ];
+                    if( oldNode )
+                    {
+                        zp_size_t index = ( oldNode->bits >> 4 ) & mask;
+                        while( grownTable->slots[ index ] )
+                        {
+                            index = ( index + 1 ) & mask;
+                        }
+
+                        grownTable->slots[ index ] = oldNode;
+                    }
+                }
+            }
+
+            // readers still on the old table keep probing it safely, it's only freed with the map
+            Atomic::StoreReleasePtr( &stripe.table, grownTable );
+            table = grownTable;
+        }
+
+        const zp_size_t mask = table->capacity - 1;
+        zp_size_t index = ( bits >> 4 ) & mask;
+        while( table->slots[ index ] )
+        {
+            index = ( index + 1 ) & mask;
+        }
+
+        Atomic::StoreReleasePtr( &table->slots[ index ], node );
+        Atomic::StoreRelaxed( &stripe.count, count );
+
+        return node;
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    void ConcurrentMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::freeStripe( ConcurrentMapStripeData& stripe, zp_bool_t keepTable )
+    {
+        for( ConcurrentMapNodeBlock* block = stripe.blocks; block != nullptr; )
+        {
+            ConcurrentMapNodeBlock* next = block->next;
+
+            for( zp_size_t i = 0; i < block->count; ++i )
+            {
+                ( block->nodes + i )->~ConcurrentMapNode();
+            }
+
+            m_allocator.free( block );
+            block = next;
+        }
+
+        ConcurrentMapTable* table = stripe.table;
+        if( table && keepTable )
+        {
+            ConcurrentMapTable* retired = table->retired;
+            const zp_size_t capacity = table->capacity;
+
+            zp_zero_memory( table, sizeof( ConcurrentMapTable ) + ( sizeof( ConcurrentMapNode* ) * ( capacity - 1 ) ) );
+            table->capacity = capacity;
+
+            table = retired;
+        }
+        else
+        {
+            stripe.table = nullptr;
+        }
+
+        while( table )
+        {
+            ConcurrentMapTable* retired = table->retired;
+            m_allocator.free( table );
+            table = retired;
+        }
+
+        stripe.blocks = nullptr;
+        stripe.count = 0;
+    }
+
+//
+//
+//
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    ConcurrentMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::ConcurrentMapIterator::ConcurrentMapIterator( self_pointer map, zp_size_t stripe )
+        : m_map( map )
+        , m_table( nullptr )
+        , m_stripe( stripe )
+        , m_slot( 0 )
+    {
+        if( m_stripe < ConcurrentMapStripe::kStripeCount )
+        {
+            m_table = Atomic::LoadAcquirePtr( &m_map->m_stripes[ m_stripe ].table );
+            advance();
+        }
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    void ConcurrentMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::ConcurrentMapIterator::advance()
+    {
+        // skip empty slots, then empty stripes
+        while( m_stripe < ConcurrentMapStripe::kStripeCount )
+        {
+            for( ; m_table && m_slot < m_table->capacity; ++m_slot )
+            {
+                if( Atomic::LoadAcquirePtr( &m_table->slots[ m_slot ] ) )
+                {
+                    return;
+                }
+            }
+
+            ++m_stripe;
+            m_slot = 0;
+            m_table = m_stripe < ConcurrentMapStripe::kStripeCount ? Atomic::LoadAcquirePtr( &m_map->m_stripes[ m_stripe ].table ) : nullptr;
+        }
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    void ConcurrentMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::ConcurrentMapIterator::operator++()
+    {
+        ++m_slot;
+        advance();
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    void ConcurrentMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::ConcurrentMapIterator::operator++( int )
+    {
+        operator++();
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    typename ConcurrentMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::key_const_reference ConcurrentMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::ConcurrentMapIterator::key() const
+    {
+        return Atomic::LoadAcquirePtr( &m_table->slots[ m_slot ] )->key;
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    typename ConcurrentMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::value_reference ConcurrentMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::ConcurrentMapIterator::value() const
+    {
+        return Atomic::LoadAcquirePtr( &m_table->slots[ m_slot ] )->value;
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    zp_bool_t ConcurrentMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::ConcurrentMapIterator::operator==( const ConcurrentMapIterator& other ) const
+    {
+        return m_map == other.m_map && m_stripe == other.m_stripe && m_slot == other.m_slot;
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    zp_bool_t ConcurrentMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::ConcurrentMapIterator::operator!=( const ConcurrentMapIterator& other ) const
+    {
+        return !( operator==( other ) );
+    }
+}
+
+#endif //ZP_CONCURRENT_MAP_H
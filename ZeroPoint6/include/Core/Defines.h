@@ -75,9 +75,14 @@
 
 #define ZP_USE_PROFILER         1
 #define ZP_USE_MEMORY_PROFILER  1
+#define ZP_USE_MEMORY_SAMPLER   1
 
 #ifndef ZP_USE_TESTS
 #define ZP_USE_TESTS            1
 #endif // ZP_USE_TESTS
 
+#ifndef ZP_USE_BENCHMARKS
+#define ZP_USE_BENCHMARKS       0
+#endif // ZP_USE_BENCHMARKS
+
 #endif //ZP_DEFINES_H
@@ -0,0 +1,1127 @@
+//
+// Created by phosg on 10/16/2026.
+//
+
+#ifndef ZP_FLAT_MAP_H
+#define ZP_FLAT_MAP_H
+
+#include "Core/Defines.h"
+#include "Core/Types.h"
+#include "Core/Common.h"
+#include "Core/Hash.h"
+#include "Core/Allocator.h"
+
+#include <new>
+
+#if ZP_PLATFORM_ARCH64
+#define ZP_FLAT_MAP_USE_SSE2    1
+#include <emmintrin.h>
+#else
+#define ZP_FLAT_MAP_USE_SSE2    0
+#endif
+
+namespace zp
+{
+    //
+    // Open addressing with one control byte per slot. A full slot stores the low 7 bits of its hash (H2), the rest of the
+    // hash (H1) picks the first group to probe. Lookups compare H2 against a whole group of 16 control bytes at once and
+    // only touch the slots that match, probing stops at the first group with an empty slot.
+    //
+
+    namespace FlatMapControl
+    {
+        enum : zp_int8_t
+        {
+            Empty = -128,
+            Deleted = -2,
+        };
+
+        enum : zp_size_t
+        {
+            kGroupWidth = 16,
+        };
+
+        // probe target of every empty map, so lookups never check for a missing table
+        alignas( kGroupWidth ) extern const zp_int8_t kEmptyGroup[ kGroupWidth ];
+
+        ZP_FORCEINLINE zp_uint64_t HashBits( zp_hash32_t hash )
+        {
+            return hash;
+        }
+
+        ZP_FORCEINLINE zp_uint64_t HashBits( zp_hash64_t hash )
+        {
+            // fold the well mixed high bits down, H2 and the group index both come from the low bits
+            return hash ^ ( hash >> 32 );
+        }
+
+        ZP_FORCEINLINE zp_uint64_t HashBits( const zp_hash128_t& hash )
+        {
+            return hash.m32 ^ hash.m10;
+        }
+
+        ZP_FORCEINLINE zp_int8_t H2( zp_uint64_t bits )
+        {
+            return static_cast<zp_int8_t>( bits & 0x7F );
+        }
+
+        ZP_FORCEINLINE zp_size_t H1( zp_uint64_t bits )
+        {
+            return static_cast<zp_size_t>( bits >> 7 );
+        }
+    }
+
+    class FlatMapGroup
+    {
+    public:
+        ZP_FORCEINLINE explicit FlatMapGroup( const zp_int8_t* ctrl )
+#if ZP_FLAT_MAP_USE_SSE2
+            : m_ctrl( _mm_load_si128( reinterpret_cast<const __m128i*>( ctrl ) ) )
+#else
+            : m_ctrl( ctrl )
+#endif
+        {
+        }
+
+        // one bit per slot in the group
+        ZP_FORCEINLINE zp_uint32_t match( zp_int8_t h2 ) const
+        {
+#if ZP_FLAT_MAP_USE_SSE2
+            return static_cast<zp_uint32_t>( _mm_movemask_epi8( _mm_cmpeq_epi8( m_ctrl, _mm_set1_epi8( h2 ) ) ) );
+#else
+            return matchScalar( h2 );
+#endif
+        }
+
+        ZP_FORCEINLINE zp_uint32_t matchEmpty() const
+        {
+#if ZP_FLAT_MAP_USE_SSE2
+            return static_cast<zp_uint32_t>( _mm_movemask_epi8( _mm_cmpeq_epi8( m_ctrl, _mm_set1_epi8( FlatMapControl::Empty ) ) ) );
+#else
+            return matchScalar( FlatMapControl::Empty );
+#endif
+        }
+
+        // empty and deleted are the only control bytes with the sign bit set
+        ZP_FORCEINLINE zp_uint32_t matchEmptyOrDeleted() const
+        {
+#if ZP_FLAT_MAP_USE_SSE2
+            return static_cast<zp_uint32_t>( _mm_movemask_epi8( m_ctrl ) );
+#else
+            zp_uint32_t mask = 0;
+            for( zp_size_t i = 0; i < FlatMapControl::kGroupWidth; ++i )
+            {
+                mask |= m_ctrl[ i ] < 0 ? 1u << i : 0u;
+            }
+            return mask;
+#endif
+        }
+
+        ZP_FORCEINLINE zp_uint32_t matchFull() const
+        {
+            return ~matchEmptyOrDeleted() & 0xFFFFu;
+        }
+
+    private:
+#if ZP_FLAT_MAP_USE_SSE2
+        __m128i m_ctrl;
+#else
+        ZP_FORCEINLINE zp_uint32_t matchScalar( zp_int8_t ctrl ) const
+        {
+            zp_uint32_t mask = 0;
+            for( zp_size_t i = 0; i < FlatMapControl::kGroupWidth; ++i )
+            {
+                mask |= m_ctrl[ i ] == ctrl ? 1u << i : 0u;
+            }
+            return mask;
+        }
+
+        const zp_int8_t* m_ctrl;
+#endif
+    };
+
+    template<typename Key, typename Value, typename H = zp_hash64_t, typename KeyComparer = DefaultEquality<Key>, typename KeyHash = DefaultHash<Key, H>, typename Allocator = MemoryLabelAllocator>
+    class FlatMap
+    {
+    public:
+        typedef Key key_value;
+        typedef Key& key_reference;
+        typedef Key&& key_move;
+        typedef const Key& key_const_reference;
+
+        typedef Value value_value;
+        typedef Value& value_reference;
+        typedef Value&& value_move;
+        typedef const Value& value_const_reference;
+
+        typedef Value* value_pointer;
+        typedef Value*& value_pointer_reference;
+        typedef Value** value_pointer_pointer;
+        typedef const Value* value_const_pointer;
+
+        typedef Allocator allocator_value;
+        typedef const Allocator& allocator_const_reference;
+
+        typedef KeyComparer comparer_value;
+        typedef const KeyComparer& comparer_const_reference;
+
+        typedef KeyHash hash_func_value;
+        typedef const KeyHash& hash_func_const_reference;
+
+        typedef H hash_value;
+        typedef const H const_hash_value;
+
+        class FlatMapIterator;
+
+        class FlatMapConstIterator;
+
+        typedef FlatMapIterator iterator;
+        typedef FlatMapConstIterator const_iterator;
+
+        typedef FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator> self_value;
+        typedef const FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>& const_self_reference;
+        typedef const FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>* const_self_pointer;
+        typedef FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>* self_pointer;
+
+        explicit FlatMap( MemoryLabel memoryLabel );
+
+        FlatMap( MemoryLabel memoryLabel, zp_size_t capacity );
+
+        FlatMap( MemoryLabel memoryLabel, zp_size_t capacity, comparer_const_reference cmp );
+
+        FlatMap( MemoryLabel memoryLabel, zp_size_t capacity, allocator_const_reference allocator );
+
+        FlatMap( MemoryLabel memoryLabel, zp_size_t capacity, comparer_const_reference cmp, allocator_const_reference allocator );
+
+        FlatMap( MemoryLabel memoryLabel, comparer_const_reference cmp );
+
+        FlatMap( MemoryLabel memoryLabel, allocator_const_reference allocator );
+
+        FlatMap( MemoryLabel memoryLabel, comparer_const_reference cmp, allocator_const_reference allocator );
+
+        FlatMap( const FlatMap& ) = delete;
+
+        ~FlatMap();
+
+        [[nodiscard]] zp_size_t size() const;
+
+        [[nodiscard]] zp_bool_t empty() const;
+
+        [[nodiscard]] zp_size_t capacity() const;
+
+        value_reference operator[]( key_const_reference key );
+
+        value_reference operator[]( key_move key );
+
+        value_value operator[]( key_const_reference key ) const;
+
+        zp_bool_t tryGet( key_const_reference key, value_reference value ) const;
+
+        zp_bool_t tryGet( key_const_reference key, value_pointer value ) const;
+
+        zp_bool_t tryGet( key_const_reference key, value_pointer_reference value ) const;
+
+        zp_bool_t tryGet( key_const_reference key, value_pointer_pointer value ) const;
+
+        // hash has to be what KeyHash returns for key
+        zp_bool_t tryGet( const_hash_value hash, key_const_reference key, value_pointer_reference value ) const;
+
+        value_pointer find( key_const_reference key );
+
+        value_const_pointer find( key_const_reference key ) const;
+
+        // heterogeneous lookup, equals( const Key&, const K& ) compares a stored key against key, which hashes to hash
+        template<typename K, typename Equals>
+        value_pointer find( const_hash_value hash, const K& key, Equals equals );
+
+        template<typename K, typename Equals>
+        value_const_pointer find( const_hash_value hash, const K& key, Equals equals ) const;
+
+        value_reference get( key_const_reference key );
+
+        value_reference get( key_move key );
+
+        void set( key_const_reference key, value_const_reference value );
+
+        void set( key_const_reference key, value_move value );
+
+        void set( key_move key, value_const_reference value );
+
+        void set( key_move key, value_move value );
+
+        // insert or assign with an already computed hash
+        template<typename K, typename V>
+        void set( const_hash_value hash, K&& key, V&& value );
+
+        void setAll( const_self_reference other );
+
+        zp_bool_t containsKey( key_const_reference key ) const;
+
+        zp_bool_t remove( key_const_reference key );
+
+        void reserve( zp_size_t size );
+
+        void clear();
+
+        void destroy();
+
+        iterator begin();
+
+        iterator end();
+
+        const_iterator begin() const;
+
+        const_iterator end() const;
+
+    private:
+        struct FlatMapSlot
+        {
+            key_value key;
+            value_value value;
+        };
+
+        static allocator_value CreateAllocator( MemoryLabel memoryLabel );
+
+        // usable slots before a rehash, keeps 1/8 of the table empty so every probe sequence terminates
+        static zp_size_t GrowthLimit( zp_size_t capacity );
+
+        template<typename K, typename Equals>
+        zp_size_t findSlot( zp_uint64_t bits, const K& key, Equals equals ) const;
+
+        zp_size_t findInsertSlot( zp_uint64_t bits ) const;
+
+        zp_size_t prepareInsert( zp_uint64_t bits );
+
+        template<typename K, typename V>
+        void setInternal( zp_uint64_t bits, K&& key, V&& value );
+
+        template<typename K>
+        value_reference getInternal( zp_uint64_t bits, K&& key );
+
+        void setCtrl( zp_size_t index, zp_int8_t ctrl );
+
+        void rehashAndGrow();
+
+        void resize( zp_size_t capacity );
+
+        zp_size_t nextFullSlot( zp_size_t index ) const;
+
+        zp_int8_t* m_ctrl;
+        FlatMapSlot* m_slots;
+
+        zp_size_t m_capacity;
+        zp_size_t m_groupMask;
+        zp_size_t m_count;
+        zp_size_t m_growthLeft;
+
+        comparer_value m_cmp;
+        hash_func_value m_hash;
+
+        allocator_value m_allocator;
+
+    public:
+        class FlatMapIterator
+        {
+        private:
+            FlatMapIterator();
+
+            FlatMapIterator( self_pointer map, zp_size_t index );
+
+        public:
+            ~FlatMapIterator() = default;
+
+            void operator++();
+
+            void operator++( int );
+
+            key_const_reference key() const;
+
+            value_reference value();
+
+            value_const_reference value() const;
+
+            zp_bool_t operator==( const FlatMapIterator& other ) const;
+
+            zp_bool_t operator!=( const FlatMapIterator& other ) const;
+
+        private:
+            self_pointer m_map;
+            zp_size_t m_current;
+
+            friend class FlatMap;
+        };
+
+        class FlatMapConstIterator
+        {
+        private:
+            FlatMapConstIterator();
+
+            FlatMapConstIterator( const_self_pointer map, zp_size_t index );
+
+        public:
+            ~FlatMapConstIterator() = default;
+
+            void operator++();
+
+            void operator++( int );
+
+            key_const_reference key() const;
+
+            value_const_reference value() const;
+
+            zp_bool_t operator==( const FlatMapConstIterator& other ) const;
+
+            zp_bool_t operator!=( const FlatMapConstIterator& other ) const;
+
+        private:
+            const_self_pointer m_map;
+            zp_size_t m_current;
+
+            friend class FlatMap;
+        };
+
+    public:
+        const MemoryLabel memoryLabel;
+    };
+}
+
+//
+//
+//
+
+namespace zp
+{
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::FlatMap( MemoryLabel memoryLabel )
+        : m_ctrl( const_cast<zp_int8_t*>( FlatMapControl::kEmptyGroup ) )
+        , m_slots( nullptr )
+        , m_capacity( 0 )
+        , m_groupMask( 0 )
+        , m_count( 0 )
+        , m_growthLeft( 0 )
+        , m_cmp( comparer_value() )
+        , m_hash( hash_func_value() )
+        , m_allocator( CreateAllocator( memoryLabel ) )
+        , memoryLabel( memoryLabel )
+    {
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::FlatMap( MemoryLabel memoryLabel, zp_size_t capacity )
+        : m_ctrl( const_cast<zp_int8_t*>( FlatMapControl::kEmptyGroup ) )
+        , m_slots( nullptr )
+        , m_capacity( 0 )
+        , m_groupMask( 0 )
+        , m_count( 0 )
+        , m_growthLeft( 0 )
+        , m_cmp( comparer_value() )
+        , m_hash( hash_func_value() )
+        , m_allocator( CreateAllocator( memoryLabel ) )
+        , memoryLabel( memoryLabel )
+    {
+        reserve( capacity );
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::FlatMap( MemoryLabel memoryLabel, zp_size_t capacity, comparer_const_reference cmp )
+        : m_ctrl( const_cast<zp_int8_t*>( FlatMapControl::kEmptyGroup ) )
+        , m_slots( nullptr )
+        , m_capacity( 0 )
+        , m_groupMask( 0 )
+        , m_count( 0 )
+        , m_growthLeft( 0 )
+        , m_cmp( cmp )
+        , m_hash( hash_func_value() )
+        , m_allocator( CreateAllocator( memoryLabel ) )
+        , memoryLabel( memoryLabel )
+    {
+        reserve( capacity );
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::FlatMap( MemoryLabel memoryLabel, zp_size_t capacity, allocator_const_reference allocator )
+        : m_ctrl( const_cast<zp_int8_t*>( FlatMapControl::kEmptyGroup ) )
+        , m_slots( nullptr )
+        , m_capacity( 0 )
+        , m_groupMask( 0 )
+        , m_count( 0 )
+        , m_growthLeft( 0 )
+        , m_cmp( comparer_value() )
+        , m_hash( hash_func_value() )
+        , m_allocator( allocator )
+        , memoryLabel( memoryLabel )
+    {
+        reserve( capacity );
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::FlatMap( MemoryLabel memoryLabel, zp_size_t capacity, comparer_const_reference cmp, allocator_const_reference allocator )
+        : m_ctrl( const_cast<zp_int8_t*>( FlatMapControl::kEmptyGroup ) )
+        , m_slots( nullptr )
+        , m_capacity( 0 )
+        , m_groupMask( 0 )
+        , m_count( 0 )
+        , m_growthLeft( 0 )
+        , m_cmp( cmp )
+        , m_hash( hash_func_value() )
+        , m_allocator( allocator )
+        , memoryLabel( memoryLabel )
+    {
+        reserve( capacity );
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::FlatMap( MemoryLabel memoryLabel, comparer_const_reference cmp )
+        : m_ctrl( const_cast<zp_int8_t*>( FlatMapControl::kEmptyGroup ) )
+        , m_slots( nullptr )
+        , m_capacity( 0 )
+        , m_groupMask( 0 )
+        , m_count( 0 )
+        , m_growthLeft( 0 )
+        , m_cmp( cmp )
+        , m_hash( hash_func_value() )
+        , m_allocator( CreateAllocator( memoryLabel ) )
+        , memoryLabel( memoryLabel )
+    {
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::FlatMap( MemoryLabel memoryLabel, allocator_const_reference allocator )
+        : m_ctrl( const_cast<zp_int8_t*>( FlatMapControl::kEmptyGroup ) )
+        , m_slots( nullptr )
+        , m_capacity( 0 )
+        , m_groupMask( 0 )
+        , m_count( 0 )
+        , m_growthLeft( 0 )
+        , m_cmp( comparer_value() )
+        , m_hash( hash_func_value() )
+        , m_allocator( allocator )
+        , memoryLabel( memoryLabel )
+    {
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::FlatMap( MemoryLabel memoryLabel, comparer_const_reference cmp, allocator_const_reference allocator )
+        : m_ctrl( const_cast<zp_int8_t*>( FlatMapControl::kEmptyGroup ) )
+        , m_slots( nullptr )
+        , m_capacity( 0 )
+        , m_groupMask( 0 )
+        , m_count( 0 )
+        , m_growthLeft( 0 )
+        , m_cmp( cmp )
+        , m_hash( hash_func_value() )
+        , m_allocator( allocator )
+        , memoryLabel( memoryLabel )
+    {
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::~FlatMap()
+    {
+        destroy();
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    zp_size_t FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::size() const
+    {
+        return m_count;
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    zp_bool_t FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::empty() const
+    {
+        return m_count == 0;
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    zp_size_t FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::capacity() const
+    {
+        return m_capacity;
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    typename FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::value_reference FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::operator[]( key_const_reference key )
+    {
+        return get( key );
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    typename FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::value_reference FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::operator[]( key_move key )
+    {
+        return get( zp_move( key ) );
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    typename FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::value_value FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::operator[]( key_const_reference key ) const
+    {
+        value_const_pointer value = find( key );
+        ZP_ASSERT( value != nullptr );
+        return *value;
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    zp_bool_t FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::tryGet( key_const_reference key, value_reference value ) const
+    {
+        value_const_pointer found = find( key );
+        if( found )
+        {
+            value = *found;
+        }
+
+        return found != nullptr;
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    zp_bool_t FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::tryGet( key_const_reference key, value_pointer value ) const
+    {
+        value_const_pointer found = find( key );
+        if( found )
+        {
+            *value = *found;
+        }
+
+        return found != nullptr;
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    zp_bool_t FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::tryGet( key_const_reference key, value_pointer_reference value ) const
+    {
+        value_const_pointer found = find( key );
+        if( found )
+        {
+            value = const_cast<value_pointer>( found );
+        }
+
+        return found != nullptr;
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    zp_bool_t FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::tryGet( key_const_reference key, value_pointer_pointer value ) const
+    {
+        value_const_pointer found = find( key );
+        if( found )
+        {
+            *value = const_cast<value_pointer>( found );
+        }
+
+        return found != nullptr;
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    zp_bool_t FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::tryGet( const_hash_value hash, key_const_reference key, value_pointer_reference value ) const
+    {
+        value_const_pointer found = find( hash, key, m_cmp );
+        if( found )
+        {
+            value = const_cast<value_pointer>( found );
+        }
+
+        return found != nullptr;
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    typename FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::value_pointer FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::find( key_const_reference key )
+    {
+        return find( m_hash( key ), key, m_cmp );
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    typename FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::value_const_pointer FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::find( key_const_reference key ) const
+    {
+        return find( m_hash( key ), key, m_cmp );
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    template<typename K, typename Equals>
+    typename FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::value_pointer FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::find( const_hash_value hash, const K& key, Equals equals )
+    {
+        const zp_size_t index = findSlot( FlatMapControl::HashBits( hash ), key, equals );
+        return index != zp::npos ? &m_slots[ index ].value : nullptr;
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    template<typename K, typename Equals>
+    typename FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::value_const_pointer FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::find( const_hash_value hash, const K& key, Equals equals ) const
+    {
+        const zp_size_t index = findSlot( FlatMapControl::HashBits( hash ), key, equals );
+        return index != zp::npos ? &m_slots[ index ].value : nullptr;
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    typename FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::value_reference FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::get( key_const_reference key )
+    {
+        return getInternal( FlatMapControl::HashBits( m_hash( key ) ), key );
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    typename FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::value_reference FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::get( key_move key )
+    {
+        const zp_uint64_t bits = FlatMapControl::HashBits( m_hash( key ) );
+        return getInternal( bits, zp_move( key ) );
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    void FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::set( key_const_reference key, value_const_reference value )
+    {
+        setInternal( FlatMapControl::HashBits( m_hash( key ) ), key, value );
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    void FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::set( key_const_reference key, value_move value )
+    {
+        setInternal( FlatMapControl::HashBits( m_hash( key ) ), key, zp_move( value ) );
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    void FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::set( key_move key, value_const_reference value )
+    {
+        const zp_uint64_t bits = FlatMapControl::HashBits( m_hash( key ) );
+        setInternal( bits, zp_move( key ), value );
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    void FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::set( key_move key, value_move value )
+    {
+        const zp_uint64_t bits = FlatMapControl::HashBits( m_hash( key ) );
+        setInternal( bits, zp_move( key ), zp_move( value ) );
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    template<typename K, typename V>
+    void FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::set( const_hash_value hash, K&& key, V&& value )
+    {
+        setInternal( FlatMapControl::HashBits( hash ), zp_forward<K>( key ), zp_forward<V>( value ) );
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    void FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::setAll( const_self_reference other )
+    {
+        reserve( m_count + other.m_count );
+
+        for( auto b = other.begin(), e = other.end(); b != e; ++b )
+        {
+            set( b.key(), b.value() );
+        }
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    zp_bool_t FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::containsKey( key_const_reference key ) const
+    {
+        return find( key ) != nullptr;
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    zp_bool_t FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::remove( key_const_reference key )
+    {
+        const zp_size_t index = findSlot( FlatMapControl::HashBits( m_hash( key ) ), key, m_cmp );
+        const zp_bool_t removed = index != zp::npos;
+
+        if( removed )
+        {
+            ( m_slots + index )->~FlatMapSlot();
+            --m_count;
+
+            // no probe sequence ever continued past a group that still has an empty slot, so the slot can go back to empty
+            const FlatMapGroup group( m_ctrl + ( index & ~( FlatMapControl::kGroupWidth - 1 ) ) );
+            if( group.matchEmpty() != 0 )
+            {
+                setCtrl( index, FlatMapControl::Empty );
+                ++m_growthLeft;
+            }
+            else
+            {
+                setCtrl( index, FlatMapControl::Deleted );
+            }
+        }
+
+        return removed;
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    void FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::reserve( zp_size_t size )
+    {
+        if( size > GrowthLimit( m_capacity ) )
+        {
+            zp_size_t capacity = zp_upper_pow2_size( size + ( size / 7 ) + 1 );
+            capacity = zp_max( capacity, static_cast<zp_size_t>( FlatMapControl::kGroupWidth ) );
+
+            resize( capacity );
+        }
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    void FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::clear()
+    {
+        if( m_capacity > 0 )
+        {
+            if( m_count > 0 )
+            {
+                for( zp_size_t i = nextFullSlot( 0 ); i < m_capacity; i = nextFullSlot( i + 1 ) )
+                {
+                    ( m_slots + i )->~FlatMapSlot();
+                }
+            }
+
+            zp_memset( m_ctrl, m_capacity, FlatMapControl::Empty );
+
+            m_count = 0;
+            m_growthLeft = GrowthLimit( m_capacity );
+        }
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    void FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::destroy()
+    {
+        clear();
+
+        if( m_capacity > 0 )
+        {
+            // control bytes and slots share one allocation
+            m_allocator.free( m_ctrl );
+        }
+
+        m_ctrl = const_cast<zp_int8_t*>( FlatMapControl::kEmptyGroup );
+        m_slots = nullptr;
+        m_capacity = 0;
+        m_groupMask = 0;
+        m_growthLeft = 0;
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    typename FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::iterator FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::begin()
+    {
+        return iterator( this, nextFullSlot( 0 ) );
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    typename FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::iterator FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::end()
+    {
+        return iterator( this, m_capacity );
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    typename FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::const_iterator FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::begin() const
+    {
+        return const_iterator( this, nextFullSlot( 0 ) );
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    typename FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::const_iterator FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::end() const
+    {
+        return const_iterator( this, m_capacity );
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    typename FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::allocator_value FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::CreateAllocator( MemoryLabel memoryLabel )
+    {
+        if constexpr( requires { allocator_value( memoryLabel ); } )
+        {
+            return allocator_value( memoryLabel );
+        }
+        else
+        {
+            return allocator_value();
+        }
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    zp_size_t FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::GrowthLimit( zp_size_t capacity )
+    {
+        return capacity - ( capacity / 8 );
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    template<typename K, typename Equals>
+    zp_size_t FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::findSlot( zp_uint64_t bits, const K& key, Equals equals ) const
+    {
+        const zp_int8_t h2 = FlatMapControl::H2( bits );
+
+        // triangular steps over a power of two group count visit every group once
+        zp_size_t group = FlatMapControl::H1( bits ) & m_groupMask;
+        for( zp_size_t step = 1;; ++step )
+        {
+            const zp_size_t groupStart = group * FlatMapControl::kGroupWidth;
+            const FlatMapGroup g( m_ctrl + groupStart );
+
+            for( zp_uint32_t match = g.match( h2 ); match != 0; match &= match - 1 )
+            {
+                const zp_size_t index = groupStart + zp_bitscan_forward( match );
+                if( equals( m_slots[ index ].key, key ) )
+                {
+                    return index;
+                }
+            }
+
+            if( g.matchEmpty() != 0 )
+            {
+                break;
+            }
+
+            group = ( group + step ) & m_groupMask;
+        }
+
+        return zp::npos;
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    zp_size_t FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::findInsertSlot( zp_uint64_t bits ) const
+    {
+        zp_size_t group = FlatMapControl::H1( bits ) & m_groupMask;
+        for( zp_size_t step = 1;; ++step )
+        {
+            const zp_size_t groupStart = group * FlatMapControl::kGroupWidth;
+            const zp_uint32_t available = FlatMapGroup( m_ctrl + groupStart ).matchEmptyOrDeleted();
+            if( available != 0 )
+            {
+                return groupStart + zp_bitscan_forward( available );
+            }
+
+            group = ( group + step ) & m_groupMask;
+        }
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    zp_size_t FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::prepareInsert( zp_uint64_t bits )
+    {
+        zp_size_t index = m_capacity > 0 ? findInsertSlot( bits ) : 0;
+
+        // reusing a deleted slot doesn't use up any growth
+        if( m_growthLeft == 0 && ( m_capacity == 0 || m_ctrl[ index ] != FlatMapControl::Deleted ) )
+        {
+            rehashAndGrow();
+            index = findInsertSlot( bits );
+        }
+
+        if( m_ctrl[ index ] == FlatMapControl::Empty )
+        {
+            --m_growthLeft;
+        }
+
+        setCtrl( index, FlatMapControl::H2( bits ) );
+        ++m_count;
+
+        return index;
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    template<typename K, typename V>
+    void FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::setInternal( zp_uint64_t bits, K&& key, V&& value )
+    {
+        const zp_size_t found = findSlot( bits, key, m_cmp );
+        if( found != zp::npos )
+        {
+            m_slots[ found ].value = zp_forward<V>( value );
+        }
+        else
+        {
+            const zp_size_t index = prepareInsert( bits );
+            new( m_slots + index ) FlatMapSlot { key_value( zp_forward<K>( key ) ), value_value( zp_forward<V>( value ) ) };
+        }
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    template<typename K>
+    typename FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::value_reference FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::getInternal( zp_uint64_t bits, K&& key )
+    {
+        zp_size_t index = findSlot( bits, key, m_cmp );
+        if( index == zp::npos )
+        {
+            index = prepareInsert( bits );
+            new( m_slots + index ) FlatMapSlot { key_value( zp_forward<K>( key ) ), value_value() };
+        }
+
+        return m_slots[ index ].value;
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    void FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::setCtrl( zp_size_t index, zp_int8_t ctrl )
+    {
+        m_ctrl[ index ] = ctrl;
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    void FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::rehashAndGrow()
+    {
+        if( m_capacity == 0 )
+        {
+            resize( FlatMapControl::kGroupWidth );
+        }
+        else if( m_count * 32 <= m_capacity * 25 )
+        {
+            // mostly tombstones, rehashing at the same size is enough to get growth back
+            resize( m_capacity );
+        }
+        else
+        {
+            resize( m_capacity * 2 );
+        }
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    void FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::resize( zp_size_t capacity )
+    {
+        ZP_ASSERT( ( capacity & ( capacity - 1 ) ) == 0 && capacity >= FlatMapControl::kGroupWidth );
+        ZP_ASSERT( alignof( FlatMapSlot ) <= kDefaultMemoryAlignment );
+
+        zp_int8_t* oldCtrl = m_ctrl;
+        FlatMapSlot* oldSlots = m_slots;
+        const zp_size_t oldCapacity = m_capacity;
+
+        // control bytes first, capacity is a multiple of the group width so the slots stay aligned
+        zp_int8_t* ctrl = static_cast<zp_int8_t*>( m_allocator.allocate( capacity + sizeof( FlatMapSlot ) * capacity ) );
+        zp_memset( ctrl, capacity, FlatMapControl::Empty );
+
+        m_ctrl = ctrl;
+        m_slots = reinterpret_cast<FlatMapSlot*>( ctrl + capacity );
+        m_capacity = capacity;
+        m_groupMask = ( capacity / FlatMapControl::kGroupWidth ) - 1;
+        m_growthLeft = GrowthLimit( capacity ) - m_count;
+
+        for( zp_size_t i = 0; i < oldCapacity; ++i )
+        {
+            if( oldCtrl[ i ] >= 0 )
+            {
+                FlatMapSlot& oldSlot = oldSlots[ i ];
+
+                const zp_uint64_t bits = FlatMapControl::HashBits( m_hash( oldSlot.key ) );
+                const zp_size_t index = findInsertSlot( bits );
+                setCtrl( index, FlatMapControl::H2( bits ) );
+
+                new( m_slots + index ) FlatMapSlot { zp_move( oldSlot.key ), zp_move( oldSlot.value ) };
+                ( &oldSlot )->~FlatMapSlot();
+            }
+        }
+
+        if( oldCapacity > 0 )
+        {
+            m_allocator.free( oldCtrl );
+        }
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    zp_size_t FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::nextFullSlot( zp_size_t index ) const
+    {
+        while( index < m_capacity && m_ctrl[ index ] < 0 )
+        {
+            ++index;
+        }
+
+        return zp_min( index, m_capacity );
+    }
+
+//
+//
+//
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::FlatMapIterator::FlatMapIterator()
+        : m_map( nullptr )
+        , m_current( 0 )
+    {
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::FlatMapIterator::FlatMapIterator( self_pointer map, zp_size_t index )
+        : m_map( map )
+        , m_current( index )
+    {
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    void FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::FlatMapIterator::operator++()
+    {
+        m_current = m_map->nextFullSlot( m_current + 1 );
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    void FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::FlatMapIterator::operator++( int )
+    {
+        operator++();
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    typename FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::key_const_reference FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::FlatMapIterator::key() const
+    {
+        return m_map->m_slots[ m_current ].key;
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    typename FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::value_reference FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::FlatMapIterator::value()
+    {
+        return m_map->m_slots[ m_current ].value;
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    typename FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::value_const_reference FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::FlatMapIterator::value() const
+    {
+        return m_map->m_slots[ m_current ].value;
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    zp_bool_t FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::FlatMapIterator::operator==( const FlatMapIterator& other ) const
+    {
+        return m_map == other.m_map && m_current == other.m_current;
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    zp_bool_t FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::FlatMapIterator::operator!=( const FlatMapIterator& other ) const
+    {
+        return !( operator==( other ) );
+    }
+
+//
+//
+//
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::FlatMapConstIterator::FlatMapConstIterator()
+        : m_map( nullptr )
+        , m_current( 0 )
+    {
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::FlatMapConstIterator::FlatMapConstIterator( const_self_pointer map, zp_size_t index )
+        : m_map( map )
+        , m_current( index )
+    {
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    void FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::FlatMapConstIterator::operator++()
+    {
+        m_current = m_map->nextFullSlot( m_current + 1 );
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    void FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::FlatMapConstIterator::operator++( int )
+    {
+        operator++();
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    typename FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::key_const_reference FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::FlatMapConstIterator::key() const
+    {
+        return m_map->m_slots[ m_current ].key;
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    typename FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::value_const_reference FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::FlatMapConstIterator::value() const
+    {
+        return m_map->m_slots[ m_current ].value;
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    zp_bool_t FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::FlatMapConstIterator::operator==( const FlatMapConstIterator& other ) const
+    {
+        return m_map == other.m_map && m_current == other.m_current;
+    }
+
+    template<typename Key, typename Value, typename H, typename KeyComparer, typename KeyHash, typename Allocator>
+    zp_bool_t FlatMap<Key, Value, H, KeyComparer, KeyHash, Allocator>::FlatMapConstIterator::operator!=( const FlatMapConstIterator& other ) const
+    {
+        return !( operator==( other ) );
+    }
+}
+
+#endif //ZP_FLAT_MAP_H
@@ -34,15 +34,15 @@ namespace zp
         }
 
         Function( const Function& func )
-            : m_data()
+            : m_data( func.m_data )
             , m_stub( func.m_stub )
         {
         }
 
         Function( Function&& func ) noexcept
+            : m_data( func.m_data )
+            , m_stub( func.m_stub )
         {
-            m_stub = func.m_stub;
-
             func.m_stub = {};
         }
 
@@ -7,6 +7,7 @@
 
 #include "Core/Types.h"
 #include "Core/Memory.h"
+#include "Core/Allocator.h"
 #include "Core/Common.h"
 #include "Core/Function.h"
 
@@ -14,9 +15,18 @@ namespace zp
 {
     struct Job;
 
+    enum class JobPriority : zp_uint8_t
+    {
+        FrameCritical,
+        Normal,
+        Background,
+        Count,
+    };
+
     struct JobHandle
     {
         Job* job;
+        zp_uint32_t generation;
     };
 
     struct JobWorkArgs
@@ -32,11 +42,23 @@ namespace zp
 
     using JobCallback = void ( * )( const JobWorkArgs& );
 
+    // per thread activity between two stat snapshots
+    struct JobWorkerStats
+    {
+        zp_uint64_t executedJobs;
+        zp_uint64_t steals;
+        zp_uint64_t failedSteals;
+        zp_uint64_t parks;
+        zp_time_t idleTime;
+        zp_uint32_t queuedJobs;
+    };
+
     using JobWorkFunc = Function<void( const JobWorkArgs& )>;
 
     namespace JobSystem
     {
-        void Setup( MemoryLabel memoryLabel, zp_uint32_t threadCount );
+        // threads are placed one per physical core first, hardwareThreadsPerCore > 1 also places threads on SMT siblings
+        void Setup( MemoryLabel memoryLabel, zp_uint32_t threadCount, zp_uint32_t hardwareThreadsPerCore = 1 );
 
         void Teardown();
 
@@ -48,32 +70,60 @@ namespace zp
 
         zp_uint32_t GetJobQueueCount();
 
+        // takes a new snapshot of every thread's counters, done automatically on Profiler::AdvanceFrame
+        void SnapshotWorkerStats();
+
+        // stats from the last snapshot, one per job queue (worker threads, then the main thread). Returns the number written
+        zp_size_t GetWorkerStats( JobWorkerStats* workerStats, zp_size_t workerStatsCount );
+
         void Complete( JobHandle jobHandle );
 
         zp_bool_t IsComplete( JobHandle jobHandle );
 
         //
-        JobHandle Execute( JobWorkFunc func );
+        JobHandle Execute( JobWorkFunc func, JobPriority priority = JobPriority::Normal );
 
-        JobHandle PrepareEmpty();
+        JobHandle PrepareEmpty( JobPriority priority = JobPriority::Normal );
 
-        JobHandle Prepare( JobWorkFunc func, JobHandle dependency );
+        JobHandle Prepare( JobWorkFunc func, JobHandle dependency, JobPriority priority = JobPriority::Normal );
+
+        // job runs once all dependencies have completed, up to 8 dependencies (join through an empty job for more)
+        JobHandle Prepare( JobWorkFunc func, const JobHandle* dependencies, zp_size_t dependencyCount, JobPriority priority = JobPriority::Normal );
 
         //
-        JobHandle Dispatch( zp_size_t length, zp_size_t batchCount, JobWorkFunc func );
+        JobHandle Dispatch( zp_size_t length, zp_size_t batchCount, JobWorkFunc func, JobPriority priority = JobPriority::Normal );
+
+        JobHandle PrepareDispatch( zp_size_t length, zp_size_t batchCount, JobWorkFunc func, JobHandle dependency, JobPriority priority = JobPriority::Normal );
 
-        JobHandle PrepareDispatch( zp_size_t length, zp_size_t batchCount, JobWorkFunc func, JobHandle dependency );
+        // runs func for every index in [0, length), splitting the range in half only while other workers are idle, never below grain
+        JobHandle ParallelFor( zp_size_t length, zp_size_t grain, JobWorkFunc func, JobPriority priority = JobPriority::Normal );
+
+        // temporary memory from the current thread's job scratch arena, only valid until the calling job returns
+        Memory AllocateScratchMemory( zp_size_t size, zp_size_t alignment = kDefaultMemoryAlignment );
 
         //
-        JobHandle Start( Memory jobData, JobCallback jobCallback );
+        JobHandle Start( Memory jobData, JobCallback jobCallback, JobPriority priority = JobPriority::Normal );
 
         template<typename T>
-        JobHandle Start( T&& jobData )
+        JobHandle Start( T&& jobData, JobPriority priority = JobPriority::Normal )
         {
             using TJob = zp_remove_reference_t<T>;
-            return Start( Memory { &jobData, sizeof( TJob ) }, TJob::Execute );
+            return Start( Memory { &jobData, sizeof( TJob ) }, TJob::Execute, priority );
         }
 
+        // queued as soon as dependency completes, without waiting for ScheduleBatchJobs
+        JobHandle StartAfter( Memory jobData, JobCallback jobCallback, JobHandle dependency, JobPriority priority = JobPriority::Normal );
+
+        // job that never runs, it completes (and releases anything depending on it) when Signal is called exactly once
+        JobHandle PrepareSignal( JobPriority priority = JobPriority::Normal );
+
+        void Signal( JobHandle signalHandle );
+
+        // coroutine frames, pooled per thread and safe to free from any thread
+        void* AllocateTaskFrame( zp_size_t size );
+
+        void FreeTaskFrame( void* ptr, zp_size_t size );
+
         //
         JobHandle Run( Memory jobData, JobCallback jobCallback );
 
@@ -84,9 +134,19 @@ namespace zp
             return Run( Memory { &jobData, sizeof( TJob ) }, TJob::Execute );
         }
 
+        // jobs count against the frame they were allocated in until they finish, background jobs excepted. Runs queued jobs
+        // until none are left from the frame before the current one, then starts the next frame
+        void AdvanceFrame();
+
         void ScheduleBatchJobs();
 
         void ProcessJobs();
+
+        // background jobs call these periodically; true when higher priority jobs are waiting
+        zp_bool_t ShouldYield();
+
+        // runs queued jobs of a higher priority than the calling job before returning to it
+        void YieldToHigherPriority();
     }
 #if 0
     static void InitializeJobThreads();
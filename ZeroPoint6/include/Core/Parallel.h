@@ -0,0 +1,547 @@
+//
+// Created by phosg on 10/16/2026.
+//
+
+#ifndef ZP_PARALLEL_H
+#define ZP_PARALLEL_H
+
+#include "Core/Defines.h"
+#include "Core/Types.h"
+#include "Core/Common.h"
+#include "Core/Memory.h"
+#include "Core/Allocator.h"
+#include "Core/Vector.h"
+#include "Core/Job.h"
+
+namespace zp
+{
+    //
+    // Data parallel algorithms over JobSystem::Dispatch. The range is cut into contiguous blocks, a few per job queue
+    // so stealing can even out uneven blocks, and each call blocks (helping run jobs) until the result is ready.
+    // Ranges too small to be worth splitting run serially on the calling thread.
+    //
+
+    namespace Parallel
+    {
+        constexpr zp_size_t kMaxBlockCount = 256;
+        constexpr zp_size_t kMinBlockLength = 4096;
+        constexpr zp_size_t kBlocksPerJobQueue = 4;
+
+        // number of blocks to cut length elements into, at least 1 and never more than kMaxBlockCount
+        zp_size_t GetBlockCount( zp_size_t length, zp_size_t minBlockLength = kMinBlockLength );
+
+        ZP_FORCEINLINE zp_size_t GetBlockStart( zp_size_t length, zp_size_t blockCount, zp_size_t block )
+        {
+            return ( length * block ) / blockCount;
+        }
+
+        // in place, not stable. scratch for the merge passes is length elements allocated from memoryLabel
+        template<typename T, typename Cmp>
+        void Sort( MemoryArray<T> values, Cmp cmp, MemoryLabel memoryLabel );
+
+        // op must be associative, blocks are combined left to right so it does not need to be commutative
+        template<typename T, typename Op>
+        T Reduce( ReadonlyMemoryArray<T> values, T identity, Op op );
+
+        // output[i] = input[0] op ... op input[i], output may be the same array as input
+        template<typename T, typename Op>
+        void InclusiveScan( ReadonlyMemoryArray<T> input, MemoryArray<T> output, T identity, Op op );
+
+        // output[i] = identity op input[0] op ... op input[i - 1], output may be the same array as input
+        template<typename T, typename Op>
+        void ExclusiveScan( ReadonlyMemoryArray<T> input, MemoryArray<T> output, T identity, Op op );
+
+        // stable stream compaction, copies every element where pred is true into output and returns how many were written.
+        // output must not overlap input and must be large enough for every element. pred is called twice per element
+        template<typename T, typename Pred>
+        zp_size_t Compact( ReadonlyMemoryArray<T> input, MemoryArray<T> output, Pred pred );
+
+        //
+        // Vector views
+        //
+
+        template<typename T, typename Allocator, typename Cmp>
+        void Sort( Vector<T, Allocator>& values, Cmp cmp, MemoryLabel memoryLabel )
+        {
+            Sort( MemoryArray<T>( values.data(), values.length() ), cmp, memoryLabel );
+        }
+
+        template<typename T, typename Allocator, typename Op>
+        T Reduce( const Vector<T, Allocator>& values, T identity, Op op )
+        {
+            return Reduce( ReadonlyMemoryArray<T>( values.data(), values.length() ), identity, op );
+        }
+
+        template<typename T, typename Allocator, typename Op>
+        void InclusiveScan( Vector<T, Allocator>& values, T identity, Op op )
+        {
+            InclusiveScan( ReadonlyMemoryArray<T>( values.data(), values.length() ), MemoryArray<T>( values.data(), values.length() ), identity, op );
+        }
+
+        template<typename T, typename Allocator, typename Op>
+        void ExclusiveScan( Vector<T, Allocator>& values, T identity, Op op )
+        {
+            ExclusiveScan( ReadonlyMemoryArray<T>( values.data(), values.length() ), MemoryArray<T>( values.data(), values.length() ), identity, op );
+        }
+
+        // output is resized to the number of elements kept
+        template<typename T, typename Allocator, typename OutAllocator, typename Pred>
+        void Compact( const Vector<T, Allocator>& input, Vector<T, OutAllocator>& output, Pred pred )
+        {
+            output.reserve( input.length() );
+            output.resize_unsafe( input.length() );
+
+            const zp_size_t count = Compact( ReadonlyMemoryArray<T>( input.data(), input.length() ), MemoryArray<T>( output.data(), output.length() ), pred );
+
+            output.resize_unsafe( count );
+        }
+    }
+}
+
+//
+//
+//
+
+namespace zp
+{
+    namespace Parallel
+    {
+        template<typename T, typename Cmp>
+        struct SortBlocksJob
+        {
+            T* values;
+            zp_size_t length;
+            zp_size_t blockCount;
+            Cmp cmp;
+
+            void execute( const JobWorkArgs& args )
+            {
+                const zp_size_t start = GetBlockStart( length, blockCount, args.index );
+                const zp_size_t end = GetBlockStart( length, blockCount, args.index + 1 );
+
+                zp_sort( values + start, values + end, cmp );
+            }
+        };
+
+        // every pair of sorted runs in src is merged into dst, each merge split into piecesPerPair jobs along the merge path
+        template<typename T, typename Cmp>
+        struct MergeRunsJob
+        {
+            const T* src;
+            T* dst;
+            const zp_size_t* runStarts;
+            zp_size_t runCount;
+            zp_size_t piecesPerPair;
+            Cmp cmp;
+
+            // number of elements taken from a for the first k merged elements, ties go to a so the merge is stable
+            zp_size_t splitMergePath( const T* a, zp_size_t aLength, const T* b, zp_size_t bLength, zp_size_t k ) const
+            {
+                zp_size_t lo = k > bLength ? k - bLength : 0;
+                zp_size_t hi = zp_min( k, aLength );
+
+                while( lo < hi )
+                {
+                    const zp_size_t i = lo + ( ( hi - lo ) / 2 );
+                    const zp_size_t j = k - i;
+
+                    if( j > 0 && cmp( a[ i ], b[ j - 1 ] ) <= 0 )
+                    {
+                        lo = i + 1;
+                    }
+                    else
+                    {
+                        hi = i;
+                    }
+                }
+
+                return lo;
+            }
+
+            void execute( const JobWorkArgs& args )
+            {
+                const zp_size_t pair = args.index / piecesPerPair;
+                const zp_size_t piece = args.index % piecesPerPair;
+
+                const zp_size_t aRun = pair * 2;
+                const zp_size_t bRun = zp_min( aRun + 1, runCount );
+                const zp_size_t endRun = zp_min( aRun + 2, runCount );
+
+                const zp_size_t start = runStarts[ aRun ];
+                const T* a = src + start;
+                const T* b = src + runStarts[ bRun ];
+                const zp_size_t aLength = runStarts[ bRun ] - start;
+                const zp_size_t bLength = runStarts[ endRun ] - runStarts[ bRun ];
+
+                const zp_size_t length = aLength + bLength;
+                const zp_size_t k0 = GetBlockStart( length, piecesPerPair, piece );
+                const zp_size_t k1 = GetBlockStart( length, piecesPerPair, piece + 1 );
+
+                zp_size_t i = splitMergePath( a, aLength, b, bLength, k0 );
+                zp_size_t j = k0 - i;
+                const zp_size_t iEnd = splitMergePath( a, aLength, b, bLength, k1 );
+                const zp_size_t jEnd = k1 - iEnd;
+
+                T* out = dst + start + k0;
+                while( i < iEnd && j < jEnd )
+                {
+                    if( cmp( b[ j ], a[ i ] ) < 0 )
+                    {
+                        *out++ = b[ j++ ];
+                    }
+                    else
+                    {
+                        *out++ = a[ i++ ];
+                    }
+                }
+
+                while( i < iEnd )
+                {
+                    *out++ = a[ i++ ];
+                }
+
+                while( j < jEnd )
+                {
+                    *out++ = b[ j++ ];
+                }
+            }
+        };
+
+        template<typename T, typename Op>
+        struct ReduceBlocksJob
+        {
+            const T* values;
+            zp_size_t length;
+            zp_size_t blockCount;
+            T identity;
+            Op op;
+            T* blockResults;
+
+            void execute( const JobWorkArgs& args )
+            {
+                const zp_size_t start = GetBlockStart( length, blockCount, args.index );
+                const zp_size_t end = GetBlockStart( length, blockCount, args.index + 1 );
+
+                T result = identity;
+                for( zp_size_t i = start; i < end; ++i )
+                {
+                    result = op( result, values[ i ] );
+                }
+
+                blockResults[ args.index ] = result;
+            }
+        };
+
+        template<typename T, typename Op, zp_bool_t Inclusive>
+        struct ScanBlocksJob
+        {
+            const T* input;
+            T* output;
+            zp_size_t length;
+            zp_size_t blockCount;
+            Op op;
+            const T* blockOffsets;
+
+            void execute( const JobWorkArgs& args )
+            {
+                const zp_size_t start = GetBlockStart( length, blockCount, args.index );
+                const zp_size_t end = GetBlockStart( length, blockCount, args.index + 1 );
+
+                T running = blockOffsets[ args.index ];
+                for( zp_size_t i = start; i < end; ++i )
+                {
+                    // read before writing so output can alias input
+                    const T value = input[ i ];
+                    if constexpr( Inclusive )
+                    {
+                        running = op( running, value );
+                        output[ i ] = running;
+                    }
+                    else
+                    {
+                        output[ i ] = running;
+                        running = op( running, value );
+                    }
+                }
+            }
+        };
+
+        template<typename T, typename Pred>
+        struct CountBlocksJob
+        {
+            const T* input;
+            zp_size_t length;
+            zp_size_t blockCount;
+            Pred pred;
+            zp_size_t* blockCounts;
+
+            void execute( const JobWorkArgs& args )
+            {
+                const zp_size_t start = GetBlockStart( length, blockCount, args.index );
+                const zp_size_t end = GetBlockStart( length, blockCount, args.index + 1 );
+
+                zp_size_t count = 0;
+                for( zp_size_t i = start; i < end; ++i )
+                {
+                    count += pred( input[ i ] ) ? 1 : 0;
+                }
+
+                blockCounts[ args.index ] = count;
+            }
+        };
+
+        template<typename T, typename Pred>
+        struct CompactBlocksJob
+        {
+            const T* input;
+            T* output;
+            zp_size_t length;
+            zp_size_t blockCount;
+            Pred pred;
+            const zp_size_t* blockOffsets;
+
+            void execute( const JobWorkArgs& args )
+            {
+                const zp_size_t start = GetBlockStart( length, blockCount, args.index );
+                const zp_size_t end = GetBlockStart( length, blockCount, args.index + 1 );
+
+                T* out = output + blockOffsets[ args.index ];
+                for( zp_size_t i = start; i < end; ++i )
+                {
+                    if( pred( input[ i ] ) )
+                    {
+                        *out++ = input[ i ];
+                    }
+                }
+            }
+        };
+
+        template<typename TJob>
+        void DispatchAndComplete( zp_size_t jobCount, TJob* job )
+        {
+            const JobHandle handle = JobSystem::Dispatch( jobCount, 1, JobWorkFunc::from_method<TJob, &TJob::execute>( job ) );
+            JobSystem::Complete( handle );
+        }
+
+        //
+        //
+        //
+
+        template<typename T, typename Cmp>
+        void Sort( MemoryArray<T> values, Cmp cmp, MemoryLabel memoryLabel )
+        {
+            const zp_size_t length = values.length();
+            const zp_size_t blockCount = GetBlockCount( length );
+
+            if( blockCount == 1 )
+            {
+                zp_sort( values.begin(), values.end(), cmp );
+                return;
+            }
+
+            SortBlocksJob<T, Cmp> sortJob {
+                .values = values.data(),
+                .length = length,
+                .blockCount = blockCount,
+                .cmp = cmp,
+            };
+            DispatchAndComplete( blockCount, &sortJob );
+
+            zp_size_t runStarts[ kMaxBlockCount + 1 ];
+            for( zp_size_t i = 0; i <= blockCount; ++i )
+            {
+                runStarts[ i ] = GetBlockStart( length, blockCount, i );
+            }
+
+            T* scratch = ZP_MALLOC_T_ARRAY( memoryLabel, T, length );
+
+            T* src = values.data();
+            T* dst = scratch;
+
+            // log2(blockCount) merge rounds, the job count stays at blockCount so later rounds with few long runs still use every worker
+            for( zp_size_t runCount = blockCount; runCount > 1; runCount = ( runCount + 1 ) / 2 )
+            {
+                const zp_size_t pairCount = ( runCount + 1 ) / 2;
+                const zp_size_t piecesPerPair = zp_max( blockCount / pairCount, static_cast<zp_size_t>( 1 ) );
+
+                MergeRunsJob<T, Cmp> mergeJob {
+                    .src = src,
+                    .dst = dst,
+                    .runStarts = runStarts,
+                    .runCount = runCount,
+                    .piecesPerPair = piecesPerPair,
+                    .cmp = cmp,
+                };
+                DispatchAndComplete( pairCount * piecesPerPair, &mergeJob );
+
+                for( zp_size_t i = 0; i < pairCount; ++i )
+                {
+                    runStarts[ i ] = runStarts[ i * 2 ];
+                }
+                runStarts[ pairCount ] = length;
+
+                zp_move_swap( src, dst );
+            }
+
+            if( src != values.data() )
+            {
+                for( zp_size_t i = 0; i < length; ++i )
+                {
+                    values[ i ] = zp_move( src[ i ] );
+                }
+            }
+
+            ZP_FREE( memoryLabel, scratch );
+        }
+
+        template<typename T, typename Op>
+        T Reduce( ReadonlyMemoryArray<T> values, T identity, Op op )
+        {
+            const zp_size_t length = values.length();
+            const zp_size_t blockCount = GetBlockCount( length );
+
+            T blockResults[ kMaxBlockCount ];
+
+            ReduceBlocksJob<T, Op> reduceJob {
+                .values = values.begin(),
+                .length = length,
+                .blockCount = blockCount,
+                .identity = identity,
+                .op = op,
+                .blockResults = blockResults,
+            };
+
+            if( blockCount == 1 )
+            {
+                reduceJob.execute( JobWorkArgs { .index = 0 } );
+            }
+            else
+            {
+                DispatchAndComplete( blockCount, &reduceJob );
+            }
+
+            T result = identity;
+            for( zp_size_t i = 0; i < blockCount; ++i )
+            {
+                result = op( result, blockResults[ i ] );
+            }
+
+            return result;
+        }
+
+        template<typename T, typename Op, zp_bool_t Inclusive>
+        void Scan( ReadonlyMemoryArray<T> input, MemoryArray<T> output, T identity, Op op )
+        {
+            ZP_ASSERT( output.length() >= input.length() );
+
+            const zp_size_t length = input.length();
+            const zp_size_t blockCount = GetBlockCount( length );
+
+            T blockOffsets[ kMaxBlockCount ];
+
+            ScanBlocksJob<T, Op, Inclusive> scanJob {
+                .input = input.begin(),
+                .output = output.data(),
+                .length = length,
+                .blockCount = blockCount,
+                .op = op,
+                .blockOffsets = blockOffsets,
+            };
+
+            if( blockCount == 1 )
+            {
+                blockOffsets[ 0 ] = identity;
+                scanJob.execute( JobWorkArgs { .index = 0 } );
+                return;
+            }
+
+            // block totals, then an exclusive scan of them gives each block its starting value
+            ReduceBlocksJob<T, Op> reduceJob {
+                .values = input.begin(),
+                .length = length,
+                .blockCount = blockCount,
+                .identity = identity,
+                .op = op,
+                .blockResults = blockOffsets,
+            };
+            DispatchAndComplete( blockCount, &reduceJob );
+
+            T running = identity;
+            for( zp_size_t i = 0; i < blockCount; ++i )
+            {
+                const T blockTotal = blockOffsets[ i ];
+                blockOffsets[ i ] = running;
+                running = op( running, blockTotal );
+            }
+
+            DispatchAndComplete( blockCount, &scanJob );
+        }
+
+        template<typename T, typename Op>
+        void InclusiveScan( ReadonlyMemoryArray<T> input, MemoryArray<T> output, T identity, Op op )
+        {
+            Scan<T, Op, true>( input, output, identity, op );
+        }
+
+        template<typename T, typename Op>
+        void ExclusiveScan( ReadonlyMemoryArray<T> input, MemoryArray<T> output, T identity, Op op )
+        {
+            Scan<T, Op, false>( input, output, identity, op );
+        }
+
+        template<typename T, typename Pred>
+        zp_size_t Compact( ReadonlyMemoryArray<T> input, MemoryArray<T> output, Pred pred )
+        {
+            const zp_size_t length = input.length();
+            const zp_size_t blockCount = GetBlockCount( length );
+
+            if( blockCount == 1 )
+            {
+                zp_size_t count = 0;
+                for( const T& value : input )
+                {
+                    if( pred( value ) )
+                    {
+                        output[ count++ ] = value;
+                    }
+                }
+                return count;
+            }
+
+            zp_size_t blockOffsets[ kMaxBlockCount ];
+
+            CountBlocksJob<T, Pred> countJob {
+                .input = input.begin(),
+                .length = length,
+                .blockCount = blockCount,
+                .pred = pred,
+                .blockCounts = blockOffsets,
+            };
+            DispatchAndComplete( blockCount, &countJob );
+
+            zp_size_t count = 0;
+            for( zp_size_t i = 0; i < blockCount; ++i )
+            {
+                const zp_size_t blockKept = blockOffsets[ i ];
+                blockOffsets[ i ] = count;
+                count += blockKept;
+            }
+
+            ZP_ASSERT( output.length() >= count );
+
+            CompactBlocksJob<T, Pred> compactJob {
+                .input = input.begin(),
+                .output = output.data(),
+                .length = length,
+                .blockCount = blockCount,
+                .pred = pred,
+                .blockOffsets = blockOffsets,
+            };
+            DispatchAndComplete( blockCount, &compactJob );
+
+            return count;
+        }
+    }
+}
+
+#endif //ZP_PARALLEL_H
@@ -88,6 +88,13 @@
 #define ZP_PROFILE_GPU_STATS_DRAW( v, i ) (void)0
 #define ZP_PROFILE_GPU_STATS_DRAW_INDEXED( v, i ) (void)0
 
+#define ZP_PROFILE_COUNTER( n, v, t ) \
+    zp::Profiler::MarkCounter( {      \
+        .counterName = ( n ),         \
+        .value = ( v ),               \
+        .track = ( t ),               \
+    } )
+
 #define ZP_PROFILE_ADVANCE_FRAME( f ) zp::Profiler::AdvanceFrame( ( f ) )
 
 #else // !ZP_USE_PROFILER
@@ -109,6 +116,8 @@
 
 #define ZP_PROFILE_GPU_MARK( ... ) (void)0
 
+#define ZP_PROFILE_COUNTER( ... ) (void)0
+
 #define ZP_PROFILE_ADVANCE_FRAME( ... ) (void)0
 
 #endif // ZP_USE_PROFILER
@@ -228,6 +237,7 @@ namespace zp
         zp_size_t maxCPUEventsPerThread;
         zp_size_t maxMemoryEventsPerThread;
         zp_size_t maxGPUEventsPerThread;
+        zp_size_t maxCounterEventsPerFrame;
         zp_size_t maxFramesToCapture;
         zp_uint32_t maxThreadCount;
     };
@@ -252,6 +262,16 @@ namespace zp
             MemoryLabel memoryLabel;
         };
 
+        // one sample of a named per frame counter, track separates instances of the same counter (e.g. per worker)
+        struct CounterDesc
+        {
+            const char* counterName;
+            zp_int64_t value;
+            zp_uint32_t track;
+        };
+
+        using AdvanceFrameCallback = void ( * )( zp_uint64_t frameIndex, void* userData );
+
         struct GPUDesc
         {
             zp_uint32_t numDrawCalls;
@@ -281,6 +301,13 @@ namespace zp
 
         void MarkGPU( const GPUDesc& gpuDesc );
 
+        void MarkCounter( const CounterDesc& counterDesc );
+
+        // called at the start of AdvanceFrame, before the frame index changes, so systems can record their per frame counters
+        void RegisterAdvanceFrameCallback( AdvanceFrameCallback callback, void* userData );
+
+        void UnregisterAdvanceFrameCallback( AdvanceFrameCallback callback, void* userData );
+
         void AdvanceFrame( zp_uint64_t frameIndex );
     }; // namespace Profiler
 
@@ -11,6 +11,8 @@
 #include "Core/Allocator.h"
 #include "Core/Atomic.h"
 
+#include <new>
+
 namespace zp
 {
     template<typename T, typename Allocator = MemoryLabelAllocator>
@@ -354,4 +356,256 @@ namespace zp
     using FixedQueue = Queue<T, FixedMemoryVectorAllocator<Size, T> >;
 }
 
+//
+//
+//
+
+namespace zp
+{
+    //
+    // Bounded multi producer, multi consumer ring. Every cell carries a sequence number that says which lap of the ring it
+    // is ready for, producers and consumers claim positions with a single CAS and then hand the cell over by bumping its
+    // sequence, so they never wait on each other unless the ring is full or empty.
+    //
+
+    template<typename T, zp_size_t Capacity>
+    class MPMCQueue
+    {
+        static_assert( Capacity >= 2 && ( Capacity & ( Capacity - 1 ) ) == 0, "MPMCQueue Capacity has to be a power of two" );
+
+        ZP_NONCOPYABLE( MPMCQueue );
+
+    public:
+        typedef T value_type;
+        typedef T& reference;
+        typedef const T& const_reference;
+        typedef T&& move_reference;
+        typedef T* pointer;
+        typedef const T* const_pointer;
+
+        MPMCQueue();
+
+        ~MPMCQueue();
+
+        // only a snapshot while other threads are using the queue
+        [[nodiscard]] zp_size_t size() const;
+
+        [[nodiscard]] zp_bool_t isEmpty() const;
+
+        [[nodiscard]] static constexpr zp_size_t capacity()
+        {
+            return Capacity;
+        }
+
+        // false when the queue is full
+        zp_bool_t tryEnqueue( const_reference val );
+
+        zp_bool_t tryEnqueue( move_reference val );
+
+        // false when the queue is empty
+        zp_bool_t tryDequeue( reference val );
+
+        // enqueues as many of vals as fit in one claim, returns how many were enqueued
+        zp_size_t tryEnqueueBatch( const_pointer vals, zp_size_t count );
+
+        // dequeues up to count into vals in one claim, returns how many were dequeued
+        zp_size_t tryDequeueBatch( pointer vals, zp_size_t count );
+
+    private:
+        enum : zp_size_t
+        {
+            kMask = Capacity - 1,
+            kCacheLineSize = 64,
+        };
+
+        struct MPMCQueueCell
+        {
+            zp_size_t sequence;
+            alignas( T ) zp_uint8_t storage[ sizeof( T ) ];
+        };
+
+        template<typename V>
+        zp_bool_t enqueue( V&& val );
+
+        // claims up to count positions starting at pos whose cells have reached their lap plus lapOffset
+        zp_size_t claim( zp_size_t* position, zp_size_t count, zp_size_t lapOffset, zp_size_t& outPosition );
+
+        FixedArray<zp_uint8_t, kCacheLineSize> m_frontPadding;
+
+        zp_size_t m_enqueuePosition;
+        FixedArray<zp_uint8_t, kCacheLineSize - sizeof( zp_size_t )> m_enqueuePadding;
+
+        zp_size_t m_dequeuePosition;
+        FixedArray<zp_uint8_t, kCacheLineSize - sizeof( zp_size_t )> m_dequeuePadding;
+
+        MPMCQueueCell m_cells[ Capacity ];
+    };
+}
+
+//
+//
+//
+
+namespace zp
+{
+    template<typename T, zp_size_t Capacity>
+    MPMCQueue<T, Capacity>::MPMCQueue()
+        : m_frontPadding {}
+        , m_enqueuePosition( 0 )
+        , m_enqueuePadding {}
+        , m_dequeuePosition( 0 )
+        , m_dequeuePadding {}
+    {
+        for( zp_size_t i = 0; i < Capacity; ++i )
+        {
+            m_cells[ i ].sequence = i;
+        }
+    }
+
+    template<typename T, zp_size_t Capacity>
+    MPMCQueue<T, Capacity>::~MPMCQueue()
+    {
+        for( zp_size_t i = m_dequeuePosition; i != m_enqueuePosition; ++i )
+        {
+            reinterpret_cast<T*>( m_cells[ i & kMask ].storage )->~T();
+        }
+    }
+
+    template<typename T, zp_size_t Capacity>
+    zp_size_t MPMCQueue<T, Capacity>::size() const
+    {
+        const zp_size_t dequeuePosition = Atomic::LoadRelaxedSizeT( &m_dequeuePosition );
+        const zp_size_t enqueuePosition = Atomic::LoadRelaxedSizeT( &m_enqueuePosition );
+
+        return enqueuePosition > dequeuePosition ? enqueuePosition - dequeuePosition : 0;
+    }
+
+    template<typename T, zp_size_t Capacity>
+    zp_bool_t MPMCQueue<T, Capacity>::isEmpty() const
+    {
+        return size() == 0;
+    }
+
+    template<typename T, zp_size_t Capacity>
+    zp_bool_t MPMCQueue<T, Capacity>::tryEnqueue( const_reference val )
+    {
+        return enqueue( val );
+    }
+
+    template<typename T, zp_size_t Capacity>
+    zp_bool_t MPMCQueue<T, Capacity>::tryEnqueue( move_reference val )
+    {
+        return enqueue( zp_move( val ) );
+    }
+
+    template<typename T, zp_size_t Capacity>
+    zp_bool_t MPMCQueue<T, Capacity>::tryDequeue( reference val )
+    {
+        return tryDequeueBatch( &val, 1 ) == 1;
+    }
+
+    template<typename T, zp_size_t Capacity>
+    zp_size_t MPMCQueue<T, Capacity>::tryEnqueueBatch( const_pointer vals, zp_size_t count )
+    {
+        zp_size_t position;
+        const zp_size_t claimed = claim( &m_enqueuePosition, count, 0, position );
+
+        for( zp_size_t i = 0; i < claimed; ++i )
+        {
+            MPMCQueueCell& cell = m_cells[ ( position + i ) & kMask ];
+
+            new( cell.storage ) T( vals[ i ] );
+            Atomic::StoreReleaseSizeT( &cell.sequence, position + i + 1 );
+        }
+
+        return claimed;
+    }
+
+    template<typename T, zp_size_t Capacity>
+    zp_size_t MPMCQueue<T, Capacity>::tryDequeueBatch( pointer vals, zp_size_t count )
+    {
+        zp_size_t position;
+        const zp_size_t claimed = claim( &m_dequeuePosition, count, 1, position );
+
+        for( zp_size_t i = 0; i < claimed; ++i )
+        {
+            MPMCQueueCell& cell = m_cells[ ( position + i ) & kMask ];
+
+            T* p = reinterpret_cast<T*>( cell.storage );
+            vals[ i ] = zp_move( *p );
+            p->~T();
+
+            // free for the producer one lap ahead
+            Atomic::StoreReleaseSizeT( &cell.sequence, position + i + Capacity );
+        }
+
+        return claimed;
+    }
+
+    template<typename T, zp_size_t Capacity>
+    template<typename V>
+    zp_bool_t MPMCQueue<T, Capacity>::enqueue( V&& val )
+    {
+        zp_size_t position;
+        const zp_bool_t claimed = claim( &m_enqueuePosition, 1, 0, position ) == 1;
+
+        if( claimed )
+        {
+            MPMCQueueCell& cell = m_cells[ position & kMask ];
+
+            new( cell.storage ) T( zp_forward<V>( val ) );
+            Atomic::StoreReleaseSizeT( &cell.sequence, position + 1 );
+        }
+
+        return claimed;
+    }
+
+    template<typename T, zp_size_t Capacity>
+    zp_size_t MPMCQueue<T, Capacity>::claim( zp_size_t* position, zp_size_t count, zp_size_t lapOffset, zp_size_t& outPosition )
+    {
+        zp_size_t claimed = 0;
+        zp_size_t pos = Atomic::LoadRelaxedSizeT( position );
+
+        while( count > 0 )
+        {
+            // count the run of cells that are ready, a cell behind its lap means full (or empty), ahead means pos is stale
+            zp_size_t ready = 0;
+            zp_ptrdiff_t diff = 0;
+            for( ; ready < count; ++ready )
+            {
+                const zp_size_t sequence = Atomic::LoadAcquireSizeT( &m_cells[ ( pos + ready ) & kMask ].sequence );
+
+                diff = static_cast<zp_ptrdiff_t>( sequence ) - static_cast<zp_ptrdiff_t>( pos + ready + lapOffset );
+                if( diff != 0 )
+                {
+                    break;
+                }
+            }
+
+            if( ready > 0 )
+            {
+                const zp_size_t prev = Atomic::CompareExchangeSizeT( position, pos + ready, pos );
+                if( prev == pos )
+                {
+                    claimed = ready;
+                    break;
+                }
+
+                pos = prev;
+            }
+            else if( diff < 0 )
+            {
+                break;
+            }
+            else
+            {
+                pos = Atomic::LoadRelaxedSizeT( position );
+            }
+        }
+
+        outPosition = pos;
+        return claimed;
+    }
+}
+
 #endif //ZP_QUEUE_H
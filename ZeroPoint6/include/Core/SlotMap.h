@@ -0,0 +1,621 @@
+//
+// Created by phosg on 10/16/2026.
+//
+
+#ifndef ZP_SLOT_MAP_H
+#define ZP_SLOT_MAP_H
+
+#include "Core/Defines.h"
+#include "Core/Types.h"
+#include "Core/Common.h"
+#include "Core/Macros.h"
+#include "Core/Allocator.h"
+
+#include <new>
+
+namespace zp
+{
+    //
+    // Handle packed as [ generation | index ]. Generation 0 is never handed out so a zeroed handle is always invalid.
+    //
+
+    template<typename Bits, zp_size_t IndexBitCount>
+    struct SlotMapHandle
+    {
+        typedef Bits bits_value;
+
+        static constexpr zp_size_t kIndexBits = IndexBitCount;
+        static constexpr zp_size_t kGenerationBits = ( sizeof( Bits ) * 8 ) - IndexBitCount;
+        static constexpr Bits kIndexMask = static_cast<Bits>( ~Bits( 0 ) ) >> kGenerationBits;
+        static constexpr Bits kMaxGeneration = static_cast<Bits>( ~Bits( 0 ) ) >> IndexBitCount;
+
+        static_assert( IndexBitCount > 0 && IndexBitCount <= 32 && IndexBitCount < sizeof( Bits ) * 8, "Index has to fit a zp_uint32_t and leave room for a generation" );
+
+        Bits bits;
+
+        [[nodiscard]] ZP_FORCEINLINE zp_uint32_t index() const
+        {
+            return static_cast<zp_uint32_t>( bits & kIndexMask );
+        }
+
+        [[nodiscard]] ZP_FORCEINLINE Bits generation() const
+        {
+            return bits >> IndexBitCount;
+        }
+
+        [[nodiscard]] ZP_FORCEINLINE zp_bool_t isValid() const
+        {
+            return generation() != 0;
+        }
+
+        ZP_FORCEINLINE zp_bool_t operator==( const SlotMapHandle& other ) const
+        {
+            return bits == other.bits;
+        }
+
+        ZP_FORCEINLINE zp_bool_t operator!=( const SlotMapHandle& other ) const
+        {
+            return bits != other.bits;
+        }
+
+        static ZP_FORCEINLINE SlotMapHandle Make( zp_uint32_t index, Bits generation )
+        {
+            return { .bits = static_cast<Bits>( ( generation << IndexBitCount ) | ( static_cast<Bits>( index ) & kIndexMask ) ) };
+        }
+    };
+
+    // 1M live slots, a slot is retired after 4095 reuses
+    typedef SlotMapHandle<zp_uint32_t, 20> SlotMapHandle32;
+
+    // 4G live slots, generations never run out in practice
+    typedef SlotMapHandle<zp_uint64_t, 32> SlotMapHandle64;
+
+    //
+    // Values are kept densely packed in insertion order, erasing moves the last value into the hole. Handles go through
+    // a sparse slot array that holds the value's dense index and the slot's current generation, erasing bumps the
+    // generation so stale handles fail the lookup instead of reading whatever reused the slot.
+    //
+
+    template<typename T, typename Handle = SlotMapHandle32, typename Allocator = MemoryLabelAllocator>
+    class SlotMap
+    {
+    public:
+        typedef T value_type;
+        typedef T& reference;
+        typedef const T& const_reference;
+        typedef T* pointer;
+        typedef const T* const_pointer;
+        typedef T* iterator;
+        typedef const T* const_iterator;
+
+        typedef Handle handle_value;
+        typedef typename Handle::bits_value generation_value;
+
+        typedef Allocator allocator_value;
+        typedef const Allocator& allocator_const_reference;
+
+        explicit SlotMap( MemoryLabel memoryLabel );
+
+        SlotMap( MemoryLabel memoryLabel, zp_size_t capacity );
+
+        SlotMap( MemoryLabel memoryLabel, zp_size_t capacity, allocator_const_reference allocator );
+
+        SlotMap( const SlotMap& ) = delete;
+
+        ~SlotMap();
+
+        [[nodiscard]] zp_size_t size() const;
+
+        [[nodiscard]] zp_bool_t empty() const;
+
+        [[nodiscard]] zp_size_t capacity() const;
+
+        // an invalid handle, and nothing inserted, once every handle index has been used
+        handle_value insert( const_reference value );
+
+        handle_value insert( T&& value );
+
+        template<typename ... Args>
+        handle_value emplace( Args&& ... args );
+
+        zp_bool_t erase( handle_value handle );
+
+        [[nodiscard]] zp_bool_t contains( handle_value handle ) const;
+
+        pointer find( handle_value handle );
+
+        const_pointer find( handle_value handle ) const;
+
+        zp_bool_t tryGet( handle_value handle, pointer& value );
+
+        zp_bool_t tryGet( handle_value handle, const_pointer& value ) const;
+
+        reference get( handle_value handle );
+
+        const_reference get( handle_value handle ) const;
+
+        reference operator[]( handle_value handle );
+
+        const_reference operator[]( handle_value handle ) const;
+
+        // handle of the value at index in data(), valid until the next erase
+        [[nodiscard]] handle_value handleAt( zp_size_t index ) const;
+
+        pointer data();
+
+        const_pointer data() const;
+
+        void reserve( zp_size_t capacity );
+
+        void clear();
+
+        void destroy();
+
+        iterator begin();
+
+        iterator end();
+
+        const_iterator begin() const;
+
+        const_iterator end() const;
+
+    private:
+        enum : zp_uint32_t
+        {
+            kInvalidIndex = ~0u,
+        };
+
+        struct Slot
+        {
+            // dense index while live, next free slot while free
+            zp_uint32_t index;
+            generation_value generation;
+        };
+
+        static allocator_value CreateAllocator( MemoryLabel memoryLabel );
+
+        static zp_size_t SlotsOffset( zp_size_t capacity );
+
+        static zp_size_t ValueSlotsOffset( zp_size_t capacity );
+
+        const Slot* findSlot( handle_value handle ) const;
+
+        zp_uint32_t acquireSlot();
+
+        void releaseSlot( zp_uint32_t slotIndex );
+
+        void resize( zp_size_t capacity );
+
+        T* m_values;
+        zp_uint32_t* m_valueSlots;
+        Slot* m_slots;
+
+        zp_size_t m_count;
+        zp_size_t m_slotCount;
+        zp_size_t m_capacity;
+        zp_uint32_t m_freeHead;
+
+        allocator_value m_allocator;
+
+    public:
+        const MemoryLabel memoryLabel;
+    };
+}
+
+//
+//
+//
+
+namespace zp
+{
+    template<typename T, typename Handle, typename Allocator>
+    SlotMap<T, Handle, Allocator>::SlotMap( MemoryLabel memoryLabel )
+        : m_values( nullptr )
+        , m_valueSlots( nullptr )
+        , m_slots( nullptr )
+        , m_count( 0 )
+        , m_slotCount( 0 )
+        , m_capacity( 0 )
+        , m_freeHead( kInvalidIndex )
+        , m_allocator( CreateAllocator( memoryLabel ) )
+        , memoryLabel( memoryLabel )
+    {
+    }
+
+    template<typename T, typename Handle, typename Allocator>
+    SlotMap<T, Handle, Allocator>::SlotMap( MemoryLabel memoryLabel, zp_size_t capacity )
+        : m_values( nullptr )
+        , m_valueSlots( nullptr )
+        , m_slots( nullptr )
+        , m_count( 0 )
+        , m_slotCount( 0 )
+        , m_capacity( 0 )
+        , m_freeHead( kInvalidIndex )
+        , m_allocator( CreateAllocator( memoryLabel ) )
+        , memoryLabel( memoryLabel )
+    {
+        reserve( capacity );
+    }
+
+    template<typename T, typename Handle, typename Allocator>
+    SlotMap<T, Handle, Allocator>::SlotMap( MemoryLabel memoryLabel, zp_size_t capacity, allocator_const_reference allocator )
+        : m_values( nullptr )
+        , m_valueSlots( nullptr )
+        , m_slots( nullptr )
+        , m_count( 0 )
+        , m_slotCount( 0 )
+        , m_capacity( 0 )
+        , m_freeHead( kInvalidIndex )
+        , m_allocator( allocator )
+        , memoryLabel( memoryLabel )
+    {
+        reserve( capacity );
+    }
+
+    template<typename T, typename Handle, typename Allocator>
+    SlotMap<T, Handle, Allocator>::~SlotMap()
+    {
+        destroy();
+    }
+
+    template<typename T, typename Handle, typename Allocator>
+    zp_size_t SlotMap<T, Handle, Allocator>::size() const
+    {
+        return m_count;
+    }
+
+    template<typename T, typename Handle, typename Allocator>
+    zp_bool_t SlotMap<T, Handle, Allocator>::empty() const
+    {
+        return m_count == 0;
+    }
+
+    template<typename T, typename Handle, typename Allocator>
+    zp_size_t SlotMap<T, Handle, Allocator>::capacity() const
+    {
+        return m_capacity;
+    }
+
+    template<typename T, typename Handle, typename Allocator>
+    typename SlotMap<T, Handle, Allocator>::handle_value SlotMap<T, Handle, Allocator>::insert( const_reference value )
+    {
+        return emplace( value );
+    }
+
+    template<typename T, typename Handle, typename Allocator>
+    typename SlotMap<T, Handle, Allocator>::handle_value SlotMap<T, Handle, Allocator>::insert( T&& value )
+    {
+        return emplace( zp_move( value ) );
+    }
+
+    template<typename T, typename Handle, typename Allocator>
+    template<typename ... Args>
+    typename SlotMap<T, Handle, Allocator>::handle_value SlotMap<T, Handle, Allocator>::emplace( Args&& ... args )
+    {
+        const zp_uint32_t slotIndex = acquireSlot();
+        if( slotIndex == kInvalidIndex )
+        {
+            return {};
+        }
+
+        Slot& slot = m_slots[ slotIndex ];
+
+        const zp_size_t denseIndex = m_count;
+        new( m_values + denseIndex ) T( zp_forward<Args>( args )... );
+        m_valueSlots[ denseIndex ] = slotIndex;
+        ++m_count;
+
+        slot.index = static_cast<zp_uint32_t>( denseIndex );
+
+        return handle_value::Make( slotIndex, slot.generation );
+    }
+
+    template<typename T, typename Handle, typename Allocator>
+    zp_bool_t SlotMap<T, Handle, Allocator>::erase( handle_value handle )
+    {
+        const Slot* slot = findSlot( handle );
+        if( slot == nullptr )
+        {
+            return false;
+        }
+
+        const zp_uint32_t denseIndex = slot->index;
+        const zp_size_t lastIndex = m_count - 1;
+
+        // keep the values packed, the last value fills the hole and its slot follows it
+        if( denseIndex != lastIndex )
+        {
+            m_values[ denseIndex ] = zp_move( m_values[ lastIndex ] );
+
+            const zp_uint32_t movedSlotIndex = m_valueSlots[ lastIndex ];
+            m_valueSlots[ denseIndex ] = movedSlotIndex;
+            m_slots[ movedSlotIndex ].index = denseIndex;
+        }
+
+        ( m_values + lastIndex )->~T();
+        --m_count;
+
+        releaseSlot( handle.index() );
+
+        return true;
+    }
+
+    template<typename T, typename Handle, typename Allocator>
+    zp_bool_t SlotMap<T, Handle, Allocator>::contains( handle_value handle ) const
+    {
+        return findSlot( handle ) != nullptr;
+    }
+
+    template<typename T, typename Handle, typename Allocator>
+    typename SlotMap<T, Handle, Allocator>::pointer SlotMap<T, Handle, Allocator>::find( handle_value handle )
+    {
+        const Slot* slot = findSlot( handle );
+        return slot != nullptr ? m_values + slot->index : nullptr;
+    }
+
+    template<typename T, typename Handle, typename Allocator>
+    typename SlotMap<T, Handle, Allocator>::const_pointer SlotMap<T, Handle, Allocator>::find( handle_value handle ) const
+    {
+        const Slot* slot = findSlot( handle );
+        return slot != nullptr ? m_values + slot->index : nullptr;
+    }
+
+    template<typename T, typename Handle, typename Allocator>
+    zp_bool_t SlotMap<T, Handle, Allocator>::tryGet( handle_value handle, pointer& value )
+    {
+        value = find( handle );
+        return value != nullptr;
+    }
+
+    template<typename T, typename Handle, typename Allocator>
+    zp_bool_t SlotMap<T, Handle, Allocator>::tryGet( handle_value handle, const_pointer& value ) const
+    {
+        value = find( handle );
+        return value != nullptr;
+    }
+
+    template<typename T, typename Handle, typename Allocator>
+    typename SlotMap<T, Handle, Allocator>::reference SlotMap<T, Handle, Allocator>::get( handle_value handle )
+    {
+        pointer value = find( handle );
+        ZP_ASSERT_MSG( value != nullptr, "Stale or invalid SlotMap handle" );
+        return *value;
+    }
+
+    template<typename T, typename Handle, typename Allocator>
+    typename SlotMap<T, Handle, Allocator>::const_reference SlotMap<T, Handle, Allocator>::get( handle_value handle ) const
+    {
+        const_pointer value = find( handle );
+        ZP_ASSERT_MSG( value != nullptr, "Stale or invalid SlotMap handle" );
+        return *value;
+    }
+
+    template<typename T, typename Handle, typename Allocator>
+    typename SlotMap<T, Handle, Allocator>::reference SlotMap<T, Handle, Allocator>::operator[]( handle_value handle )
+    {
+        return get( handle );
+    }
+
+    template<typename T, typename Handle, typename Allocator>
+    typename SlotMap<T, Handle, Allocator>::const_reference SlotMap<T, Handle, Allocator>::operator[]( handle_value handle ) const
+    {
+        return get( handle );
+    }
+
+    template<typename T, typename Handle, typename Allocator>
+    typename SlotMap<T, Handle, Allocator>::handle_value SlotMap<T, Handle, Allocator>::handleAt( zp_size_t index ) const
+    {
+        ZP_ASSERT( index < m_count );
+
+        const zp_uint32_t slotIndex = m_valueSlots[ index ];
+        return handle_value::Make( slotIndex, m_slots[ slotIndex ].generation );
+    }
+
+    template<typename T, typename Handle, typename Allocator>
+    typename SlotMap<T, Handle, Allocator>::pointer SlotMap<T, Handle, Allocator>::data()
+    {
+        return m_values;
+    }
+
+    template<typename T, typename Handle, typename Allocator>
+    typename SlotMap<T, Handle, Allocator>::const_pointer SlotMap<T, Handle, Allocator>::data() const
+    {
+        return m_values;
+    }
+
+    template<typename T, typename Handle, typename Allocator>
+    void SlotMap<T, Handle, Allocator>::reserve( zp_size_t capacity )
+    {
+        if( capacity > m_capacity )
+        {
+            resize( capacity );
+        }
+    }
+
+    template<typename T, typename Handle, typename Allocator>
+    void SlotMap<T, Handle, Allocator>::clear()
+    {
+        // release every live slot so handles from before the clear go stale
+        for( zp_size_t i = m_count; i > 0; --i )
+        {
+            ( m_values + i - 1 )->~T();
+            releaseSlot( m_valueSlots[ i - 1 ] );
+        }
+
+        m_count = 0;
+    }
+
+    template<typename T, typename Handle, typename Allocator>
+    void SlotMap<T, Handle, Allocator>::destroy()
+    {
+        clear();
+
+        if( m_capacity > 0 )
+        {
+            // values, slots and value slots share one allocation
+            m_allocator.free( m_values );
+        }
+
+        m_values = nullptr;
+        m_valueSlots = nullptr;
+        m_slots = nullptr;
+        m_slotCount = 0;
+        m_capacity = 0;
+        m_freeHead = kInvalidIndex;
+    }
+
+    template<typename T, typename Handle, typename Allocator>
+    typename SlotMap<T, Handle, Allocator>::iterator SlotMap<T, Handle, Allocator>::begin()
+    {
+        return m_values;
+    }
+
+    template<typename T, typename Handle, typename Allocator>
+    typename SlotMap<T, Handle, Allocator>::iterator SlotMap<T, Handle, Allocator>::end()
+    {
+        return m_values + m_count;
+    }
+
+    template<typename T, typename Handle, typename Allocator>
+    typename SlotMap<T, Handle, Allocator>::const_iterator SlotMap<T, Handle, Allocator>::begin() const
+    {
+        return m_values;
+    }
+
+    template<typename T, typename Handle, typename Allocator>
+    typename SlotMap<T, Handle, Allocator>::const_iterator SlotMap<T, Handle, Allocator>::end() const
+    {
+        return m_values + m_count;
+    }
+
+    template<typename T, typename Handle, typename Allocator>
+    typename SlotMap<T, Handle, Allocator>::allocator_value SlotMap<T, Handle, Allocator>::CreateAllocator( MemoryLabel memoryLabel )
+    {
+        if constexpr( requires { allocator_value( memoryLabel ); } )
+        {
+            return allocator_value( memoryLabel );
+        }
+        else
+        {
+            return allocator_value();
+        }
+    }
+
+    template<typename T, typename Handle, typename Allocator>
+    zp_size_t SlotMap<T, Handle, Allocator>::SlotsOffset( zp_size_t capacity )
+    {
+        return ZP_ALIGN_SIZE( sizeof( T ) * capacity, alignof( Slot ) );
+    }
+
+    template<typename T, typename Handle, typename Allocator>
+    zp_size_t SlotMap<T, Handle, Allocator>::ValueSlotsOffset( zp_size_t capacity )
+    {
+        return SlotsOffset( capacity ) + sizeof( Slot ) * capacity;
+    }
+
+    template<typename T, typename Handle, typename Allocator>
+    const typename SlotMap<T, Handle, Allocator>::Slot* SlotMap<T, Handle, Allocator>::findSlot( handle_value handle ) const
+    {
+        const zp_uint32_t slotIndex = handle.index();
+        if( slotIndex >= m_slotCount )
+        {
+            return nullptr;
+        }
+
+        const Slot* slot = m_slots + slotIndex;
+        if( slot->generation != handle.generation() || !handle.isValid() )
+        {
+            return nullptr;
+        }
+
+        // a free slot's index is a free list link, only a live slot's dense value points back at it
+        return slot->index < m_count && m_valueSlots[ slot->index ] == slotIndex ? slot : nullptr;
+    }
+
+    template<typename T, typename Handle, typename Allocator>
+    zp_uint32_t SlotMap<T, Handle, Allocator>::acquireSlot()
+    {
+        if( m_freeHead != kInvalidIndex )
+        {
+            const zp_uint32_t slotIndex = m_freeHead;
+            m_freeHead = m_slots[ slotIndex ].index;
+            return slotIndex;
+        }
+
+        // retired slots are never reused, so indices can run out however few values are live
+        ZP_ASSERT_MSG( m_slotCount < handle_value::kIndexMask, "SlotMap is out of handle indices" );
+        if( m_slotCount >= handle_value::kIndexMask )
+        {
+            return kInvalidIndex;
+        }
+
+        if( m_slotCount == m_capacity )
+        {
+            resize( m_capacity < 16 ? 16 : m_capacity * 2 );
+        }
+
+        const zp_uint32_t slotIndex = static_cast<zp_uint32_t>( m_slotCount );
+        m_slots[ slotIndex ] = { .index = kInvalidIndex, .generation = 1 };
+        ++m_slotCount;
+
+        return slotIndex;
+    }
+
+    template<typename T, typename Handle, typename Allocator>
+    void SlotMap<T, Handle, Allocator>::releaseSlot( zp_uint32_t slotIndex )
+    {
+        Slot& slot = m_slots[ slotIndex ];
+
+        // a slot whose generation would wrap is retired rather than risk a stale handle matching again
+        if( slot.generation == handle_value::kMaxGeneration )
+        {
+            slot = { .index = kInvalidIndex, .generation = 0 };
+        }
+        else
+        {
+            slot = { .index = m_freeHead, .generation = static_cast<generation_value>( slot.generation + 1 ) };
+            m_freeHead = slotIndex;
+        }
+    }
+
+    template<typename T, typename Handle, typename Allocator>
+    void SlotMap<T, Handle, Allocator>::resize( zp_size_t capacity )
+    {
+        ZP_ASSERT( capacity > m_capacity );
+        ZP_ASSERT( alignof( T ) <= kDefaultMemoryAlignment );
+
+        zp_uint8_t* block = static_cast<zp_uint8_t*>( m_allocator.allocate( ValueSlotsOffset( capacity ) + sizeof( zp_uint32_t ) * capacity ) );
+
+        T* values = reinterpret_cast<T*>( block );
+        Slot* slots = reinterpret_cast<Slot*>( block + SlotsOffset( capacity ) );
+        zp_uint32_t* valueSlots = reinterpret_cast<zp_uint32_t*>( block + ValueSlotsOffset( capacity ) );
+
+        for( zp_size_t i = 0; i < m_count; ++i )
+        {
+            new( values + i ) T( zp_move( m_values[ i ] ) );
+            ( m_values + i )->~T();
+        }
+
+        for( zp_size_t i = 0; i < m_slotCount; ++i )
+        {
+            slots[ i ] = m_slots[ i ];
+        }
+
+        for( zp_size_t i = 0; i < m_count; ++i )
+        {
+            valueSlots[ i ] = m_valueSlots[ i ];
+        }
+
+        if( m_capacity > 0 )
+        {
+            m_allocator.free( m_values );
+        }
+
+        m_values = values;
+        m_slots = slots;
+        m_valueSlots = valueSlots;
+        m_capacity = capacity;
+    }
+}
+
+#endif //ZP_SLOT_MAP_H
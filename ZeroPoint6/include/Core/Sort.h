@@ -0,0 +1,40 @@
+//
+// Created by phosg on 10/16/2026.
+//
+
+#ifndef ZP_SORT_H
+#define ZP_SORT_H
+
+#include "Core/Defines.h"
+#include "Core/Types.h"
+
+namespace zp
+{
+    // sort key with the index of the element it came from, sort the keys then gather the elements by index
+    struct RadixSortKey32
+    {
+        zp_uint32_t key;
+        zp_uint32_t index;
+    };
+
+    struct RadixSortKey64
+    {
+        zp_uint64_t key;
+        zp_uint32_t index;
+    };
+
+    //
+    // LSD radix sort, 8 bits per pass, ascending and stable. scratch must hold count elements.
+    // all digit histograms are built in a single read of the keys, passes where every key shares a digit are skipped.
+    //
+
+    void RadixSort( zp_uint32_t* keys, zp_uint32_t* scratch, zp_size_t count );
+
+    void RadixSort( zp_uint64_t* keys, zp_uint64_t* scratch, zp_size_t count );
+
+    void RadixSort( RadixSortKey32* keys, RadixSortKey32* scratch, zp_size_t count );
+
+    void RadixSort( RadixSortKey64* keys, RadixSortKey64* scratch, zp_size_t count );
+}
+
+#endif //ZP_SORT_H
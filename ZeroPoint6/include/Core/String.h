@@ -1556,17 +1556,129 @@ namespace zp
 
 #pragma region Pooled String
 
+    // stored right before the pooled text
+    struct PooledStringHeader
+    {
+        zp_hash64_t hash;
+        zp_uint32_t id;
+        zp_uint32_t length;
+    };
+
+    //
+    // Interned string, every PooledString with the same text points at the same pooled copy so equality is a pointer
+    // compare. The hash is computed once when the text is first pooled. Pooled text is never freed before DestroyPool().
+    //
+
     class PooledString
     {
     public:
-    private:
-        zp_char8_t* m_str;
+        using char_type = zp_char8_t;
+        using const_str_pointer = const char_type*;
 
-    public:
-        ZP_FORCEINLINE zp_bool_t operator==( const PooledString& rh )
+        static constexpr zp_hash64_t kEmptyHash = zp_fnv64_1a( static_cast<const void*>( nullptr ), 0 );
+
+        constexpr PooledString()
+            : m_str( nullptr )
+        {
+        }
+
+        [[nodiscard]] ZP_FORCEINLINE zp_bool_t empty() const
+        {
+            return m_str == nullptr;
+        }
+
+        [[nodiscard]] ZP_FORCEINLINE zp_size_t length() const
+        {
+            return m_str != nullptr ? header()->length : 0;
+        }
+
+        [[nodiscard]] ZP_FORCEINLINE zp_hash64_t hash() const
+        {
+            return m_str != nullptr ? header()->hash : kEmptyHash;
+        }
+
+        // dense and starting at 1, 0 is the empty string
+        [[nodiscard]] ZP_FORCEINLINE zp_uint32_t id() const
+        {
+            return m_str != nullptr ? header()->id : 0;
+        }
+
+        // null terminated
+        [[nodiscard]] ZP_FORCEINLINE const char* c_str() const
+        {
+            return m_str != nullptr ? reinterpret_cast<const char*>( m_str ) : "";
+        }
+
+        [[nodiscard]] ZP_FORCEINLINE const_str_pointer str() const
+        {
+            return m_str;
+        }
+
+        [[nodiscard]] ZP_FORCEINLINE String asString() const
+        {
+            return { m_str, length() };
+        }
+
+        ZP_FORCEINLINE zp_bool_t operator==( const PooledString& rh ) const
         {
             return m_str == rh.m_str;
         }
+
+        ZP_FORCEINLINE zp_bool_t operator!=( const PooledString& rh ) const
+        {
+            return m_str != rh.m_str;
+        }
+
+        // thread safe, returns the pooled copy of str and pools it first if needed
+        static PooledString Intern( const String& str );
+
+        static PooledString Intern( const char* str );
+
+        static PooledString Intern( const char* str, zp_size_t length );
+
+        // thread safe, never adds to the pool
+        static zp_bool_t TryFind( const String& str, PooledString& pooledString );
+
+        // id has to come from a PooledString
+        static PooledString FromId( zp_uint32_t id );
+
+        [[nodiscard]] static zp_size_t GetPooledCount();
+
+        // not thread safe, every PooledString is invalid afterwards
+        static void DestroyPool();
+
+    private:
+        explicit PooledString( const PooledStringHeader* header )
+            : m_str( reinterpret_cast<const_str_pointer>( header + 1 ) )
+        {
+        }
+
+        [[nodiscard]] ZP_FORCEINLINE const PooledStringHeader* header() const
+        {
+            return reinterpret_cast<const PooledStringHeader*>( m_str ) - 1;
+        }
+
+        const_str_pointer m_str;
+    };
+
+    template<typename H>
+    struct DefaultHash<PooledString, H>
+    {
+        H operator()( const PooledString& val ) const
+        {
+            if constexpr( is_same_v<H, zp_hash64_t> )
+            {
+                return val.hash();
+            }
+            else if constexpr( is_same_v<H, zp_hash32_t> )
+            {
+                return static_cast<zp_hash32_t>( val.hash() ^ ( val.hash() >> 32 ) );
+            }
+            else
+            {
+                return zp_fnv_1a<H>( val.str(), val.length() );
+            }
+        }
     };
 
 #pragma endregion
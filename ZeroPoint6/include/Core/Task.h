@@ -0,0 +1,360 @@
+//
+// Created by phosg on 10/16/2026.
+//
+
+#ifndef ZP_TASK_H
+#define ZP_TASK_H
+
+#include "Core/Types.h"
+#include "Core/Common.h"
+#include "Core/Job.h"
+
+#include <new>
+#include <coroutine>
+
+namespace zp
+{
+    template<typename T>
+    class Task;
+
+    //
+    // Tasks are lazy, nothing runs until the task is started or awaited. Every resume happens inside a job, so a suspended
+    // task never holds a worker thread, and completion is a signal job other jobs and tasks can depend on.
+    //
+
+    class TaskPromiseBase
+    {
+    public:
+        static void* operator new( std::size_t size )
+        {
+            return JobSystem::AllocateTaskFrame( size );
+        }
+
+        static void operator delete( void* ptr, std::size_t size )
+        {
+            JobSystem::FreeTaskFrame( ptr, size );
+        }
+
+        struct FinalAwaiter
+        {
+            zp_bool_t await_ready() const noexcept
+            {
+                return false;
+            }
+
+            template<typename TPromise>
+            void await_suspend( std::coroutine_handle<TPromise> coroutine ) noexcept
+            {
+                // the frame may be destroyed by a waiting thread as soon as the signal is raised, don't touch it afterwards
+                const JobHandle completion = coroutine.promise().completion();
+                JobSystem::Signal( completion );
+            }
+
+            void await_resume() const noexcept
+            {
+            }
+        };
+
+        std::suspend_always initial_suspend() const noexcept
+        {
+            return {};
+        }
+
+        FinalAwaiter final_suspend() const noexcept
+        {
+            return {};
+        }
+
+        void unhandled_exception()
+        {
+            ZP_INVALID_CODE_PATH_MSG( "Unhandled exception in Task" );
+        }
+
+        JobHandle completion() const
+        {
+            return m_completion;
+        }
+
+        JobPriority priority() const
+        {
+            return m_priority;
+        }
+
+        zp_bool_t isStarted() const
+        {
+            return m_completion.job != nullptr;
+        }
+
+        JobHandle start( void* coroutineAddress, JobPriority priority );
+
+        // resumes the coroutine in a new job once dependency completes
+        static void ResumeAfter( void* coroutineAddress, JobHandle dependency, JobPriority priority );
+
+    private:
+        JobHandle m_completion {};
+        JobPriority m_priority = JobPriority::Normal;
+    };
+
+    template<typename T>
+    class TaskPromise : public TaskPromiseBase
+    {
+    public:
+        TaskPromise() = default;
+
+        ~TaskPromise()
+        {
+            if( m_hasValue )
+            {
+                value()->~T();
+            }
+        }
+
+        Task<T> get_return_object();
+
+        template<typename U>
+        void return_value( U&& val )
+        {
+            ZP_ASSERT( !m_hasValue );
+            new( m_storage ) T( zp_forward<U>( val ) );
+            m_hasValue = true;
+        }
+
+        T& result()
+        {
+            ZP_ASSERT( m_hasValue );
+            return *value();
+        }
+
+        T take()
+        {
+            ZP_ASSERT( m_hasValue );
+            return zp_move( *value() );
+        }
+
+    private:
+        T* value()
+        {
+            return reinterpret_cast<T*>( m_storage );
+        }
+
+        alignas( T ) zp_uint8_t m_storage[sizeof( T )];
+        zp_bool_t m_hasValue = false;
+    };
+
+    template<>
+    class TaskPromise<void> : public TaskPromiseBase
+    {
+    public:
+        Task<void> get_return_object();
+
+        void return_void()
+        {
+        }
+
+        void result()
+        {
+        }
+
+        void take()
+        {
+        }
+    };
+
+    template<typename T = void>
+    class Task
+    {
+    public:
+        using promise_type = TaskPromise<T>;
+
+        Task()
+            : m_coroutine()
+        {
+        }
+
+        explicit Task( std::coroutine_handle<promise_type> coroutine )
+            : m_coroutine( coroutine )
+        {
+        }
+
+        Task( const Task& ) = delete;
+
+        Task( Task&& other ) noexcept
+            : m_coroutine( other.m_coroutine )
+        {
+            other.m_coroutine = {};
+        }
+
+        ~Task()
+        {
+            destroy();
+        }
+
+        Task& operator=( const Task& ) = delete;
+
+        Task& operator=( Task&& other ) noexcept
+        {
+            if( this != &other )
+            {
+                destroy();
+
+                m_coroutine = other.m_coroutine;
+                other.m_coroutine = {};
+            }
+
+            return *this;
+        }
+
+        // queues the first resume, the returned handle completes when the coroutine returns
+        JobHandle start( JobPriority priority = JobPriority::Normal )
+        {
+            ZP_ASSERT( m_coroutine );
+            return m_coroutine.promise().start( m_coroutine.address(), priority );
+        }
+
+        JobHandle handle() const
+        {
+            return m_coroutine ? m_coroutine.promise().completion() : JobHandle {};
+        }
+
+        zp_bool_t isStarted() const
+        {
+            return m_coroutine && m_coroutine.promise().isStarted();
+        }
+
+        zp_bool_t isComplete() const
+        {
+            return isStarted() && JobSystem::IsComplete( handle() );
+        }
+
+        // blocking, runs other jobs until the task completes. Use co_await from inside another task instead. The value lives
+        // in the coroutine frame, an lvalue task returns a reference that is valid while the task is alive
+        decltype( auto ) get() &
+        {
+            wait();
+
+            return m_coroutine.promise().result();
+        }
+
+        // a temporary task is destroyed at the end of the expression, its value is moved out
+        T get() &&
+        {
+            wait();
+
+            return m_coroutine.promise().take();
+        }
+
+        template<zp_bool_t TakeResult>
+        struct Awaiter
+        {
+            zp_bool_t await_ready() const
+            {
+                return task->isComplete();
+            }
+
+            template<typename TPromise>
+            void await_suspend( std::coroutine_handle<TPromise> coroutine )
+            {
+                const JobPriority priority = coroutine.promise().priority();
+
+                // awaiting an unstarted task runs it at the awaiting task's priority
+                if( !task->isStarted() )
+                {
+                    task->start( priority );
+                }
+
+                TaskPromiseBase::ResumeAfter( coroutine.address(), task->handle(), priority );
+            }
+
+            decltype( auto ) await_resume()
+            {
+                if constexpr( TakeResult )
+                {
+                    return task->m_coroutine.promise().take();
+                }
+                else
+                {
+                    return task->m_coroutine.promise().result();
+                }
+            }
+
+            Task* task;
+        };
+
+        Awaiter<false> operator co_await() &
+        {
+            return { this };
+        }
+
+        Awaiter<true> operator co_await() &&
+        {
+            return { this };
+        }
+
+    private:
+        void wait()
+        {
+            if( !isStarted() )
+            {
+                start();
+            }
+
+            JobSystem::Complete( handle() );
+        }
+
+        void destroy()
+        {
+            if( m_coroutine )
+            {
+                // a started coroutine may still be suspended waiting on a job, it has to finish before the frame goes away
+                ZP_ASSERT( !isStarted() || isComplete() );
+
+                m_coroutine.destroy();
+                m_coroutine = {};
+            }
+        }
+
+        std::coroutine_handle<promise_type> m_coroutine;
+    };
+
+    template<typename T>
+    Task<T> TaskPromise<T>::get_return_object()
+    {
+        return Task<T>( std::coroutine_handle<TaskPromise<T>>::from_promise( *this ) );
+    }
+
+    inline Task<void> TaskPromise<void>::get_return_object()
+    {
+        return Task<void>( std::coroutine_handle<TaskPromise<void>>::from_promise( *this ) );
+    }
+
+    //
+    // co_await on a JobHandle suspends the task and resumes it in a continuation job of the awaited job
+    //
+
+    struct JobHandleAwaiter
+    {
+        zp_bool_t await_ready() const
+        {
+            return JobSystem::IsComplete( jobHandle );
+        }
+
+        template<typename TPromise>
+        void await_suspend( std::coroutine_handle<TPromise> coroutine )
+        {
+            TaskPromiseBase::ResumeAfter( coroutine.address(), jobHandle, coroutine.promise().priority() );
+        }
+
+        void await_resume() const
+        {
+        }
+
+        JobHandle jobHandle;
+    };
+
+    inline JobHandleAwaiter operator co_await( JobHandle jobHandle )
+    {
+        return { jobHandle };
+    }
+}
+
+#endif //ZP_TASK_H
@@ -18,13 +18,13 @@ namespace zp
     {
         [[nodiscard]] void* allocate( zp_size_t size ) const
         {
-            void* ptr = GetAllocator( MemLabel )->allocate( size, Alignment );
+            void* ptr = GetAllocator( MemLabel )->allocate( size, Alignment, MemLabel );
             return ptr;
         }
 
         void free( void* ptr ) const
         {
-            GetAllocator( MemLabel )->free( ptr );
+            GetAllocator( MemLabel )->free( ptr, MemLabel );
         }
     };
 
@@ -40,8 +40,83 @@ namespace zp
         {
         }
 
+        [[nodiscard]] zp_bool_t isInline( const void* ptr ) const
+        {
+            return ptr == m_data;
+        }
+
         T m_data[ Length ];
     };
+
+    // first Length elements live inside the allocator, anything larger spills to the fallback allocator
+    template<zp_size_t Length, typename T, typename Allocator = MemoryLabelAllocator>
+    struct SmallMemoryVectorAllocator
+    {
+        static constexpr zp_size_t kInlineCapacity = Length;
+
+        SmallMemoryVectorAllocator()
+            : m_allocator()
+            , m_inlineInUse( false )
+        {
+        }
+
+        explicit( false ) SmallMemoryVectorAllocator( MemoryLabel memoryLabel )
+            : m_allocator( memoryLabel )
+            , m_inlineInUse( false )
+        {
+        }
+
+        explicit( false ) SmallMemoryVectorAllocator( const Allocator& allocator )
+            : m_allocator( allocator )
+            , m_inlineInUse( false )
+        {
+        }
+
+        // only the fallback allocator is copied, the inline storage always belongs to its owner
+        SmallMemoryVectorAllocator( const SmallMemoryVectorAllocator& other )
+            : m_allocator( other.m_allocator )
+            , m_inlineInUse( false )
+        {
+        }
+
+        SmallMemoryVectorAllocator& operator=( const SmallMemoryVectorAllocator& other )
+        {
+            m_allocator = other.m_allocator;
+            return *this;
+        }
+
+        [[nodiscard]] void* allocate( zp_size_t size )
+        {
+            if( !m_inlineInUse && size <= sizeof( T ) * Length )
+            {
+                m_inlineInUse = true;
+                return static_cast<void*>( m_data );
+            }
+
+            return m_allocator.allocate( size );
+        }
+
+        void free( void* ptr )
+        {
+            if( ptr == m_data )
+            {
+                m_inlineInUse = false;
+            }
+            else
+            {
+                m_allocator.free( ptr );
+            }
+        }
+
+        [[nodiscard]] zp_bool_t isInline( const void* ptr ) const
+        {
+            return ptr == m_data;
+        }
+
+        Allocator m_allocator;
+        zp_bool_t m_inlineInUse;
+        alignas( T ) zp_uint8_t m_data[ sizeof( T ) * Length ];
+    };
 }
 
 namespace zp
@@ -82,6 +157,10 @@ namespace zp
         template<zp_size_t Size>
         Vector( value_type (&array)[Size] );
 
+        Vector( const self_type& other );
+
+        Vector( self_type&& other ) noexcept;
+
         ~Vector();
 
         self_type& operator=( const self_type& other );
@@ -167,10 +246,7 @@ namespace zp
         template<typename Cmp>
         void sort( Cmp cmp )
         {
-            if( m_length > 1 )
-            {
-                zp_qsort3( begin(), end() - 1, cmp );
-            }
+            zp_sort( begin(), end(), cmp );
         }
 
         template<typename Func>
@@ -220,6 +296,10 @@ namespace zp
     template<typename T, zp_size_t Size>
     using FixedVector = Vector<T, FixedMemoryVectorAllocator<Size, T>>;
 
+    // same API as Vector, no allocation until it grows past Size elements
+    template<typename T, zp_size_t Size>
+    using SmallVector = Vector<T, SmallMemoryVectorAllocator<Size, T>>;
+
 }
 
 //
@@ -293,6 +373,26 @@ namespace zp
         }
     }
 
+    template<typename T, typename Allocator>
+    Vector<T, Allocator>::Vector( const self_type& other )
+        : m_data( nullptr )
+        , m_length( 0 )
+        , m_capacity( 0 )
+        , m_allocator( other.m_allocator )
+    {
+        *this = other;
+    }
+
+    template<typename T, typename Allocator>
+    Vector<T, Allocator>::Vector( self_type&& other ) noexcept
+        : m_data( nullptr )
+        , m_length( 0 )
+        , m_capacity( 0 )
+        , m_allocator( other.m_allocator )
+    {
+        *this = zp_move( other );
+    }
+
     template<typename T, typename Allocator>
     Vector<T, Allocator>::~Vector()
     {
@@ -321,9 +421,30 @@ namespace zp
     {
         destroy();
 
+        // storage inside the other allocator can't change owners, move the elements instead
+        if constexpr( requires( const Allocator& allocator ) { allocator.isInline( nullptr ); } )
+        {
+            if( other.m_allocator.isInline( other.m_data ) )
+            {
+                ensureCapacity( other.m_length );
+
+                for( zp_size_t i = 0; i != other.m_length; ++i )
+                {
+                    m_data[ i ] = zp_move( other.m_data[ i ] );
+                }
+
+                m_length = other.m_length;
+
+                other.clear();
+
+                return *this;
+            }
+        }
+
         m_data  = other.m_data;
         m_length = other.m_length;
         m_capacity = other.m_capacity;
+        m_allocator = other.m_allocator;
 
         other.m_data = nullptr;
         other.m_length = 0;
@@ -837,6 +958,12 @@ namespace zp
     {
         capacity = capacity < 4 ? 4 : capacity;
 
+        // start with all of the inline storage rather than outgrowing part of it
+        if constexpr( requires { Allocator::kInlineCapacity; } )
+        {
+            capacity = capacity < Allocator::kInlineCapacity ? Allocator::kInlineCapacity : capacity;
+        }
+
         pointer newArray = static_cast<pointer>( m_allocator.allocate( sizeof( T ) * capacity ));
         zp_zero_memory_array( newArray, capacity );
 
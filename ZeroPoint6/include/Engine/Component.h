@@ -26,6 +26,9 @@ namespace zp
 
         kMaxComponentsPerArchetype = 16,
         kMaxEntitiesPerArchetypeBlock = 64,
+
+        // archetypes kept inline before the list spills to the heap
+        kInlineComponentArchetypes = 16,
     };
     ZP_STATIC_ASSERT( kMaxEntitiesPerArchetypeBlock == sizeof(zp_uint64_t) * 8);
 
@@ -154,7 +157,7 @@ namespace zp
         RegisteredComponent m_components[kMaxComponentTypes];
         RegisteredTag m_tags[kMaxTagTypes];
 
-        Vector<ComponentArchetypeManager*> m_componentArchetypes;
+        SmallVector<ComponentArchetypeManager*, kInlineComponentArchetypes> m_componentArchetypes;
 
     public:
         const MemoryLabel memoryLabel;
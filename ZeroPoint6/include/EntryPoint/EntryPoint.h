@@ -12,6 +12,7 @@
 #include "Core/Properties.h"
 #include "Core/String.h"
 #include "Core/Types.h"
+#include "Core/Vector.h"
 
 #include "Platform/Platform.h"
 
@@ -37,6 +38,12 @@ namespace zp
     {
         zp_size_t totalSize;
         zp_size_t pageSize;
+
+        // committed memory past this is given back as whole pages free up, 0 keeps the peak committed
+        zp_size_t decommitHighWaterMark = 0;
+
+        // 2MB pages when the process is allowed to lock pages in memory, otherwise regular pages
+        zp_bool_t useLargePages = false;
     };
 
     // clang-format off
@@ -46,9 +53,13 @@ namespace zp
         MemoryConfig defaultAllocator       { .totalSize = 0 MB,  .pageSize = 16 MB };
         MemoryConfig tempAllocator          { .totalSize = 32 MB, .pageSize = 2 MB };
         MemoryConfig threadSafeAllocator    { .totalSize = 16 MB, .pageSize = 2 MB };
+        MemoryConfig frameAllocator         { .totalSize = 16 MB, .pageSize = 2 MB }; // per buffered frame, two are reserved
         MemoryConfig profilerAllocator      { .totalSize = 64 MB, .pageSize = 0 };
         MemoryConfig debugAllocator         { .totalSize = 16 MB, .pageSize = 2 MB };
         MemoryConfig graphicsAllocator      { .totalSize = 0 MB,  .pageSize = 4 MB };
+
+        // per label, see SetMemoryBudget
+        MemoryBudget memoryBudgets[ MemoryLabels::MemoryLabels_Count ] {};
     };
     // clang-format on
 
@@ -59,6 +70,7 @@ namespace zp
 
         zp_bool_t disableNetworking = false;
         zp_int32_t maxJobThreads = 2;
+        zp_int32_t jobThreadsPerCore = 1;
 
         // read boot config file
         if( Platform::FileExists( "boot.config" ) )
@@ -77,6 +89,7 @@ namespace zp
                 GlobalProperties::Parse( bootConfig, String::As( "total-memory-size" ), entryPointDesc.totalMemorySize );
                 GlobalProperties::Parse( bootConfig, String::As( "disable-networking" ), disableNetworking );
                 GlobalProperties::Parse( bootConfig, String::As( "max-job-threads" ), maxJobThreads );
+                GlobalProperties::Parse( bootConfig, String::As( "job-threads-per-core" ), jobThreadsPerCore );
             }
 
             Platform::CloseFileHandle( bootConfigFile );
@@ -93,7 +106,7 @@ namespace zp
 
         // default allocator
         MemoryAllocator s_defaultAllocator(
-            SystemPageMemoryStorage( ZP_OFFSET_PTR( systemMemory, 0 ), entryPointDesc.defaultAllocator.pageSize, entryPointDesc.defaultAllocator.totalSize ),
+            SystemPageMemoryStorage( ZP_OFFSET_PTR( systemMemory, 0 ), entryPointDesc.defaultAllocator.pageSize, entryPointDesc.defaultAllocator.totalSize, entryPointDesc.defaultAllocator.decommitHighWaterMark, entryPointDesc.defaultAllocator.useLargePages ),
             TlsfAllocatorPolicy(),
             NullMemoryLock(),
             TrackedMemoryProfiler() );
@@ -103,18 +116,33 @@ namespace zp
 
         endMemorySize -= entryPointDesc.tempAllocator.totalSize;
         MemoryAllocator s_tempAllocator(
-            SystemPageMemoryStorage( ZP_OFFSET_PTR( systemMemory, endMemorySize ), entryPointDesc.tempAllocator.pageSize, entryPointDesc.tempAllocator.totalSize ),
+            SystemPageMemoryStorage( ZP_OFFSET_PTR( systemMemory, endMemorySize ), entryPointDesc.tempAllocator.pageSize, entryPointDesc.tempAllocator.totalSize, entryPointDesc.tempAllocator.decommitHighWaterMark, entryPointDesc.tempAllocator.useLargePages ),
             TlsfAllocatorPolicy(),
             NullMemoryLock(),
             TrackedMemoryProfiler() );
 
         endMemorySize -= entryPointDesc.threadSafeAllocator.totalSize;
         MemoryAllocator s_threadSafeAllocator(
-            SystemPageMemoryStorage( ZP_OFFSET_PTR( systemMemory, endMemorySize ), entryPointDesc.threadSafeAllocator.pageSize, entryPointDesc.threadSafeAllocator.totalSize ),
-            TlsfAllocatorPolicy(),
+            SystemPageMemoryStorage( ZP_OFFSET_PTR( systemMemory, endMemorySize ), entryPointDesc.threadSafeAllocator.pageSize, entryPointDesc.threadSafeAllocator.totalSize, entryPointDesc.threadSafeAllocator.decommitHighWaterMark, entryPointDesc.threadSafeAllocator.useLargePages ),
+            ThreadCacheAllocatorPolicy<TlsfAllocatorPolicy>(),
             CriticalSectionMemoryLock(),
             TrackedMemoryProfiler() );
 
+        // frame allocators, double buffered
+        endMemorySize -= entryPointDesc.frameAllocator.totalSize;
+        FrameMemoryAllocator s_frameAllocator(
+            SystemPageMemoryStorage( ZP_OFFSET_PTR( systemMemory, endMemorySize ), entryPointDesc.frameAllocator.pageSize, entryPointDesc.frameAllocator.totalSize ),
+            AtomicLinearAllocatorPolicy(),
+            CriticalSectionMemoryLock(),
+            NullMemoryProfiler() );
+
+        endMemorySize -= entryPointDesc.frameAllocator.totalSize;
+        FrameMemoryAllocator s_previousFrameAllocator(
+            SystemPageMemoryStorage( ZP_OFFSET_PTR( systemMemory, endMemorySize ), entryPointDesc.frameAllocator.pageSize, entryPointDesc.frameAllocator.totalSize ),
+            AtomicLinearAllocatorPolicy(),
+            CriticalSectionMemoryLock(),
+            NullMemoryProfiler() );
+
 #if ZP_USE_PROFILER
         endMemorySize -= entryPointDesc.profilerAllocator.totalSize;
         MemoryAllocator s_profilingAllocator(
@@ -155,10 +183,16 @@ namespace zp
         RegisterAllocator( MemoryLabels::Data, &s_defaultAllocator );
         RegisterAllocator( MemoryLabels::Temp, &s_tempAllocator );
         RegisterAllocator( MemoryLabels::ThreadSafe, &s_threadSafeAllocator );
+        RegisterFrameAllocators( &s_frameAllocator, &s_previousFrameAllocator );
 
         RegisterAllocator( MemoryLabels::Profiling, &s_profilingAllocator );
         RegisterAllocator( MemoryLabels::Debug, &s_debugAllocator );
 
+        for( MemoryLabel memoryLabel = 0; memoryLabel < MemoryLabels::MemoryLabels_Count; ++memoryLabel )
+        {
+            SetMemoryBudget( memoryLabel, entryPointDesc.memoryBudgets[ memoryLabel ] );
+        }
+
         // initialize networking (if needed)
         if( !disableNetworking )
         {
@@ -168,13 +202,31 @@ namespace zp
         // initialize stack trace
         Platform::InitializeStackTrace();
 
-        // calculate max job threads
+        // calculate max job threads, by default one per physical core (or per used SMT sibling) minus the main thread
+        jobThreadsPerCore = zp_max( jobThreadsPerCore, 1 );
+
+        // the topology spans every processor group, GetProcessorCount() only the current one
+        const zp_uint32_t processorCount = Platform::GetProcessorTopology( nullptr, 0 );
+
+        Vector<ProcessorInfo> processors( processorCount, MemoryLabels::Default );
+        processors.resize_unsafe( zp_min( processorCount, Platform::GetProcessorTopology( processors.data(), processorCount ) ) );
+
+        const zp_int32_t logicalProcessorCount = processors.isEmpty() ? static_cast<zp_int32_t>( Platform::GetProcessorCount() ) : static_cast<zp_int32_t>( processors.length() );
+
         if( maxJobThreads == 0 )
         {
-            maxJobThreads = static_cast<zp_int32_t>( Platform::GetProcessorCount() ) - 1;
+            zp_int32_t hardwareThreadCount = 0;
+            for( const ProcessorInfo& processor : processors )
+            {
+                hardwareThreadCount += static_cast<zp_int32_t>( processor.smtIndex ) < jobThreadsPerCore ? 1 : 0;
+            }
+
+            maxJobThreads = hardwareThreadCount > 0 ? hardwareThreadCount - 1 : logicalProcessorCount - 1;
         }
 
-        const zp_int32_t numJobThreads = zp_min( maxJobThreads, static_cast<zp_int32_t>( Platform::GetProcessorCount() ) - 1 );
+        const zp_int32_t numJobThreads = zp_min( maxJobThreads, logicalProcessorCount - 1 );
+
+        processors.destroy();
 
         // set main thread
         const ThreadHandle mainThreadHandle = Platform::GetCurrentThread();
@@ -187,18 +239,21 @@ namespace zp
                 .maxCPUEventsPerThread = 128,
                 .maxMemoryEventsPerThread = 128,
                 .maxGPUEventsPerThread = 4,
+                .maxCounterEventsPerFrame = 256,
                 .maxFramesToCapture = 120,
                 .maxThreadCount = static_cast<zp_uint32_t>( numJobThreads ) + 1,
             };
             Profiler::CreateProfiler( MemoryLabels::Profiling, profilerDesc );
 
             Profiler::InitializeProfilerThread();
+
+            RegisterMemoryStatsSnapshot();
         }
 #endif // ZP_USE_PROFILER
 
         // initialize job system
         {
-            JobSystem::Setup( MemoryLabels::Default, numJobThreads );
+            JobSystem::Setup( MemoryLabels::Default, numJobThreads, jobThreadsPerCore );
 
             JobSystem::InitializeJobThreads();
         }
@@ -237,6 +292,8 @@ namespace zp
 
 #if ZP_USE_PROFILER
         {
+            UnregisterMemoryStatsSnapshot();
+
             Profiler::DestroyProfilerThread();
 
             Profiler::DestroyProfiler();
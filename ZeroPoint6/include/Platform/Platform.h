@@ -299,6 +299,12 @@ namespace zp
         void* CommitMemoryPage( void** ptr, zp_size_t size );
 
         void DecommitMemoryPage( void* ptr, zp_size_t size );
+
+        // 0 when the system has no large pages or the process isn't allowed to lock them in memory
+        [[nodiscard]] zp_size_t GetLargeMemoryPageSize();
+
+        // reserved and committed together, free with FreeSystemMemory. nullptr when no large pages are available
+        void* AllocateLargeMemoryPages( zp_size_t size );
     } // namespace Platform
 
     // File & Path
@@ -424,6 +430,16 @@ namespace zp
         }
     };
 
+    struct ProcessorInfo
+    {
+        zp_uint16_t group;
+        zp_uint8_t number;
+        zp_uint8_t smtIndex;
+        zp_uint32_t coreIndex;
+        zp_uint32_t cacheIndex;
+        zp_uint32_t numaNode;
+    };
+
     namespace Platform
     {
         zp_handle_t AllocateThreadPool( zp_uint32_t minThreads, zp_uint32_t maxThreads );
@@ -452,12 +468,18 @@ namespace zp
 
         void SetThreadIdealProcessor( ThreadHandle threadHandle, zp_uint32_t processorIndex );
 
+        void SetThreadIdealProcessor( ThreadHandle threadHandle, const ProcessorInfo& processor );
+
         void CloseThread( ThreadHandle threadHandle );
 
         void JoinThreads( const ThreadHandle* threadHandles, zp_size_t threadHandleCount );
 
         [[nodiscard]] zp_uint32_t GetProcessorCount();
 
+        // logical processors ordered by physical core, smtIndex 0 being the first hardware thread of each core. cacheIndex
+        // groups processors sharing a last level cache. Fills up to maxProcessorCount, returns the total logical processor count
+        zp_uint32_t GetProcessorTopology( ProcessorInfo* processors, zp_uint32_t maxProcessorCount );
+
         zp_int32_t ExecuteProcess( const char* process, const char* arguments );
     } // namespace Platform
 
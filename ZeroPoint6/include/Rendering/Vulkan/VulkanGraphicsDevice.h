@@ -7,6 +7,7 @@
 
 #include "Core/Types.h"
 #include "Core/Common.h"
+#include "Core/ConcurrentMap.h"
 
 #include "Rendering/GraphicsDevice.h"
 
@@ -228,8 +229,8 @@ namespace zp
         VkDebugUtilsMessengerEXT m_vkDebugMessenger;
 #endif
 
-        Map<zp_hash128_t, VkDescriptorSetLayout, zp_hash128_t> m_descriptorSetLayoutCache;
-        Map<zp_hash128_t, VkSampler, zp_hash128_t> m_samplerCache;
+        ConcurrentMap<zp_hash128_t, VkDescriptorSetLayout, zp_hash128_t> m_descriptorSetLayoutCache;
+        ConcurrentMap<zp_hash128_t, VkSampler, zp_hash128_t> m_samplerCache;
 
         Vector<DelayedDestroy> m_delayedDestroy;
 
@@ -7,12 +7,16 @@
 #include "Core/Common.h"
 #include "Core/Allocator.h"
 #include "Core/Memory.h"
+#include "Core/Atomic.h"
+#include "Core/Profiler.h"
+#include "Core/Data.h"
 
 #include "Platform/Platform.h"
 
 #include "tlsf/tlsf.h"
 
 #include <cstdlib>
+#include <cmath>
 
 namespace zp
 {
@@ -32,13 +36,56 @@ namespace zp
         ZP_ASSERT( memoryLabel < kMaxMemoryLabels );
         return s_memoryAllocators[ memoryLabel ];
     }
+
+    namespace
+    {
+        FrameMemoryAllocator* s_frameAllocator;
+        FrameMemoryAllocator* s_previousFrameAllocator;
+
+        thread_local zp_bool_t t_frameMemoryRestricted;
+    }
+
+    void RegisterFrameAllocators( FrameMemoryAllocator* frameAllocator, FrameMemoryAllocator* previousFrameAllocator )
+    {
+        s_frameAllocator = frameAllocator;
+        s_previousFrameAllocator = previousFrameAllocator;
+
+        RegisterAllocator( MemoryLabels::Frame, s_frameAllocator );
+        RegisterAllocator( MemoryLabels::PreviousFrame, s_previousFrameAllocator );
+    }
+
+    void AdvanceFrameAllocators()
+    {
+        ZP_ASSERT( s_frameAllocator && s_previousFrameAllocator );
+
+        s_previousFrameAllocator->policy().reset();
+
+        FrameMemoryAllocator* const retiredAllocator = s_previousFrameAllocator;
+        s_previousFrameAllocator = s_frameAllocator;
+        s_frameAllocator = retiredAllocator;
+
+        RegisterAllocator( MemoryLabels::Frame, s_frameAllocator );
+        RegisterAllocator( MemoryLabels::PreviousFrame, s_previousFrameAllocator );
+    }
+
+    zp_bool_t SetFrameMemoryRestricted( zp_bool_t restricted )
+    {
+        const zp_bool_t prevRestricted = t_frameMemoryRestricted;
+        t_frameMemoryRestricted = restricted;
+        return prevRestricted;
+    }
 }
 
 namespace zp
 {
-    SystemPageMemoryStorage::SystemPageMemoryStorage( void* systemMemory, zp_size_t pageSize, zp_size_t totalSize )
-        : m_pageSize( pageSize )
+    SystemPageMemoryStorage::SystemPageMemoryStorage( void* systemMemory, zp_size_t pageSize, zp_size_t totalSize, zp_size_t decommitHighWaterMark, zp_bool_t useLargePages )
+        : m_releasedRanges {}
+        , m_releasedRangeCount( 0 )
+        , m_pageSize( pageSize )
+        , m_largePageSize( useLargePages ? Platform::GetLargeMemoryPageSize() : 0 )
         , m_totalSize( totalSize )
+        , m_committedSize( 0 )
+        , m_decommitHighWaterMark( decommitHighWaterMark )
         , m_systemMemory( systemMemory )
         , m_memory( systemMemory )
     {
@@ -46,256 +93,2607 @@ namespace zp
 
     void* SystemPageMemoryStorage::request_memory( zp_size_t size, zp_size_t& requestedSize )
     {
-        requestedSize = 0;
+        requestedSize = m_pageSize == 0 ? m_totalSize : zp_align_size( size, m_pageSize );
 
-        if( m_pageSize == 0 )
+        void* mem = nullptr;
+
+        // large pages are reserved and committed together outside of the reserved range, each request is its own allocation
+        if( m_largePageSize != 0 )
         {
-            requestedSize = m_totalSize;
+            const zp_size_t largePageSize = zp_align_size( requestedSize, m_largePageSize );
+
+            mem = Platform::AllocateLargeMemoryPages( largePageSize );
+            if( mem != nullptr )
+            {
+                requestedSize = largePageSize;
+            }
         }
-        else
+
+        if( mem == nullptr )
         {
-            while( requestedSize < size )
+            mem = request_released_memory( requestedSize );
+        }
+
+        if( mem == nullptr )
+        {
+            // commit advances the cursor even when it fails, only keep the move once the pages are committed
+            void* memory = m_memory;
+            if( ZP_OFFSET_PTR( memory, requestedSize ) <= ZP_OFFSET_PTR( m_systemMemory, m_totalSize ) )
+            {
+                mem = Platform::CommitMemoryPage( &memory, requestedSize );
+            }
+
+            if( mem == nullptr )
             {
-                requestedSize += m_pageSize;
+                return nullptr;
             }
+
+            m_memory = memory;
         }
 
-        void* mem = Platform::CommitMemoryPage( &m_memory, requestedSize );
+        m_committedSize += requestedSize;
+
         return mem;
     }
 
-    zp_bool_t SystemPageMemoryStorage::is_fixed() const
+    void SystemPageMemoryStorage::release_memory( void* mem, zp_size_t size )
     {
-        return false;
-    }
-}
+        m_committedSize -= size;
 
-namespace zp
-{
-    void* MallocMemoryStorage::request_memory( zp_size_t size, zp_size_t& requestedSize )
-    {
-        requestedSize = size;
-        void* mem = ::_aligned_malloc( requestedSize, kDefaultMemoryAlignment );
-        return mem;
+        const zp_bool_t inReservedRange = mem >= m_systemMemory && mem < ZP_OFFSET_PTR( m_systemMemory, m_totalSize );
+        if( !inReservedRange )
+        {
+            Platform::FreeSystemMemory( mem );
+            return;
+        }
+
+        Platform::DecommitMemoryPage( mem, size );
+
+        ReleasedRange released { .ptr = mem, .size = size };
+
+        // absorb the ranges on either side so the list doesn't fill up with pieces of the same hole
+        for( zp_size_t i = 0; i < m_releasedRangeCount; )
+        {
+            const ReleasedRange& range = m_releasedRanges[ i ];
+            if( ZP_OFFSET_PTR( range.ptr, range.size ) == released.ptr )
+            {
+                released = { .ptr = range.ptr, .size = range.size + released.size };
+            }
+            else if( ZP_OFFSET_PTR( released.ptr, released.size ) == range.ptr )
+            {
+                released.size += range.size;
+            }
+            else
+            {
+                ++i;
+                continue;
+            }
+
+            m_releasedRanges[ i ] = m_releasedRanges[ --m_releasedRangeCount ];
+        }
+
+        // a hole ending at the commit cursor goes back to it and needs no range
+        if( ZP_OFFSET_PTR( released.ptr, released.size ) == m_memory )
+        {
+            m_memory = released.ptr;
+            return;
+        }
+
+        // should_release_memory() stops the allocator releasing while the list is full
+        ZP_ASSERT_MSG( m_releasedRangeCount < kMaxReleasedMemoryRanges, "Released memory range lost" );
+
+        if( m_releasedRangeCount < kMaxReleasedMemoryRanges )
+        {
+            m_releasedRanges[ m_releasedRangeCount++ ] = released;
+        }
     }
 
-    zp_bool_t MallocMemoryStorage::is_fixed() const
+    void* SystemPageMemoryStorage::request_released_memory( zp_size_t size )
     {
-        return false;
-    }
+        for( zp_size_t i = 0; i < m_releasedRangeCount; ++i )
+        {
+            ReleasedRange& range = m_releasedRanges[ i ];
+            if( range.size >= size )
+            {
+                void* ptr = range.ptr;
+                void* mem = Platform::CommitMemoryPage( &ptr, size );
+                if( mem == nullptr )
+                {
+                    return nullptr;
+                }
 
-    //
-    //
-    //
+                range.ptr = ZP_OFFSET_PTR( range.ptr, size );
+                range.size -= size;
 
-    namespace
+                if( range.size == 0 )
+                {
+                    m_releasedRanges[ i ] = m_releasedRanges[ --m_releasedRangeCount ];
+                }
+
+                return mem;
+            }
+        }
+
+        return nullptr;
+    }
+
+    zp_bool_t SystemPageMemoryStorage::should_release_memory() const
     {
-        struct MallocHeader
-        {
-            zp_size_t allocatedSize;
-        };
+        // a hole that doesn't merge needs a free range to be handed out again, otherwise keep the memory committed
+        return m_decommitHighWaterMark != 0 && m_committedSize > m_decommitHighWaterMark && m_releasedRangeCount < kMaxReleasedMemoryRanges;
     }
 
-    void MallocAllocatorPolicy::add_memory( void* mem, zp_size_t size )
+    zp_size_t SystemPageMemoryStorage::page_size() const
     {
-        m_size += size;
+        return m_largePageSize != 0 ? m_largePageSize : m_pageSize;
     }
 
-    zp_size_t MallocAllocatorPolicy::allocated() const
+    zp_size_t SystemPageMemoryStorage::committed() const
     {
-        return m_allocated;
+        return m_committedSize;
     }
 
-    zp_size_t MallocAllocatorPolicy::total() const
+    zp_bool_t SystemPageMemoryStorage::is_fixed() const
     {
-        return m_size;
+        return false;
     }
+}
 
-    void* MallocAllocatorPolicy::allocate( zp_size_t size, zp_size_t alignment )
+namespace zp
+{
+    namespace
     {
-#if ZP_USE_MEMORY_PROFILER
-        const zp_size_t allocatedSize = size + sizeof( MallocHeader );
-#else
-        const zp_size_t allocatedSize = size;
-#endif
+        struct MemoryLabelCounters
+        {
+            zp_int64_t liveBytes;
+            zp_int64_t liveCount;
+            zp_int64_t peakBytes;
+            zp_int64_t allocations;
+            zp_int64_t frees;
+            zp_int64_t histogram[ kMemoryHistogramBucketCount ];
+        };
 
-        void* mem = ::_aligned_malloc( allocatedSize, alignment );
-        ZP_ASSERT( mem );
+        enum
+        {
+            kMaxMemoryPressureCallbacks = 8,
+        };
 
-#if ZP_USE_MEMORY_PROFILER
-        if( mem )
+        struct MemoryStatsContext
         {
-            m_allocated += allocatedSize;
+            FixedArray<MemoryLabelCounters, kMaxMemoryLabels> counters;
+            FixedArray<MemoryLabelStats, kMaxMemoryLabels> stats;
+            FixedArray<zp_int64_t, kMaxMemoryLabels> allocationSnapshots;
+            FixedArray<zp_int64_t, kMaxMemoryLabels> freeSnapshots;
 
-            MallocHeader* header = reinterpret_cast<MallocHeader*>( mem );
-            header->allocatedSize = allocatedSize;
+            FixedArray<MemoryBudget, kMaxMemoryLabels> budgets;
+            zp_uint32_t pressuredLabels;
 
-            mem = header + 1;
-        }
-#endif
+            MemoryPressureCallback pressureCallbacks[ kMaxMemoryPressureCallbacks ];
+            void* pressureCallbackUserData[ kMaxMemoryPressureCallbacks ];
+            zp_size_t pressureCallbackCount;
 
-        return mem;
-    }
+            MemoryBudgetExceededHandler budgetExceededHandler;
+        };
 
-    void* MallocAllocatorPolicy::reallocate( void* ptr, zp_size_t size, zp_size_t alignment )
-    {
-        void* mem;
+        MemoryStatsContext s_memoryStats;
 
-#if ZP_USE_MEMORY_PROFILER
-        if( ptr )
+        void DefaultMemoryBudgetExceededHandler( MemoryLabel memoryLabel, zp_size_t liveBytes, zp_size_t hardLimit );
+
+        // hard budgets are checked before allocating, see TrackedMemoryProfiler::within_budget
+        void CheckMemoryBudget( MemoryLabel memoryLabel, zp_int64_t liveBytes )
         {
-            MallocHeader* header = reinterpret_cast<MallocHeader*>( ptr ) - 1;
-            m_allocated -= header->allocatedSize;
+            const MemoryBudget& budget = s_memoryStats.budgets[ memoryLabel ];
+            const zp_size_t size = static_cast<zp_size_t>( liveBytes );
 
-            ptr = header;
+            if( budget.softLimit != 0 && size > budget.softLimit )
+            {
+                // picked up by ProcessMemoryPressure at the next frame boundary
+                const zp_uint32_t labelBit = 1u << memoryLabel;
+                if( ( Atomic::LoadAcquire( &s_memoryStats.pressuredLabels ) & labelBit ) == 0 )
+                {
+                    Atomic::Or( &s_memoryStats.pressuredLabels, labelBit );
+                }
+            }
         }
 
-        const zp_size_t allocatedSize = size + sizeof( MallocHeader );
-        mem = ::_aligned_realloc( ptr, allocatedSize, alignment );
+        zp_size_t GetBudgetedLiveBytes( MemoryLabel memoryLabel, zp_size_t size, zp_size_t releasedSize )
+        {
+            const zp_size_t liveBytes = static_cast<zp_size_t>( zp_max( Atomic::LoadAcquire( &s_memoryStats.counters[ memoryLabel ].liveBytes ), static_cast<zp_int64_t>( 0 ) ) );
+            return liveBytes - zp_min( liveBytes, releasedSize ) + size;
+        }
 
-        if( mem )
+        zp_int64_t AddLiveAllocation( MemoryLabelCounters& counters, zp_size_t size )
         {
-            m_allocated += allocatedSize;
+            Atomic::Increment( &counters.allocations );
+            Atomic::Increment( &counters.liveCount );
+            Atomic::Increment( &counters.histogram[ GetMemoryHistogramBucket( size ) ] );
 
-            MallocHeader* header = reinterpret_cast<MallocHeader*>( mem );
-            header->allocatedSize = allocatedSize;
+            const zp_int64_t liveBytes = Atomic::Add( &counters.liveBytes, static_cast<zp_int64_t>( size ) );
 
-            mem = header + 1;
+            // only contended while the peak is still climbing
+            zp_int64_t peakBytes = Atomic::LoadRelaxed( &counters.peakBytes );
+            while( liveBytes > peakBytes )
+            {
+                const zp_int64_t prevPeakBytes = Atomic::CompareExchange( &counters.peakBytes, liveBytes, peakBytes );
+                if( prevPeakBytes == peakBytes )
+                {
+                    break;
+                }
+
+                peakBytes = prevPeakBytes;
+            }
+
+            return liveBytes;
         }
-#else
-            mem = _aligned_realloc( ptr, size, alignment );
-#endif
-        ZP_ASSERT( mem );
-        return mem;
-    }
 
-    void MallocAllocatorPolicy::free( void* ptr )
-    {
-#if ZP_USE_MEMORY_PROFILER
-        if( ptr )
+        void RemoveLiveAllocation( MemoryLabelCounters& counters, zp_size_t size )
         {
-            MallocHeader* header = reinterpret_cast<MallocHeader*>( ptr ) - 1;
-            m_allocated -= header->allocatedSize;
+            Atomic::Increment( &counters.frees );
+            Atomic::Decrement( &counters.liveCount );
+            Atomic::Decrement( &counters.histogram[ GetMemoryHistogramBucket( size ) ] );
+            Atomic::Add( &counters.liveBytes, -static_cast<zp_int64_t>( size ) );
+        }
 
-            ptr = header;
+        zp_size_t TakeMemoryCounterDelta( const zp_int64_t& counter, zp_int64_t& snapshot )
+        {
+            const zp_int64_t value = Atomic::LoadRelaxed( &counter );
+            const zp_int64_t delta = value - snapshot;
+
+            snapshot = value;
+
+            return static_cast<zp_size_t>( delta );
         }
-#endif
 
-        _aligned_free( ptr );
+#if ZP_USE_PROFILER
+        void SnapshotMemoryStatsOnAdvanceFrame( zp_uint64_t frameIndex, void* userData )
+        {
+            SnapshotMemoryStats( false );
+        }
+#endif
     }
-}
 
-namespace zp
-{
-    void LinearAllocatorPolicy::add_memory( void* mem, zp_size_t size )
+#if ZP_USE_MEMORY_SAMPLER
+    namespace
     {
-        m_ptr = mem;
-        m_allocated = 0;
-        m_size = size;
-    }
+        // sampling rate is rechecked at this interval while sampling is disabled
+        constexpr zp_size_t kMemorySamplerRecheckInterval = 1 MB;
 
-    zp_size_t LinearAllocatorPolicy::allocated() const
-    {
-        return m_allocated;
-    }
+        constexpr zp_size_t kMaxMemorySampleProbeCount = 32;
 
-    zp_size_t LinearAllocatorPolicy::total() const
-    {
-        return m_size;
-    }
+        // tombstones lengthen every probe, past this many the table is rebuilt in place
+        constexpr zp_size_t kMaxMemorySampleTombstones = kMaxMemorySamples / 4;
 
-    zp_size_t LinearAllocatorPolicy::overhead() const
-    {
-        return 0;
-    }
+        ZP_STATIC_ASSERT( zp_is_pow2( kMaxMemorySamples ) );
 
-    void* LinearAllocatorPolicy::allocate( zp_size_t size, zp_size_t alignment )
-    {
-        zp_uint8_t* mem = static_cast<zp_uint8_t*>( m_ptr ) + m_allocated;
-        m_allocated += size;
-        return mem;
-    }
+        struct MemorySample
+        {
+            void* ptr;
+            zp_size_t size;
+            MemoryLabel memoryLabel;
+            StackTrace stackTrace;
+        };
 
-    void* LinearAllocatorPolicy::reallocate( void* ptr, zp_size_t size, zp_size_t alignment )
-    {
-        zp_uint8_t* mem = static_cast<zp_uint8_t*>( m_ptr ) + m_allocated;
-        m_allocated += size;
-        return mem;
-    }
+        // open addressed by pointer under the lock, freed slots are left as tombstones until they're rebuilt away.
+        // homeSlotSamples counts live samples per home slot, frees whose home slot has none skip the lock and the table
+        struct MemorySamplerContext
+        {
+            FixedArray<MemorySample, kMaxMemorySamples> samples;
+            FixedArray<zp_uint32_t, kMaxMemorySamples> homeSlotSamples;
+            zp_size_t tombstones;
+            zp_int64_t samplingRate;
+            zp_int64_t liveSamples;
+            zp_int64_t droppedSamples;
+            zp_int32_t lock;
+        };
 
-    void LinearAllocatorPolicy::free( void* ptr )
-    {
-        // no-op
-    }
+        MemorySamplerContext s_memorySampler {
+            .samplingRate = kDefaultMemorySamplingRate,
+        };
 
-    void LinearAllocatorPolicy::reset()
-    {
-        m_allocated = 0;
-    }
-}
+        struct MemorySamplerThreadData
+        {
+            zp_size_t bytesUntilSample;
+            zp_uint64_t rng;
+        };
 
-namespace zp
-{
-    void TlsfAllocatorPolicy::add_memory( void* mem, zp_size_t size )
-    {
-        if( m_tlsf == nullptr )
+        thread_local MemorySamplerThreadData t_memorySampler;
+
+        void* const kMemorySampleTombstone = reinterpret_cast<void*>( 1 );
+
+        void AcquireMemorySamplerLock()
         {
-            m_tlsf = tlsf_create_with_pool( mem, size );
-            m_size += size - ( tlsf_size() + tlsf_pool_overhead() );
+            while( Atomic::CompareExchange( &s_memorySampler.lock, 1, 0 ) != 0 )
+            {
+                Platform::YieldCurrentThread();
+            }
         }
-        else
+
+        void ReleaseMemorySamplerLock()
         {
-            tlsf_add_pool( m_tlsf, mem, size );
-            m_size += size - tlsf_pool_overhead();
+            Atomic::Exchange( &s_memorySampler.lock, 0 );
         }
-    }
 
-    zp_size_t TlsfAllocatorPolicy::allocated() const
-    {
-        return m_allocated;
-    }
+        zp_size_t GetMemorySampleSlot( const void* ptr )
+        {
+            const zp_uint64_t hash = ( static_cast<zp_uint64_t>( reinterpret_cast<zp_ptr_t>( ptr ) ) >> 4 ) * 0x9E3779B97F4A7C15ull;
+            return static_cast<zp_size_t>( hash >> 32 ) & ( kMaxMemorySamples - 1 );
+        }
 
-    zp_size_t TlsfAllocatorPolicy::total() const
-    {
-        return m_size;
-    }
+        // exponentially distributed around the sampling rate so periodic allocation patterns don't bias the samples
+        zp_size_t PickNextSampleInterval( MemorySamplerThreadData& threadData, zp_size_t samplingRate )
+        {
+            zp_uint64_t x = threadData.rng;
+            x ^= x >> 12;
+            x ^= x << 25;
+            x ^= x >> 27;
+            threadData.rng = x;
 
-    zp_size_t TlsfAllocatorPolicy::overhead() const
-    {
-        return m_tlsf == nullptr ? tlsf_size() + tlsf_pool_overhead() : tlsf_pool_overhead();
-    }
+            // uniform in (0, 1]
+            const zp_float64_t u = static_cast<zp_float64_t>( ( ( x * 0x2545F4914F6CDD1Dull ) >> 11 ) + 1 ) * ( 1.0 / 9007199254740992.0 );
+            const zp_float64_t interval = -::log( u ) * static_cast<zp_float64_t>( samplingRate );
 
-    void* TlsfAllocatorPolicy::allocate( zp_size_t size, zp_size_t alignment )
-    {
-        void* mem = tlsf_memalign( m_tlsf, alignment, size );
-        m_allocated += tlsf_block_size( mem );
-        return mem;
-    }
+            return static_cast<zp_size_t>( interval ) + 1;
+        }
 
-    void* TlsfAllocatorPolicy::reallocate( void* ptr, zp_size_t size, zp_size_t alignment )
-    {
-        m_allocated -= tlsf_block_size( ptr );
-        void* mem = tlsf_realloc( m_tlsf, ptr, size );
-        m_allocated += tlsf_block_size( mem );
-        return mem;
-    }
+        void RecordMemorySample( void* ptr, zp_size_t size, MemoryLabel memoryLabel )
+        {
+            StackTrace stackTrace;
+            Platform::GetStackTrace( stackTrace, 1 );
+
+            zp_bool_t recorded = false;
+
+            AcquireMemorySamplerLock();
+
+            const zp_size_t slot = GetMemorySampleSlot( ptr );
+            for( zp_size_t i = 0; i < kMaxMemorySampleProbeCount && !recorded; ++i )
+            {
+                MemorySample& sample = s_memorySampler.samples[ ( slot + i ) & ( kMaxMemorySamples - 1 ) ];
+                if( sample.ptr == nullptr || sample.ptr == kMemorySampleTombstone )
+                {
+                    if( sample.ptr == kMemorySampleTombstone )
+                    {
+                        --s_memorySampler.tombstones;
+                    }
+
+                    Atomic::Increment( &s_memorySampler.homeSlotSamples[ slot ] );
+
+                    sample.size = size;
+                    sample.memoryLabel = memoryLabel;
+                    sample.stackTrace = stackTrace;
+                    sample.ptr = ptr;
+
+                    recorded = true;
+                }
+            }
+
+            ReleaseMemorySamplerLock();
+
+            Atomic::Increment( recorded ? &s_memorySampler.liveSamples : &s_memorySampler.droppedSamples );
+        }
+
+        void SampleMemoryAllocationSlow( MemorySamplerThreadData& threadData, void* ptr, zp_size_t size, MemoryLabel memoryLabel )
+        {
+            const zp_size_t samplingRate = static_cast<zp_size_t>( Atomic::LoadRelaxed( &s_memorySampler.samplingRate ) );
+
+            // the first allocation on a thread only seeds its sampler
+            const zp_bool_t seeded = threadData.rng != 0;
+            if( !seeded )
+            {
+                threadData.rng = ( ( static_cast<zp_uint64_t>( Platform::GetCurrentThreadId() ) << 32 ) ^ Platform::TimeCycles() ) | 1;
+            }
+
+            if( samplingRate == 0 )
+            {
+                threadData.bytesUntilSample = kMemorySamplerRecheckInterval;
+                return;
+            }
+
+            if( seeded )
+            {
+                RecordMemorySample( ptr, size, memoryLabel );
+            }
+
+            threadData.bytesUntilSample = PickNextSampleInterval( threadData, samplingRate );
+        }
+
+        ZP_FORCEINLINE void SampleMemoryAllocation( void* ptr, zp_size_t size, MemoryLabel memoryLabel )
+        {
+            MemorySamplerThreadData& threadData = t_memorySampler;
+            if( threadData.bytesUntilSample > size )
+            {
+                threadData.bytesUntilSample -= size;
+                return;
+            }
+
+            SampleMemoryAllocationSlow( threadData, ptr, size, memoryLabel );
+        }
+
+        // called with the lock held. Tombstones are cleared, then every sample after an empty slot (which no probe
+        // sequence crosses) is re-inserted in probe order, which only ever moves a sample back towards its home slot
+        void RebuildMemorySamples()
+        {
+            zp_size_t emptySlot = 0;
+            while( emptySlot < kMaxMemorySamples && s_memorySampler.samples[ emptySlot ].ptr != nullptr )
+            {
+                ++emptySlot;
+            }
+
+            // every slot is live or a tombstone, nothing to start from. Records keep reusing the tombstones
+            if( emptySlot == kMaxMemorySamples )
+            {
+                return;
+            }
+
+            for( MemorySample& sample : s_memorySampler.samples )
+            {
+                if( sample.ptr == kMemorySampleTombstone )
+                {
+                    sample.ptr = nullptr;
+                }
+            }
+
+            s_memorySampler.tombstones = 0;
+
+            for( zp_size_t i = 1; i < kMaxMemorySamples; ++i )
+            {
+                MemorySample& sample = s_memorySampler.samples[ ( emptySlot + i ) & ( kMaxMemorySamples - 1 ) ];
+                if( sample.ptr == nullptr )
+                {
+                    continue;
+                }
+
+                void* samplePtr = sample.ptr;
+                sample.ptr = nullptr;
+
+                const zp_size_t slot = GetMemorySampleSlot( samplePtr );
+                for( zp_size_t p = 0;; ++p )
+                {
+                    MemorySample& target = s_memorySampler.samples[ ( slot + p ) & ( kMaxMemorySamples - 1 ) ];
+                    if( target.ptr == nullptr )
+                    {
+                        if( &target != &sample )
+                        {
+                            target = sample;
+                        }
+
+                        target.ptr = samplePtr;
+                        break;
+                    }
+                }
+            }
+        }
+
+        void UnsampleMemoryAllocation( void* ptr )
+        {
+            const zp_size_t slot = GetMemorySampleSlot( ptr );
+
+            // almost every free lands here, ptr can't have been sampled
+            if( Atomic::LoadAcquire( &s_memorySampler.homeSlotSamples[ slot ] ) == 0 )
+            {
+                return;
+            }
+
+            zp_bool_t unsampled = false;
+
+            AcquireMemorySamplerLock();
+
+            for( zp_size_t i = 0; i < kMaxMemorySampleProbeCount; ++i )
+            {
+                MemorySample& sample = s_memorySampler.samples[ ( slot + i ) & ( kMaxMemorySamples - 1 ) ];
+                if( sample.ptr == nullptr )
+                {
+                    break;
+                }
+
+                if( sample.ptr == ptr )
+                {
+                    sample.ptr = kMemorySampleTombstone;
+
+                    Atomic::Decrement( &s_memorySampler.homeSlotSamples[ slot ] );
+
+                    if( ++s_memorySampler.tombstones > kMaxMemorySampleTombstones )
+                    {
+                        RebuildMemorySamples();
+                    }
+
+                    unsampled = true;
+                    break;
+                }
+            }
+
+            ReleaseMemorySamplerLock();
+
+            if( unsampled )
+            {
+                Atomic::Decrement( &s_memorySampler.liveSamples );
+            }
+        }
+
+        zp_bool_t CopyLiveMemorySample( zp_size_t index, MemorySample& sample )
+        {
+            AcquireMemorySamplerLock();
+
+            const MemorySample& src = s_memorySampler.samples[ index ];
+            const zp_bool_t live = src.ptr != nullptr && src.ptr != kMemorySampleTombstone;
+            if( live )
+            {
+                sample = src;
+            }
+
+            ReleaseMemorySamplerLock();
+
+            return live;
+        }
+
+        void WriteMemorySamplesPprof( DataStreamWriter& writer, zp_size_t samplingRate )
+        {
+            char line[ 128 ];
+            zp_int32_t length;
+
+            MemorySample sample;
+
+            zp_size_t liveCount = 0;
+            zp_size_t liveBytes = 0;
+            for( zp_size_t i = 0; i < kMaxMemorySamples; ++i )
+            {
+                if( CopyLiveMemorySample( i, sample ) )
+                {
+                    ++liveCount;
+                    liveBytes += sample.size;
+                }
+            }
+
+            // sampled values, pprof scales them back up from the rate
+            length = zp_snprintf( line, "heap profile: %zu: %zu [%zu: %zu] @ heap_v2/%zu\n", liveCount, liveBytes, liveCount, liveBytes, samplingRate );
+            writer.write( line, length );
+
+            for( zp_size_t i = 0; i < kMaxMemorySamples; ++i )
+            {
+                if( !CopyLiveMemorySample( i, sample ) )
+                {
+                    continue;
+                }
+
+                length = zp_snprintf( line, "1: %zu [1: %zu] @", sample.size, sample.size );
+                writer.write( line, length );
+
+                for( zp_size_t f = 0; f < sample.stackTrace.length; ++f )
+                {
+                    length = zp_snprintf( line, " 0x%llx", static_cast<unsigned long long>( reinterpret_cast<zp_ptr_t>( sample.stackTrace.stack[ f ] ) ) );
+                    writer.write( line, length );
+                }
+
+                writer.write( "\n" );
+            }
+        }
+
+        void WriteMemorySamplesFolded( DataStreamWriter& writer, zp_size_t samplingRate )
+        {
+            char line[ 128 ];
+            zp_int32_t length;
+
+            zp_char8_t symbols[ 8 KB ];
+
+            MemorySample sample;
+
+            for( zp_size_t i = 0; i < kMaxMemorySamples; ++i )
+            {
+                if( !CopyLiveMemorySample( i, sample ) )
+                {
+                    continue;
+                }
+
+                length = zp_snprintf( line, "MemoryLabel_%u", static_cast<zp_uint32_t>( sample.memoryLabel ) );
+                writer.write( line, length );
+
+                MutableString symbolString( symbols, sizeof( symbols ) - 1 );
+                Platform::StackTraceToString( sample.stackTrace, symbolString );
+
+                if( symbolString.empty() )
+                {
+                    // no symbols, root frame is last
+                    for( zp_size_t f = sample.stackTrace.length; f > 0; --f )
+                    {
+                        length = zp_snprintf( line, ";0x%llx", static_cast<unsigned long long>( reinterpret_cast<zp_ptr_t>( sample.stackTrace.stack[ f - 1 ] ) ) );
+                        writer.write( line, length );
+                    }
+                }
+                else
+                {
+                    // one symbol per line, root frame is last
+                    const char* begin = symbolString.c_str();
+                    const char* end = begin + symbolString.length();
+                    while( end > begin )
+                    {
+                        const char* symbolEnd = end[ -1 ] == '\n' ? end - 1 : end;
+                        const char* symbolBegin = symbolEnd;
+                        while( symbolBegin > begin && symbolBegin[ -1 ] != '\n' )
+                        {
+                            --symbolBegin;
+                        }
+
+                        writer.write( ";" );
+                        writer.write( symbolBegin, static_cast<zp_size_t>( symbolEnd - symbolBegin ) );
+
+                        end = symbolBegin;
+                    }
+                }
+
+                // estimated bytes this sample stands for
+                const zp_float64_t size = static_cast<zp_float64_t>( sample.size );
+                const zp_float64_t scale = 1.0 / ( 1.0 - ::exp( -size / static_cast<zp_float64_t>( zp_max( samplingRate, static_cast<zp_size_t>( 1 ) ) ) ) );
+
+                length = zp_snprintf( line, " %zu\n", static_cast<zp_size_t>( size * scale ) );
+                writer.write( line, length );
+            }
+        }
+    }
+#endif
+
+    zp_size_t GetMemoryHistogramBucket( zp_size_t size )
+    {
+        zp_size_t bucket = 0;
+        while( bucket < ( kMemoryHistogramBucketCount - 1 ) && size > ( static_cast<zp_size_t>( 16 ) << bucket ) )
+        {
+            ++bucket;
+        }
+
+        return bucket;
+    }
+
+    void TrackedMemoryProfiler::track_allocate( void* ptr, zp_size_t size, zp_size_t alignment, MemoryLabel memoryLabel )
+    {
+#if ZP_USE_MEMORY_PROFILER
+        if( ptr )
+        {
+            CheckMemoryBudget( memoryLabel, AddLiveAllocation( s_memoryStats.counters[ memoryLabel ], size ) );
+        }
+#endif
+
+#if ZP_USE_MEMORY_SAMPLER
+        if( ptr )
+        {
+            SampleMemoryAllocation( ptr, size, memoryLabel );
+        }
+#endif
+    }
+
+    void TrackedMemoryProfiler::track_reallocate( void* oldPtr, zp_size_t oldSize, void* ptr, zp_size_t size, zp_size_t alignment, MemoryLabel memoryLabel )
+    {
+#if ZP_USE_MEMORY_PROFILER
+        MemoryLabelCounters& counters = s_memoryStats.counters[ memoryLabel ];
+
+        if( oldPtr )
+        {
+            RemoveLiveAllocation( counters, oldSize );
+        }
+
+        if( ptr )
+        {
+            CheckMemoryBudget( memoryLabel, AddLiveAllocation( counters, size ) );
+        }
+#endif
+
+#if ZP_USE_MEMORY_SAMPLER
+        if( oldPtr )
+        {
+            UnsampleMemoryAllocation( oldPtr );
+        }
+
+        if( ptr )
+        {
+            SampleMemoryAllocation( ptr, size, memoryLabel );
+        }
+#endif
+    }
+
+    zp_bool_t TrackedMemoryProfiler::within_budget( zp_size_t size, zp_size_t releasedSize, MemoryLabel memoryLabel ) const
+    {
+#if ZP_USE_MEMORY_PROFILER
+        const zp_size_t hardLimit = s_memoryStats.budgets[ memoryLabel ].hardLimit;
+        return hardLimit == 0 || GetBudgetedLiveBytes( memoryLabel, size, releasedSize ) <= hardLimit;
+#else
+        return true;
+#endif
+    }
+
+    void TrackedMemoryProfiler::report_over_budget( zp_size_t size, zp_size_t releasedSize, MemoryLabel memoryLabel ) const
+    {
+#if ZP_USE_MEMORY_PROFILER
+        MemoryBudgetExceededHandler handler = s_memoryStats.budgetExceededHandler;
+        ( handler ? handler : DefaultMemoryBudgetExceededHandler )( memoryLabel, GetBudgetedLiveBytes( memoryLabel, size, releasedSize ), s_memoryStats.budgets[ memoryLabel ].hardLimit );
+#endif
+    }
+
+    void TrackedMemoryProfiler::track_free( void* ptr, zp_size_t size, MemoryLabel memoryLabel )
+    {
+#if ZP_USE_MEMORY_PROFILER
+        if( ptr )
+        {
+            RemoveLiveAllocation( s_memoryStats.counters[ memoryLabel ], size );
+        }
+#endif
+
+#if ZP_USE_MEMORY_SAMPLER
+        if( ptr )
+        {
+            UnsampleMemoryAllocation( ptr );
+        }
+#endif
+    }
+
+    void SnapshotMemoryStats( zp_bool_t includeHeapStats )
+    {
+        for( zp_size_t i = 0; i < MemoryLabels::MemoryLabels_Count; ++i )
+        {
+            const MemoryLabelCounters& counters = s_memoryStats.counters[ i ];
+            MemoryLabelStats& stats = s_memoryStats.stats[ i ];
+
+            stats.liveBytes = static_cast<zp_size_t>( Atomic::LoadRelaxed( &counters.liveBytes ) );
+            stats.liveCount = static_cast<zp_size_t>( Atomic::LoadRelaxed( &counters.liveCount ) );
+            stats.peakBytes = static_cast<zp_size_t>( Atomic::LoadRelaxed( &counters.peakBytes ) );
+            stats.allocations = TakeMemoryCounterDelta( counters.allocations, s_memoryStats.allocationSnapshots[ i ] );
+            stats.frees = TakeMemoryCounterDelta( counters.frees, s_memoryStats.freeSnapshots[ i ] );
+
+            for( zp_size_t b = 0; b < kMemoryHistogramBucketCount; ++b )
+            {
+                stats.histogram[ b ] = static_cast<zp_size_t>( Atomic::LoadRelaxed( &counters.histogram[ b ] ) );
+            }
+
+            const zp_uint32_t track = static_cast<zp_uint32_t>( i );
+            ZP_PROFILE_COUNTER( "Memory.LiveBytes", static_cast<zp_int64_t>( stats.liveBytes ), track );
+            ZP_PROFILE_COUNTER( "Memory.LiveCount", static_cast<zp_int64_t>( stats.liveCount ), track );
+            ZP_PROFILE_COUNTER( "Memory.PeakBytes", static_cast<zp_int64_t>( stats.peakBytes ), track );
+            ZP_PROFILE_COUNTER( "Memory.Allocations", static_cast<zp_int64_t>( stats.allocations ), track );
+            ZP_PROFILE_COUNTER( "Memory.Frees", static_cast<zp_int64_t>( stats.frees ), track );
+
+            IMemoryAllocator* allocator = s_memoryAllocators[ i ];
+            if( includeHeapStats && allocator )
+            {
+                allocator->queryHeapStats( stats.heapStats );
+
+                ZP_PROFILE_COUNTER( "Memory.FreeBytes", static_cast<zp_int64_t>( stats.heapStats.freeBytes ), track );
+                ZP_PROFILE_COUNTER( "Memory.LargestFreeBlock", static_cast<zp_int64_t>( stats.heapStats.largestFreeBlock ), track );
+            }
+        }
+    }
+
+    zp_size_t GetMemoryLabelStats( MemoryLabelStats* labelStats, zp_size_t labelStatsCount )
+    {
+        const zp_size_t count = zp_min( labelStatsCount, static_cast<zp_size_t>( MemoryLabels::MemoryLabels_Count ) );
+        for( zp_size_t i = 0; i < count; ++i )
+        {
+            labelStats[ i ] = s_memoryStats.stats[ i ];
+        }
+
+        return count;
+    }
+
+    void RegisterMemoryStatsSnapshot()
+    {
+#if ZP_USE_PROFILER
+        Profiler::RegisterAdvanceFrameCallback( SnapshotMemoryStatsOnAdvanceFrame, nullptr );
+#endif
+    }
+
+    void UnregisterMemoryStatsSnapshot()
+    {
+#if ZP_USE_PROFILER
+        Profiler::UnregisterAdvanceFrameCallback( SnapshotMemoryStatsOnAdvanceFrame, nullptr );
+#endif
+    }
+
+    void SetMemorySamplingRate( zp_size_t samplingRate )
+    {
+#if ZP_USE_MEMORY_SAMPLER
+        Atomic::StoreRelaxed( &s_memorySampler.samplingRate, static_cast<zp_int64_t>( samplingRate ) );
+
+        // calling thread starts a new interval straight away
+        t_memorySampler.bytesUntilSample = 0;
+#endif
+    }
+
+    MemorySamplerStats GetMemorySamplerStats()
+    {
+#if ZP_USE_MEMORY_SAMPLER
+        return {
+            .liveSamples = static_cast<zp_size_t>( Atomic::LoadRelaxed( &s_memorySampler.liveSamples ) ),
+            .droppedSamples = static_cast<zp_size_t>( Atomic::LoadRelaxed( &s_memorySampler.droppedSamples ) ),
+            .samplingRate = static_cast<zp_size_t>( Atomic::LoadRelaxed( &s_memorySampler.samplingRate ) ),
+        };
+#else
+        return {};
+#endif
+    }
+
+    void WriteMemorySamples( DataStreamWriter& writer, MemorySampleFormat format )
+    {
+#if ZP_USE_MEMORY_SAMPLER
+        const zp_size_t samplingRate = static_cast<zp_size_t>( Atomic::LoadRelaxed( &s_memorySampler.samplingRate ) );
+
+        switch( format )
+        {
+            case MemorySampleFormat::Pprof:
+                WriteMemorySamplesPprof( writer, samplingRate );
+                break;
+
+            case MemorySampleFormat::Folded:
+                WriteMemorySamplesFolded( writer, samplingRate );
+                break;
+
+            default:
+                ZP_INVALID_CODE_PATH();
+                break;
+        }
+#endif
+    }
+
+    void SetMemoryBudget( MemoryLabel memoryLabel, const MemoryBudget& budget )
+    {
+        ZP_ASSERT( budget.hardLimit == 0 || budget.softLimit <= budget.hardLimit );
+
+        s_memoryStats.budgets[ memoryLabel ] = budget;
+    }
+
+    MemoryBudget GetMemoryBudget( MemoryLabel memoryLabel )
+    {
+        return s_memoryStats.budgets[ memoryLabel ];
+    }
+
+    void RegisterMemoryPressureCallback( MemoryPressureCallback callback, void* userData )
+    {
+        ZP_ASSERT( s_memoryStats.pressureCallbackCount < kMaxMemoryPressureCallbacks );
+
+        const zp_size_t index = s_memoryStats.pressureCallbackCount++;
+        s_memoryStats.pressureCallbacks[ index ] = callback;
+        s_memoryStats.pressureCallbackUserData[ index ] = userData;
+    }
+
+    void UnregisterMemoryPressureCallback( MemoryPressureCallback callback, void* userData )
+    {
+        for( zp_size_t i = 0; i < s_memoryStats.pressureCallbackCount; ++i )
+        {
+            if( s_memoryStats.pressureCallbacks[ i ] == callback && s_memoryStats.pressureCallbackUserData[ i ] == userData )
+            {
+                --s_memoryStats.pressureCallbackCount;
+
+                s_memoryStats.pressureCallbacks[ i ] = s_memoryStats.pressureCallbacks[ s_memoryStats.pressureCallbackCount ];
+                s_memoryStats.pressureCallbackUserData[ i ] = s_memoryStats.pressureCallbackUserData[ s_memoryStats.pressureCallbackCount ];
+                break;
+            }
+        }
+    }
+
+    void ProcessMemoryPressure()
+    {
+        const zp_uint32_t pressuredLabels = Atomic::Exchange( &s_memoryStats.pressuredLabels, 0u );
+        if( pressuredLabels == 0 )
+        {
+            return;
+        }
+
+        for( MemoryLabel memoryLabel = 0; memoryLabel < MemoryLabels::MemoryLabels_Count; ++memoryLabel )
+        {
+            if( ( pressuredLabels & ( 1u << memoryLabel ) ) == 0 )
+            {
+                continue;
+            }
+
+            // callbacks from earlier labels may have already freed enough
+            const zp_size_t liveBytes = static_cast<zp_size_t>( Atomic::LoadRelaxed( &s_memoryStats.counters[ memoryLabel ].liveBytes ) );
+            const zp_size_t softLimit = s_memoryStats.budgets[ memoryLabel ].softLimit;
+            if( liveBytes <= softLimit )
+            {
+                continue;
+            }
+
+            for( zp_size_t i = 0; i < s_memoryStats.pressureCallbackCount; ++i )
+            {
+                s_memoryStats.pressureCallbacks[ i ]( memoryLabel, liveBytes, softLimit, s_memoryStats.pressureCallbackUserData[ i ] );
+            }
+        }
+    }
+
+    void SetMemoryBudgetExceededHandler( MemoryBudgetExceededHandler handler )
+    {
+        s_memoryStats.budgetExceededHandler = handler;
+    }
+
+    void PrintTopMemoryConsumers( MemoryLabel memoryLabel )
+    {
+        constexpr zp_size_t kTopConsumerCount = 5;
+
+        // labels by live bytes
+        FixedArray<MemoryLabel, kMaxMemoryLabels> labels;
+        for( MemoryLabel i = 0; i < MemoryLabels::MemoryLabels_Count; ++i )
+        {
+            labels[ i ] = i;
+        }
+
+        for( zp_size_t i = 1; i < MemoryLabels::MemoryLabels_Count; ++i )
+        {
+            for( zp_size_t j = i; j > 0 && Atomic::LoadRelaxed( &s_memoryStats.counters[ labels[ j - 1 ] ].liveBytes ) < Atomic::LoadRelaxed( &s_memoryStats.counters[ labels[ j ] ].liveBytes ); --j )
+            {
+                zp_swap( labels[ j - 1 ], labels[ j ] );
+            }
+        }
+
+        zp_error_printfln( "Top memory labels:" );
+        for( zp_size_t i = 0; i < MemoryLabels::MemoryLabels_Count; ++i )
+        {
+            const MemoryLabelCounters& counters = s_memoryStats.counters[ labels[ i ] ];
+            const MemoryBudget& budget = s_memoryStats.budgets[ labels[ i ] ];
+
+            zp_error_printfln( "  label %u: %lld bytes live in %lld allocations, peak %lld bytes, budget %zu/%zu",
+                static_cast<zp_uint32_t>( labels[ i ] ),
+                Atomic::LoadRelaxed( &counters.liveBytes ),
+                Atomic::LoadRelaxed( &counters.liveCount ),
+                Atomic::LoadRelaxed( &counters.peakBytes ),
+                budget.softLimit,
+                budget.hardLimit );
+        }
+
+#if ZP_USE_MEMORY_SAMPLER
+        // sampled call stacks of the label, summed by stack
+        struct StackConsumer
+        {
+            zp_hash64_t hash;
+            zp_size_t bytes;
+            zp_size_t index;
+        };
+
+        StackConsumer consumers[ kTopConsumerCount ] {};
+        zp_size_t consumerCount = 0;
+
+        MemorySample sample;
+        for( zp_size_t i = 0; i < kMaxMemorySamples; ++i )
+        {
+            if( !CopyLiveMemorySample( i, sample ) || sample.memoryLabel != memoryLabel )
+            {
+                continue;
+            }
+
+            zp_size_t c = 0;
+            while( c < consumerCount && consumers[ c ].hash != sample.stackTrace.hash )
+            {
+                ++c;
+            }
+
+            if( c == consumerCount )
+            {
+                if( consumerCount == kTopConsumerCount )
+                {
+                    // replace the smallest when this sample alone is larger
+                    zp_size_t smallest = 0;
+                    for( zp_size_t k = 1; k < consumerCount; ++k )
+                    {
+                        smallest = consumers[ k ].bytes < consumers[ smallest ].bytes ? k : smallest;
+                    }
+
+                    if( consumers[ smallest ].bytes >= sample.size )
+                    {
+                        continue;
+                    }
+
+                    c = smallest;
+                }
+                else
+                {
+                    ++consumerCount;
+                }
+
+                consumers[ c ] = { .hash = sample.stackTrace.hash, .bytes = 0, .index = i };
+            }
+
+            consumers[ c ].bytes += sample.size;
+        }
+
+        zp_error_printfln( "Top sampled call stacks of label %u:", static_cast<zp_uint32_t>( memoryLabel ) );
+        for( zp_size_t c = 0; c < consumerCount; ++c )
+        {
+            if( !CopyLiveMemorySample( consumers[ c ].index, sample ) )
+            {
+                continue;
+            }
+
+            zp_error_printfln( "  %zu sampled bytes", consumers[ c ].bytes );
+            for( zp_size_t f = 0; f < sample.stackTrace.length; ++f )
+            {
+                zp_error_printfln( "    0x%llx", static_cast<unsigned long long>( reinterpret_cast<zp_ptr_t>( sample.stackTrace.stack[ f ] ) ) );
+            }
+        }
+#endif
+    }
+
+    namespace
+    {
+        void DefaultMemoryBudgetExceededHandler( MemoryLabel memoryLabel, zp_size_t liveBytes, zp_size_t hardLimit )
+        {
+            zp_error_printfln( "Memory label %u over its hard budget, %zu of %zu bytes, failing the allocation", static_cast<zp_uint32_t>( memoryLabel ), liveBytes, hardLimit );
+
+            PrintTopMemoryConsumers( memoryLabel );
+        }
+    }
+}
+
+namespace zp
+{
+    void* MallocMemoryStorage::request_memory( zp_size_t size, zp_size_t& requestedSize )
+    {
+        requestedSize = size;
+        void* mem = ::_aligned_malloc( requestedSize, kDefaultMemoryAlignment );
+        return mem;
+    }
+
+    zp_bool_t MallocMemoryStorage::is_fixed() const
+    {
+        return false;
+    }
+
+    //
+    //
+    //
+
+    namespace
+    {
+        struct MallocHeader
+        {
+            zp_size_t allocatedSize;
+        };
+    }
+
+    void MallocAllocatorPolicy::add_memory( void* mem, zp_size_t size )
+    {
+        m_size += size;
+    }
+
+    zp_size_t MallocAllocatorPolicy::allocated() const
+    {
+        return m_allocated;
+    }
+
+    zp_size_t MallocAllocatorPolicy::total() const
+    {
+        return m_size;
+    }
+
+    void* MallocAllocatorPolicy::allocate( zp_size_t size, zp_size_t alignment )
+    {
+#if ZP_USE_MEMORY_PROFILER
+        const zp_size_t allocatedSize = size + sizeof( MallocHeader );
+#else
+        const zp_size_t allocatedSize = size;
+#endif
+
+        void* mem = ::_aligned_malloc( allocatedSize, alignment );
+        ZP_ASSERT( mem );
+
+#if ZP_USE_MEMORY_PROFILER
+        if( mem )
+        {
+            m_allocated += allocatedSize;
+
+            MallocHeader* header = reinterpret_cast<MallocHeader*>( mem );
+            header->allocatedSize = allocatedSize;
+
+            mem = header + 1;
+        }
+#endif
+
+        return mem;
+    }
+
+    void* MallocAllocatorPolicy::reallocate( void* ptr, zp_size_t size, zp_size_t alignment )
+    {
+        void* mem;
+
+#if ZP_USE_MEMORY_PROFILER
+        if( ptr )
+        {
+            MallocHeader* header = reinterpret_cast<MallocHeader*>( ptr ) - 1;
+            m_allocated -= header->allocatedSize;
+
+            ptr = header;
+        }
+
+        const zp_size_t allocatedSize = size + sizeof( MallocHeader );
+        mem = ::_aligned_realloc( ptr, allocatedSize, alignment );
+
+        if( mem )
+        {
+            m_allocated += allocatedSize;
+
+            MallocHeader* header = reinterpret_cast<MallocHeader*>( mem );
+            header->allocatedSize = allocatedSize;
+
+            mem = header + 1;
+        }
+#else
+            mem = _aligned_realloc( ptr, size, alignment );
+#endif
+        ZP_ASSERT( mem );
+        return mem;
+    }
+
+    void MallocAllocatorPolicy::free( void* ptr )
+    {
+#if ZP_USE_MEMORY_PROFILER
+        if( ptr )
+        {
+            MallocHeader* header = reinterpret_cast<MallocHeader*>( ptr ) - 1;
+            m_allocated -= header->allocatedSize;
+
+            ptr = header;
+        }
+#endif
+
+        _aligned_free( ptr );
+    }
+}
+
+namespace zp
+{
+    void LinearAllocatorPolicy::add_memory( void* mem, zp_size_t size )
+    {
+        m_ptr = mem;
+        m_allocated = 0;
+        m_size = size;
+    }
+
+    zp_size_t LinearAllocatorPolicy::allocated() const
+    {
+        return m_allocated;
+    }
+
+    zp_size_t LinearAllocatorPolicy::total() const
+    {
+        return m_size;
+    }
+
+    zp_size_t LinearAllocatorPolicy::overhead() const
+    {
+        return 0;
+    }
+
+    void* LinearAllocatorPolicy::allocate( zp_size_t size, zp_size_t alignment )
+    {
+        zp_uint8_t* mem = static_cast<zp_uint8_t*>( m_ptr ) + m_allocated;
+        m_allocated += size;
+        return mem;
+    }
+
+    void* LinearAllocatorPolicy::reallocate( void* ptr, zp_size_t size, zp_size_t alignment )
+    {
+        zp_uint8_t* mem = static_cast<zp_uint8_t*>( m_ptr ) + m_allocated;
+        m_allocated += size;
+        return mem;
+    }
+
+    void LinearAllocatorPolicy::free( void* ptr )
+    {
+        // no-op
+    }
+
+    void LinearAllocatorPolicy::reset()
+    {
+        m_allocated = 0;
+    }
+}
+
+namespace zp
+{
+    void AtomicLinearAllocatorPolicy::add_memory( void* mem, zp_size_t size )
+    {
+        if( m_ptr == nullptr )
+        {
+            m_ptr = static_cast<zp_uint8_t*>( mem );
+        }
+
+        ZP_ASSERT_MSG( mem == m_ptr + m_size, "Memory has to follow on from the previous pages" );
+
+        Atomic::StoreRelease( &m_size, m_size + static_cast<zp_int64_t>( size ) );
+    }
+
+    zp_size_t AtomicLinearAllocatorPolicy::allocated() const
+    {
+        return static_cast<zp_size_t>( Atomic::LoadAcquire( &m_allocated ) );
+    }
+
+    zp_size_t AtomicLinearAllocatorPolicy::total() const
+    {
+        return static_cast<zp_size_t>( Atomic::LoadAcquire( &m_size ) );
+    }
+
+    zp_size_t AtomicLinearAllocatorPolicy::overhead() const
+    {
+        return 0;
+    }
+
+    void* AtomicLinearAllocatorPolicy::try_allocate( zp_size_t size, zp_size_t alignment )
+    {
+#if ZP_DEBUG_BUILD
+        ZP_ASSERT_MSG( !t_frameMemoryRestricted, "Frame memory can be reset while a background job still uses it" );
+#endif // ZP_DEBUG_BUILD
+
+        // m_ptr is only safe to read once memory has been added
+        if( Atomic::LoadAcquire( &m_size ) == 0 )
+        {
+            return nullptr;
+        }
+
+        const zp_ptr_t base = reinterpret_cast<zp_ptr_t>( m_ptr );
+
+        // every allocation is preceded by its size so reallocate knows how much to copy
+        alignment = zp_max( alignment, static_cast<zp_size_t>( alignof( zp_size_t ) ) );
+
+        zp_int64_t allocated = Atomic::LoadAcquire( &m_allocated );
+        for( ;; )
+        {
+            const zp_int64_t offset = static_cast<zp_int64_t>( zp_align_size( base + allocated + sizeof( zp_size_t ), alignment ) - base );
+            const zp_int64_t end = offset + static_cast<zp_int64_t>( size );
+
+            if( end > Atomic::LoadAcquire( &m_size ) )
+            {
+                return nullptr;
+            }
+
+            const zp_int64_t prevAllocated = Atomic::CompareExchange( &m_allocated, end, allocated );
+            if( prevAllocated == allocated )
+            {
+                zp_uint8_t* mem = m_ptr + offset;
+                *reinterpret_cast<zp_size_t*>( mem - sizeof( zp_size_t ) ) = size;
+                return mem;
+            }
+
+            allocated = prevAllocated;
+        }
+    }
+
+    zp_bool_t AtomicLinearAllocatorPolicy::try_free( void* ptr )
+    {
+        return true;
+    }
+
+    void* AtomicLinearAllocatorPolicy::allocate( zp_size_t size, zp_size_t alignment )
+    {
+        void* mem = try_allocate( size, alignment );
+        ZP_ASSERT_MSG( mem, "Frame memory exhausted" );
+        return mem;
+    }
+
+    void* AtomicLinearAllocatorPolicy::reallocate( void* ptr, zp_size_t size, zp_size_t alignment )
+    {
+        void* mem = allocate( size, alignment );
+        if( ptr && mem )
+        {
+            zp_memcpy( mem, size, ptr, zp_min( block_size( ptr ), size ) );
+        }
+
+        return mem;
+    }
+
+    void AtomicLinearAllocatorPolicy::free( void* ptr )
+    {
+        // no-op
+    }
+
+    zp_size_t AtomicLinearAllocatorPolicy::block_size( void* ptr ) const
+    {
+        return *reinterpret_cast<const zp_size_t*>( static_cast<const zp_uint8_t*>( ptr ) - sizeof( zp_size_t ) );
+    }
+
+    void AtomicLinearAllocatorPolicy::reset()
+    {
+        Atomic::StoreRelease( &m_allocated, 0 );
+    }
+}
+
+namespace zp
+{
+    namespace
+    {
+        // placed in front of every pool added after the first so heap_stats can find them
+        struct TlsfPoolLink
+        {
+            TlsfPoolLink* next;
+            pool_t pool;
+            zp_size_t size;
+        };
+
+        constexpr zp_size_t kTlsfPoolLinkSize = zp_align_size( sizeof( TlsfPoolLink ), kDefaultMemoryAlignment );
+
+        struct TlsfPoolUsage
+        {
+            zp_size_t blockCount;
+            zp_size_t usedBlockCount;
+        };
+
+        void TlsfPoolUsageWalker( void* ptr, size_t size, int used, void* user )
+        {
+            TlsfPoolUsage* usage = static_cast<TlsfPoolUsage*>( user );
+            ++usage->blockCount;
+            usage->usedBlockCount += used ? 1 : 0;
+        }
+
+        void TlsfHeapStatsWalker( void* ptr, size_t size, int used, void* user )
+        {
+            if( !used )
+            {
+                MemoryHeapStats* heapStats = static_cast<MemoryHeapStats*>( user );
+                heapStats->largestFreeBlock = zp_max( heapStats->largestFreeBlock, static_cast<zp_size_t>( size ) );
+                ++heapStats->freeBlockCount;
+            }
+        }
+    }
+
+    void TlsfAllocatorPolicy::add_memory( void* mem, zp_size_t size )
+    {
+        if( m_tlsf == nullptr )
+        {
+            m_tlsf = tlsf_create_with_pool( mem, size );
+            m_size += size - ( tlsf_size() + tlsf_pool_overhead() );
+        }
+        else
+        {
+            TlsfPoolLink* link = static_cast<TlsfPoolLink*>( mem );
+            link->pool = tlsf_add_pool( m_tlsf, ZP_OFFSET_PTR( mem, kTlsfPoolLinkSize ), size - kTlsfPoolLinkSize );
+            link->size = size;
+            link->next = static_cast<TlsfPoolLink*>( m_pools );
+            m_pools = link;
+
+            m_size += size - ( kTlsfPoolLinkSize + tlsf_pool_overhead() );
+        }
+    }
+
+    zp_size_t TlsfAllocatorPolicy::allocated() const
+    {
+        return m_allocated;
+    }
+
+    zp_size_t TlsfAllocatorPolicy::total() const
+    {
+        return m_size;
+    }
+
+    zp_size_t TlsfAllocatorPolicy::overhead() const
+    {
+        return m_tlsf == nullptr ? tlsf_size() + tlsf_pool_overhead() : kTlsfPoolLinkSize + tlsf_pool_overhead();
+    }
+
+    void* TlsfAllocatorPolicy::allocate( zp_size_t size, zp_size_t alignment )
+    {
+        void* mem = tlsf_memalign( m_tlsf, alignment, size );
+        m_allocated += tlsf_block_size( mem );
+        return mem;
+    }
+
+    void* TlsfAllocatorPolicy::reallocate( void* ptr, zp_size_t size, zp_size_t alignment )
+    {
+        m_allocated -= tlsf_block_size( ptr );
+        void* mem = tlsf_realloc( m_tlsf, ptr, size );
+        m_allocated += tlsf_block_size( mem );
+        return mem;
+    }
 
     void TlsfAllocatorPolicy::free( void* ptr )
     {
-        m_allocated -= tlsf_block_size( ptr );
-        tlsf_free( m_tlsf, ptr );
+        m_allocated -= tlsf_block_size( ptr );
+        tlsf_free( m_tlsf, ptr );
+    }
+
+    zp_size_t TlsfAllocatorPolicy::block_size( void* ptr ) const
+    {
+        // frees of the neighbouring block rewrite the flags in the same header word, only read it under the allocator lock
+        return tlsf_block_size( ptr );
+    }
+
+    void TlsfAllocatorPolicy::heap_stats( MemoryHeapStats& heapStats ) const
+    {
+        heapStats.largestFreeBlock = 0;
+        heapStats.freeBlockCount = 0;
+
+        if( m_tlsf == nullptr )
+        {
+            return;
+        }
+
+        tlsf_walk_pool( tlsf_get_pool( m_tlsf ), TlsfHeapStatsWalker, &heapStats );
+
+        for( const TlsfPoolLink* link = static_cast<const TlsfPoolLink*>( m_pools ); link; link = link->next )
+        {
+            tlsf_walk_pool( link->pool, TlsfHeapStatsWalker, &heapStats );
+        }
+    }
+
+    void* TlsfAllocatorPolicy::release_free_pool( zp_size_t& size )
+    {
+        TlsfPoolLink** prevNext = reinterpret_cast<TlsfPoolLink**>( &m_pools );
+        for( TlsfPoolLink* link = *prevNext; link; prevNext = &link->next, link = link->next )
+        {
+            // a free pool is a single free block
+            TlsfPoolUsage usage {};
+            tlsf_walk_pool( link->pool, TlsfPoolUsageWalker, &usage );
+
+            if( usage.blockCount == 1 && usage.usedBlockCount == 0 )
+            {
+                tlsf_remove_pool( m_tlsf, link->pool );
+                *prevNext = link->next;
+
+                m_size -= link->size - ( kTlsfPoolLinkSize + tlsf_pool_overhead() );
+
+                size = link->size;
+                return link;
+            }
+        }
+
+        return nullptr;
+    }
+}
+
+namespace zp
+{
+    namespace
+    {
+        struct ThreadCacheRegistration
+        {
+            void** orphanedBlocks;
+            zp_uint32_t generation;
+        };
+
+        FixedArray<ThreadCacheRegistration, kMaxThreadCacheAllocators> s_threadCacheRegistrations;
+        zp_int32_t s_threadCacheGeneration;
+
+        struct ThreadCacheThreadData
+        {
+            FixedArray<ThreadCacheFreeLists, kMaxThreadCacheAllocators> caches;
+
+            ~ThreadCacheThreadData()
+            {
+                // hand every cached block back to its allocator, they are freed on its next locked call
+                for( zp_size_t i = 0; i < kMaxThreadCacheAllocators; ++i )
+                {
+                    ThreadCacheFreeLists& cache = caches[ i ];
+                    ThreadCacheRegistration& registration = s_threadCacheRegistrations[ i ];
+
+                    void** orphanedBlocks = Atomic::LoadAcquirePtr( &registration.orphanedBlocks );
+                    if( orphanedBlocks == nullptr || cache.generation != registration.generation )
+                    {
+                        continue;
+                    }
+
+                    void* head = nullptr;
+                    void* tail = nullptr;
+
+                    for( ThreadCacheFreeList& freeList : cache.freeLists )
+                    {
+                        for( void* block = freeList.head; block; )
+                        {
+                            void* next = *static_cast<void**>( block );
+
+                            *static_cast<void**>( block ) = head;
+                            head = block;
+                            tail = tail ? tail : block;
+
+                            block = next;
+                        }
+
+                        freeList = {};
+                    }
+
+                    if( head )
+                    {
+                        void* orphanHead;
+                        do
+                        {
+                            orphanHead = Atomic::LoadAcquirePtr( orphanedBlocks );
+                            *static_cast<void**>( tail ) = orphanHead;
+                        } while( Atomic::CompareExchangePtr( orphanedBlocks, head, orphanHead ) != orphanHead );
+                    }
+                }
+            }
+        };
+
+        thread_local ThreadCacheThreadData t_threadCache;
+    }
+
+    zp_uint32_t ThreadCache::Register( void** orphanedBlocks, zp_uint32_t& outGeneration )
+    {
+        for( zp_uint32_t i = 0; i < kMaxThreadCacheAllocators; ++i )
+        {
+            ThreadCacheRegistration& registration = s_threadCacheRegistrations[ i ];
+            if( Atomic::CompareExchangePtr( &registration.orphanedBlocks, orphanedBlocks, static_cast<void**>( nullptr ) ) == nullptr )
+            {
+                // new generation so threads drop any lists left over from the previous allocator at this index
+                registration.generation = static_cast<zp_uint32_t>( Atomic::Increment( &s_threadCacheGeneration ) );
+
+                outGeneration = registration.generation;
+                return i;
+            }
+        }
+
+        ZP_INVALID_CODE_PATH_MSG( "Too many thread cache allocators" );
+
+        outGeneration = 0;
+        return kInvalidThreadCacheIndex;
+    }
+
+    void ThreadCache::Unregister( zp_uint32_t cacheIndex )
+    {
+        ZP_ASSERT( cacheIndex < kMaxThreadCacheAllocators );
+
+        ThreadCacheRegistration& registration = s_threadCacheRegistrations[ cacheIndex ];
+        registration.generation = 0;
+
+        Atomic::StoreReleasePtr( &registration.orphanedBlocks, static_cast<void**>( nullptr ) );
+    }
+
+    ThreadCacheFreeLists* ThreadCache::GetFreeLists( zp_uint32_t cacheIndex, zp_uint32_t generation )
+    {
+        ThreadCacheFreeLists& cache = t_threadCache.caches[ cacheIndex ];
+
+        // blocks cached for a destroyed allocator died with its memory, just forget them
+        if( cache.generation != generation )
+        {
+            zp_zero_memory( &cache );
+            cache.generation = generation;
+        }
+
+        return &cache;
+    }
+}
+
+namespace zp
+{
+    ZP_STATIC_ASSERT( sizeof( CriticalSectionMemoryLock ) >= sizeof( CriticalSection ) );
+
+    CriticalSectionMemoryLock::CriticalSectionMemoryLock()
+    {
+        *reinterpret_cast<CriticalSection*>( m_criticalSection ) = Platform::CreateCriticalSection();
+    }
+
+    CriticalSectionMemoryLock::CriticalSectionMemoryLock( CriticalSectionMemoryLock&& other ) noexcept
+        : CriticalSectionMemoryLock()
+    {
+    }
+
+    CriticalSectionMemoryLock::~CriticalSectionMemoryLock()
+    {
+        Platform::CloseCriticalSection( *reinterpret_cast<CriticalSection*>( m_criticalSection ) );
+    }
+
+    void CriticalSectionMemoryLock::acquire()
+    {
+        Platform::EnterCriticalSection( *reinterpret_cast<CriticalSection*>( m_criticalSection ) );
+    }
+
+    void CriticalSectionMemoryLock::release()
+    {
+        Platform::LeaveCriticalSection( *reinterpret_cast<CriticalSection*>( m_criticalSection ) );
+    }
+}
+
+#if ZP_USE_TESTS
+#include "Test/Test.h"
+
+using namespace zp;
+
+ZP_TEST_GROUP( Allocator )
+{
+    ZP_TEST_SUITE( ThreadCache )
+    {
+        namespace
+        {
+            using ThreadCacheTestAllocator = MemoryAllocator<FixedAllocatedMemoryStorage, ThreadCacheAllocatorPolicy<TlsfAllocatorPolicy>, CriticalSectionMemoryLock, NullMemoryProfiler>;
+
+            constexpr zp_size_t kThreadCacheTestMemorySize = 1 MB;
+            constexpr zp_size_t kThreadCacheTestBlockCount = 100;
+
+            zp_uint32_t AllocateAndExitThreadFunc( void* threadData )
+            {
+                IMemoryAllocator* allocator = static_cast<IMemoryAllocator*>( threadData );
+
+                void* blocks[ kThreadCacheTestBlockCount ];
+                for( void*& block : blocks )
+                {
+                    block = allocator->allocate( 48, kDefaultMemoryAlignment, MemoryLabels::Default );
+                }
+
+                for( void* block : blocks )
+                {
+                    allocator->free( block, MemoryLabels::Default );
+                }
+
+                return 0;
+            }
+        }
+
+        ZP_TEST( SizeClasses )
+        {
+            ZP_CHECK_EQUALS( ThreadCache::GetSizeClass( 1 ), 0 );
+            ZP_CHECK_EQUALS( ThreadCache::GetSizeClass( 16 ), 0 );
+            ZP_CHECK_EQUALS( ThreadCache::GetSizeClass( 17 ), 1 );
+            ZP_CHECK_EQUALS( ThreadCache::GetSizeClass( 512 ), kThreadCacheSizeClassCount - 1 );
+            ZP_CHECK_EQUALS( ThreadCache::GetSizeClass( 513 ), kThreadCacheSizeClassCount );
+        }
+
+        ZP_TEST( FreedBlockReusedOnSameThread )
+        {
+            void* memory = ZP_MALLOC( MemoryLabels::Default, kThreadCacheTestMemorySize );
+
+            {
+                ThreadCacheTestAllocator allocator( FixedAllocatedMemoryStorage( memory, kThreadCacheTestMemorySize ) );
+
+                void* ptr = allocator.allocate( 64, kDefaultMemoryAlignment );
+                allocator.free( ptr );
+
+                // same size class comes straight back off the calling thread's list
+                void* reusedPtr = allocator.allocate( 60, kDefaultMemoryAlignment );
+                allocator.free( reusedPtr );
+
+                ZP_CHECK_EQUALS( ptr, reusedPtr );
+            }
+
+            ZP_FREE( MemoryLabels::Default, memory );
+        }
+
+        ZP_TEST( OverAlignedBlocksKeepPrefix )
+        {
+            void* memory = ZP_MALLOC( MemoryLabels::Default, kThreadCacheTestMemorySize );
+
+            {
+                ThreadCacheTestAllocator allocator( FixedAllocatedMemoryStorage( memory, kThreadCacheTestMemorySize ) );
+
+                // small but over aligned, bypasses the thread cache and carries a wider prefix
+                void* ptr = allocator.allocate( 64, 256 );
+
+                ZP_CHECK_EQUALS( reinterpret_cast<zp_ptr_t>( ptr ) & 255, 0 );
+                ZP_CHECK_EQUALS( allocator.policy().block_size( ptr ) >= 64, true );
+                ZP_CHECK_EQUALS( allocator.policy().try_free( ptr ), false );
+
+                allocator.free( ptr );
+
+                ZP_CHECK_EQUALS( allocator.policy().allocated(), 0 );
+            }
+
+            ZP_FREE( MemoryLabels::Default, memory );
+        }
+
+        ZP_TEST( ThreadExitReturnsCachedBlocks )
+        {
+            void* memory = ZP_MALLOC( MemoryLabels::Default, kThreadCacheTestMemorySize );
+
+            {
+                ThreadCacheTestAllocator allocator( FixedAllocatedMemoryStorage( memory, kThreadCacheTestMemorySize ) );
+
+                zp_uint32_t threadId;
+                ThreadHandle thread = Platform::CreateThread( AllocateAndExitThreadFunc, &allocator, 64 KB, &threadId );
+                Platform::JoinThreads( &thread, 1 );
+                Platform::CloseThread( thread );
+
+                ZP_CHECK_NOT_EQUALS( allocator.policy().allocated(), 0 );
+
+                // any locked call frees the blocks left by the exited thread
+                void* largePtr = allocator.allocate( 64 KB, kDefaultMemoryAlignment );
+                allocator.free( largePtr );
+
+                ZP_CHECK_EQUALS( allocator.policy().allocated(), 0 );
+            }
+
+            ZP_FREE( MemoryLabels::Default, memory );
+        }
+    }
+
+    ZP_TEST_SUITE( FrameAllocator )
+    {
+        namespace
+        {
+            using AtomicLinearTestAllocator = MemoryAllocator<FixedAllocatedMemoryStorage, AtomicLinearAllocatorPolicy, NullMemoryLock, NullMemoryProfiler>;
+
+            constexpr zp_size_t kFrameTestMemorySize = 4 KB;
+        }
+
+        ZP_TEST( BumpAllocationsAreAlignedAndReset )
+        {
+            void* memory = ZP_MALLOC( MemoryLabels::Default, kFrameTestMemorySize );
+
+            {
+                AtomicLinearTestAllocator allocator( FixedAllocatedMemoryStorage( memory, kFrameTestMemorySize ) );
+
+                void* a = allocator.allocate( 3, 1 );
+                void* b = allocator.allocate( 32, 64 );
+                allocator.free( a );
+
+                // each allocation is preceded by its size
+                ZP_CHECK_EQUALS( a, ZP_OFFSET_PTR( memory, sizeof( zp_size_t ) ) );
+                ZP_CHECK_EQUALS( reinterpret_cast<zp_ptr_t>( b ) & 63, 0 );
+                ZP_CHECK_EQUALS( allocator.policy().block_size( b ), 32 );
+                ZP_CHECK_EQUALS( allocator.policy().try_allocate( kFrameTestMemorySize, 1 ), nullptr );
+
+                allocator.policy().reset();
+
+                ZP_CHECK_EQUALS( allocator.policy().allocated(), 0 );
+                ZP_CHECK_EQUALS( allocator.allocate( 16, 16 ), ZP_OFFSET_PTR( memory, 16 ) );
+            }
+
+            ZP_FREE( MemoryLabels::Default, memory );
+        }
+
+        ZP_TEST( ReallocateCopiesContents )
+        {
+            void* memory = ZP_MALLOC( MemoryLabels::Default, kFrameTestMemorySize );
+
+            {
+                AtomicLinearTestAllocator allocator( FixedAllocatedMemoryStorage( memory, kFrameTestMemorySize ) );
+
+                zp_uint8_t* a = static_cast<zp_uint8_t*>( allocator.allocate( 16, kDefaultMemoryAlignment ) );
+                for( zp_uint8_t i = 0; i < 16; ++i )
+                {
+                    a[ i ] = i;
+                }
+
+                zp_uint8_t* grown = static_cast<zp_uint8_t*>( allocator.reallocate( a, 64, kDefaultMemoryAlignment ) );
+                zp_uint8_t* shrunk = static_cast<zp_uint8_t*>( allocator.reallocate( grown, 8, kDefaultMemoryAlignment ) );
+
+                zp_size_t matching = 0;
+                for( zp_uint8_t i = 0; i < 16; ++i )
+                {
+                    matching += grown[ i ] == i ? 1 : 0;
+                    matching += i < 8 && shrunk[ i ] == i ? 1 : 0;
+                }
+
+                ZP_CHECK_EQUALS( matching, 24 );
+                ZP_CHECK_EQUALS( allocator.policy().block_size( shrunk ), 8 );
+            }
+
+            ZP_FREE( MemoryLabels::Default, memory );
+        }
+
+        ZP_TEST( AdvanceSwapsFrameLabels )
+        {
+            constexpr zp_size_t kReservedSize = 64 KB;
+
+            // the process frame allocators hold live memory, advance a local pair in their place and restore them after
+            IMemoryAllocator* processFrameAllocator = GetAllocator( MemoryLabels::Frame );
+            IMemoryAllocator* processPreviousFrameAllocator = GetAllocator( MemoryLabels::PreviousFrame );
+
+            void* frameMemory = Platform::AllocateSystemMemory( nullptr, kReservedSize );
+            void* previousFrameMemory = Platform::AllocateSystemMemory( nullptr, kReservedSize );
+
+            {
+                FrameMemoryAllocator frameAllocator( SystemPageMemoryStorage( frameMemory, 4 KB, kReservedSize ) );
+                FrameMemoryAllocator previousFrameAllocator( SystemPageMemoryStorage( previousFrameMemory, 4 KB, kReservedSize ) );
+
+                RegisterFrameAllocators( &frameAllocator, &previousFrameAllocator );
+
+                ZP_CHECK_NOT_EQUALS( previousFrameAllocator.allocate( 64, kDefaultMemoryAlignment ), nullptr );
+
+                AdvanceFrameAllocators();
+
+                ZP_CHECK_EQUALS( GetAllocator( MemoryLabels::PreviousFrame ), &frameAllocator );
+                ZP_CHECK_EQUALS( GetAllocator( MemoryLabels::Frame ), &previousFrameAllocator );
+                ZP_CHECK_EQUALS( previousFrameAllocator.policy().allocated(), 0 );
+
+                RegisterFrameAllocators( static_cast<FrameMemoryAllocator*>( processFrameAllocator ), static_cast<FrameMemoryAllocator*>( processPreviousFrameAllocator ) );
+            }
+
+            Platform::FreeSystemMemory( previousFrameMemory );
+            Platform::FreeSystemMemory( frameMemory );
+
+            ZP_CHECK_EQUALS( GetAllocator( MemoryLabels::Frame ), processFrameAllocator );
+            ZP_CHECK_EQUALS( GetAllocator( MemoryLabels::PreviousFrame ), processPreviousFrameAllocator );
+        }
+    }
+
+    ZP_TEST_SUITE( PoolAllocator )
+    {
+        namespace
+        {
+            using FixedPoolTestAllocator = MemoryAllocator<FixedAllocatedMemoryStorage, PoolAllocatorPolicy<40>, NullMemoryLock, NullMemoryProfiler>;
+
+            constexpr zp_size_t kPoolTestMemorySize = 4 KB;
+            constexpr zp_size_t kPoolStressMemorySize = 256 KB;
+            constexpr zp_size_t kPoolStressIterations = 1000;
+            constexpr zp_size_t kPoolStressObjectsPerThread = 32;
+            constexpr zp_uint32_t kPoolStressThreadCount = 4;
+
+            struct PoolStressContext
+            {
+                IMemoryAllocator* allocator;
+                zp_int32_t mismatches;
+                zp_int32_t failedAllocations;
+            };
+
+            zp_uint32_t PoolStressThreadFunc( void* threadData )
+            {
+                PoolStressContext* ctx = static_cast<PoolStressContext*>( threadData );
+                const zp_uint32_t threadId = Platform::GetCurrentThreadId();
+
+                zp_uint32_t* objects[ kPoolStressObjectsPerThread ];
+
+                for( zp_size_t i = 0; i < kPoolStressIterations; ++i )
+                {
+                    for( zp_uint32_t*& object : objects )
+                    {
+                        object = static_cast<zp_uint32_t*>( ctx->allocator->allocate( 40, kDefaultMemoryAlignment, MemoryLabels::Default ) );
+                        if( object == nullptr )
+                        {
+                            Atomic::Increment( &ctx->failedAllocations );
+                            continue;
+                        }
+
+                        object[ 2 ] = threadId;
+                    }
+
+                    // an object handed out twice would have been overwritten by the other thread
+                    for( zp_uint32_t* object : objects )
+                    {
+                        if( object == nullptr )
+                        {
+                            continue;
+                        }
+
+                        if( object[ 2 ] != threadId )
+                        {
+                            Atomic::Increment( &ctx->mismatches );
+                        }
+
+                        ctx->allocator->free( object, MemoryLabels::Default );
+                    }
+                }
+
+                return 0;
+            }
+
+            void RunPoolStressThreads( PoolStressContext& ctx )
+            {
+                ThreadHandle threads[ kPoolStressThreadCount ];
+                for( ThreadHandle& thread : threads )
+                {
+                    zp_uint32_t threadId;
+                    thread = Platform::CreateThread( PoolStressThreadFunc, &ctx, 64 KB, &threadId );
+                }
+
+                Platform::JoinThreads( threads, kPoolStressThreadCount );
+                for( ThreadHandle thread : threads )
+                {
+                    Platform::CloseThread( thread );
+                }
+            }
+        }
+
+        ZP_TEST( AllocationsAreContiguous )
+        {
+            void* memory = ZP_MALLOC( MemoryLabels::Default, kPoolTestMemorySize );
+
+            {
+                FixedPoolTestAllocator allocator( FixedAllocatedMemoryStorage( memory, kPoolTestMemorySize ) );
+
+                constexpr zp_size_t kSlotSize = PoolAllocatorPolicy<40>::kSlotSize;
+                ZP_CHECK_EQUALS( kSlotSize, 48 );
+
+                void* a = allocator.allocate( 40, kDefaultMemoryAlignment );
+                void* b = allocator.allocate( 40, kDefaultMemoryAlignment );
+
+                ZP_CHECK_EQUALS( static_cast<zp_uint8_t*>( b ) - static_cast<zp_uint8_t*>( a ), static_cast<zp_ptrdiff_t>( kSlotSize ) );
+
+                allocator.free( a );
+                ZP_CHECK_EQUALS( allocator.allocate( 32, kDefaultMemoryAlignment ), a );
+
+                zp_size_t count = 2;
+                while( allocator.policy().try_allocate( 40, kDefaultMemoryAlignment ) )
+                {
+                    ++count;
+                }
+
+                ZP_CHECK_EQUALS( count, kPoolTestMemorySize / kSlotSize );
+                ZP_CHECK_EQUALS( allocator.policy().allocated(), allocator.policy().total() );
+            }
+
+            ZP_FREE( MemoryLabels::Default, memory );
+        }
+
+        ZP_TEST( GrowsBySlab )
+        {
+            constexpr zp_size_t kObjectCount = 1000;
+            constexpr zp_size_t kReservedSize = 1 MB;
+
+            void* systemMemory = Platform::AllocateSystemMemory( nullptr, kReservedSize );
+
+            {
+                PoolMemoryAllocator<64> allocator( SystemPageMemoryStorage( systemMemory, 4 KB, kReservedSize ) );
+
+                zp_size_t nullCount = 0;
+                for( zp_size_t i = 0; i < kObjectCount; ++i )
+                {
+                    nullCount += allocator.allocate( 64, kDefaultMemoryAlignment ) == nullptr ? 1 : 0;
+                }
+
+                ZP_CHECK_EQUALS( nullCount, 0 );
+                ZP_CHECK_EQUALS( allocator.policy().allocated(), kObjectCount * 64 );
+            }
+
+            Platform::FreeSystemMemory( systemMemory );
+        }
+
+        ZP_TEST( ConcurrentAllocFree )
+        {
+            void* memory = ZP_MALLOC( MemoryLabels::Default, kPoolStressMemorySize );
+
+            {
+                FixedPoolTestAllocator allocator( FixedAllocatedMemoryStorage( memory, kPoolStressMemorySize ) );
+
+                PoolStressContext ctx {
+                    .allocator = &allocator,
+                    .mismatches = 0,
+                    .failedAllocations = 0,
+                };
+
+                RunPoolStressThreads( ctx );
+
+                ZP_CHECK_EQUALS( ctx.mismatches, 0 );
+                ZP_CHECK_EQUALS( ctx.failedAllocations, 0 );
+                ZP_CHECK_EQUALS( allocator.policy().allocated(), 0 );
+            }
+
+            ZP_FREE( MemoryLabels::Default, memory );
+        }
+
+        ZP_TEST( ConcurrentGrow )
+        {
+            constexpr zp_size_t kReservedSize = 1 MB;
+
+            void* systemMemory = Platform::AllocateSystemMemory( nullptr, kReservedSize );
+
+            {
+                // starts empty, threads race frees against the slab growth of the locked path
+                PoolMemoryAllocator<40> allocator( SystemPageMemoryStorage( systemMemory, 4 KB, kReservedSize ) );
+
+                PoolStressContext ctx {
+                    .allocator = &allocator,
+                    .mismatches = 0,
+                    .failedAllocations = 0,
+                };
+
+                RunPoolStressThreads( ctx );
+
+                ZP_CHECK_EQUALS( ctx.mismatches, 0 );
+                ZP_CHECK_EQUALS( ctx.failedAllocations, 0 );
+                ZP_CHECK_EQUALS( allocator.policy().allocated(), 0 );
+            }
+
+            Platform::FreeSystemMemory( systemMemory );
+        }
+    }
+
+    ZP_TEST_SUITE( MemoryStats )
+    {
+        namespace
+        {
+            constexpr zp_size_t kMemoryStatsTestMemorySize = 64 KB;
+
+            using TrackedTestAllocator = MemoryAllocator<FixedAllocatedMemoryStorage, TlsfAllocatorPolicy, NullMemoryLock, TrackedMemoryProfiler>;
+
+            zp_size_t s_budgetExceededCount;
+
+            void CountUserMemoryPressure( MemoryLabel memoryLabel, zp_size_t liveBytes, zp_size_t softLimit, void* userData )
+            {
+                if( memoryLabel == MemoryLabels::User )
+                {
+                    ++*static_cast<zp_size_t*>( userData );
+                }
+            }
+
+            void CountBudgetExceeded( MemoryLabel memoryLabel, zp_size_t liveBytes, zp_size_t hardLimit )
+            {
+                if( memoryLabel == MemoryLabels::User )
+                {
+                    ++s_budgetExceededCount;
+                }
+            }
+
+            MemoryLabelStats GetSnapshotStats( MemoryLabel memoryLabel )
+            {
+                MemoryLabelStats stats[ kMaxMemoryLabels ];
+
+                SnapshotMemoryStats();
+                GetMemoryLabelStats( stats, kMaxMemoryLabels );
+
+                return stats[ memoryLabel ];
+            }
+        }
+
+        ZP_TEST( HistogramBuckets )
+        {
+            ZP_CHECK_EQUALS( GetMemoryHistogramBucket( 1 ), 0 );
+            ZP_CHECK_EQUALS( GetMemoryHistogramBucket( 16 ), 0 );
+            ZP_CHECK_EQUALS( GetMemoryHistogramBucket( 17 ), 1 );
+            ZP_CHECK_EQUALS( GetMemoryHistogramBucket( 4 KB ), 8 );
+            ZP_CHECK_EQUALS( GetMemoryHistogramBucket( 1 GB ), kMemoryHistogramBucketCount - 1 );
+        }
+
+        ZP_TEST( LiveCountersFollowAllocations )
+        {
+            void* memory = ZP_MALLOC( MemoryLabels::Default, kMemoryStatsTestMemorySize );
+
+            {
+                TrackedTestAllocator allocator( FixedAllocatedMemoryStorage( memory, kMemoryStatsTestMemorySize ) );
+
+                const MemoryLabelStats before = GetSnapshotStats( MemoryLabels::User );
+
+                void* a = allocator.allocate( 100, kDefaultMemoryAlignment, MemoryLabels::User );
+                void* b = allocator.allocate( 1000, kDefaultMemoryAlignment, MemoryLabels::User );
+
+                const MemoryLabelStats allocated = GetSnapshotStats( MemoryLabels::User );
+                ZP_CHECK_EQUALS( allocated.liveCount - before.liveCount, 2 );
+                ZP_CHECK_EQUALS( allocated.allocations, 2 );
+                ZP_CHECK_EQUALS( allocated.frees, 0 );
+
+                // counted by block size, which is never smaller than what was asked for
+                ZP_CHECK_EQUALS( allocated.liveBytes - before.liveBytes >= 1100, true );
+                ZP_CHECK_EQUALS( allocated.peakBytes >= allocated.liveBytes, true );
+
+                allocator.free( a, MemoryLabels::User );
+                allocator.free( b, MemoryLabels::User );
+
+                const MemoryLabelStats freed = GetSnapshotStats( MemoryLabels::User );
+                ZP_CHECK_EQUALS( freed.liveCount, before.liveCount );
+                ZP_CHECK_EQUALS( freed.liveBytes, before.liveBytes );
+                ZP_CHECK_EQUALS( freed.allocations, 0 );
+                ZP_CHECK_EQUALS( freed.frees, 2 );
+            }
+
+            ZP_FREE( MemoryLabels::Default, memory );
+        }
+
+        ZP_TEST( SoftBudgetPressureAtFrameBoundary )
+        {
+            void* memory = ZP_MALLOC( MemoryLabels::Default, kMemoryStatsTestMemorySize );
+
+            {
+                TrackedTestAllocator allocator( FixedAllocatedMemoryStorage( memory, kMemoryStatsTestMemorySize ) );
+
+                const MemoryLabelStats before = GetSnapshotStats( MemoryLabels::User );
+                SetMemoryBudget( MemoryLabels::User, { .softLimit = before.liveBytes + 1 KB, .hardLimit = 0 } );
+
+                zp_size_t pressureCount = 0;
+                RegisterMemoryPressureCallback( CountUserMemoryPressure, &pressureCount );
+
+                void* ptr = allocator.allocate( 2 KB, kDefaultMemoryAlignment, MemoryLabels::User );
+                ZP_CHECK_EQUALS( pressureCount, 0 );
+
+                ProcessMemoryPressure();
+                ZP_CHECK_EQUALS( pressureCount, 1 );
+
+                allocator.free( ptr, MemoryLabels::User );
+
+                ProcessMemoryPressure();
+                ZP_CHECK_EQUALS( pressureCount, 1 );
+
+                UnregisterMemoryPressureCallback( CountUserMemoryPressure, &pressureCount );
+                SetMemoryBudget( MemoryLabels::User, {} );
+            }
+
+            ZP_FREE( MemoryLabels::Default, memory );
+        }
+
+        ZP_TEST( HardBudgetCallsExceededHandler )
+        {
+            void* memory = ZP_MALLOC( MemoryLabels::Default, kMemoryStatsTestMemorySize );
+
+            {
+                TrackedTestAllocator allocator( FixedAllocatedMemoryStorage( memory, kMemoryStatsTestMemorySize ) );
+
+                const MemoryLabelStats before = GetSnapshotStats( MemoryLabels::User );
+                SetMemoryBudget( MemoryLabels::User, { .softLimit = 0, .hardLimit = before.liveBytes + 1 KB } );
+                SetMemoryBudgetExceededHandler( CountBudgetExceeded );
+
+                s_budgetExceededCount = 0;
+
+                void* a = allocator.allocate( 512, kDefaultMemoryAlignment, MemoryLabels::User );
+                ZP_CHECK_EQUALS( s_budgetExceededCount, 0 );
+
+                // the allocation past the budget fails, a is left as it was
+                void* b = allocator.allocate( 2 KB, kDefaultMemoryAlignment, MemoryLabels::User );
+                ZP_CHECK_EQUALS( s_budgetExceededCount, 1 );
+                ZP_CHECK_EQUALS( b, nullptr );
+
+                void* grown = allocator.reallocate( a, 2 KB, kDefaultMemoryAlignment, MemoryLabels::User );
+                ZP_CHECK_EQUALS( s_budgetExceededCount, 2 );
+                ZP_CHECK_EQUALS( grown, nullptr );
+                ZP_CHECK_EQUALS( GetSnapshotStats( MemoryLabels::User ).liveBytes, before.liveBytes + allocator.policy().block_size( a ) );
+
+                allocator.free( a, MemoryLabels::User );
+
+                SetMemoryBudgetExceededHandler( nullptr );
+                SetMemoryBudget( MemoryLabels::User, {} );
+            }
+
+            ZP_FREE( MemoryLabels::Default, memory );
+        }
+
+        ZP_TEST( HeapStatsFindLargestFreeBlock )
+        {
+            void* memory = ZP_MALLOC( MemoryLabels::Default, kMemoryStatsTestMemorySize );
+
+            {
+                TrackedTestAllocator allocator( FixedAllocatedMemoryStorage( memory, kMemoryStatsTestMemorySize ) );
+
+                void* a = allocator.allocate( 1 KB, kDefaultMemoryAlignment, MemoryLabels::User );
+                void* b = allocator.allocate( 1 KB, kDefaultMemoryAlignment, MemoryLabels::User );
+                void* c = allocator.allocate( 1 KB, kDefaultMemoryAlignment, MemoryLabels::User );
+
+                // hole in the middle splits free space in two
+                allocator.free( b, MemoryLabels::User );
+
+                MemoryHeapStats heapStats {};
+                allocator.queryHeapStats( heapStats );
+
+                ZP_CHECK_EQUALS( heapStats.freeBlockCount, 2 );
+                ZP_CHECK_EQUALS( heapStats.largestFreeBlock > 1 KB, true );
+                ZP_CHECK_EQUALS( heapStats.largestFreeBlock < heapStats.totalBytes, true );
+
+                allocator.free( a, MemoryLabels::User );
+                allocator.free( c, MemoryLabels::User );
+            }
+
+            ZP_FREE( MemoryLabels::Default, memory );
+        }
     }
-}
 
-namespace zp
-{
-    void CriticalSectionMemoryLock::acquire()
+    ZP_TEST_SUITE( SystemPageStorage )
+    {
+        namespace
+        {
+            constexpr zp_size_t kSystemPageTestReservedSize = 8 MB;
+            constexpr zp_size_t kSystemPageTestPageSize = 64 KB;
+            constexpr zp_size_t kSystemPageTestHighWaterMark = 256 KB;
+            constexpr zp_size_t kSystemPageTestBlockCount = 32;
+            constexpr zp_size_t kSystemPageTestBlockSize = 32 KB;
+
+            using DecommitTestAllocator = MemoryAllocator<SystemPageMemoryStorage, TlsfAllocatorPolicy, NullMemoryLock, NullMemoryProfiler>;
+
+            zp_bool_t AllocateBlocks( DecommitTestAllocator& allocator, void** blocks, zp_size_t blockCount )
+            {
+                zp_bool_t allAllocated = true;
+                for( zp_size_t i = 0; i < blockCount; ++i )
+                {
+                    blocks[ i ] = allocator.allocate( kSystemPageTestBlockSize, kDefaultMemoryAlignment );
+                    allAllocated = allAllocated && blocks[ i ] != nullptr;
+                }
+
+                return allAllocated;
+            }
+
+            void FreeBlocks( DecommitTestAllocator& allocator, void** blocks, zp_size_t blockCount )
+            {
+                for( zp_size_t i = 0; i < blockCount; ++i )
+                {
+                    allocator.free( blocks[ i ] );
+                }
+            }
+        }
+
+        ZP_TEST( FreePoolsDecommittedPastHighWaterMark )
+        {
+            void* systemMemory = Platform::AllocateSystemMemory( nullptr, kSystemPageTestReservedSize );
+
+            {
+                DecommitTestAllocator allocator( SystemPageMemoryStorage( systemMemory, kSystemPageTestPageSize, kSystemPageTestReservedSize, kSystemPageTestHighWaterMark ) );
+
+                void* blocks[ kSystemPageTestBlockCount ];
+                ZP_CHECK_EQUALS( AllocateBlocks( allocator, blocks, kSystemPageTestBlockCount ), true );
+
+                // committed from the start of the reservation
+                const zp_size_t peakCommitted = allocator.storage().committed();
+                ZP_CHECK_EQUALS( peakCommitted > kSystemPageTestHighWaterMark, true );
+
+                FreeBlocks( allocator, blocks, kSystemPageTestBlockCount );
+
+                ZP_CHECK_EQUALS( allocator.storage().committed() <= kSystemPageTestHighWaterMark, true );
+                ZP_CHECK_EQUALS( allocator.policy().allocated(), 0 );
+
+                // decommitted pages are committed again before the reservation grows
+                constexpr zp_size_t kReuseBlockCount = kSystemPageTestBlockCount / 2;
+                ZP_CHECK_EQUALS( AllocateBlocks( allocator, blocks, kReuseBlockCount ), true );
+
+                zp_size_t outsidePeakCount = 0;
+                for( zp_size_t i = 0; i < kReuseBlockCount; ++i )
+                {
+                    outsidePeakCount += blocks[ i ] >= ZP_OFFSET_PTR( systemMemory, peakCommitted ) ? 1 : 0;
+                }
+                ZP_CHECK_EQUALS( outsidePeakCount, 0 );
+
+                FreeBlocks( allocator, blocks, kReuseBlockCount );
+            }
+
+            Platform::FreeSystemMemory( systemMemory );
+        }
+
+        ZP_TEST( NoHighWaterMarkKeepsPeak )
+        {
+            void* systemMemory = Platform::AllocateSystemMemory( nullptr, kSystemPageTestReservedSize );
+
+            {
+                DecommitTestAllocator allocator( SystemPageMemoryStorage( systemMemory, kSystemPageTestPageSize, kSystemPageTestReservedSize ) );
+
+                void* blocks[ kSystemPageTestBlockCount ];
+                ZP_CHECK_EQUALS( AllocateBlocks( allocator, blocks, kSystemPageTestBlockCount ), true );
+
+                const zp_size_t peakCommitted = allocator.storage().committed();
+
+                FreeBlocks( allocator, blocks, kSystemPageTestBlockCount );
+
+                ZP_CHECK_EQUALS( allocator.storage().committed(), peakCommitted );
+            }
+
+            Platform::FreeSystemMemory( systemMemory );
+        }
+
+        ZP_TEST( ReleasedHolesCoalesce )
+        {
+            // every odd page fills the range list, the last page stays committed until the end
+            constexpr zp_size_t kPageCount = ( kMaxReleasedMemoryRanges * 2 ) + 1;
+
+            void* systemMemory = Platform::AllocateSystemMemory( nullptr, kSystemPageTestReservedSize );
+
+            {
+                SystemPageMemoryStorage storage( systemMemory, kSystemPageTestPageSize, kSystemPageTestReservedSize );
+
+                void* pages[ kPageCount ];
+                for( void*& page : pages )
+                {
+                    zp_size_t requestedSize;
+                    page = storage.request_memory( kSystemPageTestPageSize, requestedSize );
+                    ZP_CHECK_EQUALS( requestedSize, kSystemPageTestPageSize );
+                }
+
+                for( zp_size_t i = 1; i < kPageCount; i += 2 )
+                {
+                    storage.release_memory( pages[ i ], kSystemPageTestPageSize );
+                }
+                for( zp_size_t i = 0; i < kPageCount; i += 2 )
+                {
+                    storage.release_memory( pages[ i ], kSystemPageTestPageSize );
+                }
+
+                ZP_CHECK_EQUALS( storage.committed(), 0 );
+
+                // every hole merged back into one, nothing past the start of the reservation was lost
+                zp_size_t requestedSize;
+                void* mem = storage.request_memory( kPageCount * kSystemPageTestPageSize, requestedSize );
+
+                ZP_CHECK_EQUALS( mem, systemMemory );
+                ZP_CHECK_EQUALS( requestedSize, kPageCount * kSystemPageTestPageSize );
+
+                storage.release_memory( mem, requestedSize );
+            }
+
+            Platform::FreeSystemMemory( systemMemory );
+        }
+    }
+
+#if ZP_USE_MEMORY_SAMPLER
+    ZP_TEST_SUITE( MemorySampler )
     {
-        //Platform::EnterCriticalSection( m_criticalSection );
+        namespace
+        {
+            constexpr zp_size_t kMemorySamplerTestMemorySize = 64 KB;
+            constexpr zp_size_t kMemorySamplerTestAllocations = 4;
+
+            using TrackedTestAllocator = MemoryAllocator<FixedAllocatedMemoryStorage, TlsfAllocatorPolicy, NullMemoryLock, TrackedMemoryProfiler>;
+
+            const char* WriteNullTerminatedSamples( DataStreamWriter& writer, MemorySampleFormat format )
+            {
+                WriteMemorySamples( writer, format );
+                writer.write( '\0' );
+
+                return static_cast<const char*>( writer.memory().ptr() );
+            }
+        }
+
+        ZP_TEST( SampledAllocationsLiveUntilFreed )
+        {
+            void* memory = ZP_MALLOC( MemoryLabels::Default, kMemorySamplerTestMemorySize );
+
+            {
+                TrackedTestAllocator allocator( FixedAllocatedMemoryStorage( memory, kMemorySamplerTestMemorySize ) );
+
+                // every allocation larger than a few bytes is sampled
+                SetMemorySamplingRate( 1 );
+
+                // seeds this thread's sampler if it hasn't allocated before
+                allocator.free( allocator.allocate( 256, kDefaultMemoryAlignment, MemoryLabels::User ), MemoryLabels::User );
+
+                const MemorySamplerStats before = GetMemorySamplerStats();
+
+                void* ptrs[ kMemorySamplerTestAllocations ];
+                for( void*& ptr : ptrs )
+                {
+                    ptr = allocator.allocate( 256, kDefaultMemoryAlignment, MemoryLabels::User );
+                }
+
+                const MemorySamplerStats sampled = GetMemorySamplerStats();
+                ZP_CHECK_EQUALS( sampled.liveSamples - before.liveSamples, kMemorySamplerTestAllocations );
+                ZP_CHECK_EQUALS( sampled.droppedSamples, before.droppedSamples );
+
+                {
+                    DataStreamWriter writer( MemoryLabels::Default );
+                    const char* pprof = WriteNullTerminatedSamples( writer, MemorySampleFormat::Pprof );
+
+                    ZP_CHECK_EQUALS( zp_strstr( pprof, "heap profile: " ), pprof );
+                    ZP_CHECK_NOT_EQUALS( zp_strstr( pprof, "@ heap_v2/1\n" ), nullptr );
+                    ZP_CHECK_NOT_EQUALS( zp_strstr( pprof, "1: 256 [1: 256] @" ), nullptr );
+                }
+
+                {
+                    DataStreamWriter writer( MemoryLabels::Default );
+                    const char* folded = WriteNullTerminatedSamples( writer, MemorySampleFormat::Folded );
+
+                    ZP_CHECK_NOT_EQUALS( zp_strstr( folded, "MemoryLabel_5;" ), nullptr );
+                }
+
+                for( void* ptr : ptrs )
+                {
+                    allocator.free( ptr, MemoryLabels::User );
+                }
+
+                const MemorySamplerStats freed = GetMemorySamplerStats();
+                ZP_CHECK_EQUALS( freed.liveSamples, before.liveSamples );
+
+                SetMemorySamplingRate( kDefaultMemorySamplingRate );
+            }
+
+            ZP_FREE( MemoryLabels::Default, memory );
+        }
+
+        ZP_TEST( RebuildKeepsLiveSamples )
+        {
+            void* memory = ZP_MALLOC( MemoryLabels::Default, kMemorySamplerTestMemorySize );
+
+            {
+                TrackedTestAllocator allocator( FixedAllocatedMemoryStorage( memory, kMemorySamplerTestMemorySize ) );
+
+                SetMemorySamplingRate( 1 );
+
+                allocator.free( allocator.allocate( 256, kDefaultMemoryAlignment, MemoryLabels::User ), MemoryLabels::User );
+
+                const MemorySamplerStats before = GetMemorySamplerStats();
+
+                // freed samples leave tombstones between the live ones
+                void* ptrs[ kMemorySamplerTestAllocations * 2 ];
+                for( void*& ptr : ptrs )
+                {
+                    ptr = allocator.allocate( 256, kDefaultMemoryAlignment, MemoryLabels::User );
+                }
+
+                for( zp_size_t i = 0; i < kMemorySamplerTestAllocations * 2; i += 2 )
+                {
+                    allocator.free( ptrs[ i ], MemoryLabels::User );
+                }
+
+                AcquireMemorySamplerLock();
+                RebuildMemorySamples();
+                ReleaseMemorySamplerLock();
+
+                ZP_CHECK_EQUALS( s_memorySampler.tombstones, 0 );
+                ZP_CHECK_EQUALS( GetMemorySamplerStats().liveSamples - before.liveSamples, kMemorySamplerTestAllocations );
+
+                // every moved sample is still found by its free
+                for( zp_size_t i = 1; i < kMemorySamplerTestAllocations * 2; i += 2 )
+                {
+                    allocator.free( ptrs[ i ], MemoryLabels::User );
+                }
+
+                ZP_CHECK_EQUALS( GetMemorySamplerStats().liveSamples, before.liveSamples );
+
+                SetMemorySamplingRate( kDefaultMemorySamplingRate );
+            }
+
+            ZP_FREE( MemoryLabels::Default, memory );
+        }
+
+        ZP_TEST( DisabledSamplingRecordsNothing )
+        {
+            void* memory = ZP_MALLOC( MemoryLabels::Default, kMemorySamplerTestMemorySize );
+
+            {
+                TrackedTestAllocator allocator( FixedAllocatedMemoryStorage( memory, kMemorySamplerTestMemorySize ) );
+
+                SetMemorySamplingRate( 0 );
+
+                const MemorySamplerStats before = GetMemorySamplerStats();
+
+                for( zp_size_t i = 0; i < kMemorySamplerTestAllocations; ++i )
+                {
+                    allocator.free( allocator.allocate( 256, kDefaultMemoryAlignment, MemoryLabels::User ), MemoryLabels::User );
+                }
+
+                const MemorySamplerStats after = GetMemorySamplerStats();
+                ZP_CHECK_EQUALS( after.liveSamples, before.liveSamples );
+                ZP_CHECK_EQUALS( after.samplingRate, 0 );
+
+                SetMemorySamplingRate( kDefaultMemorySamplingRate );
+            }
+
+            ZP_FREE( MemoryLabels::Default, memory );
+        }
     }
+#endif
 
-    void CriticalSectionMemoryLock::release()
+#if ZP_USE_BENCHMARKS
+    ZP_TEST_SUITE( AllocatorBenchmark )
     {
-        //Platform::LeaveCriticalSection( m_criticalSection );
+        namespace
+        {
+            using LockedTlsfAllocator = MemoryAllocator<FixedAllocatedMemoryStorage, TlsfAllocatorPolicy, CriticalSectionMemoryLock, NullMemoryProfiler>;
+            using ThreadCacheTlsfAllocator = MemoryAllocator<FixedAllocatedMemoryStorage, ThreadCacheAllocatorPolicy<TlsfAllocatorPolicy>, CriticalSectionMemoryLock, NullMemoryProfiler>;
+            using TrackedTlsfAllocator = MemoryAllocator<FixedAllocatedMemoryStorage, TlsfAllocatorPolicy, CriticalSectionMemoryLock, TrackedMemoryProfiler>;
+
+            constexpr zp_size_t kBenchmarkMemorySize = 16 MB;
+            constexpr zp_size_t kBenchmarkIterations = 200000;
+            constexpr zp_size_t kBenchmarkLiveBlocks = 64;
+            constexpr zp_uint32_t kBenchmarkMaxThreads = 16;
+
+            struct MixedAllocBenchmarkContext
+            {
+                IMemoryAllocator* allocator;
+                zp_uint32_t started;
+                zp_uint32_t go;
+            };
+
+            struct MixedAllocBenchmarkThread
+            {
+                MixedAllocBenchmarkContext* ctx;
+                zp_uint32_t seed;
+            };
+
+            zp_uint32_t MixedAllocThreadFunc( void* threadData )
+            {
+                MixedAllocBenchmarkThread* thread = static_cast<MixedAllocBenchmarkThread*>( threadData );
+                MixedAllocBenchmarkContext* ctx = thread->ctx;
+
+                void* blocks[ kBenchmarkLiveBlocks ] {};
+                zp_uint32_t rng = thread->seed;
+
+                Atomic::Increment( reinterpret_cast<zp_int32_t*>( &ctx->started ) );
+                while( !Atomic::LoadAcquire( &ctx->go ) )
+                {
+                    Platform::YieldCurrentThread();
+                }
+
+                // random slot, free it if live otherwise allocate 16-512 bytes into it
+                for( zp_size_t i = 0; i < kBenchmarkIterations; ++i )
+                {
+                    rng ^= rng << 13;
+                    rng ^= rng >> 17;
+                    rng ^= rng << 5;
+
+                    void*& block = blocks[ rng % kBenchmarkLiveBlocks ];
+                    if( block )
+                    {
+                        ctx->allocator->free( block, MemoryLabels::Default );
+                        block = nullptr;
+                    }
+                    else
+                    {
+                        block = ctx->allocator->allocate( 16 + ( ( rng >> 8 ) % 497 ), kDefaultMemoryAlignment, MemoryLabels::Default );
+                    }
+                }
+
+                for( void* block : blocks )
+                {
+                    if( block )
+                    {
+                        ctx->allocator->free( block, MemoryLabels::Default );
+                    }
+                }
+
+                return 0;
+            }
+
+            zp_float64_t RunMixedAllocBenchmark( IMemoryAllocator* allocator, zp_uint32_t threadCount )
+            {
+                MixedAllocBenchmarkContext ctx {
+                    .allocator = allocator,
+                    .started = 0,
+                    .go = 0,
+                };
+
+                MixedAllocBenchmarkThread threads[ kBenchmarkMaxThreads ];
+                ThreadHandle threadHandles[ kBenchmarkMaxThreads ];
+
+                for( zp_uint32_t i = 0; i < threadCount; ++i )
+                {
+                    threads[ i ] = { .ctx = &ctx, .seed = 0x9E3779B9u * ( i + 1 ) };
+
+                    zp_uint32_t threadId;
+                    threadHandles[ i ] = Platform::CreateThread( MixedAllocThreadFunc, &threads[ i ], 64 KB, &threadId );
+                }
+
+                while( Atomic::LoadAcquire( &ctx.started ) < threadCount )
+                {
+                    Platform::YieldCurrentThread();
+                }
+
+                const zp_time_t start = Platform::TimeNow();
+
+                Atomic::StoreRelease( &ctx.go, 1 );
+
+                Platform::JoinThreads( threadHandles, threadCount );
+
+                const zp_time_t elapsed = Platform::TimeNow() - start;
+
+                for( zp_uint32_t i = 0; i < threadCount; ++i )
+                {
+                    Platform::CloseThread( threadHandles[ i ] );
+                }
+
+                return static_cast<zp_float64_t>( elapsed ) * 1000.0 / static_cast<zp_float64_t>( Platform::TimeFrequency() );
+            }
+        }
+
+        ZP_TEST( MixedSmallAllocFree )
+        {
+            void* memory = ZP_MALLOC( MemoryLabels::Default, kBenchmarkMemorySize );
+
+            const zp_uint32_t maxThreadCount = zp_min( Platform::GetProcessorCount(), static_cast<zp_uint32_t>( kBenchmarkMaxThreads ) );
+
+            for( zp_uint32_t threadCount = 1; threadCount <= maxThreadCount; threadCount *= 2 )
+            {
+                zp_float64_t lockedMS;
+                zp_float64_t cachedMS;
+
+                {
+                    LockedTlsfAllocator allocator( FixedAllocatedMemoryStorage( memory, kBenchmarkMemorySize ) );
+                    lockedMS = RunMixedAllocBenchmark( &allocator, threadCount );
+
+                    ZP_CHECK_EQUALS( allocator.policy().allocated(), 0 );
+                }
+
+                {
+                    ThreadCacheTlsfAllocator allocator( FixedAllocatedMemoryStorage( memory, kBenchmarkMemorySize ) );
+                    cachedMS = RunMixedAllocBenchmark( &allocator, threadCount );
+                }
+
+                const zp_float64_t operations = static_cast<zp_float64_t>( kBenchmarkIterations * threadCount );
+
+                zp_printfln( "[BENCH] mixed 16-512b alloc/free %u threads: locked tlsf %.3f ms (%.1f Mops/s), thread cached %.3f ms (%.1f Mops/s), %.2fx",
+                    threadCount, lockedMS, operations / ( lockedMS * 1000.0 ), cachedMS, operations / ( cachedMS * 1000.0 ), lockedMS / cachedMS );
+            }
+
+            ZP_FREE( MemoryLabels::Default, memory );
+        }
+
+#if ZP_USE_MEMORY_SAMPLER
+        ZP_TEST( SamplingOverhead )
+        {
+            void* memory = ZP_MALLOC( MemoryLabels::Default, kBenchmarkMemorySize );
+
+            zp_float64_t unsampledMS;
+            zp_float64_t sampledMS;
+
+            // the counters cost the same in both runs, only the sampler differs
+            {
+                SetMemorySamplingRate( 0 );
+
+                TrackedTlsfAllocator allocator( FixedAllocatedMemoryStorage( memory, kBenchmarkMemorySize ) );
+                unsampledMS = RunMixedAllocBenchmark( &allocator, 1 );
+            }
+
+            {
+                SetMemorySamplingRate( kDefaultMemorySamplingRate );
+
+                TrackedTlsfAllocator allocator( FixedAllocatedMemoryStorage( memory, kBenchmarkMemorySize ) );
+                sampledMS = RunMixedAllocBenchmark( &allocator, 1 );
+            }
+
+            zp_printfln( "[BENCH] mixed 16-512b alloc/free, sampling off %.3f ms, sampling every %zu bytes %.3f ms, %.2f%% overhead",
+                unsampledMS, static_cast<zp_size_t>( kDefaultMemorySamplingRate ), sampledMS, ( sampledMS / unsampledMS - 1.0 ) * 100.0 );
+
+            ZP_FREE( MemoryLabels::Default, memory );
+        }
+#endif
     }
+#endif // ZP_USE_BENCHMARKS
 }
+#endif
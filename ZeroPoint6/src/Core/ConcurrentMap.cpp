@@ -0,0 +1,171 @@
+//
+// Created by phosg on 10/16/2026.
+//
+
+#include "Core/ConcurrentMap.h"
+#include "Core/Atomic.h"
+
+#include "Platform/Platform.h"
+
+namespace zp
+{
+    namespace ConcurrentMapStripe
+    {
+        void AcquireLock( zp_int32_t* lock )
+        {
+            while( Atomic::CompareExchange( lock, 1, 0 ) != 0 )
+            {
+                Platform::YieldCurrentThread();
+            }
+        }
+
+        void ReleaseLock( zp_int32_t* lock )
+        {
+            Atomic::Exchange( lock, 0 );
+        }
+    }
+}
+
+#if ZP_USE_TESTS
+#include "Test/Test.h"
+
+using namespace zp;
+
+ZP_TEST_GROUP( ConcurrentMap )
+{
+    ZP_TEST_SUITE( ConcurrentMap )
+    {
+        namespace
+        {
+            constexpr zp_uint32_t kTestMaxThreads = 4;
+            constexpr zp_uint64_t kTestKeyCount = 1024;
+
+            typedef ConcurrentMap<zp_uint64_t, zp_uint64_t> TestConcurrentMap;
+
+            struct GetOrAddTestContext
+            {
+                TestConcurrentMap* map;
+                zp_int32_t factoryCalls;
+                zp_uint32_t started;
+                zp_uint32_t mismatches;
+            };
+
+            zp_uint32_t GetOrAddThreadFunc( void* threadData )
+            {
+                GetOrAddTestContext* ctx = static_cast<GetOrAddTestContext*>( threadData );
+
+                Atomic::Increment( reinterpret_cast<zp_int32_t*>( &ctx->started ) );
+                while( Atomic::LoadAcquire( &ctx->started ) < kTestMaxThreads )
+                {
+                    Platform::YieldCurrentThread();
+                }
+
+                // every thread asks for every key, readers race the writers growing the stripes
+                for( zp_uint64_t i = 0; i < kTestKeyCount; ++i )
+                {
+                    const zp_uint64_t value = ctx->map->getOrAdd( i, [ ctx, i ]()
+                    {
+                        Atomic::Increment( &ctx->factoryCalls );
+                        return i * 7;
+                    } );
+
+                    if( value != i * 7 )
+                    {
+                        Atomic::Increment( &ctx->mismatches );
+                    }
+                }
+
+                return 0;
+            }
+        }
+
+        ZP_TEST( AddAndFind )
+        {
+            TestConcurrentMap map( MemoryLabels::Default );
+
+            ZP_CHECK_EQUALS( map.find( 1 ), nullptr );
+
+            for( zp_uint64_t i = 0; i < kTestKeyCount; ++i )
+            {
+                ZP_CHECK_EQUALS( map.tryAdd( i, i + 1 ), true );
+            }
+
+            ZP_CHECK_EQUALS( map.tryAdd( 5, 0 ), false );
+            ZP_CHECK_EQUALS( map.size(), kTestKeyCount );
+
+            zp_size_t found = 0;
+            for( zp_uint64_t i = 0; i < kTestKeyCount; ++i )
+            {
+                zp_uint64_t value = 0;
+                found += map.tryGet( i, value ) && value == i + 1 ? 1 : 0;
+            }
+
+            ZP_CHECK_EQUALS( found, kTestKeyCount );
+            ZP_CHECK_EQUALS( map.containsKey( kTestKeyCount ), false );
+
+            zp_size_t iterated = 0;
+            for( auto b = map.begin(), e = map.end(); b != e; ++b )
+            {
+                iterated += b.value() == b.key() + 1 ? 1 : 0;
+            }
+
+            ZP_CHECK_EQUALS( iterated, kTestKeyCount );
+        }
+
+        ZP_TEST( ValuePointersStayValid )
+        {
+            TestConcurrentMap map( MemoryLabels::Default );
+
+            zp_uint64_t* first = &map.getOrAdd( 0, []()
+            {
+                return 100ull;
+            } );
+
+            // enough adds to grow every stripe table several times
+            for( zp_uint64_t i = 1; i < kTestKeyCount; ++i )
+            {
+                map.tryAdd( i, i );
+            }
+
+            ZP_CHECK_EQUALS( map.find( 0 ), first );
+            ZP_CHECK_EQUALS( *first, 100 );
+
+            map.clear();
+
+            ZP_CHECK_EQUALS( map.size(), 0 );
+            ZP_CHECK_EQUALS( map.find( 0 ), nullptr );
+            ZP_CHECK_EQUALS( map.tryAdd( 0, 1 ), true );
+        }
+
+        ZP_TEST( GetOrAddRunsFactoryOncePerKey )
+        {
+            TestConcurrentMap map( MemoryLabels::Default );
+
+            GetOrAddTestContext ctx {
+                .map = &map,
+                .factoryCalls = 0,
+                .started = 0,
+                .mismatches = 0,
+            };
+
+            ThreadHandle threadHandles[ kTestMaxThreads ];
+            for( ThreadHandle& threadHandle : threadHandles )
+            {
+                zp_uint32_t threadId;
+                threadHandle = Platform::CreateThread( GetOrAddThreadFunc, &ctx, 64 KB, &threadId );
+            }
+
+            Platform::JoinThreads( threadHandles, kTestMaxThreads );
+
+            for( ThreadHandle threadHandle : threadHandles )
+            {
+                Platform::CloseThread( threadHandle );
+            }
+
+            ZP_CHECK_EQUALS( ctx.factoryCalls, static_cast<zp_int32_t>( kTestKeyCount ) );
+            ZP_CHECK_EQUALS( ctx.mismatches, 0 );
+            ZP_CHECK_EQUALS( map.size(), kTestKeyCount );
+        }
+    }
+}
+#endif
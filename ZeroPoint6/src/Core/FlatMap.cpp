@@ -0,0 +1,290 @@
+//
+// Created by phosg on 10/16/2026.
+//
+
+#include "Core/FlatMap.h"
+
+namespace zp
+{
+    namespace FlatMapControl
+    {
+        alignas( kGroupWidth ) const zp_int8_t kEmptyGroup[ kGroupWidth ] {
+            Empty, Empty, Empty, Empty, Empty, Empty, Empty, Empty,
+            Empty, Empty, Empty, Empty, Empty, Empty, Empty, Empty,
+        };
+    }
+}
+
+#if ZP_USE_TESTS
+#include "Test/Test.h"
+#include "Core/Map.h"
+#include "Platform/Platform.h"
+
+using namespace zp;
+
+ZP_TEST_GROUP( FlatMap )
+{
+    ZP_TEST_SUITE( FlatMap )
+    {
+        namespace
+        {
+            struct NamedKey
+            {
+                zp_uint32_t id;
+                zp_uint32_t generation;
+
+                zp_bool_t operator==( const NamedKey& other ) const
+                {
+                    return id == other.id && generation == other.generation;
+                }
+            };
+
+            struct NamedKeyHash
+            {
+                zp_hash64_t operator()( const NamedKey& key ) const
+                {
+                    return zp_fnv64_1a( key.id );
+                }
+            };
+        }
+
+        ZP_TEST( EmptyLookup )
+        {
+            FlatMap<zp_uint64_t, zp_int32_t> map( MemoryLabels::Default );
+
+            zp_int32_t* value = nullptr;
+            ZP_CHECK_EQUALS( map.tryGet( 42, &value ), false );
+            ZP_CHECK_EQUALS( map.remove( 42 ), false );
+            ZP_CHECK_EQUALS( map.begin() == map.end(), true );
+            ZP_CHECK_EQUALS( map.capacity(), 0 );
+        }
+
+        ZP_TEST( SetGetGrow )
+        {
+            constexpr zp_uint64_t kCount = 10000;
+
+            FlatMap<zp_uint64_t, zp_uint64_t> map( MemoryLabels::Default );
+
+            for( zp_uint64_t i = 0; i < kCount; ++i )
+            {
+                map.set( i, i * 3 );
+            }
+
+            ZP_CHECK_EQUALS( map.size(), kCount );
+
+            zp_size_t found = 0;
+            for( zp_uint64_t i = 0; i < kCount; ++i )
+            {
+                zp_uint64_t value = 0;
+                found += map.tryGet( i, value ) && value == i * 3 ? 1 : 0;
+            }
+
+            ZP_CHECK_EQUALS( found, kCount );
+            ZP_CHECK_EQUALS( map.containsKey( kCount ), false );
+
+            // set on an existing key assigns in place
+            map.set( 7, 1 );
+            ZP_CHECK_EQUALS( map.size(), kCount );
+            ZP_CHECK_EQUALS( map[ 7 ], 1 );
+
+            zp_size_t iterated = 0;
+            for( auto b = map.begin(), e = map.end(); b != e; ++b )
+            {
+                ++iterated;
+            }
+
+            ZP_CHECK_EQUALS( iterated, kCount );
+        }
+
+        ZP_TEST( RemoveAndReuse )
+        {
+            constexpr zp_uint64_t kCount = 1000;
+
+            FlatMap<zp_uint64_t, zp_uint64_t> map( MemoryLabels::Default, kCount );
+            const zp_size_t capacity = map.capacity();
+
+            // churn through many more keys than fit, removed slots have to be reclaimed without the table growing
+            for( zp_uint64_t round = 0; round < 16; ++round )
+            {
+                for( zp_uint64_t i = 0; i < kCount; ++i )
+                {
+                    map.set( round * kCount + i, i );
+                }
+
+                for( zp_uint64_t i = 0; i < kCount; ++i )
+                {
+                    map.remove( round * kCount + i );
+                }
+            }
+
+            ZP_CHECK_EQUALS( map.size(), 0 );
+            ZP_CHECK_EQUALS( map.capacity(), capacity );
+
+            for( zp_uint64_t i = 0; i < kCount; i += 2 )
+            {
+                map.set( i, i );
+            }
+
+            for( zp_uint64_t i = 0; i < kCount; i += 4 )
+            {
+                map.remove( i );
+            }
+
+            zp_size_t found = 0;
+            for( zp_uint64_t i = 0; i < kCount; ++i )
+            {
+                found += map.containsKey( i ) ? 1 : 0;
+            }
+
+            ZP_CHECK_EQUALS( found, kCount / 4 );
+            ZP_CHECK_EQUALS( map.size(), kCount / 4 );
+        }
+
+        ZP_TEST( PrecomputedHashLookup )
+        {
+            FlatMap<NamedKey, zp_int32_t, zp_hash64_t, DefaultEquality<NamedKey>, NamedKeyHash> map( MemoryLabels::Default );
+
+            const NamedKey key { .id = 12, .generation = 3 };
+            const zp_hash64_t hash = NamedKeyHash()( key );
+
+            map.set( hash, key, 5 );
+
+            // look up by id alone, only the stored key type is ever hashed
+            const zp_int32_t* value = map.find( zp_fnv64_1a( 12u ), 12u, []( const NamedKey& stored, zp_uint32_t id )
+            {
+                return stored.id == id;
+            } );
+
+            ZP_CHECK_NOT_EQUALS( value, nullptr );
+            ZP_CHECK_EQUALS( *value, 5 );
+
+            zp_int32_t* keyValue = nullptr;
+            ZP_CHECK_EQUALS( map.tryGet( hash, key, keyValue ), true );
+            ZP_CHECK_EQUALS( keyValue, value );
+
+            ZP_CHECK_EQUALS( map.containsKey( NamedKey { .id = 12, .generation = 4 } ), false );
+        }
+
+        ZP_TEST( ClearKeepsCapacity )
+        {
+            FlatMap<zp_uint64_t, zp_uint64_t> map( MemoryLabels::Default );
+
+            for( zp_uint64_t i = 0; i < 100; ++i )
+            {
+                map[ i ] = i;
+            }
+
+            const zp_size_t capacity = map.capacity();
+            map.clear();
+
+            ZP_CHECK_EQUALS( map.size(), 0 );
+            ZP_CHECK_EQUALS( map.capacity(), capacity );
+            ZP_CHECK_EQUALS( map.containsKey( 10 ), false );
+
+            map.destroy();
+            ZP_CHECK_EQUALS( map.capacity(), 0 );
+            ZP_CHECK_EQUALS( map.containsKey( 10 ), false );
+        }
+    }
+
+#if ZP_USE_BENCHMARKS
+    ZP_TEST_SUITE( FlatMapBenchmark )
+    {
+        namespace
+        {
+            constexpr zp_size_t kMinEntryCount = 1000;
+            constexpr zp_size_t kMaxEntryCount = 1000000;
+            constexpr zp_size_t kLookupCount = 1000000;
+
+            zp_uint64_t NextKey( zp_uint64_t& rng )
+            {
+                rng ^= rng << 13;
+                rng ^= rng >> 7;
+                rng ^= rng << 17;
+                return rng;
+            }
+
+            zp_float64_t TicksToMilliseconds( zp_time_t ticks )
+            {
+                return static_cast<zp_float64_t>( ticks ) * 1000.0 / static_cast<zp_float64_t>( Platform::TimeFrequency() );
+            }
+
+            // keys are even so odd keys are guaranteed misses
+            void FillKeys( zp_uint64_t* keys, zp_size_t count )
+            {
+                zp_uint64_t rng = 0x9E3779B97F4A7C15ull;
+                for( zp_size_t i = 0; i < count; ++i )
+                {
+                    keys[ i ] = NextKey( rng ) & ~1ull;
+                }
+            }
+
+            template<typename M>
+            zp_float64_t RunLookups( const M& map, const zp_uint64_t* keys, zp_size_t count, zp_uint64_t missBit, zp_size_t& outFound )
+            {
+                zp_uint64_t rng = 0xD1B54A32D192ED03ull;
+                zp_size_t found = 0;
+
+                const zp_time_t start = Platform::TimeNow();
+
+                for( zp_size_t i = 0; i < kLookupCount; ++i )
+                {
+                    zp_uint64_t* value = nullptr;
+                    found += map.tryGet( keys[ NextKey( rng ) % count ] | missBit, &value ) ? 1 : 0;
+                }
+
+                const zp_time_t elapsed = Platform::TimeNow() - start;
+
+                outFound = found;
+                return TicksToMilliseconds( elapsed );
+            }
+
+            template<typename M>
+            void RunMapBenchmark( const char* name, const zp_uint64_t* keys, zp_size_t count, zp_bool_t& outCorrect )
+            {
+                M map( MemoryLabels::Default );
+
+                const zp_time_t start = Platform::TimeNow();
+
+                for( zp_size_t i = 0; i < count; ++i )
+                {
+                    map.set( keys[ i ], i );
+                }
+
+                const zp_float64_t insertMS = TicksToMilliseconds( Platform::TimeNow() - start );
+
+                zp_size_t hits;
+                zp_size_t misses;
+                const zp_float64_t hitMS = RunLookups( map, keys, count, 0, hits );
+                const zp_float64_t missMS = RunLookups( map, keys, count, 1, misses );
+
+                outCorrect = hits == kLookupCount && misses == 0;
+
+                zp_printfln( "[BENCH] %s %zu entries: insert %.3f ms, %zu hits %.3f ms (%.1f ns/op), %zu misses %.3f ms (%.1f ns/op)",
+                    name, count, insertMS, static_cast<zp_size_t>( kLookupCount ), hitMS, hitMS * 1000000.0 / kLookupCount, static_cast<zp_size_t>( kLookupCount ), missMS, missMS * 1000000.0 / kLookupCount );
+            }
+        }
+
+        ZP_TEST( LookupHitMiss )
+        {
+            zp_uint64_t* keys = ZP_MALLOC_T_ARRAY( MemoryLabels::Default, zp_uint64_t, kMaxEntryCount );
+            FillKeys( keys, kMaxEntryCount );
+
+            for( zp_size_t count = kMinEntryCount; count <= kMaxEntryCount; count *= 10 )
+            {
+                zp_bool_t mapCorrect;
+                zp_bool_t flatMapCorrect;
+
+                RunMapBenchmark<Map<zp_uint64_t, zp_uint64_t>>( "Map", keys, count, mapCorrect );
+                RunMapBenchmark<FlatMap<zp_uint64_t, zp_uint64_t>>( "FlatMap", keys, count, flatMapCorrect );
+
+                ZP_CHECK_EQUALS( mapCorrect, true );
+                ZP_CHECK_EQUALS( flatMapCorrect, true );
+            }
+
+            ZP_FREE( MemoryLabels::Default, keys );
+        }
+    }
+#endif // ZP_USE_BENCHMARKS
+}
+#endif
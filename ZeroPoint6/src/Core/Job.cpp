@@ -38,43 +38,115 @@ namespace zp
         {
             kJobDataSize = 64,
 
-            kJobsPerThread = 128,
-            kJobsPerThreadMask = kJobsPerThread - 1,
+            kJobPriorityCount = static_cast<zp_size_t>( JobPriority::Count ),
 
-            kJobQueueCount = 64,
-            kJobQueueCountMask = kJobQueueCount - 1,
+            kJobsPerBlock = 128,
+
+            kMaxJobDependencies = 8,
+
+            kJobQueueInitialCapacity = 256,
+
+            kCacheLineSize = 64,
+
+            kJobScratchMemorySize = 256 KB,
+            kJobScratchMemoryAlignment = 64,
+
+            kWorkerMinSpinCount = 64,
+            kWorkerMaxSpinCount = 4096,
+
+            kTaskFrameHeaderSize = kDefaultMemoryAlignment,
+            kTaskFrameMinSize = 128,
+            kTaskFrameSizeClassCount = 6,
+
+            kJobStealTierCount = 3,
+
+            kJobWorkerCounterCount = 5,
+
+            kJobFrameCount = 2,
         };
 
-        ZP_STATIC_ASSERT( zp_is_pow2( kJobQueueCount ) );
-        ZP_STATIC_ASSERT( zp_is_pow2( kJobsPerThread ) );
+        ZP_STATIC_ASSERT( zp_is_pow2( kJobQueueInitialCapacity ) );
     }; // namespace
 
+    struct JobContinuation
+    {
+        Job* job;
+        JobContinuation* next;
+    };
+
     struct Job
     {
         Job* parentJob;
-        Job* nextJob;
+        Job* nextFreeJob;
+        JobContinuation* continuations;
         JobWorkFunc callback;
         zp_size_t jobSharedMemorySize;
         zp_uint32_t uncompletedJobs;
-        zp_uint32_t batchId;
-        zp_uint32_t jobStart;
-        zp_uint32_t jobEnd;
+        zp_uint32_t pendingDependencies;
+        zp_int32_t continuationLock;
+        zp_bool_t continuationsReleased;
+        zp_uint32_t generation;
+        zp_uint32_t poolIndex;
+        zp_uint32_t frameIndex;
+        zp_size_t batchId;
+        zp_size_t jobStart;
+        zp_size_t jobEnd;
+        zp_size_t splitGrain;
+        JobPriority priority;
 #if USE_JOB_STATE_TRACKING
         JobState state;
 #endif // USE_JOB_STATE_TRACKING
+        FixedArray<JobContinuation, kMaxJobDependencies> dependencyContinuations;
         FixedArray<zp_uint8_t, kJobDataSize> data;
     };
 
 #pragma region JobQueue
     namespace
     {
+        struct JobQueueBuffer
+        {
+            JobQueueBuffer* retired;
+            zp_int64_t capacity;
+            zp_int64_t mask;
+            Job** jobs;
+        };
+
+        JobQueueBuffer* AllocateJobQueueBuffer( MemoryLabel memoryLabel, zp_int64_t capacity )
+        {
+            ZP_ASSERT( zp_is_pow2( static_cast<zp_uint32_t>( capacity ) ) );
+
+            void* mem = ZP_MALLOC( memoryLabel, sizeof( JobQueueBuffer ) + sizeof( Job* ) * capacity );
+
+            JobQueueBuffer* buffer = static_cast<JobQueueBuffer*>( mem );
+            buffer->retired = nullptr;
+            buffer->capacity = capacity;
+            buffer->mask = capacity - 1;
+            buffer->jobs = reinterpret_cast<Job**>( buffer + 1 );
+
+            return buffer;
+        }
+
+        //
+        // Chase-Lev work stealing deque. The owning thread pushes and pops from the back, any other thread may steal from the front.
+        // When full, the owner doubles the buffer. Old buffers can still be read by in-flight steals so they are retired and only
+        // freed when the queue is destroyed (total retired memory is always less than the live buffer).
+        //
+
         class JobQueue
         {
         public:
             JobQueue() = default;
 
+            ~JobQueue();
+
+            void create( MemoryLabel memoryLabel, zp_int64_t capacity );
+
+            void destroy();
+
             [[nodiscard]] zp_bool_t empty() const;
 
+            [[nodiscard]] zp_size_t size() const;
+
             void pushBack( Job* job );
 
             Job* popBack();
@@ -84,54 +156,110 @@ namespace zp
             void clear();
 
         private:
-            zp_size_t m_back;
-            zp_size_t m_front;
-            FixedArray<Job*, kJobQueueCount> m_jobs;
+            JobQueueBuffer* grow( JobQueueBuffer* buffer, zp_int64_t front, zp_int64_t back );
+
+            zp_int64_t m_front {};
+            FixedArray<zp_uint8_t, kCacheLineSize - sizeof( zp_int64_t )> m_frontPadding;
+
+            zp_int64_t m_back {};
+            JobQueueBuffer* m_buffer {};
+            MemoryLabel m_memoryLabel {};
         };
 
         //
         //
         //
 
+        JobQueue::~JobQueue()
+        {
+            destroy();
+        }
+
+        void JobQueue::create( MemoryLabel memoryLabel, zp_int64_t capacity )
+        {
+            ZP_ASSERT( m_buffer == nullptr );
+
+            m_front = 0;
+            m_back = 0;
+            m_buffer = AllocateJobQueueBuffer( memoryLabel, capacity );
+            m_memoryLabel = memoryLabel;
+        }
+
+        void JobQueue::destroy()
+        {
+            JobQueueBuffer* buffer = m_buffer;
+            while( buffer != nullptr )
+            {
+                JobQueueBuffer* retired = buffer->retired;
+                ZP_FREE( m_memoryLabel, buffer );
+                buffer = retired;
+            }
+
+            m_front = 0;
+            m_back = 0;
+            m_buffer = nullptr;
+        }
+
         zp_bool_t JobQueue::empty() const
         {
-            return m_back == m_front;
+            return Atomic::LoadRelaxed( &m_back ) <= Atomic::LoadRelaxed( &m_front );
+        }
+
+        zp_size_t JobQueue::size() const
+        {
+            const zp_int64_t count = Atomic::LoadRelaxed( &m_back ) - Atomic::LoadRelaxed( &m_front );
+            return count > 0 ? static_cast<zp_size_t>( count ) : 0;
         }
 
         void JobQueue::pushBack( Job* job )
         {
-            const zp_size_t back = m_back;
-            m_jobs[ back & kJobQueueCountMask ] = job;
-            Atomic::ExchangeSizeT( &m_back, back + 1 );
+            const zp_int64_t back = Atomic::LoadRelaxed( &m_back );
+            const zp_int64_t front = Atomic::LoadAcquire( &m_front );
+
+            JobQueueBuffer* buffer = m_buffer;
+            if( back - front >= buffer->capacity )
+            {
+                buffer = grow( buffer, front, back );
+            }
+
+            buffer->jobs[ back & buffer->mask ] = job;
+
+            // publish the job before the new back is visible to thieves
+            Atomic::StoreRelease( &m_back, back + 1 );
         }
 
         Job* JobQueue::popBack()
         {
-            const zp_size_t back = m_back - 1;
-            Atomic::ExchangeSizeT( &m_back, back );
+            const zp_int64_t back = Atomic::LoadRelaxed( &m_back ) - 1;
+            JobQueueBuffer* buffer = m_buffer;
+
+            Atomic::StoreRelaxed( &m_back, back );
 
-            const zp_size_t front = m_front;
+            // back must be visible before front is read, otherwise a thief and the owner can both take the last job
+            Atomic::MemoryBarrier();
+
+            const zp_int64_t front = Atomic::LoadRelaxed( &m_front );
 
             Job* job = nullptr;
 
             if( front <= back )
             {
-                job = m_jobs[ back & kJobQueueCountMask ];
-                if( front != back )
-                {
-                    return job;
-                }
+                job = buffer->jobs[ back & buffer->mask ];
 
-                if( Atomic::CompareExchangeSizeT( &m_front, front + 1, front ) != front )
+                if( front == back )
                 {
-                    job = nullptr;
-                }
+                    // last job, race any thieves for it
+                    if( Atomic::CompareExchange( &m_front, front + 1, front ) != front )
+                    {
+                        job = nullptr;
+                    }
 
-                m_back = front + 1;
+                    Atomic::StoreRelaxed( &m_back, back + 1 );
+                }
             }
             else
             {
-                m_back = front;
+                Atomic::StoreRelaxed( &m_back, back + 1 );
             }
 
             return job;
@@ -139,19 +267,20 @@ namespace zp
 
         Job* JobQueue::stealPopFront()
         {
-            const zp_size_t front = m_front;
+            const zp_int64_t front = Atomic::LoadAcquire( &m_front );
 
             Atomic::MemoryBarrier();
 
-            const zp_size_t back = m_back;
+            const zp_int64_t back = Atomic::LoadAcquire( &m_back );
 
             Job* job = nullptr;
 
             if( front < back )
             {
-                job = m_jobs[ front & kJobQueueCountMask ];
+                const JobQueueBuffer* buffer = Atomic::LoadAcquirePtr( &m_buffer );
+                job = buffer->jobs[ front & buffer->mask ];
 
-                if( Atomic::CompareExchangeSizeT( &m_front, front + 1, front ) != front )
+                if( Atomic::CompareExchange( &m_front, front + 1, front ) != front )
                 {
                     job = nullptr;
                 }
@@ -165,1347 +294,3262 @@ namespace zp
             m_front = 0;
             m_back = 0;
         }
+
+        JobQueueBuffer* JobQueue::grow( JobQueueBuffer* buffer, zp_int64_t front, zp_int64_t back )
+        {
+            JobQueueBuffer* newBuffer = AllocateJobQueueBuffer( m_memoryLabel, buffer->capacity * 2 );
+
+            for( zp_int64_t i = front; i < back; ++i )
+            {
+                newBuffer->jobs[ i & newBuffer->mask ] = buffer->jobs[ i & buffer->mask ];
+            }
+
+            newBuffer->retired = buffer;
+
+            Atomic::StoreReleasePtr( &m_buffer, newBuffer );
+
+            return newBuffer;
+        }
     } // namespace
 #pragma endregion
 
+#pragma region JobPool
     namespace
     {
-        struct JobThreadInfo
+        struct JobBlock
         {
-            FixedArray<Job, kJobsPerThread> jobs;
-            zp_size_t allocatedJobCount;
-            JobQueue* localJobQueue;
-            JobQueue* localBatchJobQueue;
-            zp_uint32_t threadId;
-            CriticalSection lock;
+            JobBlock* next;
+            FixedArray<Job, kJobsPerBlock> jobs;
         };
 
-        thread_local JobThreadInfo t_threadInfo;
-
-        //
-        //
-        //
-
-        struct JobSystemContext
+        struct TaskFrame
         {
-            Vector<JobQueue> allJobQueues;
-            Vector<JobQueue> allBatchJobQueues;
-            Vector<ThreadHandle> allWorkerThreadHandles;
-            zp_size_t stealJobQueueIndex;
-            zp_size_t nextJobQueueIndex;
-            ConditionVariable wakeCondition;
-            zp_uint32_t threadCount;
-            zp_int32_t isRunning;
+            TaskFrame* next;
+            zp_uint32_t poolIndex;
+            zp_uint32_t sizeClass;
         };
 
-        JobSystemContext g_context {};
+        ZP_STATIC_ASSERT( sizeof( TaskFrame ) <= kTaskFrameHeaderSize );
 
         //
-        //
+        // Each thread allocates jobs from its own pool. Jobs freed by the owning thread go straight back on the local free list,
+        // jobs freed by any other thread are pushed onto the remote list which the owner takes in one exchange when it runs dry.
+        // Blocks are never released while the job system is running so a stale JobHandle can always read the generation.
+        // Coroutine frames are recycled the same way, bucketed by power of two size starting at kTaskFrameMinSize.
         //
 
-        void InitializeLocalThreadInfo( const zp_size_t index )
+        struct JobPool
         {
-            JobThreadInfo& info = t_threadInfo;
-            info = {};
+            Job* freeJobs;
+            JobBlock* blocks;
+            zp_size_t allocatedBlockCount;
+            FixedArray<zp_uint8_t, kCacheLineSize - sizeof( Job* ) - sizeof( JobBlock* ) - sizeof( zp_size_t )> m_freePadding;
 
-            info.allocatedJobCount = 0;
-            info.localJobQueue = &g_context.allJobQueues[ index ];
-            info.localBatchJobQueue = &g_context.allBatchJobQueues[ index ];
-            info.threadId = Platform::GetCurrentThreadId();
-            info.lock = Platform::CreateCriticalSection();
-        }
+            Job* remoteFreeJobs;
+            FixedArray<zp_uint8_t, kCacheLineSize - sizeof( Job* )> m_remotePadding;
 
-        void DestroyLocalThreadInfo()
-        {
-            JobThreadInfo& info = t_threadInfo;
+            FixedArray<TaskFrame*, kTaskFrameSizeClassCount> freeTaskFrames;
+            FixedArray<zp_uint8_t, kCacheLineSize - ( sizeof( TaskFrame* ) * kTaskFrameSizeClassCount )> m_freeTaskFramePadding;
 
-            info.allocatedJobCount = 0;
-            info.localJobQueue = nullptr;
-            info.localBatchJobQueue = nullptr;
-            Platform::CloseCriticalSection( info.lock );
-        }
+            FixedArray<TaskFrame*, kTaskFrameSizeClassCount> remoteFreeTaskFrames;
+            FixedArray<zp_uint8_t, kCacheLineSize - ( sizeof( TaskFrame* ) * kTaskFrameSizeClassCount )> m_remoteTaskFramePadding;
+        };
 
-        JobQueue* GetLocalJobQueue()
+        Job* AllocateJobBlock( JobPool* pool, zp_uint32_t poolIndex )
         {
-            return t_threadInfo.localJobQueue;
-        }
+            JobBlock* block = ZP_MALLOC_T( MemoryLabels::ThreadSafe, JobBlock );
+            zp_zero_memory( block, sizeof( JobBlock ) );
 
-        JobQueue* GetLocalBatchJobQueue()
-        {
-            return t_threadInfo.localBatchJobQueue;
-        }
+            for( zp_size_t i = 0; i < kJobsPerBlock; ++i )
+            {
+                Job& job = block->jobs[ i ];
+                job.nextFreeJob = i + 1 < kJobsPerBlock ? &block->jobs[ i + 1 ] : nullptr;
+                job.poolIndex = poolIndex;
+            }
 
-        JobQueue* GetStealJobQueue()
-        {
-            const zp_size_t index = Atomic::IncrementSizeT( &g_context.stealJobQueueIndex ) - 1;
-            return &g_context.allJobQueues[ index % g_context.allJobQueues.length() ];
+            block->next = pool->blocks;
+            pool->blocks = block;
+            ++pool->allocatedBlockCount;
+
+            return block->jobs.data();
         }
 
-        JobQueue* GetNextJobQueue()
+        void FreeTaskFrameList( TaskFrame* frame )
         {
-            const zp_size_t index = Atomic::IncrementSizeT( &g_context.nextJobQueueIndex ) - 1;
-            return &g_context.allJobQueues[ index % g_context.allJobQueues.length() ];
+            while( frame != nullptr )
+            {
+                TaskFrame* next = frame->next;
+                ZP_FREE( MemoryLabels::ThreadSafe, frame );
+                frame = next;
+            }
         }
 
-        Job* AllocateJob()
+        zp_uint32_t GetTaskFrameSizeClass( zp_size_t frameSize )
         {
-            Job* job {};
-
-            const zp_size_t index = t_threadInfo.allocatedJobCount % kJobsPerThread;
-            ++t_threadInfo.allocatedJobCount;
+            zp_uint32_t sizeClass = 0;
+            while( sizeClass < kTaskFrameSizeClassCount && ( static_cast<zp_size_t>( kTaskFrameMinSize ) << sizeClass ) < frameSize )
+            {
+                ++sizeClass;
+            }
 
-            job = &t_threadInfo.jobs[ index ];
+            return sizeClass;
+        }
 
-#if USE_JOB_STATE_TRACKING
-            ZP_ASSERT( job->state == JobState::Idle );
-            job->state = JobState::Allocated;
-#endif // USE_JOB_STATE_TRACKING
+        void DestroyJobPool( JobPool* pool )
+        {
+            JobBlock* block = pool->blocks;
+            while( block != nullptr )
+            {
+                JobBlock* next = block->next;
+                ZP_FREE( MemoryLabels::ThreadSafe, block );
+                block = next;
+            }
 
-            job->parentJob = nullptr;
-            job->nextJob = nullptr;
-            job->callback = nullptr;
-            job->jobSharedMemorySize = 0;
-            job->uncompletedJobs = 1;
-            job->batchId = 0;
-            job->jobStart = 0;
-            job->jobEnd = 1;
-            zp_zero_memory( job->data.data(), job->data.length() );
+            // frames still owned by a Task are leaked, tasks must not outlive the job system
+            for( zp_size_t sizeClass = 0; sizeClass < kTaskFrameSizeClassCount; ++sizeClass )
+            {
+                FreeTaskFrameList( pool->freeTaskFrames[ sizeClass ] );
+                FreeTaskFrameList( pool->remoteFreeTaskFrames[ sizeClass ] );
+            }
 
-            return job;
+            *pool = {};
         }
+    } // namespace
+#pragma endregion
 
-        void FreeJob( Job* job )
+#pragma region JobScratchArena
+    namespace
+    {
+        struct JobScratchOverflow
         {
-#if USE_JOB_STATE_TRACKING
-            ZP_ASSERT( job->state == JobState::Finished );
-            job->state = JobState::Idle;
-#endif // USE_JOB_STATE_TRACKING
-        }
+            JobScratchOverflow* next;
+        };
 
-        void PrepareLocalJob( Job* job )
-        {
-#if USE_JOB_STATE_TRACKING
-            job->state = JobState::Prepared;
-#endif // USE_JOB_STATE_TRACKING
-            GetLocalBatchJobQueue()->pushBack( job );
-        }
+        //
+        // Per thread linear arena backing job shared memory and scratch allocations. Each job execution restores the offset it
+        // started with, so nested jobs (run while waiting on another job) unwind like a stack. Allocations that don't fit fall
+        // back to the ThreadSafe allocator and are released when the outermost job returns.
+        //
 
-        void QueueLocalJob( Job* job )
+        struct JobScratchArena
         {
-#if USE_JOB_STATE_TRACKING
-            job->state = JobState::Queued;
-#endif // USE_JOB_STATE_TRACKING
-            GetLocalJobQueue()->pushBack( job );
-        }
+            zp_uint8_t* memory;
+            zp_size_t capacity;
+            zp_size_t offset;
+            JobScratchOverflow* overflow;
+            zp_uint32_t depth;
+        };
 
-        void QueueNextJob( Job* job )
+        void CreateJobScratchArena( JobScratchArena& arena, zp_size_t capacity )
         {
-#if USE_JOB_STATE_TRACKING
-            job->state = JobState::Queued;
-#endif // USE_JOB_STATE_TRACKING
-            GetNextJobQueue()->pushBack( job );
+            arena = {
+                .memory = static_cast<zp_uint8_t*>( GetAllocator( MemoryLabels::ThreadSafe )->allocate( capacity, kJobScratchMemoryAlignment, MemoryLabels::ThreadSafe ) ),
+                .capacity = capacity,
+            };
         }
 
-        void AddJobDependency( Job* job, Job* dependency )
+        void DestroyJobScratchArena( JobScratchArena& arena )
         {
-            ZP_ASSERT( job->nextJob == nullptr );
+            ZP_ASSERT( arena.depth == 0 );
+            ZP_ASSERT( arena.overflow == nullptr );
 
-            // push front
-            job->nextJob = dependency->nextJob;
-            dependency->nextJob = job;
-        }
-
-        void SetParentJob( Job* job, Job* parentJob )
-        {
-            ZP_ASSERT( job->parentJob == nullptr );
-            job->parentJob = parentJob;
+            if( arena.memory != nullptr )
+            {
+                ZP_FREE( MemoryLabels::ThreadSafe, arena.memory );
+            }
 
-            Atomic::Increment( &parentJob->uncompletedJobs );
+            arena = {};
         }
 
-        void FinishJob( Job* job )
+        Memory AllocateJobScratchMemory( JobScratchArena& arena, zp_size_t size, zp_size_t alignment )
         {
-            const zp_size_t unfinishedJobs = Atomic::Decrement( &job->uncompletedJobs );
+            ZP_ASSERT( arena.depth > 0 );
 
-            if( unfinishedJobs == 0 )
+            if( size == 0 )
             {
-#if USE_JOB_STATE_TRACKING
-                job->state = JobState::Finished;
-#endif // USE_JOB_STATE_TRACKING
-
-                Job* parent = job->parentJob;
-                if( parent != nullptr )
-                {
-                    FinishJob( parent );
-                }
+                return {};
+            }
 
-                if( job->nextJob != nullptr )
-                {
-                    Job* dep = job->nextJob;
-                    while( dep != nullptr )
-                    {
-                        QueueNextJob( dep );
+            const zp_size_t offset = zp_align_size( arena.offset, alignment );
+            if( offset + size <= arena.capacity )
+            {
+                arena.offset = offset + size;
+                return { arena.memory + offset, size };
+            }
 
-                        dep = dep->nextJob;
-                    }
+            const zp_size_t headerSize = zp_align_size( sizeof( JobScratchOverflow ), alignment );
 
-                    Platform::NotifyAllConditionVariable( g_context.wakeCondition );
-                }
+            JobScratchOverflow* overflow = static_cast<JobScratchOverflow*>( GetAllocator( MemoryLabels::ThreadSafe )->allocate( headerSize + size, zp_max( alignment, static_cast<zp_size_t>( kDefaultMemoryAlignment ) ), MemoryLabels::ThreadSafe ) );
+            overflow->next = arena.overflow;
+            arena.overflow = overflow;
 
-                FreeJob( job );
-            }
+            return { ZP_OFFSET_PTR( overflow, headerSize ), size };
         }
 
-        void ExecuteJob( Job* job )
+        zp_size_t BeginJobScratch( JobScratchArena& arena )
         {
-#if USE_JOB_STATE_TRACKING
-            job->state = JobState::Executing;
-#endif // USE_JOB_STATE_TRACKING
+            ++arena.depth;
+            return arena.offset;
+        }
 
-            if( job->callback )
-            {
-                Memory sharedMemory {
-                    job->jobSharedMemorySize == 0 ? nullptr : ZP_MALLOC( MemoryLabels::ThreadSafe, job->jobSharedMemorySize ),
-                    job->jobSharedMemorySize
-                };
+        void EndJobScratch( JobScratchArena& arena, zp_size_t marker )
+        {
+            ZP_ASSERT( arena.depth > 0 );
 
-                JobWorkArgs args {
-                    .currentJob { .job = job },
-                    .parentJob { .job = job->parentJob },
-                    .groupId = job->batchId,
-                    .jobMemory { job->data.data(), job->data.length() },
-                    .sharedMemory = sharedMemory,
-                };
+            arena.offset = marker;
+            --arena.depth;
 
-                for( zp_size_t offset = job->jobStart, end = job->jobEnd; offset < end; ++offset )
+            if( arena.depth == 0 )
+            {
+                JobScratchOverflow* overflow = arena.overflow;
+                while( overflow != nullptr )
                 {
-                    args.index = offset;
-                    job->callback( args );
+                    JobScratchOverflow* next = overflow->next;
+                    ZP_FREE( MemoryLabels::ThreadSafe, overflow );
+                    overflow = next;
                 }
 
-                if( sharedMemory.ptr() != nullptr )
-                {
-                    ZP_FREE( MemoryLabels::ThreadSafe, sharedMemory.ptr() );
-                }
+                arena.overflow = nullptr;
             }
-
-            FinishJob( job );
         }
+    } // namespace
+#pragma endregion
+
+    namespace
+    {
+        //
+        // Counters are only written by the owning thread with plain increments and read (racily, relaxed) when a snapshot is
+        // taken. Each thread's counters sit on their own cache line.
+        //
 
-        Job* RequestQueuedJob()
+        struct JobWorkerCounters
         {
-            Job* job = nullptr;
+            zp_int64_t executedJobs;
+            zp_int64_t steals;
+            zp_int64_t failedSteals;
+            zp_int64_t parks;
+            zp_int64_t idleTime;
+            FixedArray<zp_uint8_t, kCacheLineSize - ( sizeof( zp_int64_t ) * kJobWorkerCounterCount )> m_padding;
+        };
 
-            JobQueue* jobQueue = GetLocalJobQueue();
-            if( jobQueue != nullptr && !jobQueue->empty() )
-            {
-                job = jobQueue->popBack();
-            }
-            else
-            {
-                JobQueue* stealJobQueue = GetStealJobQueue();
-                if( stealJobQueue != jobQueue && !stealJobQueue->empty() )
-                {
-                    job = stealJobQueue->stealPopFront();
-                }
-            }
+        struct JobThreadInfo
+        {
+            JobPool* jobPool;
+            zp_uint32_t jobPoolIndex;
+            FixedArray<JobQueue*, kJobPriorityCount> localJobQueues;
+            JobQueue* localBatchJobQueue;
+            JobScratchArena scratchArena;
+            JobWorkerCounters* counters;
+            const zp_uint32_t* stealOrder;
+            FixedArray<zp_uint32_t, kJobStealTierCount> stealTierEnds;
+            zp_uint32_t stealOffset;
+            JobPriority executingPriority;
+            zp_uint32_t backgroundJobDepth;
+            zp_uint32_t threadId;
+            zp_uint32_t spinCount;
+        };
 
-            if( job == nullptr )
-            {
-            }
-#if USE_JOB_STATE_TRACKING
-            else
-            {
-                ZP_ASSERT( job->state == JobState::Queued );
-            }
-#endif // USE_JOB_STATE_TRACKING
+        thread_local JobThreadInfo t_threadInfo;
 
-            return job;
-        }
+        //
+        //
+        //
 
-        void FlushBatchJobs()
+        struct JobSystemContext
         {
-            JobQueue* batchQueue = GetLocalBatchJobQueue();
+            FixedArray<Vector<JobQueue>, kJobPriorityCount> allJobQueues;
+            Vector<JobQueue> allBatchJobQueues;
+            Vector<ThreadHandle> allWorkerThreadHandles;
+            Vector<JobPool> allJobPools;
+            Vector<ProcessorInfo> allProcessors;
+            Vector<ProcessorInfo> allJobQueueProcessors;
+            Vector<zp_uint32_t> allStealOrders;
+            Vector<zp_uint32_t> allStealTierEnds;
+            Vector<JobWorkerCounters> allWorkerCounters;
+            Vector<JobWorkerCounters> allWorkerCounterSnapshots;
+            Vector<JobWorkerStats> allWorkerStats;
+            FixedArray<zp_uint32_t, kJobFrameCount> outstandingFrameJobs;
+            zp_size_t nextJobQueueIndex;
+            Semaphore wakeSemaphore;
+            zp_uint32_t sleepingWorkerCount;
+            zp_uint32_t idleWorkerCount;
+            zp_uint32_t runningBackgroundJobCount;
+            zp_uint32_t maxBackgroundJobCount;
+            zp_uint32_t hardwareThreadsPerCore;
+            zp_uint32_t threadCount;
+            zp_uint32_t frameIndex;
+            zp_int32_t isRunning;
+        };
 
-            while( !batchQueue->empty() )
-            {
-                Job* job = batchQueue->popBack();
-                QueueNextJob( job );
-            }
-        }
+        JobSystemContext g_context {};
 
-        void FlushBatchJobsLocally()
+        //
+        // Threads take one hardware thread of every physical core first, then the next SMT sibling of every core, up to
+        // hardwareThreadsPerCore. Placement 0 is the main thread's. With more threads than slots placement wraps around.
+        //
+
+        void BuildJobThreadPlacement( const ProcessorInfo* processors, zp_uint32_t processorCount, zp_uint32_t hardwareThreadsPerCore, ProcessorInfo* placements, zp_uint32_t placementCount )
         {
-            JobQueue* batchQueue = GetLocalBatchJobQueue();
+            zp_uint32_t placed = 0;
+            for( zp_uint32_t smtIndex = 0; smtIndex < hardwareThreadsPerCore && placed < placementCount; ++smtIndex )
+            {
+                for( zp_uint32_t i = 0; i < processorCount && placed < placementCount; ++i )
+                {
+                    if( processors[ i ].smtIndex == smtIndex )
+                    {
+                        placements[ placed++ ] = processors[ i ];
+                    }
+                }
+            }
 
-            while( !batchQueue->empty() )
+            const zp_uint32_t slotCount = placed;
+            for( ; placed < placementCount; ++placed )
             {
-                Job* job = batchQueue->popBack();
-                QueueLocalJob( job );
+                placements[ placed ] = slotCount > 0 ? placements[ placed - slotCount ] : ProcessorInfo {};
             }
         }
 
-        zp_bool_t IsJobComplete( Job* job )
+        zp_uint32_t GetJobStealTier( const ProcessorInfo& thief, const ProcessorInfo& victim )
         {
-            return job == nullptr || job->uncompletedJobs == 0;
+            if( thief.numaNode != victim.numaNode )
+            {
+                return 2;
+            }
+
+            return thief.cacheIndex == victim.cacheIndex ? 0 : 1;
         }
 
-        void WaitForJobComplete( Job* job )
+        //
+        // Victims of a queue ordered nearest first: sharing a last level cache, then on the same NUMA node, then the rest.
+        // Within a tier the order starts after the thief so threads don't all converge on the same victim.
+        //
+
+        void BuildJobStealOrder( const ProcessorInfo* queueProcessors, zp_uint32_t queueCount, zp_uint32_t queueIndex, zp_uint32_t* stealOrder, zp_uint32_t* stealTierEnds )
         {
-            while( !IsJobComplete( job ) )
+            zp_uint32_t count = 0;
+            for( zp_uint32_t tier = 0; tier < kJobStealTierCount; ++tier )
             {
-                Job* waitJob = RequestQueuedJob();
-                if( waitJob != nullptr )
+                for( zp_uint32_t i = 1; i < queueCount; ++i )
                 {
-                    ExecuteJob( waitJob );
+                    const zp_uint32_t victim = ( queueIndex + i ) % queueCount;
+                    if( GetJobStealTier( queueProcessors[ queueIndex ], queueProcessors[ victim ] ) == tier )
+                    {
+                        stealOrder[ count++ ] = victim;
+                    }
                 }
+
+                stealTierEnds[ tier ] = count;
             }
         }
 
-        zp_uint32_t WorkerThreadFunc( void* threadData )
-        {
-#if ZP_USE_PROFILER
-            Profiler::InitializeProfilerThread();
-#endif
-
-            const zp_size_t index = static_cast<zp_size_t>( reinterpret_cast<zp_ptr_t>( threadData ) );
-
-            Log::info() << "Entering Worker Thread..." << Log::endl;
+        //
+        //
+        //
 
-            InitializeLocalThreadInfo( index );
+        void InitializeLocalThreadInfo( const zp_size_t index )
+        {
+            JobThreadInfo& info = t_threadInfo;
+            info = {};
 
-            while( Atomic::And( &g_context.isRunning, 1 ) == 1 )
+            info.jobPool = &g_context.allJobPools[ index ];
+            info.jobPoolIndex = static_cast<zp_uint32_t>( index );
+            for( zp_size_t priority = 0; priority < kJobPriorityCount; ++priority )
             {
-                Job* job = RequestQueuedJob();
-
-                while( job != nullptr )
-                {
-                    ExecuteJob( job );
-
-                    job = RequestQueuedJob();
-                }
-
-                Platform::EnterCriticalSection( t_threadInfo.lock );
-                Platform::WaitConditionVariable( g_context.wakeCondition, t_threadInfo.lock );
-                Platform::LeaveCriticalSection( t_threadInfo.lock );
+                info.localJobQueues[ priority ] = &g_context.allJobQueues[ priority ][ index ];
+            }
+            info.localBatchJobQueue = &g_context.allBatchJobQueues[ index ];
+            info.counters = &g_context.allWorkerCounters[ index ];
+            info.stealOrder = g_context.allStealOrders.data() + ( index * g_context.threadCount );
+            for( zp_size_t tier = 0; tier < kJobStealTierCount; ++tier )
+            {
+                info.stealTierEnds[ tier ] = g_context.allStealTierEnds[ ( index * kJobStealTierCount ) + tier ];
             }
+            info.executingPriority = JobPriority::Count;
+            info.threadId = Platform::GetCurrentThreadId();
+            info.spinCount = kWorkerMinSpinCount;
 
-            Log::info() << "Exiting Worker Thread" << Log::endl;
+            CreateJobScratchArena( info.scratchArena, kJobScratchMemorySize );
+        }
 
-            DestroyLocalThreadInfo();
+        void DestroyLocalThreadInfo()
+        {
+            JobThreadInfo& info = t_threadInfo;
 
-            return 0;
+            info.jobPool = nullptr;
+            info.localJobQueues = {};
+            info.localBatchJobQueue = nullptr;
+            info.counters = nullptr;
+
+            DestroyJobScratchArena( info.scratchArena );
         }
-    }; // namespace
 
-    void JobSystem::Setup( MemoryLabel memoryLabel, zp_uint32_t threadCount )
-    {
-        const zp_size_t jobQueueCount = threadCount + 1;
+        JobQueue* GetLocalJobQueue( JobPriority priority )
+        {
+            return t_threadInfo.localJobQueues[ static_cast<zp_size_t>( priority ) ];
+        }
 
-        g_context.allJobQueues = Vector<JobQueue>( jobQueueCount, memoryLabel );
-        g_context.allBatchJobQueues = Vector<JobQueue>( jobQueueCount, memoryLabel );
-        g_context.allWorkerThreadHandles = Vector<ThreadHandle>( threadCount, memoryLabel );
-        g_context.stealJobQueueIndex = 0;
-        g_context.nextJobQueueIndex = 0;
-        g_context.wakeCondition = Platform::CreateConditionVariable();
-        g_context.threadCount = threadCount;
-        g_context.isRunning = 0;
-    }
+        JobQueue* GetLocalBatchJobQueue()
+        {
+            return t_threadInfo.localBatchJobQueue;
+        }
 
-    void JobSystem::Teardown()
-    {
-        ExitJobThreads();
+        JobQueue* GetStealJobQueue( JobPriority priority )
+        {
+            Vector<JobQueue>& jobQueues = g_context.allJobQueues[ static_cast<zp_size_t>( priority ) ];
 
-        g_context.allJobQueues.destroy();
-        g_context.allBatchJobQueues.destroy();
-        g_context.allWorkerThreadHandles.destroy();
-    }
+            JobThreadInfo& info = t_threadInfo;
+            const zp_uint32_t offset = info.stealOffset++;
 
-    void JobSystem::InitializeJobThreads()
-    {
-        g_context.allJobQueues.reset();
-        g_context.allBatchJobQueues.reset();
-        g_context.allWorkerThreadHandles.reset();
+            // first non-empty victim from the nearest tier, rotating the starting victim every call
+            zp_uint32_t tierBegin = 0;
+            for( const zp_uint32_t tierEnd : info.stealTierEnds )
+            {
+                const zp_uint32_t tierSize = tierEnd - tierBegin;
+                for( zp_uint32_t i = 0; i < tierSize; ++i )
+                {
+                    JobQueue* jobQueue = &jobQueues[ info.stealOrder[ tierBegin + ( ( offset + i ) % tierSize ) ] ];
+                    if( !jobQueue->empty() )
+                    {
+                        return jobQueue;
+                    }
+                }
 
-        // mark as running
-        g_context.isRunning = 1;
+                tierBegin = tierEnd;
+            }
 
-        const zp_size_t stackSize = 1 MB;
-        MutableFixedString64 threadName;
+            return nullptr;
+        }
 
-        const zp_uint32_t numAvailableProcessors = Platform::GetProcessorCount() - 1;
-        for( zp_uint32_t i = 0; i < g_context.threadCount; ++i )
+        JobQueue* GetNextJobQueue( JobPriority priority )
         {
-            // thread queues
-            g_context.allJobQueues.pushBackEmpty();
-            g_context.allBatchJobQueues.pushBackEmpty();
-
-            zp_uint32_t threadID;
-            const ThreadHandle threadHandle = Platform::CreateThread( WorkerThreadFunc, reinterpret_cast<void*>( static_cast<zp_ptr_t>( i ) ), stackSize, &threadID );
-
-            Platform::SetThreadIdealProcessor( threadHandle, 1 + ( i % numAvailableProcessors ) ); // proc 0 is used for main thread
+            Vector<JobQueue>& jobQueues = g_context.allJobQueues[ static_cast<zp_size_t>( priority ) ];
 
-            threadName.format( "JobThread-%d %d", threadID, i );
+            const zp_size_t index = Atomic::IncrementSizeT( &g_context.nextJobQueueIndex ) - 1;
+            return &jobQueues[ index % jobQueues.length() ];
+        }
 
-            Platform::SetThreadName( threadHandle, threadName );
+        zp_bool_t HasQueuedJobs( JobPriority highestPriority, JobPriority lowestPriority )
+        {
+            for( zp_size_t priority = static_cast<zp_size_t>( highestPriority ); priority <= static_cast<zp_size_t>( lowestPriority ); ++priority )
+            {
+                for( const JobQueue& jobQueue : g_context.allJobQueues[ priority ] )
+                {
+                    if( !jobQueue.empty() )
+                    {
+                        return true;
+                    }
+                }
+            }
 
-            g_context.allWorkerThreadHandles[ i ] = threadHandle;
+            return false;
         }
 
-        // main thread queues
-        g_context.allJobQueues.pushBackEmpty();
-        g_context.allBatchJobQueues.pushBackEmpty();
+        zp_bool_t HasQueuedJobs( JobPriority lowestPriority = JobPriority::Background )
+        {
+            return HasQueuedJobs( JobPriority::FrameCritical, lowestPriority );
+        }
 
-        // setup main thread job info
-        InitializeLocalThreadInfo( g_context.threadCount );
-    }
+        //
+        // Idle workers register in sleepingWorkerCount before parking on the shared semaphore. Waking claims sleepers by
+        // decrementing the count and releases exactly that many semaphore tokens, so only as many workers wake as there are
+        // new jobs. A worker that registers and then finds work has to remove itself, or consume the token of whoever claimed it.
+        //
 
-    void JobSystem::ExitJobThreads()
-    {
-        g_context.isRunning = 0;
+        void WakeWorkers( zp_size_t jobCount )
+        {
+            // queued jobs must be visible before reading the sleepers, pairs with the barrier in ParkWorker
+            Atomic::MemoryBarrier();
 
-        // notify all worker threads
-        Platform::NotifyAllConditionVariable( g_context.wakeCondition );
+            zp_uint32_t sleepingWorkers = Atomic::LoadAcquire( &g_context.sleepingWorkerCount );
+            while( sleepingWorkers > 0 && jobCount > 0 )
+            {
+                const zp_uint32_t wakeCount = static_cast<zp_uint32_t>( zp_min( static_cast<zp_size_t>( sleepingWorkers ), jobCount ) );
 
-        // wait for all threads to finish
-        Platform::JoinThreads( g_context.allWorkerThreadHandles.data(), g_context.allWorkerThreadHandles.length() );
+                const zp_uint32_t prevSleepingWorkers = Atomic::CompareExchange( &g_context.sleepingWorkerCount, sleepingWorkers - wakeCount, sleepingWorkers );
+                if( prevSleepingWorkers == sleepingWorkers )
+                {
+                    Platform::ReleaseSemaphore( g_context.wakeSemaphore, static_cast<zp_int32_t>( wakeCount ) );
+                    break;
+                }
 
-        // close threads
-        for( auto thread : g_context.allWorkerThreadHandles )
-        {
-            Platform::CloseThread( thread );
+                sleepingWorkers = prevSleepingWorkers;
+            }
         }
 
-        // destroy main thread job info
-        DestroyLocalThreadInfo();
-    }
+        //
+        // Background jobs are long running, so only maxBackgroundJobCount of them may run at once. The remaining workers
+        // are always free to pick up frame critical and normal work. A thread keeps its lane while the background job
+        // waits, so background jobs nested under it run on the same lane instead of waiting for another one.
+        //
 
-    zp_uint32_t JobSystem::GetThreadCount()
-    {
-        return g_context.threadCount;
-    }
+        zp_bool_t TryAcquireBackgroundLane()
+        {
+            zp_uint32_t running = Atomic::LoadAcquire( &g_context.runningBackgroundJobCount );
+            while( running < g_context.maxBackgroundJobCount )
+            {
+                const zp_uint32_t prevRunning = Atomic::CompareExchange( &g_context.runningBackgroundJobCount, running + 1, running );
+                if( prevRunning == running )
+                {
+                    return true;
+                }
 
-    zp_uint32_t JobSystem::GetJobQueueCount()
-    {
-        return g_context.threadCount + 1;
-    }
+                running = prevRunning;
+            }
 
-    void JobSystem::Complete( JobHandle jobHandle )
-    {
-        WaitForJobComplete( jobHandle.job );
-    }
+            return false;
+        }
 
-    zp_bool_t JobSystem::IsComplete( JobHandle jobHandle )
-    {
-        return IsJobComplete( jobHandle.job );
-    }
+        void ReleaseBackgroundLane()
+        {
+            Atomic::Decrement( &g_context.runningBackgroundJobCount );
 
-    JobHandle JobSystem::Execute( JobWorkFunc func )
-    {
-        Job* job = AllocateJob();
+            // workers that parked while every lane was taken are not woken by new jobs, hand them the freed lane
+            if( HasQueuedJobs( JobPriority::Background, JobPriority::Background ) )
+            {
+                WakeWorkers( 1 );
+            }
+        }
 
-        job->callback = func;
+        // background jobs only count as work while a lane is free to run them
+        zp_bool_t HasRunnableJobs()
+        {
+            if( Atomic::LoadAcquire( &g_context.runningBackgroundJobCount ) < g_context.maxBackgroundJobCount )
+            {
+                return HasQueuedJobs();
+            }
 
-        QueueNextJob( job );
+            return HasQueuedJobs( JobPriority::FrameCritical, JobPriority::Normal );
+        }
 
-        Platform::NotifyOneConditionVariable( g_context.wakeCondition );
+        void ParkWorker()
+        {
+            Atomic::Increment( &g_context.sleepingWorkerCount );
 
-        return { .job = job };
-    }
+            // re-check after registering, anything queued before this point was missed by WakeWorkers
+            Atomic::MemoryBarrier();
 
-    JobHandle JobSystem::PrepareEmpty()
-    {
-        Job* job = AllocateJob();
+            zp_bool_t parked = true;
+            if( HasRunnableJobs() || Atomic::And( &g_context.isRunning, 1 ) == 0 )
+            {
+                zp_uint32_t sleepingWorkers = Atomic::LoadAcquire( &g_context.sleepingWorkerCount );
+                while( sleepingWorkers > 0 )
+                {
+                    const zp_uint32_t prevSleepingWorkers = Atomic::CompareExchange( &g_context.sleepingWorkerCount, sleepingWorkers - 1, sleepingWorkers );
+                    if( prevSleepingWorkers == sleepingWorkers )
+                    {
+                        parked = false;
+                        break;
+                    }
 
-        PrepareLocalJob( job );
+                    sleepingWorkers = prevSleepingWorkers;
+                }
+            }
 
-        return { .job = job };
-    }
+            // either still registered, or a waker already claimed this worker and its token is (about to be) released
+            if( parked )
+            {
+                Platform::AcquireSemaphore( g_context.wakeSemaphore, zp_limit<zp_uint32_t>::max() );
+            }
+        }
 
-    JobHandle JobSystem::Prepare( JobWorkFunc func, JobHandle dependency )
-    {
-        Job* job = AllocateJob();
+        JobHandle MakeJobHandle( Job* job )
+        {
+            return job == nullptr ? JobHandle {} : JobHandle { .job = job, .generation = job->generation };
+        }
 
-        job->callback = func;
+        zp_bool_t IsJobComplete( JobHandle jobHandle )
+        {
+            if( jobHandle.job == nullptr )
+            {
+                return true;
+            }
+
+            // a recycled job has a newer generation, so the handle's job must have completed
+            return Atomic::LoadAcquire( &jobHandle.job->uncompletedJobs ) == 0 || Atomic::LoadAcquire( &jobHandle.job->generation ) != jobHandle.generation;
+        }
 
-        if( dependency.job == nullptr )
+        void LockJobContinuations( Job* job )
         {
-            PrepareLocalJob( job );
+            while( Atomic::CompareExchange( &job->continuationLock, 1, 0 ) != 0 )
+            {
+                Platform::YieldCurrentThread();
+            }
         }
-        else
+
+        void UnlockJobContinuations( Job* job )
         {
-#if USE_JOB_STATE_TRACKING
-            ZP_ASSERT( dependency.job->state == JobState::Prepared || dependency.job->state == JobState::Allocated );
-#endif // USE_JOB_STATE_TRACKING
-            AddJobDependency( job, dependency.job );
+            Atomic::Exchange( &job->continuationLock, 0 );
         }
 
-        return { .job = job };
-    }
+        //
+        // Every job but a background one counts against the frame it was allocated in until it finishes, so JobSystem::AdvanceFrame
+        // can wait for a frame's jobs before its frame memory is reset.
+        //
 
-    JobHandle Dispatch( zp_size_t length, zp_size_t batchCount, JobWorkFunc func )
-    {
-        ZP_ASSERT( length > 0 );
-        ZP_ASSERT( batchCount > 0 );
+        zp_uint32_t BeginFrameJob()
+        {
+            // re-check once counted, a job counted against a frame that was already waited on moves to the new frame
+            zp_uint32_t frameIndex = Atomic::LoadAcquire( &g_context.frameIndex );
+            for( ;; )
+            {
+                Atomic::Increment( &g_context.outstandingFrameJobs[ frameIndex % kJobFrameCount ] );
 
-        const zp_size_t jobCount = ( length + batchCount ) / batchCount;
+                const zp_uint32_t currentFrameIndex = Atomic::LoadAcquire( &g_context.frameIndex );
+                if( currentFrameIndex == frameIndex )
+                {
+                    return frameIndex;
+                }
 
-        Job* parentJob = AllocateJob();
+                Atomic::Decrement( &g_context.outstandingFrameJobs[ frameIndex % kJobFrameCount ] );
+                frameIndex = currentFrameIndex;
+            }
+        }
 
-        zp_size_t offset = 0;
-        for( zp_size_t batch = 0; batch < jobCount; ++batch )
+        void EndFrameJob( zp_uint32_t frameIndex )
         {
-            Job* job = AllocateJob();
+            Atomic::Decrement( &g_context.outstandingFrameJobs[ frameIndex % kJobFrameCount ] );
+        }
 
-            job->callback = func;
+        Job* AllocateJob( JobPriority priority = JobPriority::Normal )
+        {
+            JobPool* pool = t_threadInfo.jobPool;
+            ZP_ASSERT( pool != nullptr );
 
-            job->batchId = batch;
-            job->jobStart = offset;
+            Job* job = pool->freeJobs;
+            if( job == nullptr )
+            {
+                job = Atomic::ExchangePtr( &pool->remoteFreeJobs, static_cast<Job*>( nullptr ) );
+            }
+            if( job == nullptr )
+            {
+                job = AllocateJobBlock( pool, t_threadInfo.jobPoolIndex );
+            }
 
-            offset = zp_min( length, offset + batchCount );
+            pool->freeJobs = job->nextFreeJob;
+            job->nextFreeJob = nullptr;
 
-            job->jobEnd = offset;
+#if USE_JOB_STATE_TRACKING
+            ZP_ASSERT( job->state == JobState::Idle );
+            job->state = JobState::Allocated;
+#endif // USE_JOB_STATE_TRACKING
 
-            SetParentJob( job, parentJob );
+            // reset under the lock so a stale handle adding a continuation sees either the released list or the new generation
+            LockJobContinuations( job );
+            job->continuations = nullptr;
+            job->continuationsReleased = false;
+            UnlockJobContinuations( job );
 
-            QueueNextJob( job );
+            job->parentJob = nullptr;
+            job->pendingDependencies = 0;
+            job->callback = nullptr;
+            job->jobSharedMemorySize = 0;
+            job->batchId = 0;
+            job->jobStart = 0;
+            job->jobEnd = 1;
+            job->splitGrain = 0;
+            job->priority = priority;
+            job->frameIndex = priority != JobPriority::Background ? BeginFrameJob() : 0;
+            zp_zero_memory( job->data.data(), job->data.length() );
+
+            // publish last, a stale handle that sees this job as incomplete must also see the new generation
+            Atomic::StoreRelease( &job->uncompletedJobs, 1u );
+
+            return job;
         }
 
-        QueueNextJob( parentJob );
+        void FreeJob( Job* job )
+        {
+#if USE_JOB_STATE_TRACKING
+            ZP_ASSERT( job->state == JobState::Finished );
+            job->state = JobState::Idle;
+#endif // USE_JOB_STATE_TRACKING
 
-        Platform::NotifyAllConditionVariable( g_context.wakeCondition );
+            // invalidate all outstanding handles before the job can be reused
+            Atomic::StoreRelease( &job->generation, job->generation + 1 );
 
-        return { .job = parentJob };
-    }
+            JobPool* pool = &g_context.allJobPools[ job->poolIndex ];
+            if( pool == t_threadInfo.jobPool )
+            {
+                job->nextFreeJob = pool->freeJobs;
+                pool->freeJobs = job;
+            }
+            else
+            {
+                Job* head;
+                do
+                {
+                    head = Atomic::LoadAcquirePtr( &pool->remoteFreeJobs );
+                    job->nextFreeJob = head;
+                } while( Atomic::CompareExchangePtr( &pool->remoteFreeJobs, job, head ) != head );
+            }
+        }
 
-    JobHandle JobSystem::PrepareDispatch( zp_size_t length, zp_size_t batchCount, JobWorkFunc func, JobHandle dependency )
-    {
-        ZP_ASSERT( length > 0 );
-        ZP_ASSERT( batchCount > 0 );
+        void* AllocatePooledTaskFrame( zp_size_t size )
+        {
+            JobPool* pool = t_threadInfo.jobPool;
 
-        const zp_size_t jobCount = zp_divide_round_up( length, batchCount );
+            const zp_size_t frameSize = size + kTaskFrameHeaderSize;
+            const zp_uint32_t sizeClass = pool != nullptr ? GetTaskFrameSizeClass( frameSize ) : kTaskFrameSizeClassCount;
 
-        Job* parentJob = AllocateJob();
+            TaskFrame* frame = nullptr;
+            if( sizeClass < kTaskFrameSizeClassCount )
+            {
+                frame = pool->freeTaskFrames[ sizeClass ];
+                if( frame == nullptr )
+                {
+                    frame = Atomic::ExchangePtr( &pool->remoteFreeTaskFrames[ sizeClass ], static_cast<TaskFrame*>( nullptr ) );
+                }
 
-        zp_size_t offset = 0;
-        for( zp_size_t batch = 0; batch < jobCount; ++batch )
-        {
-            Job* job = AllocateJob();
+                if( frame != nullptr )
+                {
+                    pool->freeTaskFrames[ sizeClass ] = frame->next;
+                }
+                else
+                {
+                    frame = static_cast<TaskFrame*>( GetAllocator( MemoryLabels::ThreadSafe )->allocate( static_cast<zp_size_t>( kTaskFrameMinSize ) << sizeClass, kDefaultMemoryAlignment, MemoryLabels::ThreadSafe ) );
+                    frame->poolIndex = t_threadInfo.jobPoolIndex;
+                    frame->sizeClass = sizeClass;
+                }
+            }
+            else
+            {
+                // too large to pool, or not on a job thread
+                frame = static_cast<TaskFrame*>( GetAllocator( MemoryLabels::ThreadSafe )->allocate( frameSize, kDefaultMemoryAlignment, MemoryLabels::ThreadSafe ) );
+                frame->poolIndex = 0;
+                frame->sizeClass = kTaskFrameSizeClassCount;
+            }
 
-            job->callback = func;
+            frame->next = nullptr;
 
-            job->batchId = batch;
-            job->jobStart = offset;
+            return ZP_OFFSET_PTR( frame, kTaskFrameHeaderSize );
+        }
 
-            offset = zp_min( length, offset + batchCount );
+        void FreePooledTaskFrame( void* ptr )
+        {
+            TaskFrame* frame = static_cast<TaskFrame*>( ZP_OFFSET_PTR( ptr, -static_cast<zp_ptrdiff_t>( kTaskFrameHeaderSize ) ) );
 
-            job->jobEnd = offset;
+            const zp_uint32_t sizeClass = frame->sizeClass;
+            if( sizeClass == kTaskFrameSizeClassCount )
+            {
+                ZP_FREE( MemoryLabels::ThreadSafe, frame );
+                return;
+            }
 
-            SetParentJob( job, parentJob );
+            JobPool* pool = &g_context.allJobPools[ frame->poolIndex ];
+            if( pool == t_threadInfo.jobPool )
+            {
+                frame->next = pool->freeTaskFrames[ sizeClass ];
+                pool->freeTaskFrames[ sizeClass ] = frame;
+            }
+            else
+            {
+                TaskFrame* head;
+                do
+                {
+                    head = Atomic::LoadAcquirePtr( &pool->remoteFreeTaskFrames[ sizeClass ] );
+                    frame->next = head;
+                } while( Atomic::CompareExchangePtr( &pool->remoteFreeTaskFrames[ sizeClass ], frame, head ) != head );
+            }
+        }
 
-            PrepareLocalJob( job );
+        void PrepareLocalJob( Job* job )
+        {
+#if USE_JOB_STATE_TRACKING
+            job->state = JobState::Prepared;
+#endif // USE_JOB_STATE_TRACKING
+            GetLocalBatchJobQueue()->pushBack( job );
         }
 
-        if( dependency.job == nullptr )
+        void QueueLocalJob( Job* job )
         {
-            PrepareLocalJob( parentJob );
+#if USE_JOB_STATE_TRACKING
+            job->state = JobState::Queued;
+#endif // USE_JOB_STATE_TRACKING
+            GetLocalJobQueue( job->priority )->pushBack( job );
         }
-        else
+
+        void QueueNextJob( Job* job )
         {
 #if USE_JOB_STATE_TRACKING
-            ZP_ASSERT( dependency.job->state == JobState::Prepared || dependency.job->state == JobState::Allocated );
+            job->state = JobState::Queued;
 #endif // USE_JOB_STATE_TRACKING
-            AddJobDependency( parentJob, dependency.job );
+            GetNextJobQueue( job->priority )->pushBack( job );
         }
 
-        return { .job = parentJob };
-    }
+        //
+        // Adds continuation to the dependency's continuation list. Returns false if the dependency has already finished (or been
+        // recycled) and will never release the continuation.
+        //
 
-    JobHandle JobSystem::Start( Memory jobData, JobCallback jobCallback )
-    {
-        Job* job = AllocateJob();
+        zp_bool_t AddJobContinuation( JobHandle dependency, JobContinuation* continuation )
+        {
+            Job* dependencyJob = dependency.job;
 
-        job->callback = jobCallback;
-        zp_memcpy( job->data.asMemory(), jobData );
+            LockJobContinuations( dependencyJob );
 
-        QueueNextJob( job );
+            const zp_bool_t added = !dependencyJob->continuationsReleased && Atomic::LoadAcquire( &dependencyJob->generation ) == dependency.generation;
+            if( added )
+            {
+                // push front
+                continuation->next = dependencyJob->continuations;
+                dependencyJob->continuations = continuation;
+            }
 
-        Platform::NotifyOneConditionVariable( g_context.wakeCondition );
+            UnlockJobContinuations( dependencyJob );
 
-        return { .job = job };
-    }
+            return added;
+        }
 
+        //
+        // Returns true when all dependencies are already complete and the job is ready to be prepared. Otherwise the last
+        // dependency to finish queues the job.
+        //
 
-    JobHandle JobSystem::Run( Memory jobData, JobCallback jobCallback )
-    {
-        Job* job = AllocateJob();
+        zp_bool_t AddJobDependencies( Job* job, const JobHandle* dependencies, zp_size_t dependencyCount )
+        {
+            ZP_ASSERT( dependencyCount <= kMaxJobDependencies );
 
-        job->callback = jobCallback;
-        zp_memcpy( job->data.asMemory(), jobData );
+            // hold an extra count so the job can't be released while dependencies are still being added
+            job->pendingDependencies = static_cast<zp_uint32_t>( dependencyCount + 1 );
 
-        ExecuteJob( job );
+            for( zp_size_t i = 0; i < dependencyCount; ++i )
+            {
+                JobContinuation* continuation = &job->dependencyContinuations[ i ];
+                continuation->job = job;
+                continuation->next = nullptr;
 
-        return {};
-    }
+                if( IsJobComplete( dependencies[ i ] ) || !AddJobContinuation( dependencies[ i ], continuation ) )
+                {
+                    Atomic::Decrement( &job->pendingDependencies );
+                }
+            }
 
-    void JobSystem::ScheduleBatchJobs()
-    {
-        FlushBatchJobs();
+            return Atomic::Decrement( &job->pendingDependencies ) == 0;
+        }
 
-        Platform::NotifyAllConditionVariable( g_context.wakeCondition );
-    }
+        void ReleaseJobContinuations( Job* job )
+        {
+            LockJobContinuations( job );
+            JobContinuation* continuation = job->continuations;
+            job->continuations = nullptr;
+            job->continuationsReleased = true;
+            UnlockJobContinuations( job );
+
+            zp_size_t queuedJobCount = 0;
+            while( continuation != nullptr )
+            {
+                // read next before releasing, the continuation belongs to the dependent job which can run and be freed once queued
+                JobContinuation* next = continuation->next;
 
-    void JobSystem::ProcessJobs()
-    {
-        Job* job = RequestQueuedJob();
+                Job* dependentJob = continuation->job;
+                if( Atomic::Decrement( &dependentJob->pendingDependencies ) == 0 )
+                {
+                    QueueNextJob( dependentJob );
+                    ++queuedJobCount;
+                }
 
-        while( job != nullptr )
+                continuation = next;
+            }
+
+            WakeWorkers( queuedJobCount );
+        }
+
+        void SetParentJob( Job* job, Job* parentJob )
         {
-            ExecuteJob( job );
+            ZP_ASSERT( job->parentJob == nullptr );
+            job->parentJob = parentJob;
 
-            job = RequestQueuedJob();
+            Atomic::Increment( &parentJob->uncompletedJobs );
         }
-    }
-}; // namespace zp
 
-#if 0
-using namespace zp;
+        void FinishJob( Job* job )
+        {
+            const zp_size_t unfinishedJobs = Atomic::Decrement( &job->uncompletedJobs );
 
+            if( unfinishedJobs == 0 )
+            {
+#if USE_JOB_STATE_TRACKING
+                job->state = JobState::Finished;
+#endif // USE_JOB_STATE_TRACKING
 
-namespace
-{
-    enum
-    {
-        kJobPayload = 4 KB
-    };
+                Job* parent = job->parentJob;
+                if( parent != nullptr )
+                {
+                    FinishJob( parent );
+                }
 
-    struct JobHeader
-    {
-        Job* parent;
-        JobWorkFunc execFunc;
-        zp_int32_t uncompletedJobs;
-        zp_int32_t numDependencies;
-        zp_size_t jobDataSize;
-    };
-}
+                ReleaseJobContinuations( job );
 
-namespace zp
-{
+                if( job->priority != JobPriority::Background )
+                {
+                    EndFrameJob( job->frameIndex );
+                }
 
-    struct Job
-    {
-        JobHeader* header()
-        {
-            JobHeader* h = reinterpret_cast<JobHeader*>(m_jobData);
-            return h;
+                FreeJob( job );
+            }
         }
 
-        Memory data()
-        {
-            JobHeader* h = header();
-            return {
-                .ptr = m_jobData + sizeof( JobHeader ),
-                .size = h->jobDataSize
-            };
-        }
+        //
+        // Lazy binary splitting. A splittable job only gives away the upper half of its remaining range when its own queue has
+        // been drained (previous splits were stolen) and some worker is idle, so there is no up front batching to tune and
+        // uneven ranges rebalance as they run.
+        //
 
-        void execute()
+        void TrySplitJob( Job* job, zp_size_t offset )
         {
-            JobWorkFunc exec = header()->execFunc;
-            if( exec )
+            const zp_size_t remaining = job->jobEnd - offset;
+            if( remaining <= job->splitGrain )
             {
-                exec( this, data() );
+                return;
             }
-        }
-
-        void addDependency( Job* job )
-        {
-            JobHeader* h = header();
-            Job** dep = reinterpret_cast<Job**>(m_jobData + ( kJobPayload - sizeof( Job* ) * ( 1 + h->numDependencies ) ));
-            dep[ h->numDependencies ] = job;
-            ++h->numDependencies;
-        }
 
-        MemoryArray<Job*> dependencies()
-        {
-            JobHeader* h = header();
-            return {
-                .ptr = h->numDependencies == 0 ? nullptr : reinterpret_cast<Job**>(m_jobData + ( kJobPayload - sizeof( Job* ) * ( 1 + h->numDependencies ) )),
-                .length = static_cast<zp_size_t>(h->numDependencies)
-            };
-        }
+            if( !GetLocalJobQueue( job->priority )->empty() || Atomic::LoadAcquire( &g_context.idleWorkerCount ) == 0 )
+            {
+                return;
+            }
 
-        zp_uint8_t m_jobData[ kJobPayload ];
-    };
-}
+            const zp_size_t mid = offset + ( remaining / 2 );
 
-namespace
-{
-    enum
-    {
-        kJobsPerThread = 512,
-        kJobsPerThreadMask = kJobsPerThread - 1,
+            Job* splitJob = AllocateJob( job->priority );
+            splitJob->callback = job->callback;
+            splitJob->jobSharedMemorySize = job->jobSharedMemorySize;
+            splitJob->batchId = job->batchId;
+            splitJob->jobStart = mid;
+            splitJob->jobEnd = job->jobEnd;
+            splitJob->splitGrain = job->splitGrain;
+            splitJob->data = job->data;
 
-        kJobQueueCount = 256,
-        kJobQueueCountMask = kJobQueueCount - 1,
-    };
+            job->jobEnd = mid;
 
-    ZP_STATIC_ASSERT ( zp_is_pow2
-    ( kJobQueueCount )
-    );
-    ZP_STATIC_ASSERT ( zp_is_pow2
-    ( kJobsPerThread )
-    );
-}
+            SetParentJob( splitJob, job->parentJob );
 
-namespace
-{
-    class JobQueue
-    {
-        ZP_NONCOPYABLE( JobQueue );
+            QueueLocalJob( splitJob );
 
-    public:
-        [[nodiscard]] zp_bool_t empty() const;
+            WakeWorkers( 1 );
+        }
 
-        void pushBack( Job* job );
+        void ExecuteJob( Job* job )
+        {
+#if USE_JOB_STATE_TRACKING
+            job->state = JobState::Executing;
+#endif // USE_JOB_STATE_TRACKING
 
-        Job* popBack();
+            const JobPriority prevExecutingPriority = t_threadInfo.executingPriority;
+            t_threadInfo.executingPriority = job->priority;
 
-        Job* stealPopFront();
+            const zp_bool_t isBackgroundJob = job->priority == JobPriority::Background;
+            if( isBackgroundJob )
+            {
+                ++t_threadInfo.backgroundJobDepth;
+            }
 
-        void clear();
+            // background jobs aren't waited on by JobSystem::AdvanceFrame, they can't hold frame memory
+            const zp_bool_t prevFrameMemoryRestricted = SetFrameMemoryRestricted( isBackgroundJob );
 
-    private:
-        FixedArray<Job*, kJobQueueCount> m_jobs;
-        zp_int32_t m_back;
-        zp_int32_t m_front;
-    };
+            if( job->callback )
+            {
+                JobScratchArena& scratchArena = t_threadInfo.scratchArena;
+                const zp_size_t scratchMarker = BeginJobScratch( scratchArena );
 
-    zp_bool_t JobQueue::empty() const
-    {
-        return m_back == m_front;
-    }
+                Memory sharedMemory = AllocateJobScratchMemory( scratchArena, job->jobSharedMemorySize, kDefaultMemoryAlignment );
 
-    void JobQueue::pushBack( Job* job )
-    {
-        const zp_int32_t b = m_back;
-        m_jobs[ b & kJobQueueCountMask ] = job;
-        Atomic::Exchange( &m_back, b + 1 );
-    }
+                JobWorkArgs args {
+                    .currentJob = MakeJobHandle( job ),
+                    .parentJob = MakeJobHandle( job->parentJob ),
+                    .groupId = job->batchId,
+                    .jobMemory { job->data.data(), job->data.length() },
+                    .sharedMemory = sharedMemory,
+                };
 
-    Job* JobQueue::popBack()
-    {
-        const zp_int32_t b = m_back - 1;
-        Atomic::Exchange( &m_back, b );
+                if( job->splitGrain == 0 )
+                {
+                    for( zp_size_t offset = job->jobStart, end = job->jobEnd; offset < end; ++offset )
+                    {
+                        args.index = offset;
+                        job->callback( args );
+                    }
+                }
+                else
+                {
+                    // jobEnd shrinks as the upper half of the remaining range is split off
+                    for( zp_size_t offset = job->jobStart; offset < job->jobEnd; )
+                    {
+                        TrySplitJob( job, offset );
 
-        const zp_int32_t t = m_front;
+                        for( const zp_size_t end = zp_min( offset + job->splitGrain, job->jobEnd ); offset < end; ++offset )
+                        {
+                            args.index = offset;
+                            job->callback( args );
+                        }
+                    }
+                }
 
-        Job* job = nullptr;
+                EndJobScratch( scratchArena, scratchMarker );
+            }
 
-        if( t <= b )
+            SetFrameMemoryRestricted( prevFrameMemoryRestricted );
+
+            t_threadInfo.executingPriority = prevExecutingPriority;
+
+            ++t_threadInfo.counters->executedJobs;
+
+            FinishJob( job );
+
+            if( isBackgroundJob )
+            {
+                --t_threadInfo.backgroundJobDepth;
+                if( t_threadInfo.backgroundJobDepth == 0 )
+                {
+                    ReleaseBackgroundLane();
+                }
+            }
+        }
+
+        Job* PopOrStealJob( JobPriority priority )
         {
-            job = m_jobs[ b & kJobQueueCountMask ];
-            if( t != b )
+            Job* job = nullptr;
+
+            JobQueue* jobQueue = GetLocalJobQueue( priority );
+
+            const zp_bool_t hasLocalJob = jobQueue != nullptr && !jobQueue->empty();
+
+            // the victim scan touches other cores' queues, only look once the local queue is empty
+            JobQueue* stealJobQueue = hasLocalJob ? nullptr : GetStealJobQueue( priority );
+
+            if( !hasLocalJob && stealJobQueue == nullptr )
             {
-                return job;
+                return nullptr;
             }
 
-            if( Atomic::CompareExchange( &m_front, t + 1, t ) != t )
+            // only the outermost background job on a thread takes a lane
+            const zp_bool_t acquireLane = priority == JobPriority::Background && t_threadInfo.backgroundJobDepth == 0;
+            if( acquireLane && !TryAcquireBackgroundLane() )
             {
-                job = nullptr;
+                return nullptr;
             }
 
-            m_back = t + 1;
+            if( hasLocalJob )
+            {
+                job = jobQueue->popBack();
+
+                // thieves took the last local jobs since the check above
+                if( job == nullptr )
+                {
+                    stealJobQueue = GetStealJobQueue( priority );
+                }
+            }
+
+            if( job == nullptr && stealJobQueue != nullptr )
+            {
+                job = stealJobQueue->stealPopFront();
+
+                // a failed steal lost the race for the victim's last job to its owner or another thief
+                if( job != nullptr )
+                {
+                    ++t_threadInfo.counters->steals;
+                }
+                else
+                {
+                    ++t_threadInfo.counters->failedSteals;
+                }
+            }
+
+            if( job == nullptr )
+            {
+                if( acquireLane )
+                {
+                    ReleaseBackgroundLane();
+                }
+            }
+#if USE_JOB_STATE_TRACKING
+            else
+            {
+                ZP_ASSERT( job->state == JobState::Queued );
+            }
+#endif // USE_JOB_STATE_TRACKING
+
+            return job;
         }
-        else
+
+        //
+        // Highest priority first. Background jobs are only handed out while a background lane is free, or to a thread already holding one.
+        //
+
+        Job* RequestQueuedJob( JobPriority lowestPriority = JobPriority::Background )
         {
-            m_back = t;
+            for( zp_size_t priority = 0; priority <= static_cast<zp_size_t>( lowestPriority ); ++priority )
+            {
+                Job* job = PopOrStealJob( static_cast<JobPriority>( priority ) );
+                if( job != nullptr )
+                {
+                    return job;
+                }
+            }
+
+            return nullptr;
         }
 
-        return job;
-    }
+        JobPriority GetMainThreadLowestJobPriority()
+        {
+            // with worker threads, background jobs never run on (and stall) the main thread
+            return g_context.threadCount > 0 ? JobPriority::Normal : JobPriority::Background;
+        }
 
-    Job* JobQueue::stealPopFront()
-    {
-        const zp_int32_t t = m_front;
+        zp_size_t FlushBatchJobs()
+        {
+            JobQueue* batchQueue = GetLocalBatchJobQueue();
 
-        Atomic::MemoryBarrier();
+            zp_size_t flushedJobCount = 0;
+            while( !batchQueue->empty() )
+            {
+                Job* job = batchQueue->popBack();
+                QueueNextJob( job );
 
-        const zp_int32_t b = m_back;
+                ++flushedJobCount;
+            }
 
-        Job* job = nullptr;
+            return flushedJobCount;
+        }
 
-        if( t < b )
+        void FlushBatchJobsLocally()
         {
-            job = m_jobs[ t & kJobQueueCountMask ];
+            JobQueue* batchQueue = GetLocalBatchJobQueue();
 
-            if( Atomic::CompareExchange( &m_front, t + 1, t ) != t )
+            while( !batchQueue->empty() )
             {
-                job = nullptr;
+                Job* job = batchQueue->popBack();
+                QueueLocalJob( job );
             }
         }
 
-        return job;
-    }
+        void WaitForJobComplete( JobHandle jobHandle )
+        {
+            const JobPriority lowestPriority = t_threadInfo.jobPoolIndex == g_context.threadCount ? GetMainThreadLowestJobPriority() : JobPriority::Background;
 
-    void JobQueue::clear()
-    {
-        m_front = 0;
-        m_back = 0;
-    }
-}
+            while( !IsJobComplete( jobHandle ) )
+            {
+                Job* waitJob = RequestQueuedJob( lowestPriority );
+                if( waitJob != nullptr )
+                {
+                    ExecuteJob( waitJob );
+                }
+                else
+                {
+                    Platform::YieldCurrentThread();
+                }
+            }
+        }
 
-namespace
-{
-    struct JobThreadInfo
-    {
-        Job jobs[ kJobsPerThread ];
-        zp_size_t allocatedJobCount;
-        JobQueue* localJobQueue;
-        JobQueue* localBatchJobQueue;
-        zp_bool_t isRunning;
-    };
+        zp_uint32_t WorkerThreadFunc( void* threadData )
+        {
+#if ZP_USE_PROFILER
+            Profiler::InitializeProfilerThread();
+#endif
 
-    thread_local JobThreadInfo t_threadInfo;
+            const zp_size_t index = static_cast<zp_size_t>( reinterpret_cast<zp_ptr_t>( threadData ) );
 
+            Log::info() << "Entering Worker Thread..." << Log::endl;
 
-    MemoryArray<JobQueue> g_allQueues;
+            InitializeLocalThreadInfo( index );
 
-    MemoryArray<JobQueue*> g_allJobQueues;
+            while( Atomic::And( &g_context.isRunning, 1 ) == 1 )
+            {
+                Job* job = RequestQueuedJob();
 
-    MemoryArray<JobQueue*> g_allBatchJobQueues;
+                while( job != nullptr )
+                {
+                    ExecuteJob( job );
 
-    MemoryArray<JobThreadInfo*> g_allJobThreadInfos;
+                    job = RequestQueuedJob();
+                }
 
-    MemoryArray<ThreadHandle> g_allJobThreadHandles;
+                // spin before parking, adapting the spin length to whether spinning has been finding work
+                Atomic::Increment( &g_context.idleWorkerCount );
 
-    zp_size_t g_stealJobQueueIndex;
+                const zp_time_t idleStartTime = Platform::TimeNow();
 
-    MemoryLabel g_memoryLabel;
+                JobThreadInfo& info = t_threadInfo;
+                for( zp_uint32_t spin = 0; spin < info.spinCount && job == nullptr; ++spin )
+                {
+                    Platform::YieldCurrentThread();
 
-    //
-    //
-    //
+                    job = RequestQueuedJob();
+                }
 
-    JobQueue* GetLocalJobQueue()
-    {
-        return t_threadInfo.localJobQueue;
-    }
+                if( job != nullptr )
+                {
+                    Atomic::Decrement( &g_context.idleWorkerCount );
 
-    JobQueue* GetLocalBatchJobQueue()
-    {
-        return t_threadInfo.localBatchJobQueue;
-    }
+                    info.counters->idleTime += Platform::TimeNow() - idleStartTime;
 
-    JobQueue* GetStealJobQueue()
-    {
-        const zp_size_t index = Atomic::IncrementSizeT( &g_stealJobQueueIndex ) - 1;
-        return g_allJobQueues[ index % g_allJobQueues.length ];
-    }
+                    info.spinCount = zp_min( info.spinCount * 2, static_cast<zp_uint32_t>( kWorkerMaxSpinCount ) );
 
-    Job* AllocateJob()
-    {
-        const zp_size_t index = ++t_threadInfo.allocatedJobCount;
-        return &t_threadInfo.jobs[ index & kJobsPerThreadMask ];
-    }
+                    ExecuteJob( job );
+                }
+                else
+                {
+                    info.spinCount = zp_max( info.spinCount / 2, static_cast<zp_uint32_t>( kWorkerMinSpinCount ) );
 
-    void EnqueueLocalJob( Job* job )
-    {
-        JobQueue* jobQueue = GetLocalJobQueue();
-        jobQueue->pushBack( job );
-    }
+                    // parked workers still count as idle until they are woken
+                    ParkWorker();
 
-    void FinishJob( Job* job )
-    {
-        JobHeader* header = job->header();
+                    Atomic::Decrement( &g_context.idleWorkerCount );
 
-        const zp_int32_t unfinishedJobs = Atomic::Decrement( &header->uncompletedJobs );
+                    ++info.counters->parks;
+                    info.counters->idleTime += Platform::TimeNow() - idleStartTime;
+                }
+            }
 
-        if( unfinishedJobs == 0 )
-        {
-            Job* parent = header->parent;
+            Log::info() << "Exiting Worker Thread" << Log::endl;
 
-            if( parent )
-            {
-                FinishJob( parent );
-            }
+            DestroyLocalThreadInfo();
 
-            MemoryArray<Job*> deps = job->dependencies();
-            for( Job* dep : deps )
-            {
-                EnqueueLocalJob( dep );
-            }
+            return 0;
+        }
 
-            Atomic::Decrement( &header->uncompletedJobs );
+        zp_uint64_t TakeWorkerCounterDelta( const zp_int64_t& counter, zp_int64_t& snapshot )
+        {
+            const zp_int64_t value = Atomic::LoadRelaxed( &counter );
+            const zp_int64_t delta = value - snapshot;
 
-            // clear job memory
-            Memory mem = job->data();
-            zp_zero_memory( mem.ptr, mem.size );
+            snapshot = value;
+
+            return static_cast<zp_uint64_t>( delta );
         }
-    }
 
-    void ExecuteJob( Job* job )
+#if ZP_USE_PROFILER
+        void SnapshotWorkerStatsOnAdvanceFrame( zp_uint64_t frameIndex, void* userData )
+        {
+            JobSystem::SnapshotWorkerStats();
+        }
+#endif
+    }; // namespace
+
+    void JobSystem::Setup( MemoryLabel memoryLabel, zp_uint32_t threadCount, zp_uint32_t hardwareThreadsPerCore )
     {
-        job->execute();
+        const zp_size_t jobQueueCount = threadCount + 1;
 
-        FinishJob( job );
+        const zp_uint32_t processorCount = Platform::GetProcessorTopology( nullptr, 0 );
+        g_context.allProcessors = Vector<ProcessorInfo>( processorCount, memoryLabel );
+        g_context.allProcessors.resize_unsafe( zp_min( processorCount, Platform::GetProcessorTopology( g_context.allProcessors.data(), processorCount ) ) );
+
+        g_context.allJobQueueProcessors = Vector<ProcessorInfo>( jobQueueCount, memoryLabel );
+        g_context.allStealOrders = Vector<zp_uint32_t>( jobQueueCount * threadCount, memoryLabel );
+        g_context.allStealTierEnds = Vector<zp_uint32_t>( jobQueueCount * kJobStealTierCount, memoryLabel );
+        g_context.allWorkerCounters = Vector<JobWorkerCounters>( jobQueueCount, memoryLabel );
+        g_context.allWorkerCounterSnapshots = Vector<JobWorkerCounters>( jobQueueCount, memoryLabel );
+        g_context.allWorkerStats = Vector<JobWorkerStats>( jobQueueCount, memoryLabel );
+
+        for( Vector<JobQueue>& jobQueues : g_context.allJobQueues )
+        {
+            jobQueues = Vector<JobQueue>( jobQueueCount, memoryLabel );
+        }
+        g_context.allBatchJobQueues = Vector<JobQueue>( jobQueueCount, memoryLabel );
+        g_context.allWorkerThreadHandles = Vector<ThreadHandle>( threadCount, memoryLabel );
+        g_context.allJobPools = Vector<JobPool>( jobQueueCount, memoryLabel );
+        g_context.nextJobQueueIndex = 0;
+        g_context.wakeSemaphore = Platform::CreateSemaphore( 0, zp_limit<zp_int32_t>::max() );
+        g_context.sleepingWorkerCount = 0;
+        g_context.idleWorkerCount = 0;
+        g_context.runningBackgroundJobCount = 0;
+        g_context.maxBackgroundJobCount = zp_max( threadCount / 2, 1u );
+        g_context.hardwareThreadsPerCore = zp_max( hardwareThreadsPerCore, 1u );
+        g_context.threadCount = threadCount;
+        g_context.isRunning = 0;
     }
 
-    Job* GetJob()
+    void JobSystem::Teardown()
     {
-        Job* job = nullptr;
+        ExitJobThreads();
 
-        JobQueue* jobQueue = GetLocalJobQueue();
-        if( jobQueue && !jobQueue->empty() )
+        for( Vector<JobQueue>& jobQueues : g_context.allJobQueues )
         {
-            job = jobQueue->popBack();
+            jobQueues.destroy();
         }
-        else
-        {
-            JobQueue* stealJobQueue = GetStealJobQueue();
-            if( stealJobQueue != jobQueue && !stealJobQueue->empty() )
+        g_context.allBatchJobQueues.destroy();
+        g_context.allWorkerThreadHandles.destroy();
+        g_context.allJobPools.destroy();
+        g_context.allProcessors.destroy();
+        g_context.allJobQueueProcessors.destroy();
+        g_context.allStealOrders.destroy();
+        g_context.allStealTierEnds.destroy();
+        g_context.allWorkerCounters.destroy();
+        g_context.allWorkerCounterSnapshots.destroy();
+        g_context.allWorkerStats.destroy();
+
+        Platform::CloseSemaphore( g_context.wakeSemaphore );
+        g_context.wakeSemaphore = {};
+    }
+
+    void JobSystem::InitializeJobThreads()
+    {
+        for( Vector<JobQueue>& jobQueues : g_context.allJobQueues )
+        {
+            jobQueues.clear();
+        }
+        g_context.allBatchJobQueues.clear();
+        g_context.allWorkerThreadHandles.reset();
+        g_context.allJobPools.reset();
+        g_context.allJobQueueProcessors.reset();
+        g_context.allStealOrders.reset();
+        g_context.allStealTierEnds.reset();
+        g_context.allWorkerCounters.reset();
+        g_context.allWorkerCounterSnapshots.reset();
+        g_context.allWorkerStats.reset();
+        g_context.sleepingWorkerCount = 0;
+        g_context.idleWorkerCount = 0;
+        g_context.runningBackgroundJobCount = 0;
+
+        // create all queues and pools (worker threads + main thread) before any worker can try to steal from them
+        for( zp_uint32_t i = 0; i < g_context.threadCount + 1; ++i )
+        {
+            for( Vector<JobQueue>& jobQueues : g_context.allJobQueues )
             {
-                job = stealJobQueue->stealPopFront();
+                jobQueues.pushBackEmpty().create( MemoryLabels::ThreadSafe, kJobQueueInitialCapacity );
             }
+            g_context.allBatchJobQueues.pushBackEmpty().create( MemoryLabels::ThreadSafe, kJobQueueInitialCapacity );
+            g_context.allJobPools.pushBack( {} );
         }
 
-        if( job == nullptr )
+        // main thread keeps the first placement, worker i takes placement i + 1
+        const zp_uint32_t jobQueueCount = g_context.threadCount + 1;
+
+        g_context.allJobQueueProcessors.resize_unsafe( jobQueueCount );
+        BuildJobThreadPlacement( g_context.allProcessors.data(), static_cast<zp_uint32_t>( g_context.allProcessors.length() ), g_context.hardwareThreadsPerCore, g_context.allJobQueueProcessors.data(), jobQueueCount );
+
+        // the main thread's queue is the last one
+        const ProcessorInfo mainThreadProcessor = g_context.allJobQueueProcessors[ 0 ];
+        for( zp_uint32_t i = 0; i < g_context.threadCount; ++i )
         {
-            Platform::YieldCurrentThread();
+            g_context.allJobQueueProcessors[ i ] = g_context.allJobQueueProcessors[ i + 1 ];
         }
+        g_context.allJobQueueProcessors[ g_context.threadCount ] = mainThreadProcessor;
 
-        return job;
-    }
+        g_context.allStealOrders.resize_unsafe( jobQueueCount * g_context.threadCount );
+        g_context.allStealTierEnds.resize_unsafe( jobQueueCount * kJobStealTierCount );
+        for( zp_uint32_t i = 0; i < jobQueueCount; ++i )
+        {
+            BuildJobStealOrder( g_context.allJobQueueProcessors.data(), jobQueueCount, i, g_context.allStealOrders.data() + ( i * g_context.threadCount ), g_context.allStealTierEnds.data() + ( i * kJobStealTierCount ) );
+        }
 
-    void FlushBatchJobs()
-    {
-        JobQueue* batchQueue = GetLocalBatchJobQueue();
+        g_context.allWorkerCounters.resize_unsafe( jobQueueCount );
+        g_context.allWorkerCounterSnapshots.resize_unsafe( jobQueueCount );
+        g_context.allWorkerStats.resize_unsafe( jobQueueCount );
+        zp_zero_memory_array( g_context.allWorkerCounters.data(), jobQueueCount );
+        zp_zero_memory_array( g_context.allWorkerCounterSnapshots.data(), jobQueueCount );
+        zp_zero_memory_array( g_context.allWorkerStats.data(), jobQueueCount );
 
-        zp_size_t index = 0;
-        while( !batchQueue->empty() )
+        // mark as running
+        g_context.isRunning = 1;
+
+        const zp_size_t stackSize = 1 MB;
+        MutableFixedString64 threadName;
+
+        const zp_bool_t hasTopology = !g_context.allProcessors.isEmpty();
+        const zp_uint32_t numAvailableProcessors = zp_max( Platform::GetProcessorCount(), 2u ) - 1;
+        for( zp_uint32_t i = 0; i < g_context.threadCount; ++i )
         {
-            Job* job = batchQueue->popBack();
+            zp_uint32_t threadID;
+            const ThreadHandle threadHandle = Platform::CreateThread( WorkerThreadFunc, reinterpret_cast<void*>( static_cast<zp_ptr_t>( i ) ), stackSize, &threadID );
 
-            g_allJobQueues[ index % g_allJobQueues.length ]->pushBack( job );
-            ++index;
+            if( hasTopology )
+            {
+                Platform::SetThreadIdealProcessor( threadHandle, g_context.allJobQueueProcessors[ i ] );
+            }
+            else
+            {
+                Platform::SetThreadIdealProcessor( threadHandle, 1 + ( i % numAvailableProcessors ) ); // proc 0 is used for main thread
+            }
+
+            threadName.format( "JobThread-%d %d", threadID, i );
+
+            Platform::SetThreadName( threadHandle, threadName );
+
+            g_context.allWorkerThreadHandles.pushBack( threadHandle );
         }
+
+        // setup main thread job info
+        InitializeLocalThreadInfo( g_context.threadCount );
+
+#if ZP_USE_PROFILER
+        Profiler::RegisterAdvanceFrameCallback( SnapshotWorkerStatsOnAdvanceFrame, nullptr );
+#endif
     }
 
-    void FlushBatchJobsLocally()
+    void JobSystem::ExitJobThreads()
     {
-        JobQueue* jobQueue = GetLocalJobQueue();
-        JobQueue* batchQueue = GetLocalBatchJobQueue();
+#if ZP_USE_PROFILER
+        Profiler::UnregisterAdvanceFrameCallback( SnapshotWorkerStatsOnAdvanceFrame, nullptr );
+#endif
 
-        while( !batchQueue->empty() )
+        Atomic::Exchange( &g_context.isRunning, 0 );
+
+        // wake all worker threads, parked or about to park
+        if( g_context.threadCount > 0 )
         {
-            Job* job = batchQueue->popBack();
-            jobQueue->pushBack( job );
+            Platform::ReleaseSemaphore( g_context.wakeSemaphore, static_cast<zp_int32_t>( g_context.threadCount ) );
+        }
+
+        // wait for all threads to finish
+        Platform::JoinThreads( g_context.allWorkerThreadHandles.data(), g_context.allWorkerThreadHandles.length() );
+
+        // close threads
+        for( auto thread : g_context.allWorkerThreadHandles )
+        {
+            Platform::CloseThread( thread );
+        }
+
+        // destroy main thread job info
+        DestroyLocalThreadInfo();
+
+        // no more handles can be waited on, release all job memory
+        for( JobPool& pool : g_context.allJobPools )
+        {
+            DestroyJobPool( &pool );
         }
     }
 
-    zp_bool_t IsJobComplete( Job* job )
+    zp_uint32_t JobSystem::GetThreadCount()
     {
-        return job->header()->uncompletedJobs <= 0;
+        return g_context.threadCount;
     }
 
-    void WaitForJobComplete( Job* job )
+    zp_uint32_t JobSystem::GetJobQueueCount()
     {
-        while( !IsJobComplete( job ) )
+        return g_context.threadCount + 1;
+    }
+
+    void JobSystem::SnapshotWorkerStats()
+    {
+        for( zp_size_t i = 0; i < g_context.allWorkerCounters.length(); ++i )
         {
-            Job* waitJob = GetJob();
-            if( waitJob )
+            const JobWorkerCounters& counters = g_context.allWorkerCounters[ i ];
+            JobWorkerCounters& snapshot = g_context.allWorkerCounterSnapshots[ i ];
+
+            zp_size_t queuedJobs = 0;
+            for( const Vector<JobQueue>& jobQueues : g_context.allJobQueues )
             {
-                ExecuteJob( waitJob );
+                queuedJobs += jobQueues[ i ].size();
             }
+
+            JobWorkerStats& stats = g_context.allWorkerStats[ i ];
+            stats = {
+                .executedJobs = TakeWorkerCounterDelta( counters.executedJobs, snapshot.executedJobs ),
+                .steals = TakeWorkerCounterDelta( counters.steals, snapshot.steals ),
+                .failedSteals = TakeWorkerCounterDelta( counters.failedSteals, snapshot.failedSteals ),
+                .parks = TakeWorkerCounterDelta( counters.parks, snapshot.parks ),
+                .idleTime = static_cast<zp_time_t>( TakeWorkerCounterDelta( counters.idleTime, snapshot.idleTime ) ),
+                .queuedJobs = static_cast<zp_uint32_t>( queuedJobs ),
+            };
+
+            const zp_uint32_t track = static_cast<zp_uint32_t>( i );
+            ZP_PROFILE_COUNTER( "Job.ExecutedJobs", static_cast<zp_int64_t>( stats.executedJobs ), track );
+            ZP_PROFILE_COUNTER( "Job.Steals", static_cast<zp_int64_t>( stats.steals ), track );
+            ZP_PROFILE_COUNTER( "Job.FailedSteals", static_cast<zp_int64_t>( stats.failedSteals ), track );
+            ZP_PROFILE_COUNTER( "Job.Parks", static_cast<zp_int64_t>( stats.parks ), track );
+            ZP_PROFILE_COUNTER( "Job.IdleTime", static_cast<zp_int64_t>( stats.idleTime ), track );
+            ZP_PROFILE_COUNTER( "Job.QueuedJobs", static_cast<zp_int64_t>( stats.queuedJobs ), track );
         }
     }
 
-    //
-    //
-    //
-
-    void ShutdownThreadJob( Job* job, Memory data )
+    zp_size_t JobSystem::GetWorkerStats( JobWorkerStats* workerStats, zp_size_t workerStatsCount )
     {
-        t_threadInfo.isRunning = false;
+        const zp_size_t count = zp_min( workerStatsCount, g_context.allWorkerStats.length() );
+        for( zp_size_t i = 0; i < count; ++i )
+        {
+            workerStats[ i ] = g_context.allWorkerStats[ i ];
+        }
+
+        return count;
     }
 
-    zp_uint32_t WorkerThreadFunc( void* threadData )
+    void JobSystem::Complete( JobHandle jobHandle )
     {
+        WaitForJobComplete( jobHandle );
+    }
 
-#if ZP_USE_PROFILER
-Profiler::InitializeProfilerThread();
-#endif
+    zp_bool_t JobSystem::IsComplete( JobHandle jobHandle )
+    {
+        return IsJobComplete( jobHandle );
+    }
 
-const zp_size_t index = static_cast<zp_size_t>(reinterpret_cast<zp_ptr_t>(threadData));
+    JobHandle JobSystem::Execute( JobWorkFunc func, JobPriority priority )
+    {
+        Job* job = AllocateJob( priority );
+        const JobHandle handle = MakeJobHandle( job );
 
-g_allJobThreadInfos [ index ] = &t_threadInfo;
+        job->callback = func;
 
-zp_zero_memory_array ( t_threadInfo.jobs);
+        QueueNextJob( job );
 
-t_threadInfo.allocatedJobCount=0;
-t_threadInfo.localJobQueue= g_allJobQueues[ index ];
-t_threadInfo.localBatchJobQueue= g_allBatchJobQueues[ index ];
-t_threadInfo.isRunning=true;
+        WakeWorkers( 1 );
 
-        while( t_threadInfo.isRunning)
-        {
-            Job* job = GetJob();
-            if( job && t_threadInfo.isRunning )
-            {
-                ExecuteJob( job );
-            }
+        return handle;
+    }
 
-            Platform::YieldCurrentThread();
-        }
+    JobHandle JobSystem::PrepareEmpty( JobPriority priority )
+    {
+        Job* job = AllocateJob( priority );
+        const JobHandle handle = MakeJobHandle( job );
 
-zp_printfln ( "Exiting Worker Thread %d", Platform::GetCurrentThreadId());
+        PrepareLocalJob( job );
 
-t_threadInfo.allocatedJobCount=0;
-t_threadInfo.localBatchJobQueue=nullptr;
-t_threadInfo.localJobQueue=nullptr;
+        return handle;
+    }
 
-        return 0;
+    JobHandle JobSystem::Prepare( JobWorkFunc func, JobHandle dependency, JobPriority priority )
+    {
+        return Prepare( func, &dependency, 1, priority );
     }
-}
 
-//
-//
-//
+    JobHandle JobSystem::Prepare( JobWorkFunc func, const JobHandle* dependencies, zp_size_t dependencyCount, JobPriority priority )
+    {
+        Job* job = AllocateJob( priority );
+        const JobHandle handle = MakeJobHandle( job );
 
-const JobHandle JobHandle::Null = JobHandle( nullptr );
+        job->callback = func;
 
-JobHandle::JobHandle()
-    : m_job( nullptr )
-{
-}
+        if( AddJobDependencies( job, dependencies, dependencyCount ) )
+        {
+            PrepareLocalJob( job );
+        }
 
-JobHandle::JobHandle( Job* job )
-    : m_job( job )
-{
-}
+        return handle;
+    }
 
-void JobHandle::complete()
-{
-    if( m_job )
+    JobHandle JobSystem::Dispatch( zp_size_t length, zp_size_t batchCount, JobWorkFunc func, JobPriority priority )
     {
-        WaitForJobComplete( m_job );
-        m_job = nullptr;
-    }
-}
+        ZP_ASSERT( length > 0 );
+        ZP_ASSERT( batchCount > 0 );
 
-zp_bool_t JobHandle::isComplete() const
-{
-    return m_job == nullptr || IsJobComplete( m_job );
-}
+        const zp_size_t jobCount = zp_divide_round_up( length, batchCount );
 
-//
-//
-//
+        Job* parentJob = AllocateJob( priority );
+        const JobHandle handle = MakeJobHandle( parentJob );
 
-PrepariedJob::PrepariedJob( Job* job )
-    : m_job( job )
-{
-}
+        zp_size_t offset = 0;
+        for( zp_size_t batch = 0; batch < jobCount; ++batch )
+        {
+            Job* job = AllocateJob( priority );
 
-JobHandle PrepariedJob::schedule()
-{
-    Job* job = m_job;
-    m_job = nullptr;
+            job->callback = func;
 
-    if( job )
-    {
-        GetLocalBatchJobQueue()->pushBack( job );
-    }
+            job->batchId = batch;
+            job->jobStart = offset;
 
-    return JobHandle( job );
-}
+            offset = zp_min( length, offset + batchCount );
 
-JobHandle PrepariedJob::schedule( JobHandle dependency )
-{
-    Job* job = m_job;
-    m_job = nullptr;
+            job->jobEnd = offset;
 
-    if( job )
-    {
-        if( dependency.m_job && !dependency.isComplete() )
-        {
-            dependency.m_job->addDependency( job );
-        }
-        else
-        {
-            GetLocalBatchJobQueue()->pushBack( job );
+            SetParentJob( job, parentJob );
+
+            QueueNextJob( job );
         }
-    }
 
-    return JobHandle( job );
-}
+        QueueNextJob( parentJob );
 
-//
-//
-//
+        WakeWorkers( jobCount + 1 );
 
-void JobSystem::Setup( MemoryLabel memoryLabel, zp_uint32_t threadCount )
-{
-    if( threadCount == 0 )
-    {
-        threadCount = Platform::GetProcessorCount() - 1;
+        return handle;
     }
-    else
+
+    JobHandle JobSystem::PrepareDispatch( zp_size_t length, zp_size_t batchCount, JobWorkFunc func, JobHandle dependency, JobPriority priority )
     {
-        threadCount = zp_min( threadCount, Platform::GetProcessorCount() - 1 );
-    }
+        ZP_ASSERT( length > 0 );
+        ZP_ASSERT( batchCount > 0 );
 
-    g_stealJobQueueIndex = 0;
-    g_memoryLabel = memoryLabel;
+        const zp_size_t jobCount = zp_divide_round_up( length, batchCount );
 
-    const zp_uint32_t threadJobCount = threadCount + 1;
+        Job* parentJob = AllocateJob( priority );
+        const JobHandle handle = MakeJobHandle( parentJob );
 
-    g_allQueues = {
-        .ptr = ZP_MALLOC_T_ARRAY( memoryLabel, JobQueue, threadJobCount * 2 ),
-        .length = threadJobCount * 2
-    };
-    zp_zero_memory_array( g_allQueues.ptr, g_allQueues.length );
+        zp_size_t offset = 0;
+        for( zp_size_t batch = 0; batch < jobCount; ++batch )
+        {
+            Job* job = AllocateJob( priority );
 
-    g_allJobQueues = {
-        .ptr = ZP_MALLOC_T_ARRAY( memoryLabel, JobQueue *, threadJobCount ),
-        .length = threadJobCount
-    };
+            job->callback = func;
 
-    g_allBatchJobQueues = {
-        .ptr = ZP_MALLOC_T_ARRAY( memoryLabel, JobQueue *, threadJobCount ),
-        .length = threadJobCount
-    };
+            job->batchId = batch;
+            job->jobStart = offset;
 
-    for( zp_uint32_t i = 0; i < threadJobCount; ++i )
-    {
-        g_allJobQueues[ i ] = &g_allQueues[ i ];
-        g_allBatchJobQueues[ i ] = &g_allQueues[ i + threadJobCount ];
-    }
+            offset = zp_min( length, offset + batchCount );
 
-    g_allJobThreadInfos = {
-        .ptr = ZP_MALLOC_T_ARRAY( memoryLabel, JobThreadInfo *, threadJobCount ),
-        .length = threadJobCount
-    };
-    zp_zero_memory_array( g_allJobThreadInfos.ptr, g_allJobThreadInfos.length );
+            job->jobEnd = offset;
 
-    g_allJobThreadHandles = {
-        .ptr = ZP_MALLOC_T_ARRAY( memoryLabel, ThreadHandle, threadCount ),
-        .length = threadCount
-    };
-    zp_zero_memory_array( g_allJobThreadHandles.ptr, g_allJobThreadHandles.length );
-}
+            SetParentJob( job, parentJob );
 
-void JobSystem::Teardown()
-{
-    ZP_FREE( g_memoryLabel, g_allJobThreadHandles.ptr );
-    ZP_FREE( g_memoryLabel, g_allJobThreadInfos.ptr );
+            PrepareLocalJob( job );
+        }
 
-    ZP_FREE( g_memoryLabel, g_allBatchJobQueues.ptr );
-    ZP_FREE( g_memoryLabel, g_allJobQueues.ptr );
-    ZP_FREE( g_memoryLabel, g_allQueues.ptr );
-}
+        if( AddJobDependencies( parentJob, &dependency, 1 ) )
+        {
+            PrepareLocalJob( parentJob );
+        }
 
-void JobSystem::InitializeJobThreads()
-{
-    const zp_size_t stackSize = 1 MB;
-    MutableFixedString < 64 > threadName;
+        return handle;
+    }
 
-    const zp_uint32_t numAvailableProcessors = Platform::GetProcessorCount() - 1;
-    for( zp_uint32_t i = 0; i < g_allJobThreadHandles.length; ++i )
+    JobHandle JobSystem::ParallelFor( zp_size_t length, zp_size_t grain, JobWorkFunc func, JobPriority priority )
     {
-        zp_uint32_t threadID;
-        ThreadHandle threadHandle = Platform::CreateThread( WorkerThreadFunc, reinterpret_cast<void*>(static_cast<zp_ptr_t>(i)), stackSize, &threadID );
+        ZP_ASSERT( length > 0 );
+        ZP_ASSERT( grain > 0 );
+        ZP_ASSERT( length <= zp_limit<zp_uint32_t>::max() );
 
-        Platform::SetThreadIdealProcessor( threadHandle, 1 + ( i % numAvailableProcessors ) ); // proc 0 is used for main thread
+        Job* parentJob = AllocateJob( priority );
+        const JobHandle handle = MakeJobHandle( parentJob );
 
-        threadName.format( "JobThread-%d %d", threadID, i );
+        // start as a single job covering the whole range, TrySplitJob hands out halves while it runs
+        Job* job = AllocateJob( priority );
 
-        Platform::SetThreadName( threadHandle, threadName );
+        job->callback = func;
 
-        g_allJobThreadHandles[ i ] = threadHandle;
-    }
+        job->jobStart = 0;
+        job->jobEnd = length;
+        job->splitGrain = zp_min( grain, length );
 
-    // setup main thread job info
-    zp_zero_memory_array( t_threadInfo.jobs );
+        SetParentJob( job, parentJob );
 
-    g_allJobThreadInfos[ g_allJobThreadHandles.length ] = &t_threadInfo;
+        QueueNextJob( job );
 
-    t_threadInfo.allocatedJobCount = 0;
-    t_threadInfo.localJobQueue = g_allJobQueues[ g_allJobThreadHandles.length ];
-    t_threadInfo.localBatchJobQueue = g_allBatchJobQueues[ g_allJobThreadHandles.length ];
-    t_threadInfo.isRunning = true;
-}
+        QueueNextJob( parentJob );
 
-void JobSystem::ExitJobThreads()
-{
-    // shutdown job worker threads
-    for( zp_size_t i = 0; i < g_allJobThreadInfos.length; ++i )
-    {
-        g_allJobThreadInfos[ i ]->isRunning = false;
-    }
+        WakeWorkers( 2 );
 
-    // wait for all threads to finish
-    Platform::JoinThreads( g_allJobThreadHandles.ptr, g_allJobThreadHandles.length );
+        return handle;
+    }
 
-    // close threads
-    for( zp_size_t i = 0; i < g_allJobThreadHandles.length; ++i )
+    Memory JobSystem::AllocateScratchMemory( zp_size_t size, zp_size_t alignment )
     {
-        Platform::CloseThread( g_allJobThreadHandles[ i ] );
-        g_allJobThreadHandles[ i ] = {};
+        return AllocateJobScratchMemory( t_threadInfo.scratchArena, size, alignment );
     }
 
-    // clear info pointers
-    zp_zero_memory_array( g_allJobThreadInfos.ptr, g_allJobThreadInfos.length );
-
-    // clear queues
-    for( zp_size_t i = 0; i < g_allQueues.length; ++i )
+    JobHandle JobSystem::Start( Memory jobData, JobCallback jobCallback, JobPriority priority )
     {
-        g_allQueues[ i ].clear();
+        Job* job = AllocateJob( priority );
+        const JobHandle handle = MakeJobHandle( job );
+
+        job->callback = jobCallback;
+        zp_memcpy( job->data.asMemory(), jobData );
+
+        QueueNextJob( job );
+
+        WakeWorkers( 1 );
+
+        return handle;
     }
 
-    // clear main thread job info
-    t_threadInfo.allocatedJobCount = 0;
-    t_threadInfo.localJobQueue = nullptr;
-    t_threadInfo.localBatchJobQueue = nullptr;
-    t_threadInfo.isRunning = false;
-}
+    JobHandle JobSystem::StartAfter( Memory jobData, JobCallback jobCallback, JobHandle dependency, JobPriority priority )
+    {
+        Job* job = AllocateJob( priority );
+        const JobHandle handle = MakeJobHandle( job );
 
-void JobSystem::ProcessJobs()
-{
-    Job* job = GetJob();
-    if( job )
+        job->callback = jobCallback;
+        zp_memcpy( job->data.asMemory(), jobData );
+
+        if( AddJobDependencies( job, &dependency, 1 ) )
+        {
+            QueueNextJob( job );
+
+            WakeWorkers( 1 );
+        }
+
+        return handle;
+    }
+
+    JobHandle JobSystem::PrepareSignal( JobPriority priority )
     {
-        ExecuteJob( job );
+        // never queued, the extra uncompleted count from AllocateJob is only dropped by Signal
+        Job* job = AllocateJob( priority );
+
+        return MakeJobHandle( job );
     }
-}
 
-PrepariedJob JobSystem::Start()
-{
-    Job* job = AllocateJob();
+    void JobSystem::Signal( JobHandle signalHandle )
+    {
+        ZP_ASSERT( !IsJobComplete( signalHandle ) );
 
-    JobHeader* header = job->header();
-    *header = {
-        .parent = nullptr,
-        .execFunc = nullptr,
-        .uncompletedJobs = 1,
-        .numDependencies = 0,
-        .jobDataSize = 0
-    };
+        FinishJob( signalHandle.job );
+    }
 
-    return PrepariedJob( job );
-}
+    void* JobSystem::AllocateTaskFrame( zp_size_t size )
+    {
+        return AllocatePooledTaskFrame( size );
+    }
 
-PrepariedJob JobSystem::Start( JobHandle parentJob )
-{
-    if( parentJob.m_job )
+    void JobSystem::FreeTaskFrame( void* ptr, zp_size_t size )
     {
-        Atomic::Increment( &parentJob.m_job->header()->uncompletedJobs );
+        FreePooledTaskFrame( ptr );
     }
 
-    Job* job = AllocateJob();
+    JobHandle JobSystem::Run( Memory jobData, JobCallback jobCallback )
+    {
+        Job* job = AllocateJob();
 
-    JobHeader* header = job->header();
-    *header = {
-        .parent = parentJob.m_job,
-        .execFunc = nullptr,
-        .uncompletedJobs = 1,
-        .numDependencies = 0,
-        .jobDataSize = 0
-    };
+        job->callback = jobCallback;
+        zp_memcpy( job->data.asMemory(), jobData );
 
-    return PrepariedJob( job );
-}
+        ExecuteJob( job );
 
-PrepariedJob JobSystem::Start( JobWorkFunc execFunc )
-{
-    Job* job = AllocateJob();
+        return {};
+    }
 
-    JobHeader* header = job->header();
-    *header = {
-        .parent = nullptr,
-        .execFunc = execFunc,
-        .uncompletedJobs = 1,
-        .numDependencies = 0,
-        .jobDataSize = 0
-    };
+    void JobSystem::AdvanceFrame()
+    {
+        // only the frame chain advances frames, so the frame before this one can't gain jobs while they're waited on
+        const zp_uint32_t frameIndex = g_context.frameIndex;
+        const zp_uint32_t* previousFrameJobs = &g_context.outstandingFrameJobs[ ( frameIndex + 1 ) % kJobFrameCount ];
 
-    return PrepariedJob( job );
-}
+        // background jobs are left alone, a long running one would stall the frame
+        while( Atomic::LoadAcquire( previousFrameJobs ) != 0 )
+        {
+            Job* job = RequestQueuedJob( JobPriority::Normal );
+            if( job != nullptr )
+            {
+                ExecuteJob( job );
+            }
+            else
+            {
+                Platform::YieldCurrentThread();
+            }
+        }
 
-PrepariedJob JobSystem::Start( JobWorkFunc execFunc, JobHandle parentJob )
-{
-    if( parentJob.m_job )
-    {
-        Atomic::Increment( &parentJob.m_job->header()->uncompletedJobs );
+        // the drained counter is reused by the next frame
+        Atomic::StoreRelease( &g_context.frameIndex, frameIndex + 1 );
     }
 
-    Job* job = AllocateJob();
+    void JobSystem::ScheduleBatchJobs()
+    {
+        const zp_size_t flushedJobCount = FlushBatchJobs();
 
-    JobHeader* header = job->header();
-    *header = {
-        .parent = parentJob.m_job,
-        .execFunc = execFunc,
-        .uncompletedJobs = 1,
-        .numDependencies = 0,
-        .jobDataSize = 0
-    };
+        WakeWorkers( flushedJobCount );
+    }
 
-    return PrepariedJob( job );
-}
+    void JobSystem::ProcessJobs()
+    {
+        const JobPriority lowestPriority = GetMainThreadLowestJobPriority();
 
-PrepariedJob JobSystem::Start( JobWorkFunc execFunc, void* data, zp_size_t size )
-{
-    Job* job = AllocateJob();
+        Job* job = RequestQueuedJob( lowestPriority );
 
-    JobHeader* header = job->header();
-    *header = {
-        .parent = nullptr,
-        .execFunc = execFunc,
-        .uncompletedJobs = 1,
-        .numDependencies = 0,
-        .jobDataSize = size
-    };
+        while( job != nullptr )
+        {
+            ExecuteJob( job );
 
-    if( data && size > 0 )
-    {
-        Memory mem = job->data();
-        zp_memcpy( mem.ptr, mem.size, data, size );
+            job = RequestQueuedJob( lowestPriority );
+        }
     }
 
-    return PrepariedJob( job );
-}
-
-PrepariedJob JobSystem::Start( JobWorkFunc execFunc, void* data, zp_size_t size, JobHandle parentJob )
-{
-    if( parentJob.m_job )
+    zp_bool_t JobSystem::ShouldYield()
     {
-        Atomic::Increment( &parentJob.m_job->header()->uncompletedJobs );
+        const JobPriority executingPriority = t_threadInfo.executingPriority;
+        if( executingPriority == JobPriority::Count || executingPriority == JobPriority::FrameCritical )
+        {
+            return false;
+        }
+
+        return HasQueuedJobs( static_cast<JobPriority>( static_cast<zp_size_t>( executingPriority ) - 1 ) );
     }
 
-    Job* job = AllocateJob();
+    void JobSystem::YieldToHigherPriority()
+    {
+        const JobPriority executingPriority = t_threadInfo.executingPriority;
+        if( executingPriority == JobPriority::Count || executingPriority == JobPriority::FrameCritical )
+        {
+            return;
+        }
 
-    JobHeader* header = job->header();
-    *header = {
-        .parent = parentJob.m_job,
-        .execFunc = execFunc,
-        .uncompletedJobs = 1,
-        .numDependencies = 0,
-        .jobDataSize = size
-    };
+        // only run strictly higher priority jobs, the yielding job's own priority level waits its turn
+        const JobPriority lowestPriority = static_cast<JobPriority>( static_cast<zp_size_t>( executingPriority ) - 1 );
 
-    if( data && size > 0 )
-    {
-        Memory mem = job->data();
-        zp_memcpy( mem.ptr, mem.size, data, size );
+        Job* job = RequestQueuedJob( lowestPriority );
+
+        while( job != nullptr )
+        {
+            ExecuteJob( job );
+
+            job = RequestQueuedJob( lowestPriority );
+        }
     }
+}; // namespace zp
 
-    return PrepariedJob( job );
-}
+#if 0
+using namespace zp;
 
-void JobSystem::ScheduleBatchJobs()
+
+namespace
 {
-    //FlushBatchJobs();
+    enum
+    {
+        kJobPayload = 4 KB
+    };
+
+    struct JobHeader
+    {
+        Job* parent;
+        JobWorkFunc execFunc;
+        zp_int32_t uncompletedJobs;
+        zp_int32_t numDependencies;
+        zp_size_t jobDataSize;
+    };
+}
+
+namespace zp
+{
+
+    struct Job
+    {
+        JobHeader* header()
+        {
+            JobHeader* h = reinterpret_cast<JobHeader*>(m_jobData);
+            return h;
+        }
+
+        Memory data()
+        {
+            JobHeader* h = header();
+            return {
+                .ptr = m_jobData + sizeof( JobHeader ),
+                .size = h->jobDataSize
+            };
+        }
+
+        void execute()
+        {
+            JobWorkFunc exec = header()->execFunc;
+            if( exec )
+            {
+                exec( this, data() );
+            }
+        }
+
+        void addDependency( Job* job )
+        {
+            JobHeader* h = header();
+            Job** dep = reinterpret_cast<Job**>(m_jobData + ( kJobPayload - sizeof( Job* ) * ( 1 + h->numDependencies ) ));
+            dep[ h->numDependencies ] = job;
+            ++h->numDependencies;
+        }
+
+        MemoryArray<Job*> dependencies()
+        {
+            JobHeader* h = header();
+            return {
+                .ptr = h->numDependencies == 0 ? nullptr : reinterpret_cast<Job**>(m_jobData + ( kJobPayload - sizeof( Job* ) * ( 1 + h->numDependencies ) )),
+                .length = static_cast<zp_size_t>(h->numDependencies)
+            };
+        }
+
+        zp_uint8_t m_jobData[ kJobPayload ];
+    };
+}
+
+namespace
+{
+    enum
+    {
+        kJobsPerThread = 512,
+        kJobsPerThreadMask = kJobsPerThread - 1,
+
+        kJobQueueCount = 256,
+        kJobQueueCountMask = kJobQueueCount - 1,
+    };
+
+    ZP_STATIC_ASSERT ( zp_is_pow2
+    ( kJobQueueCount )
+    );
+    ZP_STATIC_ASSERT ( zp_is_pow2
+    ( kJobsPerThread )
+    );
+}
+
+namespace
+{
+    class JobQueue
+    {
+        ZP_NONCOPYABLE( JobQueue );
+
+    public:
+        [[nodiscard]] zp_bool_t empty() const;
+
+        void pushBack( Job* job );
+
+        Job* popBack();
+
+        Job* stealPopFront();
+
+        void clear();
+
+    private:
+        FixedArray<Job*, kJobQueueCount> m_jobs;
+        zp_int32_t m_back;
+        zp_int32_t m_front;
+    };
+
+    zp_bool_t JobQueue::empty() const
+    {
+        return m_back == m_front;
+    }
+
+    void JobQueue::pushBack( Job* job )
+    {
+        const zp_int32_t b = m_back;
+        m_jobs[ b & kJobQueueCountMask ] = job;
+        Atomic::Exchange( &m_back, b + 1 );
+    }
+
+    Job* JobQueue::popBack()
+    {
+        const zp_int32_t b = m_back - 1;
+        Atomic::Exchange( &m_back, b );
+
+        const zp_int32_t t = m_front;
+
+        Job* job = nullptr;
+
+        if( t <= b )
+        {
+            job = m_jobs[ b & kJobQueueCountMask ];
+            if( t != b )
+            {
+                return job;
+            }
+
+            if( Atomic::CompareExchange( &m_front, t + 1, t ) != t )
+            {
+                job = nullptr;
+            }
+
+            m_back = t + 1;
+        }
+        else
+        {
+            m_back = t;
+        }
+
+        return job;
+    }
+
+    Job* JobQueue::stealPopFront()
+    {
+        const zp_int32_t t = m_front;
+
+        Atomic::MemoryBarrier();
+
+        const zp_int32_t b = m_back;
+
+        Job* job = nullptr;
+
+        if( t < b )
+        {
+            job = m_jobs[ t & kJobQueueCountMask ];
+
+            if( Atomic::CompareExchange( &m_front, t + 1, t ) != t )
+            {
+                job = nullptr;
+            }
+        }
+
+        return job;
+    }
+
+    void JobQueue::clear()
+    {
+        m_front = 0;
+        m_back = 0;
+    }
+}
+
+namespace
+{
+    struct JobThreadInfo
+    {
+        Job jobs[ kJobsPerThread ];
+        zp_size_t allocatedJobCount;
+        JobQueue* localJobQueue;
+        JobQueue* localBatchJobQueue;
+        zp_bool_t isRunning;
+    };
+
+    thread_local JobThreadInfo t_threadInfo;
+
+
+    MemoryArray<JobQueue> g_allQueues;
+
+    MemoryArray<JobQueue*> g_allJobQueues;
+
+    MemoryArray<JobQueue*> g_allBatchJobQueues;
+
+    MemoryArray<JobThreadInfo*> g_allJobThreadInfos;
+
+    MemoryArray<ThreadHandle> g_allJobThreadHandles;
+
+    zp_size_t g_stealJobQueueIndex;
+
+    MemoryLabel g_memoryLabel;
+
+    //
+    //
+    //
+
+    JobQueue* GetLocalJobQueue()
+    {
+        return t_threadInfo.localJobQueue;
+    }
+
+    JobQueue* GetLocalBatchJobQueue()
+    {
+        return t_threadInfo.localBatchJobQueue;
+    }
+
+    JobQueue* GetStealJobQueue()
+    {
+        const zp_size_t index = Atomic::IncrementSizeT( &g_stealJobQueueIndex ) - 1;
+        return g_allJobQueues[ index % g_allJobQueues.length ];
+    }
+
+    Job* AllocateJob()
+    {
+        const zp_size_t index = ++t_threadInfo.allocatedJobCount;
+        return &t_threadInfo.jobs[ index & kJobsPerThreadMask ];
+    }
+
+    void EnqueueLocalJob( Job* job )
+    {
+        JobQueue* jobQueue = GetLocalJobQueue();
+        jobQueue->pushBack( job );
+    }
+
+    void FinishJob( Job* job )
+    {
+        JobHeader* header = job->header();
+
+        const zp_int32_t unfinishedJobs = Atomic::Decrement( &header->uncompletedJobs );
+
+        if( unfinishedJobs == 0 )
+        {
+            Job* parent = header->parent;
+
+            if( parent )
+            {
+                FinishJob( parent );
+            }
+
+            MemoryArray<Job*> deps = job->dependencies();
+            for( Job* dep : deps )
+            {
+                EnqueueLocalJob( dep );
+            }
+
+            Atomic::Decrement( &header->uncompletedJobs );
+
+            // clear job memory
+            Memory mem = job->data();
+            zp_zero_memory( mem.ptr, mem.size );
+        }
+    }
+
+    void ExecuteJob( Job* job )
+    {
+        job->execute();
+
+        FinishJob( job );
+    }
+
+    Job* GetJob()
+    {
+        Job* job = nullptr;
+
+        JobQueue* jobQueue = GetLocalJobQueue();
+        if( jobQueue && !jobQueue->empty() )
+        {
+            job = jobQueue->popBack();
+        }
+        else
+        {
+            JobQueue* stealJobQueue = GetStealJobQueue();
+            if( stealJobQueue != jobQueue && !stealJobQueue->empty() )
+            {
+                job = stealJobQueue->stealPopFront();
+            }
+        }
+
+        if( job == nullptr )
+        {
+            Platform::YieldCurrentThread();
+        }
+
+        return job;
+    }
+
+    void FlushBatchJobs()
+    {
+        JobQueue* batchQueue = GetLocalBatchJobQueue();
+
+        zp_size_t index = 0;
+        while( !batchQueue->empty() )
+        {
+            Job* job = batchQueue->popBack();
+
+            g_allJobQueues[ index % g_allJobQueues.length ]->pushBack( job );
+            ++index;
+        }
+    }
+
+    void FlushBatchJobsLocally()
+    {
+        JobQueue* jobQueue = GetLocalJobQueue();
+        JobQueue* batchQueue = GetLocalBatchJobQueue();
+
+        while( !batchQueue->empty() )
+        {
+            Job* job = batchQueue->popBack();
+            jobQueue->pushBack( job );
+        }
+    }
+
+    zp_bool_t IsJobComplete( Job* job )
+    {
+        return job->header()->uncompletedJobs <= 0;
+    }
+
+    void WaitForJobComplete( Job* job )
+    {
+        while( !IsJobComplete( job ) )
+        {
+            Job* waitJob = GetJob();
+            if( waitJob )
+            {
+                ExecuteJob( waitJob );
+            }
+        }
+    }
+
+    //
+    //
+    //
+
+    void ShutdownThreadJob( Job* job, Memory data )
+    {
+        t_threadInfo.isRunning = false;
+    }
+
+    zp_uint32_t WorkerThreadFunc( void* threadData )
+    {
+
+#if ZP_USE_PROFILER
+Profiler::InitializeProfilerThread();
+#endif
+
+const zp_size_t index = static_cast<zp_size_t>(reinterpret_cast<zp_ptr_t>(threadData));
+
+g_allJobThreadInfos [ index ] = &t_threadInfo;
+
+zp_zero_memory_array ( t_threadInfo.jobs);
+
+t_threadInfo.allocatedJobCount=0;
+t_threadInfo.localJobQueue= g_allJobQueues[ index ];
+t_threadInfo.localBatchJobQueue= g_allBatchJobQueues[ index ];
+t_threadInfo.isRunning=true;
+
+        while( t_threadInfo.isRunning)
+        {
+            Job* job = GetJob();
+            if( job && t_threadInfo.isRunning )
+            {
+                ExecuteJob( job );
+            }
+
+            Platform::YieldCurrentThread();
+        }
+
+zp_printfln ( "Exiting Worker Thread %d", Platform::GetCurrentThreadId());
+
+t_threadInfo.allocatedJobCount=0;
+t_threadInfo.localBatchJobQueue=nullptr;
+t_threadInfo.localJobQueue=nullptr;
+
+        return 0;
+    }
+}
+
+//
+//
+//
+
+const JobHandle JobHandle::Null = JobHandle( nullptr );
+
+JobHandle::JobHandle()
+    : m_job( nullptr )
+{
+}
+
+JobHandle::JobHandle( Job* job )
+    : m_job( job )
+{
+}
+
+void JobHandle::complete()
+{
+    if( m_job )
+    {
+        WaitForJobComplete( m_job );
+        m_job = nullptr;
+    }
+}
+
+zp_bool_t JobHandle::isComplete() const
+{
+    return m_job == nullptr || IsJobComplete( m_job );
+}
+
+//
+//
+//
+
+PrepariedJob::PrepariedJob( Job* job )
+    : m_job( job )
+{
+}
+
+JobHandle PrepariedJob::schedule()
+{
+    Job* job = m_job;
+    m_job = nullptr;
+
+    if( job )
+    {
+        GetLocalBatchJobQueue()->pushBack( job );
+    }
+
+    return JobHandle( job );
+}
+
+JobHandle PrepariedJob::schedule( JobHandle dependency )
+{
+    Job* job = m_job;
+    m_job = nullptr;
+
+    if( job )
+    {
+        if( dependency.m_job && !dependency.isComplete() )
+        {
+            dependency.m_job->addDependency( job );
+        }
+        else
+        {
+            GetLocalBatchJobQueue()->pushBack( job );
+        }
+    }
+
+    return JobHandle( job );
+}
+
+//
+//
+//
+
+void JobSystem::Setup( MemoryLabel memoryLabel, zp_uint32_t threadCount )
+{
+    if( threadCount == 0 )
+    {
+        threadCount = Platform::GetProcessorCount() - 1;
+    }
+    else
+    {
+        threadCount = zp_min( threadCount, Platform::GetProcessorCount() - 1 );
+    }
+
+    g_stealJobQueueIndex = 0;
+    g_memoryLabel = memoryLabel;
+
+    const zp_uint32_t threadJobCount = threadCount + 1;
+
+    g_allQueues = {
+        .ptr = ZP_MALLOC_T_ARRAY( memoryLabel, JobQueue, threadJobCount * 2 ),
+        .length = threadJobCount * 2
+    };
+    zp_zero_memory_array( g_allQueues.ptr, g_allQueues.length );
+
+    g_allJobQueues = {
+        .ptr = ZP_MALLOC_T_ARRAY( memoryLabel, JobQueue *, threadJobCount ),
+        .length = threadJobCount
+    };
+
+    g_allBatchJobQueues = {
+        .ptr = ZP_MALLOC_T_ARRAY( memoryLabel, JobQueue *, threadJobCount ),
+        .length = threadJobCount
+    };
+
+    for( zp_uint32_t i = 0; i < threadJobCount; ++i )
+    {
+        g_allJobQueues[ i ] = &g_allQueues[ i ];
+        g_allBatchJobQueues[ i ] = &g_allQueues[ i + threadJobCount ];
+    }
+
+    g_allJobThreadInfos = {
+        .ptr = ZP_MALLOC_T_ARRAY( memoryLabel, JobThreadInfo *, threadJobCount ),
+        .length = threadJobCount
+    };
+    zp_zero_memory_array( g_allJobThreadInfos.ptr, g_allJobThreadInfos.length );
+
+    g_allJobThreadHandles = {
+        .ptr = ZP_MALLOC_T_ARRAY( memoryLabel, ThreadHandle, threadCount ),
+        .length = threadCount
+    };
+    zp_zero_memory_array( g_allJobThreadHandles.ptr, g_allJobThreadHandles.length );
+}
+
+void JobSystem::Teardown()
+{
+    ZP_FREE( g_memoryLabel, g_allJobThreadHandles.ptr );
+    ZP_FREE( g_memoryLabel, g_allJobThreadInfos.ptr );
+
+    ZP_FREE( g_memoryLabel, g_allBatchJobQueues.ptr );
+    ZP_FREE( g_memoryLabel, g_allJobQueues.ptr );
+    ZP_FREE( g_memoryLabel, g_allQueues.ptr );
+}
+
+void JobSystem::InitializeJobThreads()
+{
+    const zp_size_t stackSize = 1 MB;
+    MutableFixedString < 64 > threadName;
+
+    const zp_uint32_t numAvailableProcessors = Platform::GetProcessorCount() - 1;
+    for( zp_uint32_t i = 0; i < g_allJobThreadHandles.length; ++i )
+    {
+        zp_uint32_t threadID;
+        ThreadHandle threadHandle = Platform::CreateThread( WorkerThreadFunc, reinterpret_cast<void*>(static_cast<zp_ptr_t>(i)), stackSize, &threadID );
+
+        Platform::SetThreadIdealProcessor( threadHandle, 1 + ( i % numAvailableProcessors ) ); // proc 0 is used for main thread
+
+        threadName.format( "JobThread-%d %d", threadID, i );
+
+        Platform::SetThreadName( threadHandle, threadName );
+
+        g_allJobThreadHandles[ i ] = threadHandle;
+    }
+
+    // setup main thread job info
+    zp_zero_memory_array( t_threadInfo.jobs );
+
+    g_allJobThreadInfos[ g_allJobThreadHandles.length ] = &t_threadInfo;
+
+    t_threadInfo.allocatedJobCount = 0;
+    t_threadInfo.localJobQueue = g_allJobQueues[ g_allJobThreadHandles.length ];
+    t_threadInfo.localBatchJobQueue = g_allBatchJobQueues[ g_allJobThreadHandles.length ];
+    t_threadInfo.isRunning = true;
+}
+
+void JobSystem::ExitJobThreads()
+{
+    // shutdown job worker threads
+    for( zp_size_t i = 0; i < g_allJobThreadInfos.length; ++i )
+    {
+        g_allJobThreadInfos[ i ]->isRunning = false;
+    }
+
+    // wait for all threads to finish
+    Platform::JoinThreads( g_allJobThreadHandles.ptr, g_allJobThreadHandles.length );
+
+    // close threads
+    for( zp_size_t i = 0; i < g_allJobThreadHandles.length; ++i )
+    {
+        Platform::CloseThread( g_allJobThreadHandles[ i ] );
+        g_allJobThreadHandles[ i ] = {};
+    }
+
+    // clear info pointers
+    zp_zero_memory_array( g_allJobThreadInfos.ptr, g_allJobThreadInfos.length );
+
+    // clear queues
+    for( zp_size_t i = 0; i < g_allQueues.length; ++i )
+    {
+        g_allQueues[ i ].clear();
+    }
+
+    // clear main thread job info
+    t_threadInfo.allocatedJobCount = 0;
+    t_threadInfo.localJobQueue = nullptr;
+    t_threadInfo.localBatchJobQueue = nullptr;
+    t_threadInfo.isRunning = false;
+}
+
+void JobSystem::ProcessJobs()
+{
+    Job* job = GetJob();
+    if( job )
+    {
+        ExecuteJob( job );
+    }
+}
+
+PrepariedJob JobSystem::Start()
+{
+    Job* job = AllocateJob();
+
+    JobHeader* header = job->header();
+    *header = {
+        .parent = nullptr,
+        .execFunc = nullptr,
+        .uncompletedJobs = 1,
+        .numDependencies = 0,
+        .jobDataSize = 0
+    };
+
+    return PrepariedJob( job );
+}
+
+PrepariedJob JobSystem::Start( JobHandle parentJob )
+{
+    if( parentJob.m_job )
+    {
+        Atomic::Increment( &parentJob.m_job->header()->uncompletedJobs );
+    }
+
+    Job* job = AllocateJob();
+
+    JobHeader* header = job->header();
+    *header = {
+        .parent = parentJob.m_job,
+        .execFunc = nullptr,
+        .uncompletedJobs = 1,
+        .numDependencies = 0,
+        .jobDataSize = 0
+    };
+
+    return PrepariedJob( job );
+}
+
+PrepariedJob JobSystem::Start( JobWorkFunc execFunc )
+{
+    Job* job = AllocateJob();
+
+    JobHeader* header = job->header();
+    *header = {
+        .parent = nullptr,
+        .execFunc = execFunc,
+        .uncompletedJobs = 1,
+        .numDependencies = 0,
+        .jobDataSize = 0
+    };
+
+    return PrepariedJob( job );
+}
+
+PrepariedJob JobSystem::Start( JobWorkFunc execFunc, JobHandle parentJob )
+{
+    if( parentJob.m_job )
+    {
+        Atomic::Increment( &parentJob.m_job->header()->uncompletedJobs );
+    }
+
+    Job* job = AllocateJob();
+
+    JobHeader* header = job->header();
+    *header = {
+        .parent = parentJob.m_job,
+        .execFunc = execFunc,
+        .uncompletedJobs = 1,
+        .numDependencies = 0,
+        .jobDataSize = 0
+    };
+
+    return PrepariedJob( job );
+}
+
+PrepariedJob JobSystem::Start( JobWorkFunc execFunc, void* data, zp_size_t size )
+{
+    Job* job = AllocateJob();
+
+    JobHeader* header = job->header();
+    *header = {
+        .parent = nullptr,
+        .execFunc = execFunc,
+        .uncompletedJobs = 1,
+        .numDependencies = 0,
+        .jobDataSize = size
+    };
+
+    if( data && size > 0 )
+    {
+        Memory mem = job->data();
+        zp_memcpy( mem.ptr, mem.size, data, size );
+    }
+
+    return PrepariedJob( job );
+}
+
+PrepariedJob JobSystem::Start( JobWorkFunc execFunc, void* data, zp_size_t size, JobHandle parentJob )
+{
+    if( parentJob.m_job )
+    {
+        Atomic::Increment( &parentJob.m_job->header()->uncompletedJobs );
+    }
+
+    Job* job = AllocateJob();
+
+    JobHeader* header = job->header();
+    *header = {
+        .parent = parentJob.m_job,
+        .execFunc = execFunc,
+        .uncompletedJobs = 1,
+        .numDependencies = 0,
+        .jobDataSize = size
+    };
+
+    if( data && size > 0 )
+    {
+        Memory mem = job->data();
+        zp_memcpy( mem.ptr, mem.size, data, size );
+    }
+
+    return PrepariedJob( job );
+}
+
+void JobSystem::ScheduleBatchJobs()
+{
+    //FlushBatchJobs();
     FlushBatchJobsLocally();
 }
 #endif
+
+#if ZP_USE_TESTS
+#include "Test/Test.h"
+
+using namespace zp;
+
+ZP_TEST_GROUP( Job )
+{
+    ZP_TEST_SUITE( JobQueue )
+    {
+        ZP_TEST( GrowPastInitialCapacity )
+        {
+            constexpr zp_size_t kCount = kJobQueueInitialCapacity * 40;
+
+            JobQueue queue;
+            queue.create( MemoryLabels::Default, kJobQueueInitialCapacity );
+
+            for( zp_size_t i = 0; i < kCount; ++i )
+            {
+                queue.pushBack( reinterpret_cast<Job*>( i + 1 ) );
+            }
+
+            ZP_CHECK_EQUALS( queue.size(), kCount );
+
+            zp_size_t mismatches = 0;
+            for( zp_size_t i = kCount; i > 0; --i )
+            {
+                Job* job = queue.popBack();
+                mismatches += job == reinterpret_cast<Job*>( i ) ? 0 : 1;
+            }
+
+            ZP_CHECK_EQUALS( mismatches, 0 );
+            ZP_CHECK_EQUALS( queue.empty(), true );
+            ZP_CHECK_EQUALS( queue.popBack(), nullptr );
+
+            queue.destroy();
+        }
+
+        namespace
+        {
+            // tests run at every startup, enough to grow the queue several times without taking long
+            constexpr zp_size_t kStressCount = 16 * 1024;
+            constexpr zp_size_t kStressOwnerBacklog = 4096;
+
+            struct StealStressContext
+            {
+                JobQueue* queue;
+                zp_int64_t* counts;
+                zp_int64_t done;
+            };
+
+            void CountJob( zp_int64_t* counts, Job* job )
+            {
+                Atomic::Increment( counts + ( reinterpret_cast<zp_size_t>( job ) - 1 ) );
+            }
+
+            zp_uint32_t StealStressThreadFunc( void* threadData )
+            {
+                StealStressContext* ctx = static_cast<StealStressContext*>( threadData );
+
+                for( ;; )
+                {
+                    Job* job = ctx->queue->stealPopFront();
+                    if( job != nullptr )
+                    {
+                        CountJob( ctx->counts, job );
+                    }
+                    else if( Atomic::LoadAcquire( &ctx->done ) && ctx->queue->empty() )
+                    {
+                        break;
+                    }
+                    else
+                    {
+                        Platform::YieldCurrentThread();
+                    }
+                }
+
+                return 0;
+            }
+        }
+
+        ZP_TEST( StealStress )
+        {
+            zp_int64_t* counts = ZP_MALLOC_T_ARRAY( MemoryLabels::Default, zp_int64_t, kStressCount );
+            zp_zero_memory_array( counts, kStressCount );
+
+            JobQueue queue;
+            queue.create( MemoryLabels::Default, kJobQueueInitialCapacity );
+
+            StealStressContext ctx {
+                .queue = &queue,
+                .counts = counts,
+                .done = 0,
+            };
+
+            const zp_uint32_t thiefCount = zp_max( 1u, JobSystem::GetThreadCount() );
+            ThreadHandle* thieves = ZP_MALLOC_T_ARRAY( MemoryLabels::Default, ThreadHandle, thiefCount );
+
+            for( zp_uint32_t i = 0; i < thiefCount; ++i )
+            {
+                zp_uint32_t threadId;
+                thieves[ i ] = Platform::CreateThread( StealStressThreadFunc, &ctx, 64 KB, &threadId );
+            }
+
+            // owner pushes everything and pops its own work whenever it falls behind the thieves
+            for( zp_size_t i = 0; i < kStressCount; ++i )
+            {
+                queue.pushBack( reinterpret_cast<Job*>( i + 1 ) );
+
+                while( queue.size() > kStressOwnerBacklog )
+                {
+                    Job* job = queue.popBack();
+                    if( job != nullptr )
+                    {
+                        CountJob( counts, job );
+                    }
+                }
+            }
+
+            for( Job* job = queue.popBack(); job != nullptr; job = queue.popBack() )
+            {
+                CountJob( counts, job );
+            }
+
+            Atomic::StoreRelease( &ctx.done, 1 );
+
+            Platform::JoinThreads( thieves, thiefCount );
+            for( zp_uint32_t i = 0; i < thiefCount; ++i )
+            {
+                Platform::CloseThread( thieves[ i ] );
+            }
+
+            zp_size_t mismatches = 0;
+            for( zp_size_t i = 0; i < kStressCount; ++i )
+            {
+                mismatches += counts[ i ] == 1 ? 0 : 1;
+            }
+
+            ZP_CHECK_EQUALS( mismatches, 0 );
+
+            queue.destroy();
+
+            ZP_FREE( MemoryLabels::Default, thieves );
+            ZP_FREE( MemoryLabels::Default, counts );
+        }
+    }
+
+    ZP_TEST_SUITE( JobPool )
+    {
+        ZP_TEST( GrowPastBlock )
+        {
+            constexpr zp_size_t kCount = kJobsPerBlock * 4 + 1;
+
+            FixedArray<JobHandle, kCount> handles;
+            for( zp_size_t i = 0; i < kCount; ++i )
+            {
+                handles[ i ] = MakeJobHandle( AllocateJob() );
+            }
+
+            zp_size_t incomplete = 0;
+            for( zp_size_t i = 0; i < kCount; ++i )
+            {
+                incomplete += IsJobComplete( handles[ i ] ) ? 0 : 1;
+            }
+
+            ZP_CHECK_EQUALS( incomplete, kCount );
+
+            for( zp_size_t i = 0; i < kCount; ++i )
+            {
+                FinishJob( handles[ i ].job );
+            }
+
+            zp_size_t complete = 0;
+            for( zp_size_t i = 0; i < kCount; ++i )
+            {
+                complete += IsJobComplete( handles[ i ] ) ? 1 : 0;
+            }
+
+            ZP_CHECK_EQUALS( complete, kCount );
+        }
+
+        ZP_TEST( StaleHandleAfterRecycle )
+        {
+            const JobHandle staleHandle = MakeJobHandle( AllocateJob() );
+            FinishJob( staleHandle.job );
+
+            // local frees are reused first
+            const JobHandle handle = MakeJobHandle( AllocateJob() );
+
+            ZP_CHECK_EQUALS( handle.job, staleHandle.job );
+            ZP_CHECK_NOT_EQUALS( handle.generation, staleHandle.generation );
+            ZP_CHECK_EQUALS( JobSystem::IsComplete( staleHandle ), true );
+            ZP_CHECK_EQUALS( JobSystem::IsComplete( handle ), false );
+
+            FinishJob( handle.job );
+
+            ZP_CHECK_EQUALS( JobSystem::IsComplete( handle ), true );
+        }
+
+        ZP_TEST( FrameJobsCountUntilFinished )
+        {
+            const zp_uint32_t* frameJobs = &g_context.outstandingFrameJobs[ g_context.frameIndex % kJobFrameCount ];
+            const zp_uint32_t startFrameJobs = *frameJobs;
+
+            Job* job = AllocateJob( JobPriority::Normal );
+            Job* backgroundJob = AllocateJob( JobPriority::Background );
+
+            // background jobs are never waited on
+            ZP_CHECK_EQUALS( job->frameIndex, g_context.frameIndex );
+            ZP_CHECK_EQUALS( *frameJobs, startFrameJobs + 1 );
+
+            FinishJob( backgroundJob );
+            FinishJob( job );
+
+            ZP_CHECK_EQUALS( *frameJobs, startFrameJobs );
+        }
+    }
+
+    ZP_TEST_SUITE( JobSystem )
+    {
+        namespace
+        {
+            constexpr zp_size_t kDispatchCount = 16 * 1024;
+
+            zp_int64_t* s_dispatchCounts;
+
+            void DispatchCountJob( const JobWorkArgs& args )
+            {
+                Atomic::Increment( s_dispatchCounts + args.index );
+            }
+        }
+
+        namespace
+        {
+            zp_int32_t s_diamondInputsDone;
+            zp_int32_t s_diamondInputsSeen;
+
+            void DiamondInputJob( const JobWorkArgs& args )
+            {
+                Atomic::Increment( &s_diamondInputsDone );
+            }
+
+            void DiamondOutputJob( const JobWorkArgs& args )
+            {
+                s_diamondInputsSeen = Atomic::Add( &s_diamondInputsDone, 0 );
+            }
+        }
+
+        ZP_TEST( PrepareDiamond )
+        {
+            s_diamondInputsDone = 0;
+            s_diamondInputsSeen = -1;
+
+            const JobHandle root = JobSystem::PrepareEmpty();
+
+            const JobHandle inputs[] {
+                JobSystem::Prepare( JobWorkFunc::from_function( DiamondInputJob ), root ),
+                JobSystem::Prepare( JobWorkFunc::from_function( DiamondInputJob ), root ),
+                JobSystem::Prepare( JobWorkFunc::from_function( DiamondInputJob ), root ),
+            };
+
+            const JobHandle output = JobSystem::Prepare( JobWorkFunc::from_function( DiamondOutputJob ), inputs, ZP_ARRAY_SIZE( inputs ) );
+
+            ZP_CHECK_EQUALS( JobSystem::IsComplete( output ), false );
+
+            JobSystem::ScheduleBatchJobs();
+            JobSystem::Complete( output );
+
+            ZP_CHECK_EQUALS( s_diamondInputsSeen, 3 );
+        }
+
+        ZP_TEST( PrepareCompletedDependencies )
+        {
+            s_diamondInputsDone = 0;
+            s_diamondInputsSeen = -1;
+
+            const JobHandle inputs[] {
+                JobSystem::Execute( JobWorkFunc::from_function( DiamondInputJob ) ),
+                JobSystem::Execute( JobWorkFunc::from_function( DiamondInputJob ) ),
+            };
+
+            JobSystem::Complete( inputs[ 0 ] );
+            JobSystem::Complete( inputs[ 1 ] );
+
+            const JobHandle output = JobSystem::Prepare( JobWorkFunc::from_function( DiamondOutputJob ), inputs, ZP_ARRAY_SIZE( inputs ) );
+
+            JobSystem::ScheduleBatchJobs();
+            JobSystem::Complete( output );
+
+            ZP_CHECK_EQUALS( s_diamondInputsSeen, 2 );
+        }
+
+        ZP_TEST( DispatchExactlyOnce )
+        {
+            s_dispatchCounts = ZP_MALLOC_T_ARRAY( MemoryLabels::Default, zp_int64_t, kDispatchCount );
+            zp_zero_memory_array( s_dispatchCounts, kDispatchCount );
+
+            // ~1k jobs in flight at once, well past a single job block
+            JobHandle handle = JobSystem::Dispatch( kDispatchCount, 16, JobWorkFunc::from_function( DispatchCountJob ) );
+            JobSystem::Complete( handle );
+
+            zp_size_t mismatches = 0;
+            for( zp_size_t i = 0; i < kDispatchCount; ++i )
+            {
+                mismatches += s_dispatchCounts[ i ] == 1 ? 0 : 1;
+            }
+
+            ZP_CHECK_EQUALS( mismatches, 0 );
+
+            ZP_FREE( MemoryLabels::Default, s_dispatchCounts );
+            s_dispatchCounts = nullptr;
+        }
+    }
+
+    ZP_TEST_SUITE( JobPriority )
+    {
+        namespace
+        {
+            zp_int32_t s_criticalJobRan;
+            zp_int32_t s_backgroundJobResult;
+
+            void CriticalJob( const JobWorkArgs& args )
+            {
+                Atomic::Exchange( &s_criticalJobRan, 1 );
+            }
+
+            void BackgroundJob( const JobWorkArgs& args )
+            {
+                const JobHandle critical = JobSystem::Execute( JobWorkFunc::from_function( CriticalJob ), JobPriority::FrameCritical );
+
+                // cooperative yield, either this thread runs the critical job or another worker does
+                while( !JobSystem::IsComplete( critical ) )
+                {
+                    JobSystem::YieldToHigherPriority();
+                }
+
+                s_backgroundJobResult = Atomic::Add( &s_criticalJobRan, 0 ) == 1 ? 1 : 0;
+            }
+
+            constexpr zp_int32_t kBackgroundChildCount = 8;
+
+            zp_int32_t s_backgroundChildrenDone;
+
+            void BackgroundChildJob( const JobWorkArgs& args )
+            {
+                Atomic::Increment( &s_backgroundChildrenDone );
+            }
+
+            void BackgroundParentJob( const JobWorkArgs& args )
+            {
+                JobHandle children[kBackgroundChildCount];
+                for( JobHandle& child : children )
+                {
+                    child = JobSystem::Execute( JobWorkFunc::from_function( BackgroundChildJob ), JobPriority::Background );
+                }
+
+                // this job holds the only lane, the children can only run nested on this thread
+                for( const JobHandle& child : children )
+                {
+                    JobSystem::Complete( child );
+                }
+
+                s_backgroundJobResult = Atomic::Add( &s_backgroundChildrenDone, 0 );
+            }
+        }
+
+        ZP_TEST( ShouldYieldOutsideJob )
+        {
+            ZP_CHECK_EQUALS( JobSystem::ShouldYield(), false );
+        }
+
+        ZP_TEST( BackgroundYieldsToCritical )
+        {
+            s_criticalJobRan = 0;
+            s_backgroundJobResult = 0;
+
+            const JobHandle handle = JobSystem::Execute( JobWorkFunc::from_function( BackgroundJob ), JobPriority::Background );
+            JobSystem::Complete( handle );
+
+            ZP_CHECK_EQUALS( s_backgroundJobResult, 1 );
+        }
+
+        ZP_TEST( BackgroundWaitsOnBackground )
+        {
+            s_backgroundChildrenDone = 0;
+            s_backgroundJobResult = 0;
+
+            // the single lane a threadCount of 1 gets, restarting the workers with 1 thread is not possible mid run
+            const zp_uint32_t maxBackgroundJobCount = g_context.maxBackgroundJobCount;
+            g_context.maxBackgroundJobCount = 1;
+
+            const JobHandle handle = JobSystem::Execute( JobWorkFunc::from_function( BackgroundParentJob ), JobPriority::Background );
+            JobSystem::Complete( handle );
+
+            g_context.maxBackgroundJobCount = maxBackgroundJobCount;
+
+            ZP_CHECK_EQUALS( s_backgroundJobResult, kBackgroundChildCount );
+        }
+    }
+
+    ZP_TEST_SUITE( JobScratch )
+    {
+        namespace
+        {
+            zp_int32_t s_scratchResult;
+
+            zp_bool_t FillAndCheck( Memory memory, zp_uint8_t value )
+            {
+                if( memory.ptr() == nullptr )
+                {
+                    return false;
+                }
+
+                zp_uint8_t* bytes = memory.as<zp_uint8_t>();
+                for( zp_size_t i = 0; i < memory.size(); ++i )
+                {
+                    bytes[ i ] = value;
+                }
+
+                return bytes[ 0 ] == value && bytes[ memory.size() - 1 ] == value;
+            }
+
+            void ScratchJob( const JobWorkArgs& args )
+            {
+                const Memory small = JobSystem::AllocateScratchMemory( 100, 64 );
+                const Memory large = JobSystem::AllocateScratchMemory( kJobScratchMemorySize * 2 );
+
+                zp_int32_t result = 0;
+                result += FillAndCheck( small, 0xAB ) ? 1 : 0;
+                result += ( reinterpret_cast<zp_ptr_t>( small.ptr() ) & 63 ) == 0 ? 1 : 0;
+                result += FillAndCheck( large, 0xCD ) ? 1 : 0;
+                result += small.as<zp_uint8_t>()[ 99 ] == 0xAB ? 1 : 0;
+
+                s_scratchResult = result;
+            }
+        }
+
+        ZP_TEST( AllocateInsideJob )
+        {
+            s_scratchResult = 0;
+
+            JobSystem::Complete( JobSystem::Execute( JobWorkFunc::from_function( ScratchJob ) ) );
+
+            ZP_CHECK_EQUALS( s_scratchResult, 4 );
+        }
+    }
+
+    ZP_TEST_SUITE( JobTelemetry )
+    {
+        namespace
+        {
+            void EmptyJob( const JobWorkArgs& args )
+            {
+            }
+        }
+
+        ZP_TEST( SnapshotCountsExecutedJobs )
+        {
+            constexpr zp_size_t kJobCount = 64;
+
+            // drop whatever ran before this test
+            JobSystem::SnapshotWorkerStats();
+
+            JobHandle handles[kJobCount];
+            for( JobHandle& handle : handles )
+            {
+                handle = JobSystem::Execute( JobWorkFunc::from_function( EmptyJob ) );
+            }
+
+            for( const JobHandle& handle : handles )
+            {
+                JobSystem::Complete( handle );
+            }
+
+            JobSystem::SnapshotWorkerStats();
+
+            JobWorkerStats stats[64];
+            const zp_size_t statsCount = JobSystem::GetWorkerStats( stats, ZP_ARRAY_SIZE( stats ) );
+
+            ZP_CHECK_EQUALS( statsCount, zp_min( static_cast<zp_size_t>( JobSystem::GetJobQueueCount() ), ZP_ARRAY_SIZE( stats ) ) );
+
+            zp_uint64_t executedJobs = 0;
+            for( zp_size_t i = 0; i < statsCount; ++i )
+            {
+                executedJobs += stats[ i ].executedJobs;
+            }
+
+            ZP_CHECK_EQUALS( executedJobs, kJobCount );
+        }
+    }
+
+    ZP_TEST_SUITE( JobTopology )
+    {
+        namespace
+        {
+            // 4 cores with 2 hardware threads each, enumerated core by core like the platform layer does
+            void MakeSmtProcessors( ProcessorInfo ( &processors )[8] )
+            {
+                for( zp_uint32_t i = 0; i < 8; ++i )
+                {
+                    processors[ i ] = {
+                        .number = static_cast<zp_uint8_t>( i ),
+                        .smtIndex = static_cast<zp_uint8_t>( i % 2 ),
+                        .coreIndex = i / 2,
+                    };
+                }
+            }
+        }
+
+        ZP_TEST( PlacementOnePerCoreFirst )
+        {
+            ProcessorInfo processors[8];
+            MakeSmtProcessors( processors );
+
+            ProcessorInfo placements[6];
+            BuildJobThreadPlacement( processors, 8, 1, placements, 6 );
+
+            // only the first hardware thread of each core is used, wrapping once all cores are taken
+            const zp_uint32_t expectedCores[] { 0, 1, 2, 3, 0, 1 };
+            for( zp_uint32_t i = 0; i < 6; ++i )
+            {
+                ZP_CHECK_EQUALS( placements[ i ].coreIndex, expectedCores[ i ] );
+                ZP_CHECK_EQUALS( placements[ i ].smtIndex, 0 );
+            }
+        }
+
+        ZP_TEST( PlacementUsesSiblingsLast )
+        {
+            ProcessorInfo processors[8];
+            MakeSmtProcessors( processors );
+
+            ProcessorInfo placements[6];
+            BuildJobThreadPlacement( processors, 8, 2, placements, 6 );
+
+            const zp_uint32_t expectedCores[] { 0, 1, 2, 3, 0, 1 };
+            const zp_uint32_t expectedSmt[] { 0, 0, 0, 0, 1, 1 };
+            for( zp_uint32_t i = 0; i < 6; ++i )
+            {
+                ZP_CHECK_EQUALS( placements[ i ].coreIndex, expectedCores[ i ] );
+                ZP_CHECK_EQUALS( placements[ i ].smtIndex, expectedSmt[ i ] );
+            }
+        }
+
+        ZP_TEST( StealOrderNearestFirst )
+        {
+            // two sockets, the first with two last level caches
+            const ProcessorInfo queueProcessors[] {
+                { .cacheIndex = 0, .numaNode = 0 },
+                { .cacheIndex = 2, .numaNode = 1 },
+                { .cacheIndex = 1, .numaNode = 0 },
+                { .cacheIndex = 0, .numaNode = 0 },
+                { .cacheIndex = 2, .numaNode = 1 },
+            };
+
+            zp_uint32_t stealOrder[4];
+            zp_uint32_t stealTierEnds[kJobStealTierCount];
+            BuildJobStealOrder( queueProcessors, 5, 0, stealOrder, stealTierEnds );
+
+            ZP_CHECK_EQUALS( stealTierEnds[ 0 ], 1 );
+            ZP_CHECK_EQUALS( stealTierEnds[ 1 ], 2 );
+            ZP_CHECK_EQUALS( stealTierEnds[ 2 ], 4 );
+
+            ZP_CHECK_EQUALS( stealOrder[ 0 ], 3 );
+            ZP_CHECK_EQUALS( stealOrder[ 1 ], 2 );
+            ZP_CHECK_EQUALS( stealOrder[ 2 ], 1 );
+            ZP_CHECK_EQUALS( stealOrder[ 3 ], 4 );
+        }
+    }
+
+    ZP_TEST_SUITE( ParallelFor )
+    {
+        namespace
+        {
+            constexpr zp_size_t kParallelForCount = 16 * 1024;
+
+            zp_int64_t* s_parallelForCounts;
+
+            void ParallelForCountJob( const JobWorkArgs& args )
+            {
+                Atomic::Increment( s_parallelForCounts + args.index );
+            }
+
+            zp_bool_t RunParallelForExactlyOnce( zp_size_t length, zp_size_t grain )
+            {
+                s_parallelForCounts = ZP_MALLOC_T_ARRAY( MemoryLabels::Default, zp_int64_t, length );
+                zp_zero_memory_array( s_parallelForCounts, length );
+
+                JobHandle handle = JobSystem::ParallelFor( length, grain, JobWorkFunc::from_function( ParallelForCountJob ) );
+                JobSystem::Complete( handle );
+
+                zp_size_t mismatches = 0;
+                for( zp_size_t i = 0; i < length; ++i )
+                {
+                    mismatches += s_parallelForCounts[ i ] == 1 ? 0 : 1;
+                }
+
+                ZP_FREE( MemoryLabels::Default, s_parallelForCounts );
+                s_parallelForCounts = nullptr;
+
+                return mismatches == 0;
+            }
+        }
+
+        ZP_TEST( ExactlyOnce )
+        {
+            ZP_CHECK_EQUALS( RunParallelForExactlyOnce( kParallelForCount, 64 ), true );
+        }
+
+        ZP_TEST( GrainLargerThanRange )
+        {
+            ZP_CHECK_EQUALS( RunParallelForExactlyOnce( 10, 1000 ), true );
+        }
+
+        ZP_TEST( GrainOfOne )
+        {
+            ZP_CHECK_EQUALS( RunParallelForExactlyOnce( 4097, 1 ), true );
+        }
+
+#if ZP_PLATFORM_ARCH64
+        namespace
+        {
+            constexpr zp_size_t kWideIndexStart = ( static_cast<zp_size_t>( 1 ) << 32 ) - 2;
+
+            zp_size_t s_wideIndexSum;
+
+            void WideIndexJob( const JobWorkArgs& args )
+            {
+                s_wideIndexSum += args.index - kWideIndexStart;
+            }
+        }
+
+        ZP_TEST( IndicesPastUint32 )
+        {
+            s_wideIndexSum = 0;
+
+            // ranges are never narrowed, a range crossing 4G runs every index once
+            Job* job = AllocateJob();
+            job->callback = JobWorkFunc::from_function( WideIndexJob );
+            job->jobStart = kWideIndexStart;
+            job->jobEnd = kWideIndexStart + 4;
+
+            ExecuteJob( job );
+
+            ZP_CHECK_EQUALS( s_wideIndexSum, 0 + 1 + 2 + 3 );
+        }
+#endif // ZP_PLATFORM_ARCH64
+    }
+
+#if ZP_USE_BENCHMARKS
+    ZP_TEST_SUITE( JobSystemBenchmark )
+    {
+        namespace
+        {
+            constexpr zp_size_t kChainLength = 10000;
+            constexpr zp_size_t kWakeSampleCount = 100;
+
+            zp_time_t s_spinTicks;
+            zp_time_t s_wakeStartTime;
+
+            void SpinJob( const JobWorkArgs& args )
+            {
+                const zp_time_t end = Platform::TimeNow() + s_spinTicks;
+                while( Platform::TimeNow() < end )
+                {
+                }
+            }
+
+            void WakeLatencyJob( const JobWorkArgs& args )
+            {
+                s_wakeStartTime = Platform::TimeNow();
+            }
+
+            zp_float64_t TicksToMicroseconds( zp_time_t ticks )
+            {
+                return static_cast<zp_float64_t>( ticks ) * 1000000.0 / static_cast<zp_float64_t>( Platform::TimeFrequency() );
+            }
+        }
+
+        ZP_TEST( DependentChainThroughput )
+        {
+            s_spinTicks = zp_max( Platform::TimeFrequency() / 1000000, static_cast<zp_time_t>( 1 ) );
+
+            const JobHandle root = JobSystem::PrepareEmpty();
+
+            JobHandle last = root;
+            for( zp_size_t i = 0; i < kChainLength; ++i )
+            {
+                last = JobSystem::Prepare( JobWorkFunc::from_function( SpinJob ), last );
+            }
+
+            const zp_time_t start = Platform::TimeNow();
+
+            JobSystem::ScheduleBatchJobs();
+            JobSystem::Complete( last );
+
+            const zp_float64_t elapsedUS = TicksToMicroseconds( Platform::TimeNow() - start );
+            const zp_float64_t workUS = TicksToMicroseconds( s_spinTicks * kChainLength );
+
+            zp_printfln( "[BENCH] job chain %zu x 1us: %.3f ms, %.0f jobs/s, %.3f us overhead per dependency",
+                kChainLength, elapsedUS / 1000.0, kChainLength * 1000000.0 / elapsedUS, ( elapsedUS - workUS ) / kChainLength );
+
+            ZP_CHECK_EQUALS( JobSystem::IsComplete( last ), true );
+        }
+
+        ZP_TEST( ParkedWakeLatency )
+        {
+            if( JobSystem::GetThreadCount() == 0 )
+            {
+                return;
+            }
+
+            zp_float64_t totalUS = 0;
+            zp_float64_t maxUS = 0;
+
+            for( zp_size_t i = 0; i < kWakeSampleCount; ++i )
+            {
+                // long enough for every worker to finish spinning and park
+                Platform::SleepCurrentThread( 2 );
+
+                const zp_time_t submitTime = Platform::TimeNow();
+                const JobHandle handle = JobSystem::Execute( JobWorkFunc::from_function( WakeLatencyJob ) );
+
+                // don't help, the point is to measure how long a parked worker takes to pick it up
+                while( !JobSystem::IsComplete( handle ) )
+                {
+                    Platform::YieldCurrentThread();
+                }
+
+                const zp_float64_t latencyUS = TicksToMicroseconds( s_wakeStartTime - submitTime );
+                totalUS += latencyUS;
+                maxUS = zp_max( maxUS, latencyUS );
+            }
+
+            zp_printfln( "[BENCH] parked worker wake latency: avg %.3f us, max %.3f us", totalUS / kWakeSampleCount, maxUS );
+
+            ZP_CHECK_NOT_EQUALS( totalUS, 0.0 );
+        }
+    }
+#endif // ZP_USE_BENCHMARKS
+}
+#endif
@@ -0,0 +1,377 @@
+//
+// Created by phosg on 10/16/2026.
+//
+
+#include "Core/Parallel.h"
+#include "Core/Job.h"
+
+namespace zp
+{
+    zp_size_t Parallel::GetBlockCount( zp_size_t length, zp_size_t minBlockLength )
+    {
+        // no workers to hand blocks to, splitting would only add overhead
+        if( JobSystem::GetThreadCount() == 0 )
+        {
+            return 1;
+        }
+
+        const zp_size_t maxBlockCount = zp_min( static_cast<zp_size_t>( JobSystem::GetJobQueueCount() ) * kBlocksPerJobQueue, kMaxBlockCount );
+        const zp_size_t blockCount = zp_min( length / zp_max( minBlockLength, static_cast<zp_size_t>( 1 ) ), maxBlockCount );
+
+        return zp_max( blockCount, static_cast<zp_size_t>( 1 ) );
+    }
+}
+
+#if ZP_USE_TESTS
+#include "Test/Test.h"
+#include "Platform/Platform.h"
+
+using namespace zp;
+
+ZP_TEST_GROUP( Parallel )
+{
+    namespace
+    {
+        // up to 16 blocks of kMinBlockLength, the serial count stays under it. Tests run at every startup, the
+        // large sizes are in ParallelBenchmark
+        constexpr zp_size_t kParallelCount = 64 * 1024;
+        constexpr zp_size_t kSerialCount = 1000;
+
+        zp_uint64_t NextRandom( zp_uint64_t& rng )
+        {
+            rng ^= rng << 13;
+            rng ^= rng >> 7;
+            rng ^= rng << 17;
+            return rng;
+        }
+
+        void FillRandom( zp_uint32_t* values, zp_size_t count, zp_uint32_t modulo )
+        {
+            zp_uint64_t rng = 0x9E3779B97F4A7C15ull;
+            for( zp_size_t i = 0; i < count; ++i )
+            {
+                values[ i ] = static_cast<zp_uint32_t>( NextRandom( rng ) % modulo );
+            }
+        }
+
+        zp_uint64_t Add( zp_uint64_t lh, zp_uint64_t rh )
+        {
+            return lh + rh;
+        }
+
+        zp_bool_t IsOdd( const zp_uint32_t& value )
+        {
+            return ( value & 1 ) != 0;
+        }
+
+        zp_bool_t RunSortMatchesSerial( zp_size_t count, zp_uint32_t modulo )
+        {
+            zp_uint32_t* values = ZP_MALLOC_T_ARRAY( MemoryLabels::Default, zp_uint32_t, count );
+            zp_uint32_t* expected = ZP_MALLOC_T_ARRAY( MemoryLabels::Default, zp_uint32_t, count );
+
+            FillRandom( values, count, modulo );
+            FillRandom( expected, count, modulo );
+
+            Parallel::Sort( MemoryArray<zp_uint32_t>( values, count ), zp_cmp<zp_uint32_t>, MemoryLabels::Temp );
+            zp_sort( expected, expected + count, zp_cmp<zp_uint32_t> );
+
+            const zp_bool_t matches = zp_memcmp( values, sizeof( zp_uint32_t ) * count, expected, sizeof( zp_uint32_t ) * count ) == 0;
+
+            ZP_FREE( MemoryLabels::Default, expected );
+            ZP_FREE( MemoryLabels::Default, values );
+
+            return matches;
+        }
+
+        template<zp_bool_t Inclusive>
+        zp_bool_t RunScanMatchesSerial( zp_size_t count, zp_bool_t inPlace )
+        {
+            zp_uint64_t* input = ZP_MALLOC_T_ARRAY( MemoryLabels::Default, zp_uint64_t, count );
+            zp_uint64_t* output = inPlace ? input : ZP_MALLOC_T_ARRAY( MemoryLabels::Default, zp_uint64_t, count );
+            zp_uint64_t* expected = ZP_MALLOC_T_ARRAY( MemoryLabels::Default, zp_uint64_t, count );
+
+            zp_uint64_t rng = 0xD1B54A32D192ED03ull;
+            zp_uint64_t running = 0;
+            for( zp_size_t i = 0; i < count; ++i )
+            {
+                input[ i ] = NextRandom( rng ) % 1000;
+
+                if constexpr( Inclusive )
+                {
+                    running += input[ i ];
+                    expected[ i ] = running;
+                }
+                else
+                {
+                    expected[ i ] = running;
+                    running += input[ i ];
+                }
+            }
+
+            if constexpr( Inclusive )
+            {
+                Parallel::InclusiveScan( ReadonlyMemoryArray<zp_uint64_t>( input, count ), MemoryArray<zp_uint64_t>( output, count ), static_cast<zp_uint64_t>( 0 ), Add );
+            }
+            else
+            {
+                Parallel::ExclusiveScan( ReadonlyMemoryArray<zp_uint64_t>( input, count ), MemoryArray<zp_uint64_t>( output, count ), static_cast<zp_uint64_t>( 0 ), Add );
+            }
+
+            const zp_bool_t matches = zp_memcmp( output, sizeof( zp_uint64_t ) * count, expected, sizeof( zp_uint64_t ) * count ) == 0;
+
+            ZP_FREE( MemoryLabels::Default, expected );
+            if( !inPlace )
+            {
+                ZP_FREE( MemoryLabels::Default, output );
+            }
+            ZP_FREE( MemoryLabels::Default, input );
+
+            return matches;
+        }
+    }
+
+    ZP_TEST_SUITE( Parallel )
+    {
+        ZP_TEST( Sort )
+        {
+            ZP_CHECK_EQUALS( RunSortMatchesSerial( kParallelCount, 0xFFFFFFFF ), true );
+            ZP_CHECK_EQUALS( RunSortMatchesSerial( kParallelCount, 16 ), true );
+            ZP_CHECK_EQUALS( RunSortMatchesSerial( kParallelCount + 13, 1000 ), true );
+            ZP_CHECK_EQUALS( RunSortMatchesSerial( kSerialCount, 0xFFFFFFFF ), true );
+        }
+
+        ZP_TEST( SortVector )
+        {
+            Vector<zp_uint32_t> values( kParallelCount, MemoryLabels::Default );
+            values.resize_unsafe( kParallelCount );
+
+            for( zp_size_t i = 0; i < kParallelCount; ++i )
+            {
+                values[ i ] = static_cast<zp_uint32_t>( i );
+            }
+
+            Parallel::Sort( values, zp_cmp_dsc<zp_uint32_t>, MemoryLabels::Temp );
+
+            zp_size_t ordered = 0;
+            for( zp_size_t i = 0; i < kParallelCount; ++i )
+            {
+                ordered += values[ i ] == kParallelCount - 1 - i ? 1 : 0;
+            }
+
+            ZP_CHECK_EQUALS( ordered, kParallelCount );
+        }
+
+        ZP_TEST( Reduce )
+        {
+            zp_uint32_t* values = ZP_MALLOC_T_ARRAY( MemoryLabels::Default, zp_uint32_t, kParallelCount );
+            FillRandom( values, kParallelCount, 0xFFFFFFFF );
+
+            zp_uint64_t expectedSum = 0;
+            zp_uint32_t expectedMax = 0;
+            for( zp_size_t i = 0; i < kParallelCount; ++i )
+            {
+                expectedSum += values[ i ];
+                expectedMax = zp_max( expectedMax, values[ i ] );
+            }
+
+            const ReadonlyMemoryArray<zp_uint32_t> view( values, kParallelCount );
+
+            const zp_uint32_t max = Parallel::Reduce( view, 0u, []( zp_uint32_t lh, zp_uint32_t rh )
+            {
+                return zp_max( lh, rh );
+            } );
+
+            // wraps, but the same way the serial sum does
+            const zp_uint32_t sum = Parallel::Reduce( view, 0u, []( zp_uint32_t lh, zp_uint32_t rh )
+            {
+                return lh + rh;
+            } );
+
+            ZP_CHECK_EQUALS( max, expectedMax );
+            ZP_CHECK_EQUALS( sum, static_cast<zp_uint32_t>( expectedSum ) );
+
+            const zp_uint32_t smallMax = Parallel::Reduce( ReadonlyMemoryArray<zp_uint32_t>( values, kSerialCount ), 0u, []( zp_uint32_t lh, zp_uint32_t rh )
+            {
+                return zp_max( lh, rh );
+            } );
+
+            zp_uint32_t expectedSmallMax = 0;
+            for( zp_size_t i = 0; i < kSerialCount; ++i )
+            {
+                expectedSmallMax = zp_max( expectedSmallMax, values[ i ] );
+            }
+
+            ZP_CHECK_EQUALS( smallMax, expectedSmallMax );
+
+            ZP_FREE( MemoryLabels::Default, values );
+        }
+
+        ZP_TEST( ReduceKeepsOrder )
+        {
+            constexpr zp_size_t kCount = 100000;
+
+            // 2x2 matrix products don't commute, blocks have to be combined in order
+            struct Mat2
+            {
+                zp_uint32_t m00, m01, m10, m11;
+            };
+
+            Mat2* values = ZP_MALLOC_T_ARRAY( MemoryLabels::Default, Mat2, kCount );
+
+            zp_uint64_t rng = 0xA0761D6478BD642Full;
+            for( zp_size_t i = 0; i < kCount; ++i )
+            {
+                values[ i ] = { static_cast<zp_uint32_t>( NextRandom( rng ) ), 1, 1, 0 };
+            }
+
+            auto multiply = []( const Mat2& lh, const Mat2& rh )
+            {
+                return Mat2 {
+                    lh.m00 * rh.m00 + lh.m01 * rh.m10,
+                    lh.m00 * rh.m01 + lh.m01 * rh.m11,
+                    lh.m10 * rh.m00 + lh.m11 * rh.m10,
+                    lh.m10 * rh.m01 + lh.m11 * rh.m11,
+                };
+            };
+
+            const Mat2 identity { 1, 0, 0, 1 };
+
+            Mat2 expected = identity;
+            for( zp_size_t i = 0; i < kCount; ++i )
+            {
+                expected = multiply( expected, values[ i ] );
+            }
+
+            const Mat2 result = Parallel::Reduce( ReadonlyMemoryArray<Mat2>( values, kCount ), identity, multiply );
+
+            ZP_CHECK_EQUALS( zp_memcmp( &result, sizeof( Mat2 ), &expected, sizeof( Mat2 ) ), 0 );
+
+            ZP_FREE( MemoryLabels::Default, values );
+        }
+
+        ZP_TEST( InclusiveScan )
+        {
+            ZP_CHECK_EQUALS( RunScanMatchesSerial<true>( kParallelCount, false ), true );
+            ZP_CHECK_EQUALS( RunScanMatchesSerial<true>( kParallelCount, true ), true );
+            ZP_CHECK_EQUALS( RunScanMatchesSerial<true>( kSerialCount, false ), true );
+        }
+
+        ZP_TEST( ExclusiveScan )
+        {
+            ZP_CHECK_EQUALS( RunScanMatchesSerial<false>( kParallelCount, false ), true );
+            ZP_CHECK_EQUALS( RunScanMatchesSerial<false>( kParallelCount, true ), true );
+            ZP_CHECK_EQUALS( RunScanMatchesSerial<false>( kSerialCount, true ), true );
+        }
+
+        ZP_TEST( Compact )
+        {
+            Vector<zp_uint32_t> input( kParallelCount, MemoryLabels::Default );
+            input.resize_unsafe( kParallelCount );
+            FillRandom( input.data(), kParallelCount, 0xFFFFFFFF );
+
+            Vector<zp_uint32_t> output( MemoryLabels::Default );
+            Parallel::Compact( input, output, IsOdd );
+
+            zp_size_t expectedCount = 0;
+            zp_size_t mismatches = 0;
+            for( zp_size_t i = 0; i < kParallelCount; ++i )
+            {
+                if( IsOdd( input[ i ] ) )
+                {
+                    mismatches += expectedCount < output.length() && output[ expectedCount ] == input[ i ] ? 0 : 1;
+                    ++expectedCount;
+                }
+            }
+
+            ZP_CHECK_EQUALS( output.length(), expectedCount );
+            ZP_CHECK_EQUALS( mismatches, 0 );
+
+            zp_uint32_t small[ kSerialCount ];
+            const zp_size_t smallCount = Parallel::Compact( ReadonlyMemoryArray<zp_uint32_t>( input.data(), kSerialCount ), MemoryArray<zp_uint32_t>( small, kSerialCount ), IsOdd );
+
+            zp_size_t expectedSmallCount = 0;
+            for( zp_size_t i = 0; i < kSerialCount; ++i )
+            {
+                expectedSmallCount += IsOdd( input[ i ] ) ? 1 : 0;
+            }
+
+            ZP_CHECK_EQUALS( smallCount, expectedSmallCount );
+        }
+    }
+
+#if ZP_USE_BENCHMARKS
+    ZP_TEST_SUITE( ParallelBenchmark )
+    {
+        namespace
+        {
+            constexpr zp_size_t kBenchmarkCount = 4000000;
+
+            zp_float64_t TicksToMilliseconds( zp_time_t ticks )
+            {
+                return static_cast<zp_float64_t>( ticks ) * 1000.0 / static_cast<zp_float64_t>( Platform::TimeFrequency() );
+            }
+        }
+
+        ZP_TEST( SerialVsParallel )
+        {
+            zp_uint32_t* values = ZP_MALLOC_T_ARRAY( MemoryLabels::Default, zp_uint32_t, kBenchmarkCount );
+            zp_uint64_t* sums = ZP_MALLOC_T_ARRAY( MemoryLabels::Default, zp_uint64_t, kBenchmarkCount );
+
+            const zp_size_t jobQueueCount = JobSystem::GetJobQueueCount();
+
+            // sort
+            {
+                FillRandom( values, kBenchmarkCount, 0xFFFFFFFF );
+
+                zp_time_t start = Platform::TimeNow();
+                zp_sort( values, values + kBenchmarkCount, zp_cmp<zp_uint32_t> );
+                const zp_float64_t serialMS = TicksToMilliseconds( Platform::TimeNow() - start );
+
+                FillRandom( values, kBenchmarkCount, 0xFFFFFFFF );
+
+                start = Platform::TimeNow();
+                Parallel::Sort( MemoryArray<zp_uint32_t>( values, kBenchmarkCount ), zp_cmp<zp_uint32_t>, MemoryLabels::Temp );
+                const zp_float64_t parallelMS = TicksToMilliseconds( Platform::TimeNow() - start );
+
+                zp_printfln( "[BENCH] parallel sort %zu uint32 on %zu job queues: serial %.3f ms, parallel %.3f ms, %.2fx",
+                    kBenchmarkCount, jobQueueCount, serialMS, parallelMS, serialMS / parallelMS );
+            }
+
+            // inclusive scan
+            {
+                for( zp_size_t i = 0; i < kBenchmarkCount; ++i )
+                {
+                    sums[ i ] = values[ i ];
+                }
+
+                zp_time_t start = Platform::TimeNow();
+                for( zp_size_t i = 1; i < kBenchmarkCount; ++i )
+                {
+                    sums[ i ] += sums[ i - 1 ];
+                }
+                const zp_float64_t serialMS = TicksToMilliseconds( Platform::TimeNow() - start );
+
+                const zp_uint64_t serialTotal = sums[ kBenchmarkCount - 1 ];
+
+                for( zp_size_t i = 0; i < kBenchmarkCount; ++i )
+                {
+                    sums[ i ] = values[ i ];
+                }
+
+                start = Platform::TimeNow();
+                Parallel::InclusiveScan( ReadonlyMemoryArray<zp_uint64_t>( sums, kBenchmarkCount ), MemoryArray<zp_uint64_t>( sums, kBenchmarkCount ), static_cast<zp_uint64_t>( 0 ), Add );
+                const zp_float64_t parallelMS = TicksToMilliseconds( Platform::TimeNow() - start );
+
+                ZP_CHECK_EQUALS( sums[ kBenchmarkCount - 1 ], serialTotal );
+
+                zp_printfln( "[BENCH] parallel inclusive scan %zu uint64 on %zu job queues: serial %.3f ms, parallel %.3f ms, %.2fx",
+                    kBenchmarkCount, jobQueueCount, serialMS, parallelMS, serialMS / parallelMS );
+            }
+
+            ZP_FREE( MemoryLabels::Default, sums );
+            ZP_FREE( MemoryLabels::Default, values );
+        }
+    }
+#endif // ZP_USE_BENCHMARKS
+}
+#endif
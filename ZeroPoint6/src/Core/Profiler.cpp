@@ -71,13 +71,23 @@ namespace zp
 
             zp_uint32_t threadId;
         };
+
+        struct CounterProfilerEvent
+        {
+            const char* counterName;
+            zp_uint64_t frameIndex;
+            zp_time_t time;
+            zp_int64_t value;
+            zp_uint32_t track;
+        };
     }
 
     namespace
     {
         enum
         {
-            kMaxEventStackCount = 32
+            kMaxEventStackCount = 32,
+            kMaxAdvanceFrameCallbacks = 8,
         };
 
         struct ProfilerThreadData
@@ -118,9 +128,17 @@ namespace zp
             MemoryArray<MemoryProfilerEvent> memProfilerData;
             MemoryArray<GPUProfilerEvent> gpuProfilerData;
 
+            // shared by all threads, counters are usually only sampled once per frame
+            MemoryArray<CounterProfilerEvent> counterProfilerData;
+            zp_size_t currentCounterProfilerEvent;
+
             zp_size_t profilerThreadDataCount;
             MemoryArray<ProfilerThreadData*> profilerThreadData;
 
+            zp_size_t advanceFrameCallbackCount;
+            Profiler::AdvanceFrameCallback advanceFrameCallbacks[kMaxAdvanceFrameCallbacks];
+            void* advanceFrameCallbackUserData[kMaxAdvanceFrameCallbacks];
+
             MemoryLabel memoryLabel;
         };
 
@@ -131,6 +149,11 @@ namespace zp
     {
         void AdvanceProfilerFrame( zp_uint64_t frameIndex )
         {
+            for( zp_size_t i = 0; i < g_context.advanceFrameCallbackCount; ++i )
+            {
+                g_context.advanceFrameCallbacks[ i ]( g_context.currentFrame, g_context.advanceFrameCallbackUserData[ i ] );
+            }
+
             g_context.currentFrame = frameIndex;
 
             for( zp_size_t i = 0; i < g_context.profilerThreadDataCount; ++i )
@@ -200,6 +223,7 @@ namespace zp
         const zp_size_t cpuEventCount = ( profilerCreateDesc.maxFramesToCapture * profilerCreateDesc.maxThreadCount * profilerCreateDesc.maxCPUEventsPerThread );
         const zp_size_t memEventCount = ( profilerCreateDesc.maxFramesToCapture * profilerCreateDesc.maxThreadCount * profilerCreateDesc.maxMemoryEventsPerThread );
         const zp_size_t gpuEventCount = ( profilerCreateDesc.maxFramesToCapture * profilerCreateDesc.maxThreadCount * profilerCreateDesc.maxGPUEventsPerThread );
+        const zp_size_t counterEventCount = ( profilerCreateDesc.maxFramesToCapture * profilerCreateDesc.maxCounterEventsPerFrame );
 
         g_context = {
             .currentFrame = 0,
@@ -211,8 +235,11 @@ namespace zp
             .cpuProfilerData = { ZP_MALLOC_T_ARRAY( memoryLabel, CPUProfilerEvent, cpuEventCount ), cpuEventCount },
             .memProfilerData = { ZP_MALLOC_T_ARRAY( memoryLabel, MemoryProfilerEvent, memEventCount ), memEventCount },
             .gpuProfilerData = { ZP_MALLOC_T_ARRAY( memoryLabel, GPUProfilerEvent, gpuEventCount ), gpuEventCount },
+            .counterProfilerData = { counterEventCount > 0 ? ZP_MALLOC_T_ARRAY( memoryLabel, CounterProfilerEvent, counterEventCount ) : nullptr, counterEventCount },
+            .currentCounterProfilerEvent = 0,
             .profilerThreadDataCount = 0,
             .profilerThreadData = { ZP_MALLOC_T_ARRAY( memoryLabel, ProfilerThreadData*, profilerCreateDesc.maxThreadCount ), profilerCreateDesc.maxThreadCount },
+            .advanceFrameCallbackCount = 0,
             .memoryLabel = memoryLabel
         };
 #if 0
@@ -253,6 +280,11 @@ namespace zp
         ZP_FREE( g_context.memoryLabel, g_context.gpuProfilerData.data() );
         ZP_FREE( g_context.memoryLabel, g_context.profilerThreadData.data() );
 
+        if( g_context.counterProfilerData.data() != nullptr )
+        {
+            ZP_FREE( g_context.memoryLabel, g_context.counterProfilerData.data() );
+        }
+
         g_context = {};
 #if 0
         ZP_FREE( memoryLabel, m_cpuProfilerData );
@@ -371,6 +403,47 @@ namespace zp
         //event->threadId = t_profilerData.threadID;
     }
 
+    void Profiler::MarkCounter( const Profiler::CounterDesc& counterDesc )
+    {
+        if( g_context.counterProfilerData.length() == 0 )
+        {
+            return;
+        }
+
+        const zp_size_t eventIndex = ( Atomic::IncrementSizeT( &g_context.currentCounterProfilerEvent ) - 1 ) % g_context.counterProfilerData.length();
+
+        CounterProfilerEvent* event = g_context.counterProfilerData.data() + eventIndex;
+        event->counterName = counterDesc.counterName;
+        event->frameIndex = g_context.currentFrame;
+        event->time = Platform::TimeNow();
+        event->value = counterDesc.value;
+        event->track = counterDesc.track;
+    }
+
+    void Profiler::RegisterAdvanceFrameCallback( AdvanceFrameCallback callback, void* userData )
+    {
+        ZP_ASSERT( g_context.advanceFrameCallbackCount < kMaxAdvanceFrameCallbacks );
+
+        const zp_size_t index = g_context.advanceFrameCallbackCount++;
+        g_context.advanceFrameCallbacks[ index ] = callback;
+        g_context.advanceFrameCallbackUserData[ index ] = userData;
+    }
+
+    void Profiler::UnregisterAdvanceFrameCallback( AdvanceFrameCallback callback, void* userData )
+    {
+        for( zp_size_t i = 0; i < g_context.advanceFrameCallbackCount; ++i )
+        {
+            if( g_context.advanceFrameCallbacks[ i ] == callback && g_context.advanceFrameCallbackUserData[ i ] == userData )
+            {
+                --g_context.advanceFrameCallbackCount;
+
+                g_context.advanceFrameCallbacks[ i ] = g_context.advanceFrameCallbacks[ g_context.advanceFrameCallbackCount ];
+                g_context.advanceFrameCallbackUserData[ i ] = g_context.advanceFrameCallbackUserData[ g_context.advanceFrameCallbackCount ];
+                break;
+            }
+        }
+    }
+
     void Profiler::AdvanceFrame( zp_uint64_t frameIndex )
     {
         AdvanceProfilerFrame( frameIndex );
@@ -0,0 +1,361 @@
+//
+// Created by phosg on 10/16/2026.
+//
+
+#include "Core/Vector.h"
+#include "Core/Queue.h"
+
+#if ZP_USE_TESTS
+#include "Test/Test.h"
+#include "Core/Atomic.h"
+#include "Platform/Platform.h"
+
+using namespace zp;
+
+ZP_TEST_GROUP( Queue )
+{
+    ZP_TEST_SUITE( MPMCQueue )
+    {
+        namespace
+        {
+            constexpr zp_uint32_t kTestThreadCount = 4;
+            constexpr zp_uint64_t kTestItemsPerProducer = 100000;
+
+            typedef MPMCQueue<zp_uint64_t, 256> TestMPMCQueue;
+
+            struct MPMCTestContext
+            {
+                TestMPMCQueue* queue;
+                zp_uint64_t consumedSum;
+                zp_int64_t consumedCount;
+                zp_uint32_t nextProducer;
+            };
+
+            zp_uint32_t ProducerThreadFunc( void* threadData )
+            {
+                MPMCTestContext* ctx = static_cast<MPMCTestContext*>( threadData );
+                const zp_uint64_t producer = Atomic::Increment( reinterpret_cast<zp_int32_t*>( &ctx->nextProducer ) ) - 1;
+
+                for( zp_uint64_t i = 0; i < kTestItemsPerProducer; ++i )
+                {
+                    const zp_uint64_t value = producer * kTestItemsPerProducer + i;
+                    while( !ctx->queue->tryEnqueue( value ) )
+                    {
+                        Platform::YieldCurrentThread();
+                    }
+                }
+
+                return 0;
+            }
+
+            zp_uint32_t ConsumerThreadFunc( void* threadData )
+            {
+                MPMCTestContext* ctx = static_cast<MPMCTestContext*>( threadData );
+
+                constexpr zp_int64_t kTotal = kTestThreadCount * kTestItemsPerProducer;
+
+                zp_uint64_t values[ 8 ];
+                while( Atomic::LoadAcquire( &ctx->consumedCount ) < kTotal )
+                {
+                    const zp_size_t count = ctx->queue->tryDequeueBatch( values, 8 );
+                    if( count == 0 )
+                    {
+                        Platform::YieldCurrentThread();
+                        continue;
+                    }
+
+                    zp_uint64_t sum = 0;
+                    for( zp_size_t i = 0; i < count; ++i )
+                    {
+                        sum += values[ i ];
+                    }
+
+                    Atomic::Add( reinterpret_cast<zp_int64_t*>( &ctx->consumedSum ), static_cast<zp_int64_t>( sum ) );
+                    Atomic::Add( &ctx->consumedCount, static_cast<zp_int64_t>( count ) );
+                }
+
+                return 0;
+            }
+        }
+
+        ZP_TEST( FIFO )
+        {
+            MPMCQueue<zp_int32_t, 4> queue;
+
+            ZP_CHECK_EQUALS( queue.isEmpty(), true );
+
+            for( zp_int32_t i = 0; i < 4; ++i )
+            {
+                ZP_CHECK_EQUALS( queue.tryEnqueue( i ), true );
+            }
+
+            ZP_CHECK_EQUALS( queue.tryEnqueue( 4 ), false );
+            ZP_CHECK_EQUALS( queue.size(), 4 );
+
+            zp_int32_t value = -1;
+            ZP_CHECK_EQUALS( queue.tryDequeue( value ), true );
+            ZP_CHECK_EQUALS( value, 0 );
+
+            // wraps into the freed cell
+            ZP_CHECK_EQUALS( queue.tryEnqueue( 4 ), true );
+
+            for( zp_int32_t i = 1; i < 5; ++i )
+            {
+                ZP_CHECK_EQUALS( queue.tryDequeue( value ), true );
+                ZP_CHECK_EQUALS( value, i );
+            }
+
+            ZP_CHECK_EQUALS( queue.tryDequeue( value ), false );
+        }
+
+        ZP_TEST( Batch )
+        {
+            MPMCQueue<zp_int32_t, 8> queue;
+
+            const zp_int32_t values[ 6 ] { 0, 1, 2, 3, 4, 5 };
+            ZP_CHECK_EQUALS( queue.tryEnqueueBatch( values, 6 ), 6 );
+
+            // only two cells left
+            ZP_CHECK_EQUALS( queue.tryEnqueueBatch( values, 6 ), 2 );
+
+            zp_int32_t out[ 16 ] {};
+            ZP_CHECK_EQUALS( queue.tryDequeueBatch( out, 16 ), 8 );
+            ZP_CHECK_EQUALS( out[ 5 ], 5 );
+            ZP_CHECK_EQUALS( out[ 7 ], 1 );
+            ZP_CHECK_EQUALS( queue.tryDequeueBatch( out, 16 ), 0 );
+        }
+
+        ZP_TEST( ProducersAndConsumers )
+        {
+            TestMPMCQueue queue;
+
+            MPMCTestContext ctx {
+                .queue = &queue,
+                .consumedSum = 0,
+                .consumedCount = 0,
+                .nextProducer = 0,
+            };
+
+            ThreadHandle threadHandles[ kTestThreadCount * 2 ];
+            for( zp_uint32_t i = 0; i < kTestThreadCount; ++i )
+            {
+                zp_uint32_t threadId;
+                threadHandles[ i ] = Platform::CreateThread( ProducerThreadFunc, &ctx, 64 KB, &threadId );
+                threadHandles[ kTestThreadCount + i ] = Platform::CreateThread( ConsumerThreadFunc, &ctx, 64 KB, &threadId );
+            }
+
+            Platform::JoinThreads( threadHandles, kTestThreadCount * 2 );
+
+            for( ThreadHandle threadHandle : threadHandles )
+            {
+                Platform::CloseThread( threadHandle );
+            }
+
+            // every value 0..n-1 exactly once
+            constexpr zp_uint64_t kTotal = kTestThreadCount * kTestItemsPerProducer;
+
+            ZP_CHECK_EQUALS( ctx.consumedCount, static_cast<zp_int64_t>( kTotal ) );
+            ZP_CHECK_EQUALS( ctx.consumedSum, kTotal * ( kTotal - 1 ) / 2 );
+            ZP_CHECK_EQUALS( queue.isEmpty(), true );
+        }
+    }
+
+#if ZP_USE_BENCHMARKS
+    ZP_TEST_SUITE( QueueBenchmark )
+    {
+        namespace
+        {
+            constexpr zp_uint32_t kBenchmarkMaxThreads = 32;
+            constexpr zp_size_t kBenchmarkItemsPerProducer = 200000;
+
+            // shared interface so both queues run the exact same producer and consumer loops
+            struct BenchmarkMPMCQueue
+            {
+                MPMCQueue<zp_uint64_t, 1024> queue;
+
+                zp_bool_t tryEnqueue( zp_uint64_t value )
+                {
+                    return queue.tryEnqueue( value );
+                }
+
+                zp_bool_t tryDequeue( zp_uint64_t& value )
+                {
+                    return queue.tryDequeue( value );
+                }
+            };
+
+            struct BenchmarkLockedQueue
+            {
+                BenchmarkLockedQueue()
+                    : queue( 1024, MemoryLabels::Default )
+                    , lock( Platform::CreateCriticalSection() )
+                {
+                }
+
+                ~BenchmarkLockedQueue()
+                {
+                    Platform::CloseCriticalSection( lock );
+                }
+
+                zp_bool_t tryEnqueue( zp_uint64_t value )
+                {
+                    Platform::EnterCriticalSection( lock );
+
+                    // same bound as the ring so both see back pressure
+                    const zp_bool_t enqueued = queue.size() < 1024;
+                    if( enqueued )
+                    {
+                        queue.enqueue( value );
+                    }
+
+                    Platform::LeaveCriticalSection( lock );
+
+                    return enqueued;
+                }
+
+                zp_bool_t tryDequeue( zp_uint64_t& value )
+                {
+                    Platform::EnterCriticalSection( lock );
+
+                    const zp_bool_t dequeued = queue.tryDequeue( value );
+
+                    Platform::LeaveCriticalSection( lock );
+
+                    return dequeued;
+                }
+
+                Queue<zp_uint64_t> queue;
+                CriticalSection lock;
+            };
+
+            template<typename Q>
+            struct QueueBenchmarkContext
+            {
+                Q* queue;
+                zp_int64_t remaining;
+                zp_uint32_t started;
+                zp_uint32_t threadCount;
+                zp_uint32_t go;
+            };
+
+            template<typename Q>
+            void WaitForGo( QueueBenchmarkContext<Q>* ctx )
+            {
+                Atomic::Increment( reinterpret_cast<zp_int32_t*>( &ctx->started ) );
+                while( !Atomic::LoadAcquire( &ctx->go ) )
+                {
+                    Platform::YieldCurrentThread();
+                }
+            }
+
+            template<typename Q>
+            zp_uint32_t BenchmarkProducerFunc( void* threadData )
+            {
+                QueueBenchmarkContext<Q>* ctx = static_cast<QueueBenchmarkContext<Q>*>( threadData );
+                WaitForGo( ctx );
+
+                for( zp_size_t i = 0; i < kBenchmarkItemsPerProducer; ++i )
+                {
+                    while( !ctx->queue->tryEnqueue( i ) )
+                    {
+                        Platform::YieldCurrentThread();
+                    }
+                }
+
+                return 0;
+            }
+
+            template<typename Q>
+            zp_uint32_t BenchmarkConsumerFunc( void* threadData )
+            {
+                QueueBenchmarkContext<Q>* ctx = static_cast<QueueBenchmarkContext<Q>*>( threadData );
+                WaitForGo( ctx );
+
+                zp_uint64_t value;
+                while( Atomic::LoadAcquire( &ctx->remaining ) > 0 )
+                {
+                    if( ctx->queue->tryDequeue( value ) )
+                    {
+                        Atomic::Decrement( &ctx->remaining );
+                    }
+                    else
+                    {
+                        Platform::YieldCurrentThread();
+                    }
+                }
+
+                return 0;
+            }
+
+            // threadCount producers and threadCount consumers
+            template<typename Q>
+            zp_float64_t RunQueueBenchmark( Q* queue, zp_uint32_t threadCount )
+            {
+                QueueBenchmarkContext<Q> ctx {
+                    .queue = queue,
+                    .remaining = static_cast<zp_int64_t>( kBenchmarkItemsPerProducer * threadCount ),
+                    .started = 0,
+                    .threadCount = threadCount,
+                    .go = 0,
+                };
+
+                ThreadHandle threadHandles[ kBenchmarkMaxThreads * 2 ];
+                for( zp_uint32_t i = 0; i < threadCount; ++i )
+                {
+                    zp_uint32_t threadId;
+                    threadHandles[ i * 2 ] = Platform::CreateThread( BenchmarkProducerFunc<Q>, &ctx, 64 KB, &threadId );
+                    threadHandles[ i * 2 + 1 ] = Platform::CreateThread( BenchmarkConsumerFunc<Q>, &ctx, 64 KB, &threadId );
+                }
+
+                while( Atomic::LoadAcquire( &ctx.started ) < threadCount * 2 )
+                {
+                    Platform::YieldCurrentThread();
+                }
+
+                const zp_time_t start = Platform::TimeNow();
+
+                Atomic::StoreRelease( &ctx.go, 1 );
+
+                Platform::JoinThreads( threadHandles, threadCount * 2 );
+
+                const zp_time_t elapsed = Platform::TimeNow() - start;
+
+                for( zp_uint32_t i = 0; i < threadCount * 2; ++i )
+                {
+                    Platform::CloseThread( threadHandles[ i ] );
+                }
+
+                return static_cast<zp_float64_t>( elapsed ) * 1000.0 / static_cast<zp_float64_t>( Platform::TimeFrequency() );
+            }
+        }
+
+        ZP_TEST( ProducerConsumerContention )
+        {
+            for( zp_uint32_t threadCount = 1; threadCount <= kBenchmarkMaxThreads; threadCount *= 2 )
+            {
+                zp_float64_t lockedMS;
+                zp_float64_t mpmcMS;
+
+                {
+                    BenchmarkLockedQueue queue;
+                    lockedMS = RunQueueBenchmark( &queue, threadCount );
+                }
+
+                {
+                    BenchmarkMPMCQueue* queue = new( ZP_MALLOC( MemoryLabels::Default, sizeof( BenchmarkMPMCQueue ) ) ) BenchmarkMPMCQueue();
+                    mpmcMS = RunQueueBenchmark( queue, threadCount );
+
+                    ZP_CHECK_EQUALS( queue->queue.isEmpty(), true );
+                    ZP_DELETE_LABEL( MemoryLabels::Default, BenchmarkMPMCQueue, queue );
+                }
+
+                const zp_float64_t operations = static_cast<zp_float64_t>( kBenchmarkItemsPerProducer * threadCount );
+
+                zp_printfln( "[BENCH] queue %u producers / %u consumers: locked queue %.3f ms (%.1f Mitems/s), mpmc ring %.3f ms (%.1f Mitems/s), %.2fx",
+                    threadCount, threadCount, lockedMS, operations / ( lockedMS * 1000.0 ), mpmcMS, operations / ( mpmcMS * 1000.0 ), lockedMS / mpmcMS );
+            }
+        }
+    }
+#endif // ZP_USE_BENCHMARKS
+}
+#endif
@@ -0,0 +1,365 @@
+//
+// Created by phosg on 10/16/2026.
+//
+
+#include "Core/SlotMap.h"
+
+#if ZP_USE_TESTS
+#include "Test/Test.h"
+#include "Core/Map.h"
+#include "Platform/Platform.h"
+
+using namespace zp;
+
+ZP_TEST_GROUP( SlotMap )
+{
+    ZP_TEST_SUITE( SlotMap )
+    {
+        namespace
+        {
+            zp_int32_t s_liveValueCount;
+
+            struct TrackedValue
+            {
+                zp_int32_t value;
+
+                explicit TrackedValue( zp_int32_t v )
+                    : value( v )
+                {
+                    ++s_liveValueCount;
+                }
+
+                TrackedValue( TrackedValue&& other )
+                    : value( other.value )
+                {
+                    ++s_liveValueCount;
+                }
+
+                TrackedValue& operator=( TrackedValue&& other )
+                {
+                    value = other.value;
+                    return *this;
+                }
+
+                ~TrackedValue()
+                {
+                    --s_liveValueCount;
+                }
+            };
+        }
+
+        ZP_TEST( EmptyLookup )
+        {
+            SlotMap<zp_int32_t> slotMap( MemoryLabels::Default );
+
+            ZP_CHECK_EQUALS( slotMap.contains( SlotMapHandle32 {} ), false );
+            ZP_CHECK_EQUALS( slotMap.find( SlotMapHandle32::Make( 0, 1 ) ), nullptr );
+            ZP_CHECK_EQUALS( slotMap.erase( SlotMapHandle32::Make( 0, 1 ) ), false );
+            ZP_CHECK_EQUALS( slotMap.begin() == slotMap.end(), true );
+        }
+
+        ZP_TEST( InsertFindErase )
+        {
+            SlotMap<zp_int32_t> slotMap( MemoryLabels::Default );
+
+            const SlotMapHandle32 a = slotMap.insert( 10 );
+            const SlotMapHandle32 b = slotMap.insert( 20 );
+            const SlotMapHandle32 c = slotMap.emplace( 30 );
+
+            ZP_CHECK_EQUALS( slotMap.size(), 3 );
+            ZP_CHECK_EQUALS( slotMap[ a ], 10 );
+            ZP_CHECK_EQUALS( slotMap[ b ], 20 );
+            ZP_CHECK_EQUALS( slotMap[ c ], 30 );
+
+            ZP_CHECK_EQUALS( slotMap.erase( a ), true );
+            ZP_CHECK_EQUALS( slotMap.erase( a ), false );
+
+            // the last value moved into the hole, its handle still resolves
+            ZP_CHECK_EQUALS( slotMap.size(), 2 );
+            ZP_CHECK_EQUALS( slotMap.data()[ 0 ], 30 );
+            ZP_CHECK_EQUALS( slotMap[ c ], 30 );
+            ZP_CHECK_EQUALS( slotMap[ b ], 20 );
+            ZP_CHECK_EQUALS( slotMap.handleAt( 0 ) == c, true );
+        }
+
+        ZP_TEST( StaleHandleAfterReuse )
+        {
+            SlotMap<zp_int32_t> slotMap( MemoryLabels::Default );
+
+            const SlotMapHandle32 stale = slotMap.insert( 1 );
+            slotMap.erase( stale );
+
+            // reuses the slot with a newer generation
+            const SlotMapHandle32 fresh = slotMap.insert( 2 );
+
+            ZP_CHECK_EQUALS( fresh.index(), stale.index() );
+            ZP_CHECK_NOT_EQUALS( fresh.generation(), stale.generation() );
+            ZP_CHECK_EQUALS( slotMap.contains( stale ), false );
+            ZP_CHECK_EQUALS( slotMap.find( stale ), nullptr );
+            ZP_CHECK_EQUALS( slotMap[ fresh ], 2 );
+
+            slotMap.clear();
+
+            ZP_CHECK_EQUALS( slotMap.contains( fresh ), false );
+            ZP_CHECK_EQUALS( slotMap.empty(), true );
+        }
+
+        ZP_TEST( RetireExhaustedSlot )
+        {
+            // 2 generation bits, generations 1 to 3 are handed out before the slot is retired
+            typedef SlotMapHandle<zp_uint32_t, 30> TinyHandle;
+            SlotMap<zp_int32_t, TinyHandle> slotMap( MemoryLabels::Default );
+
+            TinyHandle handle {};
+            for( zp_int32_t i = 0; i < 3; ++i )
+            {
+                handle = slotMap.insert( i );
+                ZP_CHECK_EQUALS( handle.index(), 0 );
+                slotMap.erase( handle );
+            }
+
+            const TinyHandle next = slotMap.insert( 3 );
+
+            ZP_CHECK_EQUALS( next.index(), 1 );
+            ZP_CHECK_EQUALS( slotMap.contains( handle ), false );
+            ZP_CHECK_EQUALS( slotMap.contains( TinyHandle {} ), false );
+        }
+
+        ZP_TEST( FreeSlotGenerationNotFound )
+        {
+            SlotMap<zp_int32_t> slotMap( MemoryLabels::Default );
+
+            const SlotMapHandle32 a = slotMap.insert( 1 );
+            const SlotMapHandle32 b = slotMap.insert( 2 );
+            slotMap.erase( b );
+            slotMap.erase( a );
+
+            // a handle carrying a free slot's next generation was never handed out
+            const SlotMapHandle32 unissued = SlotMapHandle32::Make( a.index(), a.generation() + 1 );
+
+            ZP_CHECK_EQUALS( slotMap.contains( unissued ), false );
+            ZP_CHECK_EQUALS( slotMap.find( unissued ), nullptr );
+            ZP_CHECK_EQUALS( slotMap.erase( unissued ), false );
+        }
+
+        ZP_TEST( OutOfHandleIndices )
+        {
+            // indices 0 to 2 are handed out before the map is out of them
+            typedef SlotMapHandle<zp_uint32_t, 2> TinyIndexHandle;
+            SlotMap<zp_int32_t, TinyIndexHandle> slotMap( MemoryLabels::Default );
+
+            for( zp_int32_t i = 0; i < 3; ++i )
+            {
+                ZP_CHECK_EQUALS( slotMap.insert( i ).isValid(), true );
+            }
+
+            const TinyIndexHandle failed = slotMap.insert( 3 );
+
+            ZP_CHECK_EQUALS( failed.isValid(), false );
+            ZP_CHECK_EQUALS( slotMap.size(), 3 );
+        }
+
+        ZP_TEST( GrowAndDenseIteration )
+        {
+            s_liveValueCount = 0;
+
+            {
+                SlotMap<TrackedValue, SlotMapHandle64> slotMap( MemoryLabels::Default );
+
+                SlotMapHandle64 handles[ 1000 ];
+                for( zp_int32_t i = 0; i < 1000; ++i )
+                {
+                    handles[ i ] = slotMap.emplace( i );
+                }
+
+                zp_size_t erased = 0;
+                for( zp_int32_t i = 0; i < 1000; i += 3 )
+                {
+                    erased += slotMap.erase( handles[ i ] ) ? 1 : 0;
+                }
+
+                ZP_CHECK_EQUALS( slotMap.size(), 1000 - erased );
+                ZP_CHECK_EQUALS( s_liveValueCount, static_cast<zp_int32_t>( 1000 - erased ) );
+
+                zp_int64_t expectedSum = 0;
+                zp_size_t found = 0;
+                for( zp_int32_t i = 0; i < 1000; ++i )
+                {
+                    const TrackedValue* value = slotMap.find( handles[ i ] );
+                    if( i % 3 == 0 )
+                    {
+                        found += value == nullptr ? 0 : 1;
+                    }
+                    else
+                    {
+                        found += value != nullptr && value->value == i ? 1 : 0;
+                        expectedSum += i;
+                    }
+                }
+
+                zp_int64_t sum = 0;
+                for( const TrackedValue& value : slotMap )
+                {
+                    sum += value.value;
+                }
+
+                ZP_CHECK_EQUALS( found, 1000 - erased );
+                ZP_CHECK_EQUALS( sum, expectedSum );
+            }
+
+            ZP_CHECK_EQUALS( s_liveValueCount, 0 );
+        }
+    }
+
+#if ZP_USE_BENCHMARKS
+    ZP_TEST_SUITE( SlotMapBenchmark )
+    {
+        namespace
+        {
+            constexpr zp_size_t kMinEntryCount = 1000;
+            constexpr zp_size_t kMaxEntryCount = 1000000;
+            constexpr zp_size_t kLookupCount = 1000000;
+            constexpr zp_size_t kIterationCount = 10;
+
+            zp_uint64_t NextRandom( zp_uint64_t& rng )
+            {
+                rng ^= rng << 13;
+                rng ^= rng >> 7;
+                rng ^= rng << 17;
+                return rng;
+            }
+
+            zp_float64_t TicksToMilliseconds( zp_time_t ticks )
+            {
+                return static_cast<zp_float64_t>( ticks ) * 1000.0 / static_cast<zp_float64_t>( Platform::TimeFrequency() );
+            }
+
+            struct BenchmarkResult
+            {
+                zp_float64_t insertMS;
+                zp_float64_t lookupMS;
+                zp_float64_t iterateMS;
+                zp_uint64_t lookupSum;
+                zp_uint64_t iterateSum;
+            };
+
+            // Map stands in for the handle registries, keyed by an id handed out on insert
+            BenchmarkResult RunMap( zp_uint64_t* ids, zp_size_t count )
+            {
+                BenchmarkResult result {};
+                Map<zp_uint64_t, zp_uint64_t> map( MemoryLabels::Default );
+
+                zp_time_t start = Platform::TimeNow();
+
+                for( zp_size_t i = 0; i < count; ++i )
+                {
+                    ids[ i ] = i + 1;
+                    map.set( ids[ i ], i );
+                }
+
+                result.insertMS = TicksToMilliseconds( Platform::TimeNow() - start );
+
+                zp_uint64_t rng = 0xD1B54A32D192ED03ull;
+                start = Platform::TimeNow();
+
+                for( zp_size_t i = 0; i < kLookupCount; ++i )
+                {
+                    zp_uint64_t* value = nullptr;
+                    if( map.tryGet( ids[ NextRandom( rng ) % count ], &value ) )
+                    {
+                        result.lookupSum += *value;
+                    }
+                }
+
+                result.lookupMS = TicksToMilliseconds( Platform::TimeNow() - start );
+
+                start = Platform::TimeNow();
+
+                for( zp_size_t n = 0; n < kIterationCount; ++n )
+                {
+                    for( auto it = map.begin(); it != map.end(); ++it )
+                    {
+                        result.iterateSum += it.value();
+                    }
+                }
+
+                result.iterateMS = TicksToMilliseconds( Platform::TimeNow() - start );
+
+                return result;
+            }
+
+            BenchmarkResult RunSlotMap( SlotMapHandle32* handles, zp_size_t count )
+            {
+                BenchmarkResult result {};
+                SlotMap<zp_uint64_t> slotMap( MemoryLabels::Default );
+
+                zp_time_t start = Platform::TimeNow();
+
+                for( zp_size_t i = 0; i < count; ++i )
+                {
+                    handles[ i ] = slotMap.insert( i );
+                }
+
+                result.insertMS = TicksToMilliseconds( Platform::TimeNow() - start );
+
+                zp_uint64_t rng = 0xD1B54A32D192ED03ull;
+                start = Platform::TimeNow();
+
+                for( zp_size_t i = 0; i < kLookupCount; ++i )
+                {
+                    const zp_uint64_t* value = slotMap.find( handles[ NextRandom( rng ) % count ] );
+                    if( value != nullptr )
+                    {
+                        result.lookupSum += *value;
+                    }
+                }
+
+                result.lookupMS = TicksToMilliseconds( Platform::TimeNow() - start );
+
+                start = Platform::TimeNow();
+
+                for( zp_size_t n = 0; n < kIterationCount; ++n )
+                {
+                    for( const zp_uint64_t value : slotMap )
+                    {
+                        result.iterateSum += value;
+                    }
+                }
+
+                result.iterateMS = TicksToMilliseconds( Platform::TimeNow() - start );
+
+                return result;
+            }
+
+            void PrintResult( const char* name, zp_size_t count, const BenchmarkResult& result )
+            {
+                zp_printfln( "[BENCH] %s %zu entries: insert %.3f ms, %zu lookups %.3f ms (%.1f ns/op), iterate x%zu %.3f ms (%.2f ns/entry)",
+                    name, count, result.insertMS, static_cast<zp_size_t>( kLookupCount ), result.lookupMS, result.lookupMS * 1000000.0 / kLookupCount,
+                    static_cast<zp_size_t>( kIterationCount ), result.iterateMS, result.iterateMS * 1000000.0 / static_cast<zp_float64_t>( count * kIterationCount ) );
+            }
+        }
+
+        ZP_TEST( LookupAndIterate )
+        {
+            zp_uint64_t* ids = ZP_MALLOC_T_ARRAY( MemoryLabels::Default, zp_uint64_t, kMaxEntryCount );
+            SlotMapHandle32* handles = ZP_MALLOC_T_ARRAY( MemoryLabels::Default, SlotMapHandle32, kMaxEntryCount );
+
+            for( zp_size_t count = kMinEntryCount; count <= kMaxEntryCount; count *= 10 )
+            {
+                const BenchmarkResult mapResult = RunMap( ids, count );
+                const BenchmarkResult slotMapResult = RunSlotMap( handles, count );
+
+                PrintResult( "Map", count, mapResult );
+                PrintResult( "SlotMap", count, slotMapResult );
+
+                ZP_CHECK_EQUALS( slotMapResult.lookupSum, mapResult.lookupSum );
+                ZP_CHECK_EQUALS( slotMapResult.iterateSum, mapResult.iterateSum );
+            }
+
+            ZP_FREE( MemoryLabels::Default, handles );
+            ZP_FREE( MemoryLabels::Default, ids );
+        }
+    }
+#endif // ZP_USE_BENCHMARKS
+}
+#endif
@@ -0,0 +1,433 @@
+//
+// Created by phosg on 10/16/2026.
+//
+
+#include "Core/Common.h"
+#include "Core/Sort.h"
+
+namespace zp
+{
+    namespace
+    {
+        struct RadixKeyValue
+        {
+            template<typename T>
+            ZP_FORCEINLINE T operator()( T value ) const
+            {
+                return value;
+            }
+        };
+
+        struct RadixKeyMember
+        {
+            template<typename T>
+            ZP_FORCEINLINE auto operator()( const T& value ) const
+            {
+                return value.key;
+            }
+        };
+
+        template<typename K, typename T, typename KeyFunc>
+        void RadixSortImpl( T* keys, T* scratch, zp_size_t count, KeyFunc keyFunc )
+        {
+            constexpr zp_size_t kDigitCount = sizeof( K );
+            constexpr zp_size_t kBucketCount = 256;
+
+            if( count < 2 )
+            {
+                return;
+            }
+
+            zp_size_t histograms[ kDigitCount ][ kBucketCount ] {};
+
+            for( zp_size_t i = 0; i < count; ++i )
+            {
+                const K key = keyFunc( keys[ i ] );
+                for( zp_size_t d = 0; d < kDigitCount; ++d )
+                {
+                    ++histograms[ d ][ ( key >> ( d * 8 ) ) & 0xFF ];
+                }
+            }
+
+            T* src = keys;
+            T* dst = scratch;
+
+            for( zp_size_t d = 0; d < kDigitCount; ++d )
+            {
+                zp_size_t* histogram = histograms[ d ];
+
+                // every key has the same digit, the pass would only copy
+                const zp_size_t shift = d * 8;
+                if( histogram[ ( keyFunc( src[ 0 ] ) >> shift ) & 0xFF ] == count )
+                {
+                    continue;
+                }
+
+                zp_size_t offset = 0;
+                for( zp_size_t b = 0; b < kBucketCount; ++b )
+                {
+                    const zp_size_t bucketCount = histogram[ b ];
+                    histogram[ b ] = offset;
+                    offset += bucketCount;
+                }
+
+                for( zp_size_t i = 0; i < count; ++i )
+                {
+                    const zp_size_t bucket = ( keyFunc( src[ i ] ) >> shift ) & 0xFF;
+                    dst[ histogram[ bucket ]++ ] = src[ i ];
+                }
+
+                zp_move_swap( src, dst );
+            }
+
+            if( src != keys )
+            {
+                zp_memcpy( keys, sizeof( T ) * count, src, sizeof( T ) * count );
+            }
+        }
+    }
+
+    void RadixSort( zp_uint32_t* keys, zp_uint32_t* scratch, zp_size_t count )
+    {
+        RadixSortImpl<zp_uint32_t>( keys, scratch, count, RadixKeyValue() );
+    }
+
+    void RadixSort( zp_uint64_t* keys, zp_uint64_t* scratch, zp_size_t count )
+    {
+        RadixSortImpl<zp_uint64_t>( keys, scratch, count, RadixKeyValue() );
+    }
+
+    void RadixSort( RadixSortKey32* keys, RadixSortKey32* scratch, zp_size_t count )
+    {
+        RadixSortImpl<zp_uint32_t>( keys, scratch, count, RadixKeyMember() );
+    }
+
+    void RadixSort( RadixSortKey64* keys, RadixSortKey64* scratch, zp_size_t count )
+    {
+        RadixSortImpl<zp_uint64_t>( keys, scratch, count, RadixKeyMember() );
+    }
+}
+
+#if ZP_USE_TESTS
+#include "Test/Test.h"
+#include "Core/Vector.h"
+#include "Platform/Platform.h"
+
+using namespace zp;
+
+ZP_TEST_GROUP( Sort )
+{
+    namespace
+    {
+        enum class SortInput
+        {
+            Random,
+            Sorted,
+            Reversed,
+            Duplicates,
+        };
+
+        const SortInput kSortInputs[] {
+            SortInput::Random,
+            SortInput::Sorted,
+            SortInput::Reversed,
+            SortInput::Duplicates,
+        };
+
+        const char* kSortInputNames[] {
+            "random",
+            "sorted",
+            "reversed",
+            "duplicates",
+        };
+
+        zp_uint64_t NextRandom( zp_uint64_t& rng )
+        {
+            rng ^= rng << 13;
+            rng ^= rng >> 7;
+            rng ^= rng << 17;
+            return rng;
+        }
+
+        template<typename T>
+        void FillSortInput( T* values, zp_size_t count, SortInput input )
+        {
+            zp_uint64_t rng = 0x9E3779B97F4A7C15ull;
+            for( zp_size_t i = 0; i < count; ++i )
+            {
+                switch( input )
+                {
+                    case SortInput::Random:
+                        values[ i ] = static_cast<T>( NextRandom( rng ) );
+                        break;
+                    case SortInput::Sorted:
+                        values[ i ] = static_cast<T>( i );
+                        break;
+                    case SortInput::Reversed:
+                        values[ i ] = static_cast<T>( count - i );
+                        break;
+                    case SortInput::Duplicates:
+                        values[ i ] = static_cast<T>( NextRandom( rng ) % 16 );
+                        break;
+                }
+            }
+        }
+
+        template<typename T>
+        zp_bool_t IsSorted( const T* values, zp_size_t count )
+        {
+            for( zp_size_t i = 1; i < count; ++i )
+            {
+                if( values[ i ] < values[ i - 1 ] )
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // order independent checksum so a sort that drops or duplicates elements is caught
+        template<typename T>
+        zp_uint64_t Checksum( const T* values, zp_size_t count )
+        {
+            zp_uint64_t sum = 0;
+            zp_uint64_t sumSq = 0;
+            for( zp_size_t i = 0; i < count; ++i )
+            {
+                const zp_uint64_t v = static_cast<zp_uint64_t>( values[ i ] );
+                sum += v;
+                sumSq += v * v;
+            }
+            return sum ^ ( sumSq * 0x100000001B3ull );
+        }
+    }
+
+    ZP_TEST_SUITE( Sort )
+    {
+        ZP_TEST( Introsort )
+        {
+            constexpr zp_size_t kCount = 10000;
+
+            zp_uint32_t* values = ZP_MALLOC_T_ARRAY( MemoryLabels::Default, zp_uint32_t, kCount );
+
+            for( SortInput input : kSortInputs )
+            {
+                FillSortInput( values, kCount, input );
+                const zp_uint64_t checksum = Checksum( values, kCount );
+
+                zp_sort( values, values + kCount, zp_cmp<zp_uint32_t> );
+
+                ZP_CHECK_EQUALS_REASON( IsSorted( values, kCount ), true, kSortInputNames[ static_cast<zp_size_t>( input ) ] );
+                ZP_CHECK_EQUALS( Checksum( values, kCount ), checksum );
+            }
+
+            ZP_FREE( MemoryLabels::Default, values );
+        }
+
+        ZP_TEST( IntrosortSmall )
+        {
+            zp_int32_t values[] { 5, -1, 3, 3, 0, 9, -7, 2 };
+            const zp_int32_t expected[] { -7, -1, 0, 2, 3, 3, 5, 9 };
+
+            zp_sort( values, values, zp_cmp<zp_int32_t> );
+            zp_sort( values, values + 1, zp_cmp<zp_int32_t> );
+            zp_sort( values, values + zp_array_size( values ), zp_cmp<zp_int32_t> );
+
+            ZP_CHECK_EQUALS( zp_memcmp( values, sizeof( values ), expected, sizeof( expected ) ), 0 );
+        }
+
+        ZP_TEST( HeapSortFallback )
+        {
+            constexpr zp_size_t kCount = 1000;
+
+            zp_uint32_t values[ kCount ];
+            FillSortInput( values, kCount, SortInput::Random );
+            const zp_uint64_t checksum = Checksum( values, kCount );
+
+            // a zero depth limit goes straight to heap sort
+            zp_introsort( values, values + kCount, static_cast<const zp_uint32_t*>( nullptr ), 0, zp_cmp<zp_uint32_t> );
+
+            ZP_CHECK_EQUALS( IsSorted( values, kCount ), true );
+            ZP_CHECK_EQUALS( Checksum( values, kCount ), checksum );
+        }
+
+        ZP_TEST( VectorSort )
+        {
+            Vector<zp_int32_t> vector( 4, MemoryLabels::Default );
+            vector.pushBack( 3 );
+            vector.pushBack( 1 );
+            vector.pushBack( 2 );
+
+            vector.sort( zp_cmp_dsc<zp_int32_t> );
+
+            ZP_CHECK_EQUALS( vector[ 0 ], 3 );
+            ZP_CHECK_EQUALS( vector[ 1 ], 2 );
+            ZP_CHECK_EQUALS( vector[ 2 ], 1 );
+        }
+    }
+
+    ZP_TEST_SUITE( RadixSort )
+    {
+        ZP_TEST( Keys )
+        {
+            constexpr zp_size_t kCount = 10000;
+
+            zp_uint64_t* values = ZP_MALLOC_T_ARRAY( MemoryLabels::Default, zp_uint64_t, kCount * 2 );
+            zp_uint32_t* values32 = reinterpret_cast<zp_uint32_t*>( values );
+
+            for( SortInput input : kSortInputs )
+            {
+                FillSortInput( values, kCount, input );
+                const zp_uint64_t checksum = Checksum( values, kCount );
+
+                RadixSort( values, values + kCount, kCount );
+
+                ZP_CHECK_EQUALS_REASON( IsSorted( values, kCount ), true, kSortInputNames[ static_cast<zp_size_t>( input ) ] );
+                ZP_CHECK_EQUALS( Checksum( values, kCount ), checksum );
+
+                FillSortInput( values32, kCount, input );
+                const zp_uint64_t checksum32 = Checksum( values32, kCount );
+
+                RadixSort( values32, values32 + kCount, kCount );
+
+                ZP_CHECK_EQUALS_REASON( IsSorted( values32, kCount ), true, kSortInputNames[ static_cast<zp_size_t>( input ) ] );
+                ZP_CHECK_EQUALS( Checksum( values32, kCount ), checksum32 );
+            }
+
+            ZP_FREE( MemoryLabels::Default, values );
+        }
+
+        ZP_TEST( KeyIndexIsStable )
+        {
+            constexpr zp_size_t kCount = 4096;
+
+            RadixSortKey64* keys = ZP_MALLOC_T_ARRAY( MemoryLabels::Default, RadixSortKey64, kCount * 2 );
+
+            // high bits only so the low digit passes get skipped
+            zp_uint64_t rng = 0xD1B54A32D192ED03ull;
+            for( zp_size_t i = 0; i < kCount; ++i )
+            {
+                keys[ i ] = { .key = ( NextRandom( rng ) % 8 ) << 48, .index = static_cast<zp_uint32_t>( i ) };
+            }
+
+            RadixSort( keys, keys + kCount, kCount );
+
+            zp_size_t ordered = 0;
+            for( zp_size_t i = 1; i < kCount; ++i )
+            {
+                const RadixSortKey64& prev = keys[ i - 1 ];
+                const RadixSortKey64& curr = keys[ i ];
+                ordered += prev.key < curr.key || ( prev.key == curr.key && prev.index < curr.index ) ? 1 : 0;
+            }
+
+            ZP_CHECK_EQUALS( ordered, kCount - 1 );
+
+            ZP_FREE( MemoryLabels::Default, keys );
+        }
+
+        ZP_TEST( KeyIndex32 )
+        {
+            RadixSortKey32 keys[ 6 ] {
+                { .key = 0x300, .index = 0 },
+                { .key = 0x001, .index = 1 },
+                { .key = 0x300, .index = 2 },
+                { .key = 0x000, .index = 3 },
+                { .key = 0x001, .index = 4 },
+                { .key = 0xFFFFFFFF, .index = 5 },
+            };
+            RadixSortKey32 scratch[ 6 ];
+
+            RadixSort( keys, scratch, 6 );
+
+            const zp_uint32_t expectedIndices[ 6 ] { 3, 1, 4, 0, 2, 5 };
+
+            zp_size_t matches = 0;
+            for( zp_size_t i = 0; i < 6; ++i )
+            {
+                matches += keys[ i ].index == expectedIndices[ i ] ? 1 : 0;
+            }
+
+            ZP_CHECK_EQUALS( matches, 6 );
+        }
+    }
+
+#if ZP_USE_BENCHMARKS
+    ZP_TEST_SUITE( SortBenchmark )
+    {
+        namespace
+        {
+            constexpr zp_size_t kBenchmarkCount = 1000000;
+
+            zp_float64_t TicksToMilliseconds( zp_time_t ticks )
+            {
+                return static_cast<zp_float64_t>( ticks ) * 1000.0 / static_cast<zp_float64_t>( Platform::TimeFrequency() );
+            }
+        }
+
+        ZP_TEST( SortAlgorithms )
+        {
+            zp_uint64_t* source = ZP_MALLOC_T_ARRAY( MemoryLabels::Default, zp_uint64_t, kBenchmarkCount );
+            zp_uint64_t* values = ZP_MALLOC_T_ARRAY( MemoryLabels::Default, zp_uint64_t, kBenchmarkCount );
+            zp_uint64_t* scratch = ZP_MALLOC_T_ARRAY( MemoryLabels::Default, zp_uint64_t, kBenchmarkCount );
+
+            for( SortInput input : kSortInputs )
+            {
+                const char* inputName = kSortInputNames[ static_cast<zp_size_t>( input ) ];
+
+                FillSortInput( source, kBenchmarkCount, input );
+
+                // qsort3 recurses once per element on already ordered input and would overflow the stack
+                zp_float64_t qsortMS = -1.0;
+                if( input == SortInput::Random || input == SortInput::Duplicates )
+                {
+                    zp_memcpy( values, sizeof( zp_uint64_t ) * kBenchmarkCount, source, sizeof( zp_uint64_t ) * kBenchmarkCount );
+
+                    const zp_time_t start = Platform::TimeNow();
+                    zp_qsort3( values, values + kBenchmarkCount - 1, zp_cmp<zp_uint64_t> );
+                    qsortMS = TicksToMilliseconds( Platform::TimeNow() - start );
+
+                    ZP_CHECK_EQUALS( IsSorted( values, kBenchmarkCount ), true );
+                }
+
+                zp_float64_t introsortMS;
+                {
+                    zp_memcpy( values, sizeof( zp_uint64_t ) * kBenchmarkCount, source, sizeof( zp_uint64_t ) * kBenchmarkCount );
+
+                    const zp_time_t start = Platform::TimeNow();
+                    zp_sort( values, values + kBenchmarkCount, zp_cmp<zp_uint64_t> );
+                    introsortMS = TicksToMilliseconds( Platform::TimeNow() - start );
+
+                    ZP_CHECK_EQUALS( IsSorted( values, kBenchmarkCount ), true );
+                }
+
+                zp_float64_t radixMS;
+                {
+                    zp_memcpy( values, sizeof( zp_uint64_t ) * kBenchmarkCount, source, sizeof( zp_uint64_t ) * kBenchmarkCount );
+
+                    const zp_time_t start = Platform::TimeNow();
+                    RadixSort( values, scratch, kBenchmarkCount );
+                    radixMS = TicksToMilliseconds( Platform::TimeNow() - start );
+
+                    ZP_CHECK_EQUALS( IsSorted( values, kBenchmarkCount ), true );
+                }
+
+                if( qsortMS >= 0.0 )
+                {
+                    zp_printfln( "[BENCH] sort %zu %s uint64: qsort3 %.3f ms, introsort %.3f ms, radix %.3f ms",
+                        kBenchmarkCount, inputName, qsortMS, introsortMS, radixMS );
+                }
+                else
+                {
+                    zp_printfln( "[BENCH] sort %zu %s uint64: qsort3 skipped, introsort %.3f ms, radix %.3f ms",
+                        kBenchmarkCount, inputName, introsortMS, radixMS );
+                }
+            }
+
+            ZP_FREE( MemoryLabels::Default, scratch );
+            ZP_FREE( MemoryLabels::Default, values );
+            ZP_FREE( MemoryLabels::Default, source );
+        }
+    }
+#endif // ZP_USE_BENCHMARKS
+}
+#endif
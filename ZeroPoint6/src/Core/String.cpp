@@ -6,6 +6,9 @@
 #include "Core/Common.h"
 #include "Core/Memory.h"
 #include "Core/String.h"
+#include "Core/Atomic.h"
+
+#include "Platform/Platform.h"
 
 namespace zp
 {
@@ -106,7 +109,7 @@ namespace zp
     {
         ZP_ASSERT( m_str != nullptr );
         const char* end = str + length;
-        for( ; length < m_capacity && *str != '\0' && str != end; ++length, ++str )
+        for( ; m_length < m_capacity && *str != '\0' && str != end; ++m_length, ++str )
         {
             m_str[ m_length ] = *str;
         }
@@ -260,6 +263,355 @@ namespace zp
 //
 //
 
+namespace zp
+{
+    namespace
+    {
+        enum : zp_size_t
+        {
+            kStringPoolStripeCount = 16,
+            kStringPoolMinTableCapacity = 64,
+            kStringPoolBlockSize = 64 KB,
+            kStringPoolIdPageSize = 4096,
+            kStringPoolMaxIdPages = 1024,
+            kStringPoolMaxIds = kStringPoolIdPageSize * kStringPoolMaxIdPages,
+            kStringPoolCacheLineSize = 64,
+        };
+
+        constexpr MemoryLabel kStringPoolMemoryLabel = MemoryLabels::String;
+
+        struct StringPoolBlock
+        {
+            StringPoolBlock* next;
+            zp_size_t used;
+            zp_size_t capacity;
+        };
+
+        // open addressing over pooled headers, insert only so there are no tombstones
+        struct alignas( kStringPoolCacheLineSize ) StringPoolStripe
+        {
+            const PooledStringHeader** table;
+            zp_size_t capacity;
+            zp_size_t count;
+            StringPoolBlock* blocks;
+            zp_int32_t lock;
+        };
+
+        struct StringPool
+        {
+            StringPoolStripe stripes[ kStringPoolStripeCount ];
+            const PooledStringHeader** idPages[ kStringPoolMaxIdPages ];
+            zp_uint32_t nextId;
+            zp_int32_t idPageLock;
+        };
+
+        // zero initialized, pooling works before any engine setup
+        StringPool s_stringPool;
+
+        void AcquireStringPoolLock( zp_int32_t* lock )
+        {
+            while( Atomic::CompareExchange( lock, 1, 0 ) != 0 )
+            {
+                Platform::YieldCurrentThread();
+            }
+        }
+
+        void ReleaseStringPoolLock( zp_int32_t* lock )
+        {
+            Atomic::Exchange( lock, 0 );
+        }
+
+        StringPoolStripe& StripeFor( zp_hash64_t hash )
+        {
+            // top bits pick the stripe, the low bits pick the table slot
+            return s_stringPool.stripes[ hash >> 60 ];
+        }
+
+        const PooledStringHeader* FindLocked( const StringPoolStripe& stripe, zp_hash64_t hash, const zp_char8_t* str, zp_size_t length )
+        {
+            if( stripe.capacity == 0 )
+            {
+                return nullptr;
+            }
+
+            const zp_size_t mask = stripe.capacity - 1;
+            for( zp_size_t i = hash & mask;; i = ( i + 1 ) & mask )
+            {
+                const PooledStringHeader* header = stripe.table[ i ];
+                if( header == nullptr )
+                {
+                    return nullptr;
+                }
+
+                if( header->hash == hash && header->length == length && zp_memcmp( header + 1, length, str, length ) == 0 )
+                {
+                    return header;
+                }
+            }
+        }
+
+        void InsertLocked( StringPoolStripe& stripe, const PooledStringHeader* header )
+        {
+            const zp_size_t mask = stripe.capacity - 1;
+            zp_size_t i = header->hash & mask;
+            while( stripe.table[ i ] != nullptr )
+            {
+                i = ( i + 1 ) & mask;
+            }
+
+            stripe.table[ i ] = header;
+            ++stripe.count;
+        }
+
+        void GrowTableLocked( StringPoolStripe& stripe )
+        {
+            const PooledStringHeader** oldTable = stripe.table;
+            const zp_size_t oldCapacity = stripe.capacity;
+
+            stripe.capacity = oldCapacity == 0 ? kStringPoolMinTableCapacity : oldCapacity * 2;
+            stripe.table = ZP_MALLOC_T_ARRAY( kStringPoolMemoryLabel, const PooledStringHeader*, stripe.capacity );
+            stripe.count = 0;
+            zp_zero_memory_array( stripe.table, stripe.capacity );
+
+            for( zp_size_t i = 0; i < oldCapacity; ++i )
+            {
+                if( oldTable[ i ] != nullptr )
+                {
+                    InsertLocked( stripe, oldTable[ i ] );
+                }
+            }
+
+            if( oldTable != nullptr )
+            {
+                ZP_FREE( kStringPoolMemoryLabel, oldTable );
+            }
+        }
+
+        // strings are bump allocated from the stripe's current block, long strings get a block of their own
+        PooledStringHeader* AllocateLocked( StringPoolStripe& stripe, zp_size_t length )
+        {
+            const zp_size_t size = ZP_ALIGN_SIZE( sizeof( PooledStringHeader ) + length + 1, alignof( PooledStringHeader ) );
+
+            StringPoolBlock* block = stripe.blocks;
+            if( block == nullptr || block->used + size > block->capacity )
+            {
+                const zp_size_t capacity = size > kStringPoolBlockSize / 4 ? size : kStringPoolBlockSize - sizeof( StringPoolBlock );
+
+                StringPoolBlock* newBlock = static_cast<StringPoolBlock*>( ZP_MALLOC( kStringPoolMemoryLabel, sizeof( StringPoolBlock ) + capacity ) );
+                newBlock->used = 0;
+                newBlock->capacity = capacity;
+
+                // a dedicated block goes behind the current one so the current block keeps filling up
+                if( block != nullptr && capacity == size )
+                {
+                    newBlock->next = block->next;
+                    block->next = newBlock;
+                }
+                else
+                {
+                    newBlock->next = block;
+                    stripe.blocks = newBlock;
+                }
+
+                block = newBlock;
+            }
+
+            PooledStringHeader* header = reinterpret_cast<PooledStringHeader*>( reinterpret_cast<zp_uint8_t*>( block + 1 ) + block->used );
+            block->used += size;
+
+            return header;
+        }
+
+        // 0 once every id is used, ids are never given back
+        zp_uint32_t ReserveId()
+        {
+            zp_uint32_t id = Atomic::LoadAcquire( &s_stringPool.nextId );
+            for( ;; )
+            {
+                if( id + 1 >= kStringPoolMaxIds )
+                {
+                    return 0;
+                }
+
+                const zp_uint32_t prevId = Atomic::CompareExchange( &s_stringPool.nextId, id + 1, id );
+                if( prevId == id )
+                {
+                    return id + 1;
+                }
+
+                id = prevId;
+            }
+        }
+
+        void RegisterId( const PooledStringHeader* header )
+        {
+            const zp_size_t pageIndex = header->id / kStringPoolIdPageSize;
+
+            const PooledStringHeader** page = Atomic::LoadAcquirePtr( &s_stringPool.idPages[ pageIndex ] );
+            if( page == nullptr )
+            {
+                AcquireStringPoolLock( &s_stringPool.idPageLock );
+
+                page = s_stringPool.idPages[ pageIndex ];
+                if( page == nullptr )
+                {
+                    page = ZP_MALLOC_T_ARRAY( kStringPoolMemoryLabel, const PooledStringHeader*, kStringPoolIdPageSize );
+                    zp_zero_memory_array( page, kStringPoolIdPageSize );
+
+                    Atomic::StoreReleasePtr( &s_stringPool.idPages[ pageIndex ], page );
+                }
+
+                ReleaseStringPoolLock( &s_stringPool.idPageLock );
+            }
+
+            // FromId can read the slot from any thread without the stripe lock
+            Atomic::StoreReleasePtr( &page[ header->id % kStringPoolIdPageSize ], header );
+        }
+    }
+
+    PooledString PooledString::Intern( const String& str )
+    {
+        return Intern( str.c_str(), str.length() );
+    }
+
+    PooledString PooledString::Intern( const char* str )
+    {
+        return Intern( str, zp_strlen( str ) );
+    }
+
+    PooledString PooledString::Intern( const char* str, zp_size_t length )
+    {
+        if( str == nullptr || length == 0 )
+        {
+            return {};
+        }
+
+        ZP_ASSERT( length <= 0xFFFFFFFFu );
+
+        const zp_char8_t* text = reinterpret_cast<const zp_char8_t*>( str );
+        const zp_hash64_t hash = zp_fnv64_1a( text, length );
+
+        StringPoolStripe& stripe = StripeFor( hash );
+        AcquireStringPoolLock( &stripe.lock );
+
+        const PooledStringHeader* header = FindLocked( stripe, hash, text, length );
+        if( header == nullptr )
+        {
+            const zp_uint32_t id = ReserveId();
+            if( id == 0 )
+            {
+                ReleaseStringPoolLock( &stripe.lock );
+
+                ZP_ASSERT_MSG( false, "String pool is out of ids" );
+                return {};
+            }
+
+            // keep at most 3/4 of the table full
+            if( ( stripe.count + 1 ) * 4 > stripe.capacity * 3 )
+            {
+                GrowTableLocked( stripe );
+            }
+
+            PooledStringHeader* newHeader = AllocateLocked( stripe, length );
+            newHeader->hash = hash;
+            newHeader->id = id;
+            newHeader->length = static_cast<zp_uint32_t>( length );
+
+            zp_uint8_t* newText = reinterpret_cast<zp_uint8_t*>( newHeader + 1 );
+            zp_memcpy( newText, length, text, length );
+            newText[ length ] = '\0';
+
+            RegisterId( newHeader );
+            InsertLocked( stripe, newHeader );
+
+            header = newHeader;
+        }
+
+        ReleaseStringPoolLock( &stripe.lock );
+
+        return PooledString( header );
+    }
+
+    zp_bool_t PooledString::TryFind( const String& str, PooledString& pooledString )
+    {
+        if( str.empty() )
+        {
+            pooledString = {};
+            return true;
+        }
+
+        const zp_hash64_t hash = zp_fnv64_1a( str.str(), str.length() );
+
+        StringPoolStripe& stripe = StripeFor( hash );
+        AcquireStringPoolLock( &stripe.lock );
+
+        const PooledStringHeader* header = FindLocked( stripe, hash, str.str(), str.length() );
+
+        ReleaseStringPoolLock( &stripe.lock );
+
+        if( header != nullptr )
+        {
+            pooledString = PooledString( header );
+        }
+
+        return header != nullptr;
+    }
+
+    PooledString PooledString::FromId( zp_uint32_t id )
+    {
+        if( id == 0 )
+        {
+            return {};
+        }
+
+        const PooledStringHeader* const* page = id < kStringPoolMaxIds ? Atomic::LoadAcquirePtr( &s_stringPool.idPages[ id / kStringPoolIdPageSize ] ) : nullptr;
+        const PooledStringHeader* header = page != nullptr ? Atomic::LoadAcquirePtr( &page[ id % kStringPoolIdPageSize ] ) : nullptr;
+        ZP_ASSERT_MSG( header != nullptr, "Id was never handed out by the string pool" );
+
+        return header != nullptr ? PooledString( header ) : PooledString {};
+    }
+
+    zp_size_t PooledString::GetPooledCount()
+    {
+        return Atomic::LoadAcquire( &s_stringPool.nextId );
+    }
+
+    void PooledString::DestroyPool()
+    {
+        for( StringPoolStripe& stripe : s_stringPool.stripes )
+        {
+            for( StringPoolBlock* block = stripe.blocks; block != nullptr; )
+            {
+                StringPoolBlock* next = block->next;
+                ZP_FREE( kStringPoolMemoryLabel, block );
+                block = next;
+            }
+
+            if( stripe.table != nullptr )
+            {
+                ZP_FREE( kStringPoolMemoryLabel, stripe.table );
+            }
+
+            stripe = {};
+        }
+
+        for( const PooledStringHeader**& page : s_stringPool.idPages )
+        {
+            if( page != nullptr )
+            {
+                ZP_FREE( kStringPoolMemoryLabel, page );
+                page = nullptr;
+            }
+        }
+
+        s_stringPool.nextId = 0;
+    }
+}
+
+//
+//
+//
+
 zp_int32_t zp_strcmp( const zp::String& lh, const zp::String& rh )
 {
     return zp_strcmp( lh.str(), lh.length(), rh.str(), rh.length() );
@@ -269,3 +621,254 @@ const char* zp_strnstr( const zp::String& str, const zp::String& find )
 {
     return zp_strnstr( str.c_str(), str.length(), find.c_str(), find.length() );
 }
+
+#if ZP_USE_TESTS
+#include "Test/Test.h"
+#include "Core/Map.h"
+
+using namespace zp;
+
+ZP_TEST_GROUP( String )
+{
+    ZP_TEST_SUITE( PooledString )
+    {
+        namespace
+        {
+            constexpr zp_uint32_t kTestMaxThreads = 8;
+            constexpr zp_size_t kTestStringCount = 2048;
+
+            struct InternTestContext
+            {
+                zp_uint32_t ids[ kTestMaxThreads ][ kTestStringCount ];
+                zp_uint32_t started;
+                zp_uint32_t threadIndex;
+                zp_uint32_t mismatches;
+            };
+
+            zp_uint32_t InternThreadFunc( void* threadData )
+            {
+                InternTestContext* ctx = static_cast<InternTestContext*>( threadData );
+
+                const zp_uint32_t threadIndex = Atomic::Increment( &ctx->threadIndex ) - 1;
+
+                Atomic::Increment( &ctx->started );
+                while( Atomic::LoadAcquire( &ctx->started ) < kTestMaxThreads )
+                {
+                    Platform::YieldCurrentThread();
+                }
+
+                // every thread pools every string, in a different order per thread
+                for( zp_size_t n = 0; n < kTestStringCount; ++n )
+                {
+                    const zp_size_t i = ( n * ( threadIndex * 2 + 1 ) ) % kTestStringCount;
+
+                    char text[ 64 ];
+                    const zp_int32_t length = zp_snprintf( text, "thread/intern/%zu", i );
+
+                    const PooledString pooled = PooledString::Intern( text, length );
+                    if( zp_strcmp( pooled.c_str(), text ) != 0 )
+                    {
+                        Atomic::Increment( &ctx->mismatches );
+                    }
+
+                    ctx->ids[ threadIndex ][ i ] = pooled.id();
+                }
+
+                return 0;
+            }
+        }
+
+        ZP_TEST( SameTextSamePointer )
+        {
+            const char path[] = "assets/shaders/basic.shader";
+            char copy[ sizeof( path ) ];
+            zp_memcpy( copy, sizeof( copy ), path, sizeof( path ) );
+
+            const PooledString a = PooledString::Intern( path );
+            const PooledString b = PooledString::Intern( String::As( copy ) );
+
+            ZP_CHECK_EQUALS( a == b, true );
+            ZP_CHECK_EQUALS( a.str(), b.str() );
+            ZP_CHECK_EQUALS( a.id(), b.id() );
+            ZP_CHECK_EQUALS( a.length(), sizeof( path ) - 1 );
+            ZP_CHECK_EQUALS( a.hash(), zp_fnv64_1a( static_cast<const void*>( path ), sizeof( path ) - 1 ) );
+            ZP_CHECK_EQUALS( zp_strcmp( a.c_str(), path ), 0 );
+
+            // prefixes are different strings
+            const PooledString prefix = PooledString::Intern( path, 6 );
+
+            ZP_CHECK_EQUALS( prefix != a, true );
+            ZP_CHECK_NOT_EQUALS( prefix.id(), a.id() );
+            ZP_CHECK_EQUALS( zp_strcmp( prefix.c_str(), "assets" ), 0 );
+        }
+
+        ZP_TEST( EmptyString )
+        {
+            const PooledString empty = PooledString::Intern( "" );
+
+            ZP_CHECK_EQUALS( empty == PooledString(), true );
+            ZP_CHECK_EQUALS( empty.empty(), true );
+            ZP_CHECK_EQUALS( empty.id(), 0 );
+            ZP_CHECK_EQUALS( empty.length(), 0 );
+            ZP_CHECK_EQUALS( empty.hash(), PooledString::kEmptyHash );
+            ZP_CHECK_EQUALS( zp_strcmp( empty.c_str(), "" ), 0 );
+            ZP_CHECK_EQUALS( PooledString::FromId( 0 ) == empty, true );
+        }
+
+        ZP_TEST( TryFindAndFromId )
+        {
+            PooledString found;
+            ZP_CHECK_EQUALS( PooledString::TryFind( String::As( "never/pooled/before" ), found ), false );
+
+            const PooledString pooled = PooledString::Intern( "never/pooled/before" );
+
+            ZP_CHECK_EQUALS( PooledString::TryFind( String::As( "never/pooled/before" ), found ), true );
+            ZP_CHECK_EQUALS( found == pooled, true );
+            ZP_CHECK_EQUALS( PooledString::FromId( pooled.id() ) == pooled, true );
+        }
+
+        ZP_TEST( MapKey )
+        {
+            Map<PooledString, zp_int32_t> map( MemoryLabels::Default );
+
+            map.set( PooledString::Intern( "Transform" ), 1 );
+            map.set( PooledString::Intern( "Camera" ), 2 );
+
+            zp_int32_t value = 0;
+            ZP_CHECK_EQUALS( map.tryGet( PooledString::Intern( "Camera" ), value ), true );
+            ZP_CHECK_EQUALS( value, 2 );
+            ZP_CHECK_EQUALS( map.containsKey( PooledString::Intern( "Light" ) ), false );
+        }
+
+        ZP_TEST( InternFromManyThreads )
+        {
+            InternTestContext* ctx = ZP_MALLOC_T( MemoryLabels::Default, InternTestContext );
+            zp_zero_memory( ctx );
+
+            ThreadHandle threadHandles[ kTestMaxThreads ];
+            for( ThreadHandle& threadHandle : threadHandles )
+            {
+                zp_uint32_t threadId;
+                threadHandle = Platform::CreateThread( InternThreadFunc, ctx, 64 KB, &threadId );
+            }
+
+            Platform::JoinThreads( threadHandles, kTestMaxThreads );
+
+            for( ThreadHandle threadHandle : threadHandles )
+            {
+                Platform::CloseThread( threadHandle );
+            }
+
+            // every thread has to see the same pooled string for the same text
+            zp_size_t agreed = 0;
+            for( zp_size_t i = 0; i < kTestStringCount; ++i )
+            {
+                zp_bool_t same = ctx->ids[ 0 ][ i ] != 0;
+                for( zp_uint32_t t = 1; t < kTestMaxThreads; ++t )
+                {
+                    same &= ctx->ids[ t ][ i ] == ctx->ids[ 0 ][ i ];
+                }
+
+                agreed += same ? 1 : 0;
+            }
+
+            ZP_CHECK_EQUALS( ctx->mismatches, 0 );
+            ZP_CHECK_EQUALS( agreed, kTestStringCount );
+
+            ZP_FREE( MemoryLabels::Default, ctx );
+        }
+    }
+
+#if ZP_USE_BENCHMARKS
+    ZP_TEST_SUITE( PooledStringBenchmark )
+    {
+        namespace
+        {
+            constexpr zp_size_t kKeyCount = 4096;
+            constexpr zp_size_t kLookupCount = 1000000;
+
+            zp_float64_t TicksToMilliseconds( zp_time_t ticks )
+            {
+                return static_cast<zp_float64_t>( ticks ) * 1000.0 / static_cast<zp_float64_t>( Platform::TimeFrequency() );
+            }
+
+            struct TextKey
+            {
+                char text[ 64 ];
+                zp_size_t length;
+            };
+        }
+
+        // asset path style keys, looked up by hashing and comparing the text versus by pooled string
+        ZP_TEST( TextVersusPooledLookup )
+        {
+            TextKey* keys = ZP_MALLOC_T_ARRAY( MemoryLabels::Default, TextKey, kKeyCount );
+            PooledString* pooledKeys = ZP_MALLOC_T_ARRAY( MemoryLabels::Default, PooledString, kKeyCount );
+
+            Map<zp_hash64_t, zp_size_t> textMap( MemoryLabels::Default );
+            Map<PooledString, zp_size_t> pooledMap( MemoryLabels::Default );
+
+            for( zp_size_t i = 0; i < kKeyCount; ++i )
+            {
+                keys[ i ].length = zp_snprintf( keys[ i ].text, "assets/textures/environment/rock_cliff_%04zu_albedo.png", i );
+                pooledKeys[ i ] = PooledString::Intern( keys[ i ].text, keys[ i ].length );
+
+                textMap.set( zp_fnv64_1a( static_cast<const void*>( keys[ i ].text ), keys[ i ].length ), i );
+                pooledMap.set( pooledKeys[ i ], i );
+            }
+
+            zp_uint64_t rng = 0x9E3779B97F4A7C15ull;
+            zp_size_t textFound = 0;
+            zp_size_t pooledFound = 0;
+
+            zp_time_t start = Platform::TimeNow();
+
+            for( zp_size_t n = 0; n < kLookupCount; ++n )
+            {
+                rng ^= rng << 13;
+                rng ^= rng >> 7;
+                rng ^= rng << 17;
+
+                const TextKey& key = keys[ rng % kKeyCount ];
+
+                // hashed text has to be compared again to rule out a collision
+                zp_size_t index;
+                if( textMap.tryGet( zp_fnv64_1a( static_cast<const void*>( key.text ), key.length ), index ) && zp_strcmp( keys[ index ].text, keys[ index ].length, key.text, key.length ) == 0 )
+                {
+                    ++textFound;
+                }
+            }
+
+            const zp_float64_t textMS = TicksToMilliseconds( Platform::TimeNow() - start );
+
+            rng = 0x9E3779B97F4A7C15ull;
+            start = Platform::TimeNow();
+
+            for( zp_size_t n = 0; n < kLookupCount; ++n )
+            {
+                rng ^= rng << 13;
+                rng ^= rng >> 7;
+                rng ^= rng << 17;
+
+                zp_size_t index;
+                if( pooledMap.tryGet( pooledKeys[ rng % kKeyCount ], index ) )
+                {
+                    ++pooledFound;
+                }
+            }
+
+            const zp_float64_t pooledMS = TicksToMilliseconds( Platform::TimeNow() - start );
+
+            zp_printfln( "[BENCH] %zu lookups over %zu paths: text %.3f ms (%.1f ns/op), pooled %.3f ms (%.1f ns/op)",
+                kLookupCount, kKeyCount, textMS, textMS * 1000000.0 / kLookupCount, pooledMS, pooledMS * 1000000.0 / kLookupCount );
+
+            ZP_CHECK_EQUALS( textFound, kLookupCount );
+            ZP_CHECK_EQUALS( pooledFound, kLookupCount );
+
+            ZP_FREE( MemoryLabels::Default, pooledKeys );
+            ZP_FREE( MemoryLabels::Default, keys );
+        }
+    }
+#endif // ZP_USE_BENCHMARKS
+}
+#endif
@@ -0,0 +1,155 @@
+//
+// Created by phosg on 10/16/2026.
+//
+
+#include "Core/Task.h"
+#include "Core/Job.h"
+#include "Core/Common.h"
+#include "Core/Types.h"
+
+namespace zp
+{
+    namespace
+    {
+        struct TaskResumeJob
+        {
+            void* coroutineAddress;
+
+            static void Execute( const JobWorkArgs& args )
+            {
+                const TaskResumeJob* data = args.jobMemory.as<TaskResumeJob>();
+                std::coroutine_handle<>::from_address( data->coroutineAddress ).resume();
+            }
+        };
+    }
+
+    JobHandle TaskPromiseBase::start( void* coroutineAddress, JobPriority priority )
+    {
+        ZP_ASSERT( !isStarted() );
+
+        const JobHandle completion = JobSystem::PrepareSignal( priority );
+
+        m_completion = completion;
+        m_priority = priority;
+
+        JobSystem::Start( TaskResumeJob { .coroutineAddress = coroutineAddress }, priority );
+
+        return completion;
+    }
+
+    void TaskPromiseBase::ResumeAfter( void* coroutineAddress, JobHandle dependency, JobPriority priority )
+    {
+        TaskResumeJob resumeJob { .coroutineAddress = coroutineAddress };
+
+        JobSystem::StartAfter( Memory { &resumeJob, sizeof( TaskResumeJob ) }, TaskResumeJob::Execute, dependency, priority );
+    }
+}
+
+#if ZP_USE_TESTS
+#include "Test/Test.h"
+#include "Core/Atomic.h"
+
+using namespace zp;
+
+ZP_TEST_GROUP( Task )
+{
+    ZP_TEST_SUITE( Task )
+    {
+        namespace
+        {
+            zp_int32_t s_jobRunCount;
+
+            void CountJob( const JobWorkArgs& args )
+            {
+                Atomic::Increment( &s_jobRunCount );
+            }
+
+            Task<zp_int32_t> AwaitJobTask()
+            {
+                co_await JobSystem::Execute( JobWorkFunc::from_function( CountJob ) );
+
+                co_return Atomic::Add( &s_jobRunCount, 0 );
+            }
+
+            Task<zp_int32_t> AddTask( zp_int32_t a, zp_int32_t b )
+            {
+                co_return a + b;
+            }
+
+            Task<zp_int32_t> NestedTask()
+            {
+                const zp_int32_t x = co_await AddTask( 1, 2 );
+                const zp_int32_t y = co_await AddTask( x, 3 );
+
+                co_return y;
+            }
+
+            Task<> CountAfterJobTask()
+            {
+                co_await JobSystem::Execute( JobWorkFunc::from_function( CountJob ) );
+
+                Atomic::Increment( &s_jobRunCount );
+            }
+        }
+
+        ZP_TEST( AwaitJobHandle )
+        {
+            s_jobRunCount = 0;
+
+            Task<zp_int32_t> task = AwaitJobTask();
+            ZP_CHECK_EQUALS( task.isStarted(), false );
+
+            ZP_CHECK_EQUALS( task.get(), 1 );
+        }
+
+        ZP_TEST( AwaitNestedTasks )
+        {
+            Task<zp_int32_t> task = NestedTask();
+
+            ZP_CHECK_EQUALS( task.get(), 6 );
+        }
+
+        ZP_TEST( GetTemporaryTaskByValue )
+        {
+            // the task is destroyed before the value is used
+            const zp_int32_t value = AddTask( 2, 3 ).get();
+
+            ZP_CHECK_EQUALS( value, 5 );
+        }
+
+        ZP_TEST( ManyTasksInFlight )
+        {
+            constexpr zp_size_t kTaskCount = 256;
+
+            s_jobRunCount = 0;
+
+            Task<> tasks[kTaskCount];
+            for( Task<>& task : tasks )
+            {
+                task = CountAfterJobTask();
+                task.start();
+            }
+
+            for( Task<>& task : tasks )
+            {
+                JobSystem::Complete( task.handle() );
+            }
+
+            ZP_CHECK_EQUALS( s_jobRunCount, static_cast<zp_int32_t>( kTaskCount * 2 ) );
+        }
+
+        ZP_TEST( FrameRecycledOnSameThread )
+        {
+            void* frame = JobSystem::AllocateTaskFrame( 200 );
+            JobSystem::FreeTaskFrame( frame, 200 );
+
+            // same size class comes straight back off the local free list
+            void* recycledFrame = JobSystem::AllocateTaskFrame( 180 );
+            JobSystem::FreeTaskFrame( recycledFrame, 180 );
+
+            ZP_CHECK_EQUALS( frame, recycledFrame );
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,200 @@
+//
+// Created by phosg on 10/16/2026.
+//
+
+#include "Core/Vector.h"
+
+#if ZP_USE_TESTS
+#include "Test/Test.h"
+#include "Platform/Platform.h"
+
+using namespace zp;
+
+ZP_TEST_GROUP( Vector )
+{
+    namespace
+    {
+        zp_size_t s_allocationCount;
+        zp_size_t s_freeCount;
+
+        struct CountingAllocator
+        {
+            [[nodiscard]] void* allocate( zp_size_t size ) const
+            {
+                ++s_allocationCount;
+                return ZP_MALLOC( MemoryLabels::Default, size );
+            }
+
+            void free( void* ptr ) const
+            {
+                ++s_freeCount;
+                ZP_FREE( MemoryLabels::Default, ptr );
+            }
+        };
+
+        template<typename T, zp_size_t Size>
+        using CountingSmallVector = Vector<T, SmallMemoryVectorAllocator<Size, T, CountingAllocator>>;
+
+        void ResetAllocationCounts()
+        {
+            s_allocationCount = 0;
+            s_freeCount = 0;
+        }
+    }
+
+    ZP_TEST_SUITE( SmallVector )
+    {
+        ZP_TEST( InlineUntilFull )
+        {
+            ResetAllocationCounts();
+
+            {
+                CountingSmallVector<zp_int32_t, 8> vector;
+
+                for( zp_int32_t i = 0; i < 8; ++i )
+                {
+                    vector.pushBack( i );
+                }
+
+                ZP_CHECK_EQUALS( s_allocationCount, 0 );
+                ZP_CHECK_EQUALS( vector.length(), 8 );
+
+                // the 9th element spills everything to the fallback allocator
+                vector.pushBack( 8 );
+
+                ZP_CHECK_EQUALS( s_allocationCount, 1 );
+
+                zp_size_t matches = 0;
+                for( zp_int32_t i = 0; i < 9; ++i )
+                {
+                    matches += vector[ i ] == i ? 1 : 0;
+                }
+
+                ZP_CHECK_EQUALS( matches, 9 );
+
+                // after destroy the inline storage is used again
+                vector.destroy();
+                vector.pushBack( 1 );
+
+                ZP_CHECK_EQUALS( s_allocationCount, 1 );
+                ZP_CHECK_EQUALS( s_freeCount, 1 );
+            }
+
+            ZP_CHECK_EQUALS( s_freeCount, 1 );
+        }
+
+        ZP_TEST( MoveInlineAndSpilled )
+        {
+            ResetAllocationCounts();
+
+            CountingSmallVector<zp_int32_t, 4> inlineVector;
+            inlineVector.pushBack( 1 );
+            inlineVector.pushBack( 2 );
+
+            // inline elements are moved into the new vector's own storage
+            CountingSmallVector<zp_int32_t, 4> movedInline( zp_move( inlineVector ) );
+
+            ZP_CHECK_EQUALS( movedInline.length(), 2 );
+            ZP_CHECK_EQUALS( movedInline[ 1 ], 2 );
+            ZP_CHECK_EQUALS( inlineVector.length(), 0 );
+            ZP_CHECK_NOT_EQUALS( movedInline.data(), inlineVector.data() );
+
+            CountingSmallVector<zp_int32_t, 4> spilledVector;
+            for( zp_int32_t i = 0; i < 10; ++i )
+            {
+                spilledVector.pushBack( i );
+            }
+
+            ZP_CHECK_NOT_EQUALS( s_allocationCount, 0 );
+
+            // spilled storage changes owners without copying
+            const zp_size_t spilledAllocationCount = s_allocationCount;
+            const zp_int32_t* spilledData = spilledVector.data();
+            CountingSmallVector<zp_int32_t, 4> movedSpilled;
+            movedSpilled = zp_move( spilledVector );
+
+            ZP_CHECK_EQUALS( movedSpilled.data(), spilledData );
+            ZP_CHECK_EQUALS( movedSpilled.length(), 10 );
+            ZP_CHECK_EQUALS( spilledVector.length(), 0 );
+            ZP_CHECK_EQUALS( s_allocationCount, spilledAllocationCount );
+        }
+
+        ZP_TEST( CopyIsDeep )
+        {
+            SmallVector<zp_int32_t, 4> vector( MemoryLabels::Default );
+            vector.pushBack( 7 );
+            vector.pushBack( 9 );
+
+            SmallVector<zp_int32_t, 4> copy( vector );
+            copy[ 0 ] = 1;
+
+            ZP_CHECK_EQUALS( vector[ 0 ], 7 );
+            ZP_CHECK_EQUALS( copy[ 0 ], 1 );
+            ZP_CHECK_EQUALS( copy[ 1 ], 9 );
+            ZP_CHECK_NOT_EQUALS( copy.data(), vector.data() );
+        }
+    }
+
+#if ZP_USE_BENCHMARKS
+    ZP_TEST_SUITE( SmallVectorBenchmark )
+    {
+        namespace
+        {
+            constexpr zp_size_t kListCount = 100000;
+
+            // mostly short lists with the odd long one, like component lists or per-asset argument lists
+            zp_size_t NextListLength( zp_uint64_t& rng )
+            {
+                rng ^= rng << 13;
+                rng ^= rng >> 7;
+                rng ^= rng << 17;
+
+                return ( rng % 16 ) == 0 ? 32 + ( rng % 32 ) : rng % 12;
+            }
+
+            template<typename V>
+            void RunShortListBenchmark( const char* name )
+            {
+                ResetAllocationCounts();
+
+                zp_uint64_t rng = 0x9E3779B97F4A7C15ull;
+                zp_uint64_t checksum = 0;
+
+                const zp_time_t start = Platform::TimeNow();
+
+                for( zp_size_t i = 0; i < kListCount; ++i )
+                {
+                    V list;
+
+                    const zp_size_t length = NextListLength( rng );
+                    for( zp_size_t j = 0; j < length; ++j )
+                    {
+                        list.pushBack( static_cast<zp_uint32_t>( i + j ) );
+                    }
+
+                    for( const zp_uint32_t value : list )
+                    {
+                        checksum += value;
+                    }
+                }
+
+                const zp_time_t elapsed = Platform::TimeNow() - start;
+                const zp_float64_t elapsedMS = static_cast<zp_float64_t>( elapsed ) * 1000.0 / static_cast<zp_float64_t>( Platform::TimeFrequency() );
+
+                zp_printfln( "[BENCH] %zu short lists %s: %zu allocations, %zu frees, %.3f ms (checksum %llu)",
+                    kListCount, name, s_allocationCount, s_freeCount, elapsedMS, checksum );
+            }
+        }
+
+        ZP_TEST( ShortListAllocations )
+        {
+            RunShortListBenchmark<Vector<zp_uint32_t, CountingAllocator>>( "Vector" );
+            RunShortListBenchmark<CountingSmallVector<zp_uint32_t, 8>>( "SmallVector<8>" );
+            RunShortListBenchmark<CountingSmallVector<zp_uint32_t, 16>>( "SmallVector<16>" );
+
+            ZP_CHECK_EQUALS( s_allocationCount, s_freeCount );
+        }
+    }
+#endif // ZP_USE_BENCHMARKS
+}
+#endif
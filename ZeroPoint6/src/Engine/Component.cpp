@@ -247,7 +247,7 @@ namespace zp
         , m_registeredTags( 0 )
         , m_components {}
         , m_tags {}
-        , m_componentArchetypes( 16, memoryLabel )
+        , m_componentArchetypes( memoryLabel )
         , memoryLabel( memoryLabel )
     {
     }
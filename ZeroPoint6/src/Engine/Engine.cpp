@@ -327,7 +327,7 @@ namespace zp
 
                 engine->advanceFrame();
 
-                JobSystem::Start( BeginEngineJob { .engine = engine } );
+                JobSystem::Start( BeginEngineJob { .engine = engine }, JobPriority::FrameCritical );
             }
         };
 
@@ -343,7 +343,7 @@ namespace zp
 
                 engine->submitToGPU();
 
-                JobSystem::Start( AdvanceFrameJob { .engine = engine } );
+                JobSystem::Start( AdvanceFrameJob { .engine = engine }, JobPriority::FrameCritical );
             }
         };
 
@@ -359,7 +359,7 @@ namespace zp
 
                 engine->update();
 
-                JobSystem::Start( SyncGPUEngineJob { .engine = engine } );
+                JobSystem::Start( SyncGPUEngineJob { .engine = engine }, JobPriority::FrameCritical );
             }
         };
 
@@ -369,7 +369,7 @@ namespace zp
 
             Engine* engine = args.jobMemory.as<BeginEngineJob>()->engine;
 
-            JobSystem::Start( UpdateEngineJob { .engine = engine } );
+            JobSystem::Start( UpdateEngineJob { .engine = engine }, JobPriority::FrameCritical );
         }
 
         struct InitialEngineJob
@@ -384,7 +384,7 @@ namespace zp
 
                 Engine* engine = args.jobMemory.as<InitialEngineJob>()->engine;
 
-                JobSystem::Start( BeginEngineJob { .engine = engine } );
+                JobSystem::Start( BeginEngineJob { .engine = engine }, JobPriority::FrameCritical );
             }
         };
     } // namespace
@@ -396,7 +396,7 @@ namespace zp
             m_moduleAPI->onEngineStarted( this );
         }
 
-        JobSystem::Start( InitialEngineJob { .engine = this } );
+        JobSystem::Start( InitialEngineJob { .engine = this }, JobPriority::FrameCritical );
     }
 
     void Engine::stopEngine()
@@ -809,6 +809,13 @@ namespace zp
 
         ZP_PROFILE_ADVANCE_FRAME( m_frameCount );
 
+        // jobs from the frame before this one can still be using the PreviousFrame memory about to be reset
+        JobSystem::AdvanceFrame();
+        AdvanceFrameAllocators();
+
+        // soft budget callbacks run here, between frames
+        ProcessMemoryPressure();
+
         m_frameStartTime = Platform::TimeNow();
         ++m_frameCount;
     }
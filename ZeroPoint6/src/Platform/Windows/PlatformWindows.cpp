@@ -848,6 +848,57 @@ namespace zp
         ::VirtualFree( ptr, size, MEM_DECOMMIT );
     }
 
+    namespace
+    {
+        zp_size_t EnableLargeMemoryPages()
+        {
+            const zp_size_t largePageSize = ::GetLargePageMinimum();
+            if( largePageSize == 0 )
+            {
+                return 0;
+            }
+
+            HANDLE token;
+            if( ::OpenProcessToken( ::GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &token ) == FALSE )
+            {
+                return 0;
+            }
+
+            TOKEN_PRIVILEGES privileges {};
+            privileges.PrivilegeCount = 1;
+            privileges.Privileges[ 0 ].Attributes = SE_PRIVILEGE_ENABLED;
+
+            zp_bool_t enabled = ::LookupPrivilegeValue( nullptr, SE_LOCK_MEMORY_NAME, &privileges.Privileges[ 0 ].Luid ) != FALSE;
+            if( enabled )
+            {
+                // succeeds without enabling anything when the account doesn't hold the privilege
+                enabled = ::AdjustTokenPrivileges( token, FALSE, &privileges, 0, nullptr, nullptr ) != FALSE && ::GetLastError() == ERROR_SUCCESS;
+            }
+
+            ::CloseHandle( token );
+
+            return enabled ? largePageSize : 0;
+        }
+    }
+
+    zp_size_t Platform::GetLargeMemoryPageSize()
+    {
+        static const zp_size_t s_largePageSize = EnableLargeMemoryPages();
+        return s_largePageSize;
+    }
+
+    void* Platform::AllocateLargeMemoryPages( const zp_size_t size )
+    {
+        const zp_size_t largePageSize = GetLargeMemoryPageSize();
+        if( largePageSize == 0 )
+        {
+            return nullptr;
+        }
+
+        void* ptr = ::VirtualAlloc( nullptr, zp_align_size( size, largePageSize ), MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE );
+        return ptr;
+    }
+
     zp_size_t Platform::GetCurrentDir( char* path, zp_size_t maxPathLength )
     {
         const zp_size_t length = ::GetCurrentDirectory( 0, nullptr );
@@ -1290,6 +1341,28 @@ namespace zp
         }
     }
 
+    void Platform::SetThreadIdealProcessor( const ThreadHandle threadHandle, const ProcessorInfo& processor )
+    {
+        const DWORD groupProcessorCount = ::GetActiveProcessorCount( processor.group );
+        if( groupProcessorCount == 0 )
+        {
+            return;
+        }
+
+        // threads start in the creating thread's group, the ideal processor is rejected unless the thread is moved first
+        const GROUP_AFFINITY groupAffinity {
+            .Mask = groupProcessorCount >= 64 ? ~static_cast<KAFFINITY>( 0 ) : ( static_cast<KAFFINITY>( 1 ) << groupProcessorCount ) - 1,
+            .Group = processor.group,
+        };
+        ::SetThreadGroupAffinity( threadHandle.handle, &groupAffinity, nullptr );
+
+        PROCESSOR_NUMBER processorNumber {
+            .Group = processor.group,
+            .Number = processor.number,
+        };
+        ::SetThreadIdealProcessorEx( threadHandle.handle, &processorNumber, nullptr );
+    }
+
     void Platform::CloseThread( const ThreadHandle threadHandle )
     {
         ::CloseHandle( threadHandle.handle );
@@ -1313,6 +1386,116 @@ namespace zp
         return systemInfo.dwNumberOfProcessors;
     }
 
+    namespace
+    {
+        void AssignProcessorGroupMask( ProcessorInfo* processors, zp_uint32_t processorCount, const GROUP_AFFINITY& groupMask, zp_uint32_t ProcessorInfo::* field, zp_uint32_t value )
+        {
+            for( zp_uint32_t i = 0; i < processorCount; ++i )
+            {
+                ProcessorInfo& processor = processors[ i ];
+                if( processor.group == groupMask.Group && ( groupMask.Mask & ( static_cast<KAFFINITY>( 1 ) << processor.number ) ) != 0 )
+                {
+                    processor.*field = value;
+                }
+            }
+        }
+
+        template<typename Func>
+        void ForEachLogicalProcessorInformation( zp_uint8_t* buffer, DWORD length, LOGICAL_PROCESSOR_RELATIONSHIP relationship, Func func )
+        {
+            for( DWORD offset = 0; offset < length; )
+            {
+                const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX* info = reinterpret_cast<const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>( buffer + offset );
+                if( info->Relationship == relationship )
+                {
+                    func( *info );
+                }
+
+                offset += info->Size;
+            }
+        }
+    } // namespace
+
+    zp_uint32_t Platform::GetProcessorTopology( ProcessorInfo* processors, zp_uint32_t maxProcessorCount )
+    {
+        DWORD length = 0;
+        ::GetLogicalProcessorInformationEx( RelationAll, nullptr, &length );
+        if( length == 0 )
+        {
+            return 0;
+        }
+
+        zp_uint8_t* buffer = static_cast<zp_uint8_t*>( ::HeapAlloc( ::GetProcessHeap(), 0, length ) );
+        if( !::GetLogicalProcessorInformationEx( RelationAll, reinterpret_cast<SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>( buffer ), &length ) )
+        {
+            ::HeapFree( ::GetProcessHeap(), 0, buffer );
+            return 0;
+        }
+
+        // one entry per logical processor, hardware threads of the same core are adjacent
+        zp_uint32_t processorCount = 0;
+        zp_uint32_t coreIndex = 0;
+        ForEachLogicalProcessorInformation( buffer, length, RelationProcessorCore, [ & ]( const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX& info )
+        {
+            zp_uint8_t smtIndex = 0;
+            for( WORD g = 0; g < info.Processor.GroupCount; ++g )
+            {
+                const GROUP_AFFINITY& groupMask = info.Processor.GroupMask[ g ];
+                for( zp_uint8_t number = 0; number < 64; ++number )
+                {
+                    if( ( groupMask.Mask & ( static_cast<KAFFINITY>( 1 ) << number ) ) != 0 )
+                    {
+                        if( processorCount < maxProcessorCount )
+                        {
+                            processors[ processorCount ] = {
+                                .group = groupMask.Group,
+                                .number = number,
+                                .smtIndex = smtIndex,
+                                .coreIndex = coreIndex,
+                            };
+                        }
+
+                        ++processorCount;
+                        ++smtIndex;
+                    }
+                }
+            }
+
+            ++coreIndex;
+        } );
+
+        // group by the last level cache (L3 on desktop parts, L2 on some mobile and server parts)
+        BYTE lastCacheLevel = 0;
+        ForEachLogicalProcessorInformation( buffer, length, RelationCache, [ & ]( const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX& info )
+        {
+            if( info.Cache.Type == CacheUnified || info.Cache.Type == CacheData )
+            {
+                lastCacheLevel = zp_max( lastCacheLevel, info.Cache.Level );
+            }
+        } );
+
+        const zp_uint32_t writtenProcessorCount = zp_min( processorCount, maxProcessorCount );
+
+        zp_uint32_t cacheIndex = 0;
+        ForEachLogicalProcessorInformation( buffer, length, RelationCache, [ & ]( const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX& info )
+        {
+            if( info.Cache.Level == lastCacheLevel && ( info.Cache.Type == CacheUnified || info.Cache.Type == CacheData ) )
+            {
+                AssignProcessorGroupMask( processors, writtenProcessorCount, info.Cache.GroupMask, &ProcessorInfo::cacheIndex, cacheIndex );
+                ++cacheIndex;
+            }
+        } );
+
+        ForEachLogicalProcessorInformation( buffer, length, RelationNumaNode, [ & ]( const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX& info )
+        {
+            AssignProcessorGroupMask( processors, writtenProcessorCount, info.NumaNode.GroupMask, &ProcessorInfo::numaNode, info.NumaNode.NodeNumber );
+        } );
+
+        ::HeapFree( ::GetProcessHeap(), 0, buffer );
+
+        return processorCount;
+    }
+
     zp_time_t Platform::TimeNow()
     {
         LARGE_INTEGER val;
@@ -1916,32 +2099,34 @@ namespace zp
 
     void Platform::GetStackTrace( StackTrace& stackTrace, const zp_uint32_t framesToSkip )
     {
-#if ZP_DEBUG
+        // capturing doesn't need symbols, only StackTraceToString does
         DWORD hash {};
         const zp_size_t capturedFrames = ::RtlCaptureStackBackTrace( 1 + framesToSkip, kMaxStackTraceDepth, stackTrace.stack, &hash );
         stackTrace.length = capturedFrames;
         stackTrace.hash = hash;
-#else
-        stackTrace = {};
-#endif
     }
 
     void Platform::StackTraceToString( const StackTrace& stackTrace, MutableString& string )
     {
 #if ZP_DEBUG
         const HANDLE process = ::GetCurrentProcess();
-        SYMBOL_INFO info {};
 
-        for( void* addr : stackTrace.stack )
+        // SYMBOL_INFO only has room for the first character of the name
+        alignas( SYMBOL_INFO ) zp_uint8_t infoBuffer[ sizeof( SYMBOL_INFO ) + MAX_SYM_NAME ] {};
+        SYMBOL_INFO* info = reinterpret_cast<SYMBOL_INFO*>( infoBuffer );
+        info->SizeOfStruct = sizeof( SYMBOL_INFO );
+        info->MaxNameLen = MAX_SYM_NAME;
+
+        for( zp_size_t i = 0; i < stackTrace.length; ++i )
         {
-            const WINBOOL ok = ::SymFromAddr( process, reinterpret_cast<DWORD64>( addr ), 0, &info );
+            const WINBOOL ok = ::SymFromAddr( process, reinterpret_cast<DWORD64>( stackTrace.stack[ i ] ), 0, info );
             if( !ok )
             {
                 PrintLastErrorMsg( "" );
                 break;
             }
 
-            string.append( info.Name, info.NameLen );
+            string.append( info->Name, info->NameLen );
             string.append( '\n' );
         }
 #endif
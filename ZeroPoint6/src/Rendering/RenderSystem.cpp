@@ -271,7 +271,7 @@ namespace zp
                     FileHandle fileHandle = Platform::OpenFileHandle( "../../ZeroPoint6/bin/Shaders/DebugColor.vert.spv", ZP_OPEN_FILE_MODE_READ );
                     zp_size_t fileSize = Platform::GetFileSize( fileHandle );
 
-                    void* memPtr = GetAllocator( MemoryLabels::FileIO )->allocate( fileSize, kDefaultMemoryAlignment );
+                    void* memPtr = GetAllocator( MemoryLabels::FileIO )->allocate( fileSize, kDefaultMemoryAlignment, MemoryLabels::FileIO );
                     zp_size_t read = Platform::ReadFile( fileHandle, memPtr, fileSize );
                     ZP_ASSERT( read == fileSize );
                     Platform::CloseFileHandle( fileHandle );
@@ -285,14 +285,14 @@ namespace zp
                     };
                     //graphicsDevice->createShader( shaderDesc, m_colorVertexShader.data() );
 
-                    GetAllocator( MemoryLabels::FileIO )->free( memPtr );
+                    GetAllocator( MemoryLabels::FileIO )->free( memPtr, MemoryLabels::FileIO );
                 }
 
                 {
                     FileHandle fileHandle = Platform::OpenFileHandle( "../../ZeroPoint6/bin/Shaders/DebugColor.frag.spv", ZP_OPEN_FILE_MODE_READ );
                     zp_size_t fileSize = Platform::GetFileSize( fileHandle );
 
-                    void* memPtr = GetAllocator( MemoryLabels::FileIO )->allocate( fileSize, kDefaultMemoryAlignment );
+                    void* memPtr = GetAllocator( MemoryLabels::FileIO )->allocate( fileSize, kDefaultMemoryAlignment, MemoryLabels::FileIO );
                     zp_size_t read = Platform::ReadFile( fileHandle, memPtr, fileSize );
                     ZP_ASSERT( read == fileSize );
                     Platform::CloseFileHandle( fileHandle );
@@ -306,7 +306,7 @@ namespace zp
                     };
                     //graphicsDevice->createShader( shaderDesc, m_colorFragmentShader.data() );
 
-                    GetAllocator( MemoryLabels::FileIO )->free( memPtr );
+                    GetAllocator( MemoryLabels::FileIO )->free( memPtr, MemoryLabels::FileIO );
                 }
             }
 
@@ -66,6 +66,9 @@ namespace zp
             String value;
         };
 
+        // 64K textures, 65536 down to 1x1, also the number of mip level offsets written below
+        constexpr zp_size_t kMaxTextureMipLevels = 17;
+
         zp_uint32_t MaxMipLevels( const Size3Du& size )
         {
             const zp_uint32_t maxSize = zp_max( size.width, size.height );
@@ -376,12 +379,12 @@ namespace zp
 
         ArenaAllocator arenaAllocator( FixedArenaMemoryStorage( MemoryLabels::Temp, 16 MB ) );
 
-        Vector<Memory> compressedMipLevels( mipLevelCount, MemoryLabels::Temp );
+        SmallVector<Memory, kMaxTextureMipLevels> compressedMipLevels( MemoryLabels::Temp );
 
         // generate all mip levels
         if( config.generateMipMaps )
         {
-            Vector<RawTextureData> allMipLevels( maxMipLevels, MemoryLabels::Temp );
+            SmallVector<RawTextureData, kMaxTextureMipLevels> allMipLevels( MemoryLabels::Temp );
 
             // add mip 0
             allMipLevels.pushBack( srcData );
@@ -443,7 +446,7 @@ namespace zp
         const zp_ptrdiff_t indexOffset = dstDataStream.write( index );
 
         // mip levels
-        FixedArray<zp_ptrdiff_t, 16> mipLevelOffsets;
+        FixedArray<zp_ptrdiff_t, kMaxTextureMipLevels> mipLevelOffsets;
         for( zp_uint32_t i = 0; i < mipLevelCount; ++i )
         {
             const KTX2Level level {};
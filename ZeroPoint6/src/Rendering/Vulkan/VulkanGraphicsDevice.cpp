@@ -1625,7 +1625,7 @@ namespace zp
         void* AllocationCallback( void* pUserData, size_t size, size_t alignment, VkSystemAllocationScope allocationScope )
         {
             auto* allocator = static_cast<IMemoryAllocator*>( pUserData );
-            void* ptr = allocator->allocate( size, alignment );
+            void* ptr = allocator->allocate( size, alignment, MemoryLabels::Graphics );
             // Log::info() << "alloc " << size << " " << alignment << " " << ptr << Log::endl;
             return ptr;
         }
@@ -1633,7 +1633,7 @@ namespace zp
         void* ReallocationCallback( void* pUserData, void* pOriginal, size_t size, size_t alignment, VkSystemAllocationScope allocationScope )
         {
             auto* allocator = static_cast<IMemoryAllocator*>( pUserData );
-            void* ptr = allocator->reallocate( pOriginal, size, alignment );
+            void* ptr = allocator->reallocate( pOriginal, size, alignment, MemoryLabels::Graphics );
             // Log::info() << "realloc " << size << " " << alignment << " " << pOriginal << "->" << ptr << Log::endl;
             return ptr;
         }
@@ -1641,7 +1641,7 @@ namespace zp
         void FreeCallback( void* pUserData, void* pMemory )
         {
             auto* allocator = static_cast<IMemoryAllocator*>( pUserData );
-            allocator->free( pMemory );
+            allocator->free( pMemory, MemoryLabels::Graphics );
             // Log::info() << "free " << pMemory << Log::endl;
         }
 
@@ -7888,15 +7888,16 @@ namespace zp
     {
         const zp_hash128_t hash = CalculateHash( createInfo );
 
-        VkDescriptorSetLayout layout;
-        if( !m_descriptorSetLayoutCache.tryGet( hash, &layout ) )
+        // jobs can race on the same layout, only one of them creates it
+        const VkDescriptorSetLayout layout = m_descriptorSetLayoutCache.getOrAdd( hash, [ this, &createInfo ]()
         {
-            VK_HR( vkCreateDescriptorSetLayout( m_vkLocalDevice, &createInfo, &m_vkAllocationCallbacks, &layout ) );
+            VkDescriptorSetLayout newLayout;
+            VK_HR( vkCreateDescriptorSetLayout( m_vkLocalDevice, &createInfo, &m_vkAllocationCallbacks, &newLayout ) );
 
-            SetDebugObjectName( m_vkInstance, m_vkLocalDevice, VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, layout, "Descriptor Set Layout #%d (%d)", m_descriptorSetLayoutCache.size(), Platform::GetCurrentThreadId() );
+            SetDebugObjectName( m_vkInstance, m_vkLocalDevice, VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, newLayout, "Descriptor Set Layout #%d (%d)", m_descriptorSetLayoutCache.size(), Platform::GetCurrentThreadId() );
 
-            m_descriptorSetLayoutCache.set( hash, layout );
-        }
+            return newLayout;
+        } );
 
         return layout;
     }
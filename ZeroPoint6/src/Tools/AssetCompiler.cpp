@@ -156,6 +156,7 @@ void AssetCompilerApplication::initialize( const String& commandLine )
         .maxCPUEventsPerThread = 128,
         .maxMemoryEventsPerThread = 128,
         .maxGPUEventsPerThread = 4,
+        .maxCounterEventsPerFrame = 256,
         .maxFramesToCapture = 120,
         .maxThreadCount = numJobThreads + 2, // main thread + socket thread
     } );
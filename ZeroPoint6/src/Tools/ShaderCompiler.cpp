@@ -1857,7 +1857,7 @@ float4 fragmentMainOld(
                                 }
 
                                 // sort feature set in descending order
-                                zp_qsort3( shaderFeature.shaderFeatures.begin(), shaderFeature.shaderFeatures.end(), zp_cmp_dsc<zp_size_t> );
+                                zp_sort( shaderFeature.shaderFeatures.begin(), shaderFeature.shaderFeatures.end(), zp_cmp_dsc<zp_size_t> );
 
                                 // generate hash from sorted list
                                 shaderFeature.shaderFeatureHash = zp_fnv64_1a( shaderFeature.shaderFeatures );
@@ -1895,7 +1895,7 @@ float4 fragmentMainOld(
                             }
 
                             // sort feature set
-                            zp_qsort3( shaderFeature.shaderFeatures.begin(), shaderFeature.shaderFeatures.end(), zp_cmp_dsc<zp_size_t> );
+                            zp_sort( shaderFeature.shaderFeatures.begin(), shaderFeature.shaderFeatures.end(), zp_cmp_dsc<zp_size_t> );
 
                             // generate hash from sorted list
                             shaderFeature.shaderFeatureHash = zp_fnv64_1a( shaderFeature.shaderFeatures );